@@ -2,9 +2,13 @@
 
 #include "commoninc.h"
 #include "utils.h"
+#include "aesni.h"
+#include "aesbitslice.h"
 
 using namespace std;
 
+#define AES_DEFAULT_PARALLEL_THRESHOLD (1 << 20)
+
 enum AESSize
 {
     AES128,
@@ -19,37 +23,54 @@ enum AESMode
     CFB1,
     CFB8,
     CFB128,
-    OFB
+    OFB,
+    CTR
 };
 
-struct AESStreamer
+enum AESEngine
 {
-    uint32_t bitOffset;
-    uint32_t r;
-    AESMode mode;
-    vector<uint8_t> data;
+    AES_REFERENCE,
+    AES_TTABLE,
+    AES_AESNI,
+    AES_BITSLICED
+};
 
-    AESStreamer() : bitOffset(0), r(128), mode(ECB) {};
-    AESStreamer(AESMode modeIn);
+struct AESKeySchedule
+{
+    uint32_t nk;
+    uint32_t nr;
+    uint32_t w[64];
+    uint32_t dw[64];
+    uint8_t niEnc[16 * AESNI_MAX_ROUND_KEYS];
+    uint8_t niDec[16 * AESNI_MAX_ROUND_KEYS];
+    bool bTables;
+
+    AESKeySchedule();
+    AESKeySchedule(const vector<uint32_t>& key, const bool bConstantTime = false);
 
-    void SetData(const vector<uint8_t>& dataIn);
-    void Reset();
-    void Next(uint32_t block[4]);
-    bool End();
+    void Expand(const vector<uint32_t>& key, const bool bConstantTime = false);
+    void ExpandTables();
 };
 
 struct AES
 {
     uint32_t state[4];
-    AESStreamer stream;
     AESMode mode;
+    AESEngine engine;
     uint32_t nk;
     uint32_t nr;
-    uint32_t w[64];
+    AESKeySchedule sched;
+    const AESKeySchedule* sharedSched;
+    vector<uint64_t> bsKeys;
     vector<uint32_t> iv;
+    uint32_t numThreads;
+    uint64_t parallelThreshold;
 
     AES(AESSize sz, AESMode modeIn);
 
+    void SetEngine(const AESEngine engineIn);
+    void SetThreading(const uint32_t numThreadsIn, const uint64_t parallelThresholdIn);
+
     void ClearState();
     void PrintState();
 
@@ -62,13 +83,12 @@ struct AES
     void InvShiftRows();
     void InvMixColumns();
 
+    void Cipher();
+    void InvCipher();
+
     void SetIV(const vector<uint32_t>& iv);
-    void RotateIVLeft(const uint32_t s);
-    void XORText(uint32_t txt[4], uint32_t s);
     void ExpandKey(const vector<uint32_t>& key);
-    void WriteBits(const uint32_t s, vector<uint8_t> &msgOut, const uint32_t offset);
-    void UpdateInputBlock(const uint32_t s);
-    void UpdateInputBlock(const uint32_t s, const uint32_t txt[4]);
+    void SetKey(const AESKeySchedule& schedIn);
 
     void Encrypt(const vector<uint8_t> &plainTxtIn,
         vector<uint8_t> &ciphTxtOut, const vector<uint32_t> &key
@@ -78,29 +98,38 @@ struct AES
         vector<uint8_t> &plainTxtOut, const vector<uint32_t> &key
     );
 
+    void Encrypt(const vector<uint8_t>& plainTxtIn, vector<uint8_t>& ciphTxtOut);
+    void Decrypt(const vector<uint8_t>& ciphTxtIn, vector<uint8_t>& plainTxtOut);
+
+    void Encrypt(const uint8_t* in, uint8_t* out, const uint64_t len);
+    void Decrypt(const uint8_t* in, uint8_t* out, const uint64_t len);
+
 private:
 
-    void EncryptECBCBC(const vector<uint8_t>& plainTxtIn,
-        vector<uint8_t>& ciphTxtOut, const vector<uint32_t>& key
-    );
+    const AESKeySchedule& Keys() const;
+    void ExpandBitsliced();
 
-    void DecryptECBCBC(const vector<uint8_t>& ciphTxtIn,
-        vector<uint8_t>& plainTxtOut, const vector<uint32_t>& key
-    );
+    void CipherBlock(const uint8_t in[16], uint8_t out[16]);
+    void InvCipherBlock(const uint8_t in[16], uint8_t out[16]);
 
-    void EncryptCFB(const vector<uint8_t>& plainTxtIn, const uint32_t s,
-        vector<uint8_t>& ciphTxtOut, const vector<uint32_t>& key
-    );
+    void EncryptAESNI(const uint8_t* in, uint8_t* out, const uint64_t len);
+    void DecryptAESNI(const uint8_t* in, uint8_t* out, const uint64_t len);
 
-    void DecryptCFB(const vector<uint8_t>& ciphTxtIn, const uint32_t s,
-        vector<uint8_t>& plainTxtOut, const vector<uint32_t>& key
-    );
+    void EncryptECBCBC(const uint8_t* in, uint8_t* out, const uint64_t len);
+    void DecryptECBCBC(const uint8_t* in, uint8_t* out, const uint64_t len);
 
-    void EncryptOFB(const vector<uint8_t>& plainTxtIn,
-        vector<uint8_t>& ciphTxtOut, const vector<uint32_t>& key
+    void CryptCFB(const uint8_t* in, uint8_t* out, const uint64_t len, const uint32_t s,
+        const bool bEncrypt
     );
 
-    void DecryptOFB(const vector<uint8_t>& ciphTxtIn,
-        vector<uint8_t>& plainTxtOut, const vector<uint32_t>& key
-    );
-};
\ No newline at end of file
+    void CryptOFB(const uint8_t* in, uint8_t* out, const uint64_t len);
+
+    void CryptCTR(const uint8_t* in, uint8_t* out, const uint64_t len);
+    void CryptCTRBlocks(const uint8_t* in, uint8_t* out, const uint64_t len, uint8_t ctr[16]);
+
+    void DecryptChained(const uint8_t* in, uint8_t* out, const uint64_t len);
+    void DecryptChainedBlocks(const uint8_t* in, uint8_t* out, const uint64_t nBlocks, uint8_t prev[16]);
+};
+
+void AESEncryptMultiKey(const AESSize sz, const AESEngine engine, const uint32_t* keys,
+    const uint8_t* in, uint8_t* out, const uint64_t numKeys, const uint64_t blocksPerKey);
\ No newline at end of file
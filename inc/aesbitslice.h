@@ -0,0 +1,18 @@
+#pragma once
+
+#include "commoninc.h"
+#include "utils.h"
+
+using namespace std;
+
+#define AESBS_BLOCKS            8
+#define AESBS_MAX_ROUND_KEYS    15
+#define AESBS_KEY_WORDS         (16 * AESBS_MAX_ROUND_KEYS)
+
+uint32_t AESBSSubWord(const uint32_t word);
+void AESBSExpandKey(const uint32_t* w, const uint32_t nr, uint64_t bsKeys[AESBS_KEY_WORDS]);
+
+void AESBSEncryptBlocks(const uint64_t* bsKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks);
+void AESBSDecryptBlocks(const uint64_t* bsKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks);
\ No newline at end of file
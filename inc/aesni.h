@@ -0,0 +1,56 @@
+#pragma once
+
+#include "commoninc.h"
+#include "utils.h"
+
+using namespace std;
+
+#define AESNI_MAX_ROUND_KEYS 15
+#define AESNI_MULTIKEY_LANES 8
+
+bool AESNISupported();
+
+void AESNIExpandKey(const uint8_t* key, const uint32_t nk,
+    uint8_t encKeys[16 * AESNI_MAX_ROUND_KEYS], uint8_t decKeys[16 * AESNI_MAX_ROUND_KEYS]);
+
+void AESNIEncryptBlock(const uint8_t* encKeys, const uint32_t nr, const uint8_t in[16], uint8_t out[16]);
+void AESNIDecryptBlock(const uint8_t* decKeys, const uint32_t nr, const uint8_t in[16], uint8_t out[16]);
+
+void AESNIEncryptECB(const uint8_t* encKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks);
+void AESNIDecryptECB(const uint8_t* decKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks);
+
+void AESNIEncryptCBC(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks);
+void AESNIDecryptCBC(const uint8_t* decKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks);
+
+void AESNIEncryptCFB128(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len);
+void AESNIDecryptCFB128(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len);
+
+void AESNICryptCFB1(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt);
+void AESNICryptCFB8(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt);
+
+void AESNICryptOFB(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len);
+
+void AESNICryptCTR(const uint8_t* encKeys, const uint32_t nr, uint8_t ctr[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len);
+
+void AESNIEncryptMultiKey(const uint8_t* keys, const uint32_t nk,
+    const uint8_t* in, uint8_t* out, const uint64_t numKeys, const uint64_t blocksPerKey);
+
+bool AESNIGCMSupported();
+
+void AESNIGHASHPrecompute(const uint8_t H[16], uint8_t hPowers[16 * 4]);
+void AESNIGHASH(const uint8_t* hPowers, uint8_t X[16], const uint8_t* data, const uint64_t nBlocks);
+
+void AESNIGCMEncrypt(const uint8_t* encKeys, const uint32_t nr, const uint8_t* hPowers,
+    uint8_t ctr[16], uint8_t X[16], const uint8_t* in, uint8_t* out, const uint64_t len);
+void AESNIGCMDecrypt(const uint8_t* encKeys, const uint32_t nr, const uint8_t* hPowers,
+    uint8_t ctr[16], uint8_t X[16], const uint8_t* in, uint8_t* out, const uint64_t len);
\ No newline at end of file
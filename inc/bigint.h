@@ -5,9 +5,17 @@
 
 using namespace std;
 
+#define BIGINT_LIMB_BITS    64
+#define BIGINT_LIMB_BYTES   8
+
+#define BIGINT_KARATSUBA_THRESHOLD      40
+#define BIGINT_TOOM3_THRESHOLD          480
+#define BIGINT_SQR_KARATSUBA_THRESHOLD  64
+#define BIGINT_SQR_TOOM3_THRESHOLD      640
+
 struct BigInt
 {
-    vector<uint8_t> data;
+    vector<uint64_t> data;
     uint64_t nBits;
 
     BigInt();
@@ -19,6 +27,8 @@ struct BigInt
     string GetDecimalString();
     string GetBinaryString();
     string GetHexString();
+    void GetBytes(vector<uint8_t>& bytes) const;
+    void Normalize();
 
     bool operator==(const BigInt& rhs) const;
     bool operator==(const uint64_t rhs);
@@ -29,12 +39,15 @@ struct BigInt
     BigInt& operator=(const BigInt& rhs);
     BigInt& operator<<=(uint64_t shift);
     BigInt& operator>>=(uint64_t shift);
+    BigInt operator<<(uint64_t shift) const;
+    BigInt operator>>(uint64_t shift) const;
     BigInt& operator+=(const BigInt& rhs);
     BigInt operator+(const BigInt& rhs) const;
     BigInt& operator-=(const BigInt& rhs);
     BigInt operator-(const BigInt& rhs) const;
     BigInt& operator*=(const BigInt& rhs);
     BigInt operator*(const BigInt& rhs) const;
+    BigInt Square() const;
     BigInt& operator*=(const uint8_t rhs);
     BigInt operator*(const uint8_t rhs) const;
     BigInt& operator/=(const BigInt& rhs);
@@ -49,6 +62,9 @@ struct BigInt
 };
 
 void BigIntRand(uint64_t nBits, BigInt& bigInt);
+void BigIntSetMulThresholds(const uint64_t karatsuba, const uint64_t toom3,
+    const uint64_t sqrKaratsuba, const uint64_t sqrToom3);
+void DivMod(const BigInt& dividend, const BigInt& divisor, BigInt& quotient, BigInt& remainder);
 bool IsSquareBigInt(const BigInt& i);
 BigInt GetModInverse(BigInt k, BigInt n);
 BigInt GetGCD(BigInt aIn, BigInt bIn);
\ No newline at end of file
@@ -12,4 +12,5 @@
 #include <assert.h>
 #include <regex>
 #include <cstring>
-#include <csignal>
\ No newline at end of file
+#include <csignal>
+#include <thread>
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "commoninc.h"
 #include "bigint.h"
+#include "modarith.h"
 #include "sha.h"
 
 using namespace std;
@@ -73,6 +74,16 @@ struct ECPoint
     }
 };
 
+struct ECJacobianPoint
+{
+    BigInt x;
+    BigInt y;
+    BigInt z;
+
+    ECJacobianPoint(BigInt xIn, BigInt yIn, BigInt zIn) : x(xIn), y(yIn), z(zIn) {}
+    ECJacobianPoint() : x(0), y(0), z(0) {}
+};
+
 struct DigSign
 {
     BigInt r;
@@ -107,8 +118,11 @@ struct EllipticCurve
 {
     DomainParams params;
     ECPoint G;
+    MontgomeryCtx field;
+    BigInt aMont;
+    BarrettCtx order;
 
-    EllipticCurve(DomainParams& paramsIn) : params(paramsIn) {}
+    EllipticCurve(DomainParams& paramsIn);
 
     ECPoint MultiplyBase(BigInt k);
     ECPoint Add(ECPoint r, ECPoint s);
@@ -118,4 +132,13 @@ struct EllipticCurve
         BigInt d,
         SHASize sz
     );
+
+private:
+
+    BigInt InverseMont(const BigInt& x) const;
+    ECPoint AddMont(const ECPoint& r, const ECPoint& s) const;
+    ECPoint DoubleMont(const ECPoint& r) const;
+    ECJacobianPoint DoubleJacobian(const ECJacobianPoint& r) const;
+    ECJacobianPoint AddMixed(const ECJacobianPoint& r, const ECPoint& s) const;
+    ECPoint ToAffine(const ECJacobianPoint& r) const;
 };
\ No newline at end of file
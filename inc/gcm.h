@@ -0,0 +1,63 @@
+#pragma once
+
+#include "commoninc.h"
+#include "utils.h"
+#include "aes.h"
+
+using namespace std;
+
+#define GCM_BLOCK_BYTES     16
+#define GCM_CHUNK_BLOCKS    16
+
+enum GHASHEngine
+{
+    GHASH_4BIT,
+    GHASH_8BIT,
+    GHASH_PCLMUL
+};
+
+struct GCM
+{
+    AES cipher;
+    AESKeySchedule sched;
+    GHASHEngine ghashEngine;
+    uint8_t H[GCM_BLOCK_BYTES];
+    uint64_t HL4[16];
+    uint64_t HH4[16];
+    uint64_t HL8[256];
+    uint64_t HH8[256];
+    uint8_t hPowers[4 * GCM_BLOCK_BYTES];
+
+    GCM(AESSize sz);
+    GCM(const GCM&) = delete;
+    GCM& operator=(const GCM&) = delete;
+
+    void SetKey(const vector<uint32_t>& key);
+    void SetEngine(const AESEngine engineIn);
+    void SetGHASHEngine(const GHASHEngine ghashEngineIn);
+
+    void Encrypt(const vector<uint8_t>& iv, const vector<uint8_t>& aad,
+        const vector<uint8_t>& plainTxtIn, vector<uint8_t>& ciphTxtOut,
+        vector<uint8_t>& tagOut, const uint32_t tagBytes = GCM_BLOCK_BYTES
+    );
+
+    bool Decrypt(const vector<uint8_t>& iv, const vector<uint8_t>& aad,
+        const vector<uint8_t>& ciphTxtIn, const vector<uint8_t>& tagIn,
+        vector<uint8_t>& plainTxtOut
+    );
+
+private:
+
+    void BuildTables();
+    void EncryptBlock(const uint8_t in[GCM_BLOCK_BYTES], uint8_t out[GCM_BLOCK_BYTES]);
+    void MultH(uint8_t X[GCM_BLOCK_BYTES]);
+    void GHASHBlocks(uint8_t X[GCM_BLOCK_BYTES], const uint8_t* data, const uint64_t nBlocks);
+    void GHASHPadded(uint8_t X[GCM_BLOCK_BYTES], const uint8_t* data, const uint64_t len);
+    void GHASHLengths(uint8_t X[GCM_BLOCK_BYTES], const uint64_t aadLen, const uint64_t txtLen);
+    void ComputeJ0(const vector<uint8_t>& iv, uint8_t J0[GCM_BLOCK_BYTES]);
+    void CryptChunked(uint8_t ctr[GCM_BLOCK_BYTES], uint8_t X[GCM_BLOCK_BYTES],
+        const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt);
+    void Crypt(const vector<uint8_t>& iv, const vector<uint8_t>& aad,
+        const vector<uint8_t>& txtIn, vector<uint8_t>& txtOut,
+        uint8_t S[GCM_BLOCK_BYTES], const bool bEncrypt);
+};
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "commoninc.h"
+#include "utils.h"
+
+using namespace std;
+
+#define KECCAK_AVX2_LANES       4
+#define KECCAK_AVX512_LANES     8
+
+void KeccakF1600x4AVX2(const uint64_t rc[24], uint64_t a[25 * KECCAK_AVX2_LANES]);
+void KeccakF1600x8AVX512(const uint64_t rc[24], uint64_t a[25 * KECCAK_AVX512_LANES]);
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "commoninc.h"
+#include "bigint.h"
+
+using namespace std;
+
+#define MONTGOMERY_EXP_WINDOW_BITS  4
+#define MONTGOMERY_STACK_LIMBS      32
+#define MONTGOMERY_SQR_THRESHOLD    16
+#define BARRETT_STACK_LIMBS         32
+
+struct MontgomeryCtx
+{
+    BigInt m;
+    uint64_t nLimbs;
+    uint64_t mInv;
+    BigInt r2;
+    BigInt one;
+
+    MontgomeryCtx(const BigInt& modulus);
+
+    BigInt ToMont(const BigInt& a) const;
+    BigInt FromMont(const BigInt& a) const;
+
+    BigInt Mul(const BigInt& a, const BigInt& b) const;
+    BigInt Sqr(const BigInt& a) const;
+    BigInt Add(const BigInt& a, const BigInt& b) const;
+    BigInt Sub(const BigInt& a, const BigInt& b) const;
+    BigInt Exp(const BigInt& a, const BigInt& e) const;
+
+private:
+
+    void Load(const BigInt& a, uint64_t* out) const;
+    void MulLimbs(const uint64_t* a, const uint64_t* b, uint64_t* t) const;
+    BigInt Finish(uint64_t* r) const;
+    BigInt Reduce(vector<uint64_t>& t) const;
+};
+
+struct BarrettCtx
+{
+    BigInt m;
+    uint64_t nLimbs;
+    BigInt mu;
+
+    BarrettCtx(const BigInt& modulus);
+
+    BigInt Reduce(const BigInt& x) const;
+    BigInt Mul(const BigInt& a, const BigInt& b) const;
+    BigInt Sqr(const BigInt& a) const;
+};
+
+BigInt ModExp(const BigInt& base, const BigInt& exp, const BigInt& mod);
\ No newline at end of file
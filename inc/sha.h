@@ -7,6 +7,7 @@ using namespace std;
 
 #define ROTR32(x, n) (((x) >> (n)) | ((x) << ((32 - n))))
 #define ROTR64(x, n) (((x) >> (n)) | ((x) << ((64 - n))))
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> ((64 - n))))
 
 #define STATE_W             5
 #define STATE_H             5
@@ -48,12 +49,40 @@ enum PrintMode
     LINEAR
 };
 
+#define SHA2_MAX_BLOCK_BYTES 128
+
+enum SHA2Engine
+{
+    SHA2_SCALAR,
+    SHA2_SHANI
+};
+
 struct SHA2
 {
+    SHASize sz;
+    SHA2Engine engine;
+    uint32_t H32[8];
+    uint64_t H64[8];
+    uint8_t buf[SHA2_MAX_BLOCK_BYTES];
+    uint64_t bufLen;
+    uint64_t msgLen;
+
+    SHA2();
+
+    void SetEngine(const SHA2Engine engineIn);
     void Hash(SHASize sz, vector<uint8_t>& msg, vector<uint8_t>& md);
 
+    void Init(SHASize szIn);
+    void Update(const uint8_t* data, uint64_t len);
+    void Update(const vector<uint8_t>& data);
+    void Final(vector<uint8_t>& md);
+
 private:
 
+    uint64_t BlockBytes();
+    void Compress256(const uint8_t* blocks, uint64_t nBlocks);
+    void Compress512(const uint8_t* blocks, uint64_t nBlocks);
+
     uint32_t ch32(uint32_t x, uint32_t y, uint32_t z);
     uint32_t maj32(uint32_t x, uint32_t y, uint32_t z);
     uint32_t Sig032(uint32_t x);
@@ -74,6 +103,27 @@ private:
     void Hash512(vector<uint8_t>& msg, vector<uint8_t>& md);
 };
 
+enum SHA2MultiEngine
+{
+    SHA2_MULTI_SERIAL,
+    SHA2_MULTI_AVX2,
+    SHA2_MULTI_AVX512
+};
+
+struct SHA2Multi
+{
+    SHA2MultiEngine engine;
+
+    SHA2Multi();
+
+    void SetEngine(const SHA2MultiEngine engineIn);
+    uint32_t Lanes(const SHASize sz);
+
+    void Hash(const SHASize sz, const uint8_t* const* msgs, const uint64_t* lens,
+        uint8_t* mds, const uint64_t numMsgs);
+    void Hash(const SHASize sz, const vector<vector<uint8_t>>& msgs, vector<vector<uint8_t>>& mds);
+};
+
 struct SHA3Params
 {
     SHASize sz;
@@ -117,6 +167,9 @@ struct SHA3
     SHA3Params params;
     uint64_t state[STATE_W * STATE_H];
     SHAStreamer stream;
+    uint8_t buf[STATE_BYTES];
+    uint64_t bufLen;
+    uint64_t squeezeOffset;
 
     SHA3(SHASize sz);
 
@@ -124,7 +177,15 @@ struct SHA3
     void PrintState(PrintMode mode = XY);
 
     void Hash(vector<uint8_t> &msg, vector<uint8_t> &md);
+    void Init();
+    void Update(const uint8_t* data, uint64_t len);
+    void Update(const vector<uint8_t>& data);
+    void Final(vector<uint8_t>& md);
+    void AbsorbFinal(const uint8_t suffix);
+    void Squeeze(uint8_t* out, uint64_t len);
+
     void SpongeAbsorbBlock(vector<uint64_t> &block);
+    void SpongeAbsorbBlock(const uint8_t* block);
     void ApplyKeccak();
     void SpongeSqueezeBlock(vector<uint8_t>& md);
 
@@ -142,4 +203,138 @@ struct SHA3
 private:
 
     SHA3();
+};
+
+void KeccakF1600(uint64_t a[STATE_W * STATE_H]);
+
+enum SHAKESize
+{
+    SHAKE128,
+    SHAKE256
+};
+
+struct SHAKE
+{
+    SHA3 sponge;
+    uint8_t suffix;
+    bool bSqueezing;
+
+    SHAKE(SHAKESize sz);
+
+    void Init();
+    void Update(const uint8_t* data, uint64_t len);
+    void Update(const vector<uint8_t>& data);
+    void Squeeze(uint8_t* out, uint64_t len);
+    void Squeeze(vector<uint8_t>& out, uint64_t len);
+
+    void Hash(const vector<uint8_t>& msg, vector<uint8_t>& out, uint64_t len);
+};
+
+void LeftEncode(const uint64_t x, vector<uint8_t>& out);
+void RightEncode(const uint64_t x, vector<uint8_t>& out);
+void EncodeString(const uint8_t* str, const uint64_t len, vector<uint8_t>& out);
+void BytePad(vector<uint8_t>& x, const uint64_t w);
+
+struct CSHAKE
+{
+    SHAKE xof;
+    uint64_t prefixState[STATE_W * STATE_H];
+
+    CSHAKE(SHAKESize sz, const vector<uint8_t>& N = {}, const vector<uint8_t>& S = {});
+
+    void Init();
+    void Update(const uint8_t* data, uint64_t len);
+    void Update(const vector<uint8_t>& data);
+    void Squeeze(uint8_t* out, uint64_t len);
+    void Squeeze(vector<uint8_t>& out, uint64_t len);
+
+    void Hash(const vector<uint8_t>& msg, vector<uint8_t>& out, uint64_t len);
+};
+
+#define KMAC_MIN_MAC_BYTES 4
+
+struct KMAC
+{
+    CSHAKE cshake;
+    uint64_t keyState[STATE_W * STATE_H];
+    bool bKeySet;
+
+    KMAC(SHAKESize sz, const vector<uint8_t>& S = {});
+
+    void SetKey(const uint8_t* key, const uint64_t keyLen);
+    void SetKey(const vector<uint8_t>& key);
+
+    void Init();
+    void Update(const uint8_t* data, uint64_t len);
+    void Update(const vector<uint8_t>& data);
+    void Final(uint8_t* mac, const uint64_t macLen);
+    void FinalXOF(uint8_t* out, const uint64_t len);
+
+    void Mac(const vector<uint8_t>& msg, vector<uint8_t>& mac, const uint64_t macLen);
+    bool Verify(const vector<uint8_t>& msg, const vector<uint8_t>& mac, const uint64_t macLen);
+};
+
+#define KECCAK_MAX_LANES 8
+
+enum KeccakEngine
+{
+    KECCAK_SCALAR,
+    KECCAK_AVX2,
+    KECCAK_AVX512
+};
+
+struct KeccakMulti
+{
+    KeccakEngine engine;
+    uint64_t a[STATE_W * STATE_H * KECCAK_MAX_LANES];
+
+    KeccakMulti();
+
+    void SetEngine(const KeccakEngine engineIn);
+    uint32_t Lanes();
+
+    void ClearState();
+    void Load(const uint32_t lane, const uint64_t state[STATE_W * STATE_H]);
+    void Store(const uint32_t lane, uint64_t state[STATE_W * STATE_H]);
+    void Permute();
+
+    void Sponge(const uint64_t rateBytes, const uint8_t suffix, const uint8_t* const* msgs,
+        const uint64_t* lens, uint8_t* outs, const uint64_t outBytes, const uint64_t numMsgs);
+};
+
+struct SHA3Multi
+{
+    KeccakMulti keccak;
+
+    void SetEngine(const KeccakEngine engineIn);
+
+    void Hash(const SHASize sz, const uint8_t* const* msgs, const uint64_t* lens,
+        uint8_t* mds, const uint64_t numMsgs);
+    void Hash(const SHASize sz, const vector<vector<uint8_t>>& msgs, vector<vector<uint8_t>>& mds);
+};
+
+#define PARALLELHASH_DEFAULT_THRESHOLD (1 << 20)
+
+struct ParallelHash
+{
+    SHAKESize sz;
+    uint64_t blockBytes;
+    vector<uint8_t> S;
+    KeccakEngine engine;
+    uint32_t numThreads;
+    uint64_t parallelThreshold;
+
+    ParallelHash(SHAKESize szIn, const uint64_t blockBytesIn, const vector<uint8_t>& SIn = {});
+
+    void SetEngine(const KeccakEngine engineIn);
+    void SetThreading(const uint32_t numThreadsIn, const uint64_t parallelThresholdIn);
+
+    void Hash(const uint8_t* msg, const uint64_t len, uint8_t* out, const uint64_t outLen);
+    void Hash(const vector<uint8_t>& msg, vector<uint8_t>& out, const uint64_t outLen);
+    void HashXOF(const vector<uint8_t>& msg, vector<uint8_t>& out, const uint64_t outLen);
+
+private:
+
+    void Compute(const uint8_t* msg, const uint64_t len, uint8_t* out, const uint64_t outLen,
+        const bool bXOF);
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "commoninc.h"
+#include "utils.h"
+
+using namespace std;
+
+#define SHA256_AVX2_LANES       8
+#define SHA256_AVX512_LANES     16
+#define SHA512_AVX2_LANES       4
+#define SHA512_AVX512_LANES     8
+
+void SHA256HashManyAVX2(const uint32_t k[64], const uint32_t iv[8], const uint32_t mdBytes,
+    const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds, const uint64_t numMsgs);
+void SHA256HashManyAVX512(const uint32_t k[64], const uint32_t iv[8], const uint32_t mdBytes,
+    const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds, const uint64_t numMsgs);
+
+void SHA512HashManyAVX2(const uint64_t k[80], const uint64_t iv[8], const uint32_t mdBytes,
+    const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds, const uint64_t numMsgs);
+void SHA512HashManyAVX512(const uint64_t k[80], const uint64_t iv[8], const uint32_t mdBytes,
+    const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds, const uint64_t numMsgs);
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "commoninc.h"
+#include "utils.h"
+
+using namespace std;
+
+bool SHANISupported();
+
+void SHANICompress256(const uint32_t k[64], uint32_t H[8], const uint8_t* blocks, const uint64_t nBlocks);
\ No newline at end of file
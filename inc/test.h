@@ -57,6 +57,11 @@ struct TestResult
 };
 
 typedef TestResult(*pfnTestFunc)(void);
+typedef void(*pfnBenchFunc)(void);
+
+double GetTimeSeconds();
+void PrintThroughput(const string& name, const uint64_t bytes, const double seconds);
+void PrintOpTime(const string& name, const uint64_t ops, const double seconds);
 
 TestResult TestAssignBigInt();
 TestResult TestCmpLShiftBigIntCorrect();
@@ -64,11 +69,17 @@ TestResult TestCmpRShiftBigIntCorrect();
 TestResult TestCmpAddBigIntCorrect();
 TestResult TestCmpSubBigIntCorrect();
 TestResult TestCmpMulBigIntCorrect();
+TestResult TestFastMulBigIntCorrect();
 TestResult TestCmpDivBigIntCorrect();
 TestResult TestCmpModBigIntCorrect();
+TestResult TestDivModBigIntCorrect();
+TestResult TestMontgomeryBigIntCorrect();
+TestResult TestBarrettBigIntCorrect();
 TestResult TestSqrtBigIntCorrect();
 TestResult TestGetModInverseBigInt();
 
+TestResult TestECMultiplyBase();
+
 TestResult GetNearestSquareFactors();
 
 TestResult TestDiff();
@@ -84,6 +95,10 @@ TestResult TestSHA256Long();
 TestResult TestSHA384Long();
 TestResult TestSHA512Long();
 
+TestResult TestSHA2Streaming();
+TestResult TestSHA2Engines();
+TestResult TestSHA2Multi();
+
 TestResult TestSHA3224Short();
 TestResult TestSHA3224Long();
 TestResult TestSHA3224Monte();
@@ -100,6 +115,14 @@ TestResult TestSHA3512Short();
 TestResult TestSHA3512Long();
 TestResult TestSHA3512Monte();
 
+TestResult TestSHA3Streaming();
+TestResult TestKeccakMulti();
+TestResult TestSHA3Multi();
+TestResult TestSHAKE();
+TestResult TestCSHAKE();
+TestResult TestParallelHash();
+TestResult TestKMAC();
+
 TestResult TestAESEncrypt128ECB();
 TestResult TestAESDecrypt128ECB();
 TestResult TestAESEncrypt192ECB();
@@ -146,4 +169,50 @@ TestResult TestAESDecrypt128OFB();
 TestResult TestAESDecrypt192OFB();
 TestResult TestAESDecrypt256OFB();
 
-TestResult TestSigGen();
\ No newline at end of file
+TestResult TestAESEncrypt128CTR();
+TestResult TestAESEncrypt192CTR();
+TestResult TestAESEncrypt256CTR();
+
+TestResult TestAESDecrypt128CTR();
+TestResult TestAESDecrypt192CTR();
+TestResult TestAESDecrypt256CTR();
+
+TestResult TestThreadPoolStress();
+
+TestResult TestAESEngines();
+TestResult TestAESKeySchedule();
+TestResult TestAESCTRParallel();
+TestResult TestAESChainedDecrypt();
+TestResult TestAESInPlace();
+TestResult TestAESMultiKey();
+
+TestResult TestAESGCM128();
+TestResult TestAESGCM192();
+TestResult TestAESGCM256();
+TestResult TestAESGCMEngines();
+
+TestResult TestAESXTS128();
+TestResult TestAESXTS256();
+TestResult TestAESXTSSectors();
+
+TestResult TestSigGen();
+
+void BenchAESEngines();
+void BenchAESKeySchedule();
+void BenchAESMultiKey();
+void BenchAESCFBSegments();
+void BenchAESCTR();
+void BenchAESCBCDecrypt();
+void BenchAESGCM();
+void BenchAESXTS();
+
+void BenchSHA2();
+void BenchSHA2Multi();
+void BenchSHA3Multi();
+void BenchSHAKE();
+void BenchParallelHash();
+void BenchKMAC();
+
+void BenchBigIntMul();
+void BenchBigIntMulThresholds();
+void BenchBarrettReduce();
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "commoninc.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+struct ThreadPoolJob
+{
+    const function<void(uint64_t)>* task;
+    uint64_t numTasks;
+    atomic<uint64_t> nextTask;
+    uint64_t tasksDone;
+    exception_ptr taskError;
+
+    ThreadPoolJob(const function<void(uint64_t)>* taskIn, const uint64_t numTasksIn) :
+        task(taskIn), numTasks(numTasksIn), nextTask(0), tasksDone(0) {}
+};
+
+struct ThreadPool
+{
+    vector<thread> workers;
+    mutex mtx;
+    mutex callMtx;
+    condition_variable wakeCv;
+    condition_variable doneCv;
+    shared_ptr<ThreadPoolJob> job;
+    uint64_t generation;
+    bool bStop;
+
+    ThreadPool(const uint32_t numWorkers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t Size() const;
+    void ParallelFor(const uint64_t numTasksIn, const function<void(uint64_t)>& taskIn);
+
+    static ThreadPool& Global();
+
+private:
+
+    void WorkerLoop();
+    void RunTasks(ThreadPoolJob& jobIn);
+};
\ No newline at end of file
@@ -7,6 +7,10 @@
 #include "bcrypt.h"
 #endif
 
+#if defined(__x86_64__) || defined(__i386__)
+#define NISTCRYPTO_X86 1
+#endif
+
 using namespace std;
 
 #define BYTES(x) (((x) / 8) + ((x) % 8 ? 1 : 0))
@@ -27,10 +31,25 @@ using namespace std;
 
 #define BYTE32(x, b) (((x) & (0xFF << (8 * (b)))) >> (8 * (b)))
 
+enum CPUFeature
+{
+    CPU_SSSE3,
+    CPU_SSE41,
+    CPU_AESNI,
+    CPU_PCLMUL,
+    CPU_SHA,
+    CPU_AVX2,
+    CPU_AVX512,
+    CPU_NUM_FEATURES
+};
+
 void StringToHexArray(const string val, vector<uint8_t>& bytes, bool bLittleEndian = true);
 void HexArrayToString(const vector<uint8_t>& bytes, string &out, bool bLittleEndian = true);
 uint8_t Parity(uint8_t val);
 void GenKey(uint64_t bitLen, vector<uint8_t>& keyOut);
 void Seive(const uint64_t min, const uint64_t max, vector<uint64_t>& primes);
 
-uint64_t InvModN(const uint64_t k, const uint64_t n);
\ No newline at end of file
+uint64_t InvModN(const uint64_t k, const uint64_t n);
+
+bool CPUSupports(const CPUFeature feature);
+bool CPUHasFeature(const CPUFeature feature);
\ No newline at end of file
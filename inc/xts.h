@@ -0,0 +1,47 @@
+#pragma once
+
+#include "commoninc.h"
+#include "utils.h"
+#include "aes.h"
+
+using namespace std;
+
+#define XTS_BLOCK_BYTES         16
+#define XTS_BATCH_BLOCKS        32
+#define XTS_SECTOR_BYTES        4096
+
+struct XTS
+{
+    AESSize size;
+    AES dataCipher;
+    AES tweakCipher;
+    AESKeySchedule dataSched;
+    AESKeySchedule tweakSched;
+    uint32_t numThreads;
+    uint64_t parallelThreshold;
+
+    XTS(AESSize sz);
+    XTS(const XTS&) = delete;
+    XTS& operator=(const XTS&) = delete;
+
+    void SetKey(const vector<uint32_t>& key);
+    void SetEngine(const AESEngine engineIn);
+    void SetThreading(const uint32_t numThreadsIn, const uint64_t parallelThresholdIn);
+
+    void EncryptSector(const uint8_t tweak[XTS_BLOCK_BYTES], const uint8_t* in,
+        uint8_t* out, const uint64_t len);
+    void DecryptSector(const uint8_t tweak[XTS_BLOCK_BYTES], const uint8_t* in,
+        uint8_t* out, const uint64_t len);
+
+    void EncryptSectors(const uint64_t firstSector, const uint64_t sectorBytes,
+        const uint8_t* in, uint8_t* out, const uint64_t len);
+    void DecryptSectors(const uint64_t firstSector, const uint64_t sectorBytes,
+        const uint8_t* in, uint8_t* out, const uint64_t len);
+
+    static void SectorTweak(const uint64_t sectorNum, uint8_t tweak[XTS_BLOCK_BYTES]);
+
+private:
+
+    void CryptSectors(const uint64_t firstSector, const uint64_t sectorBytes,
+        const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt);
+};
\ No newline at end of file
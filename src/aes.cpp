@@ -1,4 +1,9 @@
 #include "aes.h"
+#include "threadpool.h"
+
+static const uint32_t ctrBatchBlocks = 4;
+static const uint32_t chainBatchBlocks = 8;
+static const uint32_t multiKeyChunk = 64;
 
 static const uint32_t rcs[11] =
 {
@@ -55,6 +60,294 @@ static const uint32_t sboxInv[16][16] =
     0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
 };
 
+static const uint32_t Te0[256] =
+{
+    0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d, 0xfff2f20d, 0xd66b6bbd, 0xde6f6fb1, 0x91c5c554,
+    0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d, 0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a,
+    0x8fcaca45, 0x1f82829d, 0x89c9c940, 0xfa7d7d87, 0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+    0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea, 0x239c9cbf, 0x53a4a4f7, 0xe4727296, 0x9bc0c05b,
+    0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a, 0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f,
+    0x6834345c, 0x51a5a5f4, 0xd1e5e534, 0xf9f1f108, 0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+    0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e, 0x30181828, 0x379696a1, 0x0a05050f, 0x2f9a9ab5,
+    0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d, 0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f,
+    0x1209091b, 0x1d83839e, 0x582c2c74, 0x341a1a2e, 0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+    0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce, 0x5229297b, 0xdde3e33e, 0x5e2f2f71, 0x13848497,
+    0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c, 0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed,
+    0xd46a6abe, 0x8dcbcb46, 0x67bebed9, 0x7239394b, 0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+    0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16, 0x864343c5, 0x9a4d4dd7, 0x66333355, 0x11858594,
+    0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81, 0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3,
+    0xa25151f3, 0x5da3a3fe, 0x804040c0, 0x058f8f8a, 0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+    0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163, 0x20101030, 0xe5ffff1a, 0xfdf3f30e, 0xbfd2d26d,
+    0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f, 0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739,
+    0x93c4c457, 0x55a7a7f2, 0xfc7e7e82, 0x7a3d3d47, 0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+    0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f, 0x44222266, 0x542a2a7e, 0x3b9090ab, 0x0b888883,
+    0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c, 0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76,
+    0xdbe0e03b, 0x64323256, 0x743a3a4e, 0x140a0a1e, 0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+    0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6, 0x399191a8, 0x319595a4, 0xd3e4e437, 0xf279798b,
+    0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7, 0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0,
+    0xd86c6cb4, 0xac5656fa, 0xf3f4f407, 0xcfeaea25, 0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+    0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72, 0x381c1c24, 0x57a6a6f1, 0x73b4b4c7, 0x97c6c651,
+    0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21, 0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85,
+    0xe0707090, 0x7c3e3e42, 0x71b5b5c4, 0xcc6666aa, 0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+    0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0, 0x17868691, 0x99c1c158, 0x3a1d1d27, 0x279e9eb9,
+    0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133, 0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7,
+    0x2d9b9bb6, 0x3c1e1e22, 0x15878792, 0xc9e9e920, 0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+    0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17, 0x65bfbfda, 0xd7e6e631, 0x844242c6, 0xd06868b8,
+    0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11, 0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a
+};
+
+static const uint32_t Te1[256] =
+{
+    0xa5c66363, 0x84f87c7c, 0x99ee7777, 0x8df67b7b, 0x0dfff2f2, 0xbdd66b6b, 0xb1de6f6f, 0x5491c5c5,
+    0x50603030, 0x03020101, 0xa9ce6767, 0x7d562b2b, 0x19e7fefe, 0x62b5d7d7, 0xe64dabab, 0x9aec7676,
+    0x458fcaca, 0x9d1f8282, 0x4089c9c9, 0x87fa7d7d, 0x15effafa, 0xebb25959, 0xc98e4747, 0x0bfbf0f0,
+    0xec41adad, 0x67b3d4d4, 0xfd5fa2a2, 0xea45afaf, 0xbf239c9c, 0xf753a4a4, 0x96e47272, 0x5b9bc0c0,
+    0xc275b7b7, 0x1ce1fdfd, 0xae3d9393, 0x6a4c2626, 0x5a6c3636, 0x417e3f3f, 0x02f5f7f7, 0x4f83cccc,
+    0x5c683434, 0xf451a5a5, 0x34d1e5e5, 0x08f9f1f1, 0x93e27171, 0x73abd8d8, 0x53623131, 0x3f2a1515,
+    0x0c080404, 0x5295c7c7, 0x65462323, 0x5e9dc3c3, 0x28301818, 0xa1379696, 0x0f0a0505, 0xb52f9a9a,
+    0x090e0707, 0x36241212, 0x9b1b8080, 0x3ddfe2e2, 0x26cdebeb, 0x694e2727, 0xcd7fb2b2, 0x9fea7575,
+    0x1b120909, 0x9e1d8383, 0x74582c2c, 0x2e341a1a, 0x2d361b1b, 0xb2dc6e6e, 0xeeb45a5a, 0xfb5ba0a0,
+    0xf6a45252, 0x4d763b3b, 0x61b7d6d6, 0xce7db3b3, 0x7b522929, 0x3edde3e3, 0x715e2f2f, 0x97138484,
+    0xf5a65353, 0x68b9d1d1, 0x00000000, 0x2cc1eded, 0x60402020, 0x1fe3fcfc, 0xc879b1b1, 0xedb65b5b,
+    0xbed46a6a, 0x468dcbcb, 0xd967bebe, 0x4b723939, 0xde944a4a, 0xd4984c4c, 0xe8b05858, 0x4a85cfcf,
+    0x6bbbd0d0, 0x2ac5efef, 0xe54faaaa, 0x16edfbfb, 0xc5864343, 0xd79a4d4d, 0x55663333, 0x94118585,
+    0xcf8a4545, 0x10e9f9f9, 0x06040202, 0x81fe7f7f, 0xf0a05050, 0x44783c3c, 0xba259f9f, 0xe34ba8a8,
+    0xf3a25151, 0xfe5da3a3, 0xc0804040, 0x8a058f8f, 0xad3f9292, 0xbc219d9d, 0x48703838, 0x04f1f5f5,
+    0xdf63bcbc, 0xc177b6b6, 0x75afdada, 0x63422121, 0x30201010, 0x1ae5ffff, 0x0efdf3f3, 0x6dbfd2d2,
+    0x4c81cdcd, 0x14180c0c, 0x35261313, 0x2fc3ecec, 0xe1be5f5f, 0xa2359797, 0xcc884444, 0x392e1717,
+    0x5793c4c4, 0xf255a7a7, 0x82fc7e7e, 0x477a3d3d, 0xacc86464, 0xe7ba5d5d, 0x2b321919, 0x95e67373,
+    0xa0c06060, 0x98198181, 0xd19e4f4f, 0x7fa3dcdc, 0x66442222, 0x7e542a2a, 0xab3b9090, 0x830b8888,
+    0xca8c4646, 0x29c7eeee, 0xd36bb8b8, 0x3c281414, 0x79a7dede, 0xe2bc5e5e, 0x1d160b0b, 0x76addbdb,
+    0x3bdbe0e0, 0x56643232, 0x4e743a3a, 0x1e140a0a, 0xdb924949, 0x0a0c0606, 0x6c482424, 0xe4b85c5c,
+    0x5d9fc2c2, 0x6ebdd3d3, 0xef43acac, 0xa6c46262, 0xa8399191, 0xa4319595, 0x37d3e4e4, 0x8bf27979,
+    0x32d5e7e7, 0x438bc8c8, 0x596e3737, 0xb7da6d6d, 0x8c018d8d, 0x64b1d5d5, 0xd29c4e4e, 0xe049a9a9,
+    0xb4d86c6c, 0xfaac5656, 0x07f3f4f4, 0x25cfeaea, 0xafca6565, 0x8ef47a7a, 0xe947aeae, 0x18100808,
+    0xd56fbaba, 0x88f07878, 0x6f4a2525, 0x725c2e2e, 0x24381c1c, 0xf157a6a6, 0xc773b4b4, 0x5197c6c6,
+    0x23cbe8e8, 0x7ca1dddd, 0x9ce87474, 0x213e1f1f, 0xdd964b4b, 0xdc61bdbd, 0x860d8b8b, 0x850f8a8a,
+    0x90e07070, 0x427c3e3e, 0xc471b5b5, 0xaacc6666, 0xd8904848, 0x05060303, 0x01f7f6f6, 0x121c0e0e,
+    0xa3c26161, 0x5f6a3535, 0xf9ae5757, 0xd069b9b9, 0x91178686, 0x5899c1c1, 0x273a1d1d, 0xb9279e9e,
+    0x38d9e1e1, 0x13ebf8f8, 0xb32b9898, 0x33221111, 0xbbd26969, 0x70a9d9d9, 0x89078e8e, 0xa7339494,
+    0xb62d9b9b, 0x223c1e1e, 0x92158787, 0x20c9e9e9, 0x4987cece, 0xffaa5555, 0x78502828, 0x7aa5dfdf,
+    0x8f038c8c, 0xf859a1a1, 0x80098989, 0x171a0d0d, 0xda65bfbf, 0x31d7e6e6, 0xc6844242, 0xb8d06868,
+    0xc3824141, 0xb0299999, 0x775a2d2d, 0x111e0f0f, 0xcb7bb0b0, 0xfca85454, 0xd66dbbbb, 0x3a2c1616
+};
+
+static const uint32_t Te2[256] =
+{
+    0x63a5c663, 0x7c84f87c, 0x7799ee77, 0x7b8df67b, 0xf20dfff2, 0x6bbdd66b, 0x6fb1de6f, 0xc55491c5,
+    0x30506030, 0x01030201, 0x67a9ce67, 0x2b7d562b, 0xfe19e7fe, 0xd762b5d7, 0xabe64dab, 0x769aec76,
+    0xca458fca, 0x829d1f82, 0xc94089c9, 0x7d87fa7d, 0xfa15effa, 0x59ebb259, 0x47c98e47, 0xf00bfbf0,
+    0xadec41ad, 0xd467b3d4, 0xa2fd5fa2, 0xafea45af, 0x9cbf239c, 0xa4f753a4, 0x7296e472, 0xc05b9bc0,
+    0xb7c275b7, 0xfd1ce1fd, 0x93ae3d93, 0x266a4c26, 0x365a6c36, 0x3f417e3f, 0xf702f5f7, 0xcc4f83cc,
+    0x345c6834, 0xa5f451a5, 0xe534d1e5, 0xf108f9f1, 0x7193e271, 0xd873abd8, 0x31536231, 0x153f2a15,
+    0x040c0804, 0xc75295c7, 0x23654623, 0xc35e9dc3, 0x18283018, 0x96a13796, 0x050f0a05, 0x9ab52f9a,
+    0x07090e07, 0x12362412, 0x809b1b80, 0xe23ddfe2, 0xeb26cdeb, 0x27694e27, 0xb2cd7fb2, 0x759fea75,
+    0x091b1209, 0x839e1d83, 0x2c74582c, 0x1a2e341a, 0x1b2d361b, 0x6eb2dc6e, 0x5aeeb45a, 0xa0fb5ba0,
+    0x52f6a452, 0x3b4d763b, 0xd661b7d6, 0xb3ce7db3, 0x297b5229, 0xe33edde3, 0x2f715e2f, 0x84971384,
+    0x53f5a653, 0xd168b9d1, 0x00000000, 0xed2cc1ed, 0x20604020, 0xfc1fe3fc, 0xb1c879b1, 0x5bedb65b,
+    0x6abed46a, 0xcb468dcb, 0xbed967be, 0x394b7239, 0x4ade944a, 0x4cd4984c, 0x58e8b058, 0xcf4a85cf,
+    0xd06bbbd0, 0xef2ac5ef, 0xaae54faa, 0xfb16edfb, 0x43c58643, 0x4dd79a4d, 0x33556633, 0x85941185,
+    0x45cf8a45, 0xf910e9f9, 0x02060402, 0x7f81fe7f, 0x50f0a050, 0x3c44783c, 0x9fba259f, 0xa8e34ba8,
+    0x51f3a251, 0xa3fe5da3, 0x40c08040, 0x8f8a058f, 0x92ad3f92, 0x9dbc219d, 0x38487038, 0xf504f1f5,
+    0xbcdf63bc, 0xb6c177b6, 0xda75afda, 0x21634221, 0x10302010, 0xff1ae5ff, 0xf30efdf3, 0xd26dbfd2,
+    0xcd4c81cd, 0x0c14180c, 0x13352613, 0xec2fc3ec, 0x5fe1be5f, 0x97a23597, 0x44cc8844, 0x17392e17,
+    0xc45793c4, 0xa7f255a7, 0x7e82fc7e, 0x3d477a3d, 0x64acc864, 0x5de7ba5d, 0x192b3219, 0x7395e673,
+    0x60a0c060, 0x81981981, 0x4fd19e4f, 0xdc7fa3dc, 0x22664422, 0x2a7e542a, 0x90ab3b90, 0x88830b88,
+    0x46ca8c46, 0xee29c7ee, 0xb8d36bb8, 0x143c2814, 0xde79a7de, 0x5ee2bc5e, 0x0b1d160b, 0xdb76addb,
+    0xe03bdbe0, 0x32566432, 0x3a4e743a, 0x0a1e140a, 0x49db9249, 0x060a0c06, 0x246c4824, 0x5ce4b85c,
+    0xc25d9fc2, 0xd36ebdd3, 0xacef43ac, 0x62a6c462, 0x91a83991, 0x95a43195, 0xe437d3e4, 0x798bf279,
+    0xe732d5e7, 0xc8438bc8, 0x37596e37, 0x6db7da6d, 0x8d8c018d, 0xd564b1d5, 0x4ed29c4e, 0xa9e049a9,
+    0x6cb4d86c, 0x56faac56, 0xf407f3f4, 0xea25cfea, 0x65afca65, 0x7a8ef47a, 0xaee947ae, 0x08181008,
+    0xbad56fba, 0x7888f078, 0x256f4a25, 0x2e725c2e, 0x1c24381c, 0xa6f157a6, 0xb4c773b4, 0xc65197c6,
+    0xe823cbe8, 0xdd7ca1dd, 0x749ce874, 0x1f213e1f, 0x4bdd964b, 0xbddc61bd, 0x8b860d8b, 0x8a850f8a,
+    0x7090e070, 0x3e427c3e, 0xb5c471b5, 0x66aacc66, 0x48d89048, 0x03050603, 0xf601f7f6, 0x0e121c0e,
+    0x61a3c261, 0x355f6a35, 0x57f9ae57, 0xb9d069b9, 0x86911786, 0xc15899c1, 0x1d273a1d, 0x9eb9279e,
+    0xe138d9e1, 0xf813ebf8, 0x98b32b98, 0x11332211, 0x69bbd269, 0xd970a9d9, 0x8e89078e, 0x94a73394,
+    0x9bb62d9b, 0x1e223c1e, 0x87921587, 0xe920c9e9, 0xce4987ce, 0x55ffaa55, 0x28785028, 0xdf7aa5df,
+    0x8c8f038c, 0xa1f859a1, 0x89800989, 0x0d171a0d, 0xbfda65bf, 0xe631d7e6, 0x42c68442, 0x68b8d068,
+    0x41c38241, 0x99b02999, 0x2d775a2d, 0x0f111e0f, 0xb0cb7bb0, 0x54fca854, 0xbbd66dbb, 0x163a2c16
+};
+
+static const uint32_t Te3[256] =
+{
+    0x6363a5c6, 0x7c7c84f8, 0x777799ee, 0x7b7b8df6, 0xf2f20dff, 0x6b6bbdd6, 0x6f6fb1de, 0xc5c55491,
+    0x30305060, 0x01010302, 0x6767a9ce, 0x2b2b7d56, 0xfefe19e7, 0xd7d762b5, 0xababe64d, 0x76769aec,
+    0xcaca458f, 0x82829d1f, 0xc9c94089, 0x7d7d87fa, 0xfafa15ef, 0x5959ebb2, 0x4747c98e, 0xf0f00bfb,
+    0xadadec41, 0xd4d467b3, 0xa2a2fd5f, 0xafafea45, 0x9c9cbf23, 0xa4a4f753, 0x727296e4, 0xc0c05b9b,
+    0xb7b7c275, 0xfdfd1ce1, 0x9393ae3d, 0x26266a4c, 0x36365a6c, 0x3f3f417e, 0xf7f702f5, 0xcccc4f83,
+    0x34345c68, 0xa5a5f451, 0xe5e534d1, 0xf1f108f9, 0x717193e2, 0xd8d873ab, 0x31315362, 0x15153f2a,
+    0x04040c08, 0xc7c75295, 0x23236546, 0xc3c35e9d, 0x18182830, 0x9696a137, 0x05050f0a, 0x9a9ab52f,
+    0x0707090e, 0x12123624, 0x80809b1b, 0xe2e23ddf, 0xebeb26cd, 0x2727694e, 0xb2b2cd7f, 0x75759fea,
+    0x09091b12, 0x83839e1d, 0x2c2c7458, 0x1a1a2e34, 0x1b1b2d36, 0x6e6eb2dc, 0x5a5aeeb4, 0xa0a0fb5b,
+    0x5252f6a4, 0x3b3b4d76, 0xd6d661b7, 0xb3b3ce7d, 0x29297b52, 0xe3e33edd, 0x2f2f715e, 0x84849713,
+    0x5353f5a6, 0xd1d168b9, 0x00000000, 0xeded2cc1, 0x20206040, 0xfcfc1fe3, 0xb1b1c879, 0x5b5bedb6,
+    0x6a6abed4, 0xcbcb468d, 0xbebed967, 0x39394b72, 0x4a4ade94, 0x4c4cd498, 0x5858e8b0, 0xcfcf4a85,
+    0xd0d06bbb, 0xefef2ac5, 0xaaaae54f, 0xfbfb16ed, 0x4343c586, 0x4d4dd79a, 0x33335566, 0x85859411,
+    0x4545cf8a, 0xf9f910e9, 0x02020604, 0x7f7f81fe, 0x5050f0a0, 0x3c3c4478, 0x9f9fba25, 0xa8a8e34b,
+    0x5151f3a2, 0xa3a3fe5d, 0x4040c080, 0x8f8f8a05, 0x9292ad3f, 0x9d9dbc21, 0x38384870, 0xf5f504f1,
+    0xbcbcdf63, 0xb6b6c177, 0xdada75af, 0x21216342, 0x10103020, 0xffff1ae5, 0xf3f30efd, 0xd2d26dbf,
+    0xcdcd4c81, 0x0c0c1418, 0x13133526, 0xecec2fc3, 0x5f5fe1be, 0x9797a235, 0x4444cc88, 0x1717392e,
+    0xc4c45793, 0xa7a7f255, 0x7e7e82fc, 0x3d3d477a, 0x6464acc8, 0x5d5de7ba, 0x19192b32, 0x737395e6,
+    0x6060a0c0, 0x81819819, 0x4f4fd19e, 0xdcdc7fa3, 0x22226644, 0x2a2a7e54, 0x9090ab3b, 0x8888830b,
+    0x4646ca8c, 0xeeee29c7, 0xb8b8d36b, 0x14143c28, 0xdede79a7, 0x5e5ee2bc, 0x0b0b1d16, 0xdbdb76ad,
+    0xe0e03bdb, 0x32325664, 0x3a3a4e74, 0x0a0a1e14, 0x4949db92, 0x06060a0c, 0x24246c48, 0x5c5ce4b8,
+    0xc2c25d9f, 0xd3d36ebd, 0xacacef43, 0x6262a6c4, 0x9191a839, 0x9595a431, 0xe4e437d3, 0x79798bf2,
+    0xe7e732d5, 0xc8c8438b, 0x3737596e, 0x6d6db7da, 0x8d8d8c01, 0xd5d564b1, 0x4e4ed29c, 0xa9a9e049,
+    0x6c6cb4d8, 0x5656faac, 0xf4f407f3, 0xeaea25cf, 0x6565afca, 0x7a7a8ef4, 0xaeaee947, 0x08081810,
+    0xbabad56f, 0x787888f0, 0x25256f4a, 0x2e2e725c, 0x1c1c2438, 0xa6a6f157, 0xb4b4c773, 0xc6c65197,
+    0xe8e823cb, 0xdddd7ca1, 0x74749ce8, 0x1f1f213e, 0x4b4bdd96, 0xbdbddc61, 0x8b8b860d, 0x8a8a850f,
+    0x707090e0, 0x3e3e427c, 0xb5b5c471, 0x6666aacc, 0x4848d890, 0x03030506, 0xf6f601f7, 0x0e0e121c,
+    0x6161a3c2, 0x35355f6a, 0x5757f9ae, 0xb9b9d069, 0x86869117, 0xc1c15899, 0x1d1d273a, 0x9e9eb927,
+    0xe1e138d9, 0xf8f813eb, 0x9898b32b, 0x11113322, 0x6969bbd2, 0xd9d970a9, 0x8e8e8907, 0x9494a733,
+    0x9b9bb62d, 0x1e1e223c, 0x87879215, 0xe9e920c9, 0xcece4987, 0x5555ffaa, 0x28287850, 0xdfdf7aa5,
+    0x8c8c8f03, 0xa1a1f859, 0x89898009, 0x0d0d171a, 0xbfbfda65, 0xe6e631d7, 0x4242c684, 0x6868b8d0,
+    0x4141c382, 0x9999b029, 0x2d2d775a, 0x0f0f111e, 0xb0b0cb7b, 0x5454fca8, 0xbbbbd66d, 0x16163a2c
+};
+
+static const uint32_t Td0[256] =
+{
+    0x51f4a750, 0x7e416553, 0x1a17a4c3, 0x3a275e96, 0x3bab6bcb, 0x1f9d45f1, 0xacfa58ab, 0x4be30393,
+    0x2030fa55, 0xad766df6, 0x88cc7691, 0xf5024c25, 0x4fe5d7fc, 0xc52acbd7, 0x26354480, 0xb562a38f,
+    0xdeb15a49, 0x25ba1b67, 0x45ea0e98, 0x5dfec0e1, 0xc32f7502, 0x814cf012, 0x8d4697a3, 0x6bd3f9c6,
+    0x038f5fe7, 0x15929c95, 0xbf6d7aeb, 0x955259da, 0xd4be832d, 0x587421d3, 0x49e06929, 0x8ec9c844,
+    0x75c2896a, 0xf48e7978, 0x99583e6b, 0x27b971dd, 0xbee14fb6, 0xf088ad17, 0xc920ac66, 0x7dce3ab4,
+    0x63df4a18, 0xe51a3182, 0x97513360, 0x62537f45, 0xb16477e0, 0xbb6bae84, 0xfe81a01c, 0xf9082b94,
+    0x70486858, 0x8f45fd19, 0x94de6c87, 0x527bf8b7, 0xab73d323, 0x724b02e2, 0xe31f8f57, 0x6655ab2a,
+    0xb2eb2807, 0x2fb5c203, 0x86c57b9a, 0xd33708a5, 0x302887f2, 0x23bfa5b2, 0x02036aba, 0xed16825c,
+    0x8acf1c2b, 0xa779b492, 0xf307f2f0, 0x4e69e2a1, 0x65daf4cd, 0x0605bed5, 0xd134621f, 0xc4a6fe8a,
+    0x342e539d, 0xa2f355a0, 0x058ae132, 0xa4f6eb75, 0x0b83ec39, 0x4060efaa, 0x5e719f06, 0xbd6e1051,
+    0x3e218af9, 0x96dd063d, 0xdd3e05ae, 0x4de6bd46, 0x91548db5, 0x71c45d05, 0x0406d46f, 0x605015ff,
+    0x1998fb24, 0xd6bde997, 0x894043cc, 0x67d99e77, 0xb0e842bd, 0x07898b88, 0xe7195b38, 0x79c8eedb,
+    0xa17c0a47, 0x7c420fe9, 0xf8841ec9, 0x00000000, 0x09808683, 0x322bed48, 0x1e1170ac, 0x6c5a724e,
+    0xfd0efffb, 0x0f853856, 0x3daed51e, 0x362d3927, 0x0a0fd964, 0x685ca621, 0x9b5b54d1, 0x24362e3a,
+    0x0c0a67b1, 0x9357e70f, 0xb4ee96d2, 0x1b9b919e, 0x80c0c54f, 0x61dc20a2, 0x5a774b69, 0x1c121a16,
+    0xe293ba0a, 0xc0a02ae5, 0x3c22e043, 0x121b171d, 0x0e090d0b, 0xf28bc7ad, 0x2db6a8b9, 0x141ea9c8,
+    0x57f11985, 0xaf75074c, 0xee99ddbb, 0xa37f60fd, 0xf701269f, 0x5c72f5bc, 0x44663bc5, 0x5bfb7e34,
+    0x8b432976, 0xcb23c6dc, 0xb6edfc68, 0xb8e4f163, 0xd731dcca, 0x42638510, 0x13972240, 0x84c61120,
+    0x854a247d, 0xd2bb3df8, 0xaef93211, 0xc729a16d, 0x1d9e2f4b, 0xdcb230f3, 0x0d8652ec, 0x77c1e3d0,
+    0x2bb3166c, 0xa970b999, 0x119448fa, 0x47e96422, 0xa8fc8cc4, 0xa0f03f1a, 0x567d2cd8, 0x223390ef,
+    0x87494ec7, 0xd938d1c1, 0x8ccaa2fe, 0x98d40b36, 0xa6f581cf, 0xa57ade28, 0xdab78e26, 0x3fadbfa4,
+    0x2c3a9de4, 0x5078920d, 0x6a5fcc9b, 0x547e4662, 0xf68d13c2, 0x90d8b8e8, 0x2e39f75e, 0x82c3aff5,
+    0x9f5d80be, 0x69d0937c, 0x6fd52da9, 0xcf2512b3, 0xc8ac993b, 0x10187da7, 0xe89c636e, 0xdb3bbb7b,
+    0xcd267809, 0x6e5918f4, 0xec9ab701, 0x834f9aa8, 0xe6956e65, 0xaaffe67e, 0x21bccf08, 0xef15e8e6,
+    0xbae79bd9, 0x4a6f36ce, 0xea9f09d4, 0x29b07cd6, 0x31a4b2af, 0x2a3f2331, 0xc6a59430, 0x35a266c0,
+    0x744ebc37, 0xfc82caa6, 0xe090d0b0, 0x33a7d815, 0xf104984a, 0x41ecdaf7, 0x7fcd500e, 0x1791f62f,
+    0x764dd68d, 0x43efb04d, 0xccaa4d54, 0xe49604df, 0x9ed1b5e3, 0x4c6a881b, 0xc12c1fb8, 0x4665517f,
+    0x9d5eea04, 0x018c355d, 0xfa877473, 0xfb0b412e, 0xb3671d5a, 0x92dbd252, 0xe9105633, 0x6dd64713,
+    0x9ad7618c, 0x37a10c7a, 0x59f8148e, 0xeb133c89, 0xcea927ee, 0xb761c935, 0xe11ce5ed, 0x7a47b13c,
+    0x9cd2df59, 0x55f2733f, 0x1814ce79, 0x73c737bf, 0x53f7cdea, 0x5ffdaa5b, 0xdf3d6f14, 0x7844db86,
+    0xcaaff381, 0xb968c43e, 0x3824342c, 0xc2a3405f, 0x161dc372, 0xbce2250c, 0x283c498b, 0xff0d9541,
+    0x39a80171, 0x080cb3de, 0xd8b4e49c, 0x6456c190, 0x7bcb8461, 0xd532b670, 0x486c5c74, 0xd0b85742
+};
+
+static const uint32_t Td1[256] =
+{
+    0x5051f4a7, 0x537e4165, 0xc31a17a4, 0x963a275e, 0xcb3bab6b, 0xf11f9d45, 0xabacfa58, 0x934be303,
+    0x552030fa, 0xf6ad766d, 0x9188cc76, 0x25f5024c, 0xfc4fe5d7, 0xd7c52acb, 0x80263544, 0x8fb562a3,
+    0x49deb15a, 0x6725ba1b, 0x9845ea0e, 0xe15dfec0, 0x02c32f75, 0x12814cf0, 0xa38d4697, 0xc66bd3f9,
+    0xe7038f5f, 0x9515929c, 0xebbf6d7a, 0xda955259, 0x2dd4be83, 0xd3587421, 0x2949e069, 0x448ec9c8,
+    0x6a75c289, 0x78f48e79, 0x6b99583e, 0xdd27b971, 0xb6bee14f, 0x17f088ad, 0x66c920ac, 0xb47dce3a,
+    0x1863df4a, 0x82e51a31, 0x60975133, 0x4562537f, 0xe0b16477, 0x84bb6bae, 0x1cfe81a0, 0x94f9082b,
+    0x58704868, 0x198f45fd, 0x8794de6c, 0xb7527bf8, 0x23ab73d3, 0xe2724b02, 0x57e31f8f, 0x2a6655ab,
+    0x07b2eb28, 0x032fb5c2, 0x9a86c57b, 0xa5d33708, 0xf2302887, 0xb223bfa5, 0xba02036a, 0x5ced1682,
+    0x2b8acf1c, 0x92a779b4, 0xf0f307f2, 0xa14e69e2, 0xcd65daf4, 0xd50605be, 0x1fd13462, 0x8ac4a6fe,
+    0x9d342e53, 0xa0a2f355, 0x32058ae1, 0x75a4f6eb, 0x390b83ec, 0xaa4060ef, 0x065e719f, 0x51bd6e10,
+    0xf93e218a, 0x3d96dd06, 0xaedd3e05, 0x464de6bd, 0xb591548d, 0x0571c45d, 0x6f0406d4, 0xff605015,
+    0x241998fb, 0x97d6bde9, 0xcc894043, 0x7767d99e, 0xbdb0e842, 0x8807898b, 0x38e7195b, 0xdb79c8ee,
+    0x47a17c0a, 0xe97c420f, 0xc9f8841e, 0x00000000, 0x83098086, 0x48322bed, 0xac1e1170, 0x4e6c5a72,
+    0xfbfd0eff, 0x560f8538, 0x1e3daed5, 0x27362d39, 0x640a0fd9, 0x21685ca6, 0xd19b5b54, 0x3a24362e,
+    0xb10c0a67, 0x0f9357e7, 0xd2b4ee96, 0x9e1b9b91, 0x4f80c0c5, 0xa261dc20, 0x695a774b, 0x161c121a,
+    0x0ae293ba, 0xe5c0a02a, 0x433c22e0, 0x1d121b17, 0x0b0e090d, 0xadf28bc7, 0xb92db6a8, 0xc8141ea9,
+    0x8557f119, 0x4caf7507, 0xbbee99dd, 0xfda37f60, 0x9ff70126, 0xbc5c72f5, 0xc544663b, 0x345bfb7e,
+    0x768b4329, 0xdccb23c6, 0x68b6edfc, 0x63b8e4f1, 0xcad731dc, 0x10426385, 0x40139722, 0x2084c611,
+    0x7d854a24, 0xf8d2bb3d, 0x11aef932, 0x6dc729a1, 0x4b1d9e2f, 0xf3dcb230, 0xec0d8652, 0xd077c1e3,
+    0x6c2bb316, 0x99a970b9, 0xfa119448, 0x2247e964, 0xc4a8fc8c, 0x1aa0f03f, 0xd8567d2c, 0xef223390,
+    0xc787494e, 0xc1d938d1, 0xfe8ccaa2, 0x3698d40b, 0xcfa6f581, 0x28a57ade, 0x26dab78e, 0xa43fadbf,
+    0xe42c3a9d, 0x0d507892, 0x9b6a5fcc, 0x62547e46, 0xc2f68d13, 0xe890d8b8, 0x5e2e39f7, 0xf582c3af,
+    0xbe9f5d80, 0x7c69d093, 0xa96fd52d, 0xb3cf2512, 0x3bc8ac99, 0xa710187d, 0x6ee89c63, 0x7bdb3bbb,
+    0x09cd2678, 0xf46e5918, 0x01ec9ab7, 0xa8834f9a, 0x65e6956e, 0x7eaaffe6, 0x0821bccf, 0xe6ef15e8,
+    0xd9bae79b, 0xce4a6f36, 0xd4ea9f09, 0xd629b07c, 0xaf31a4b2, 0x312a3f23, 0x30c6a594, 0xc035a266,
+    0x37744ebc, 0xa6fc82ca, 0xb0e090d0, 0x1533a7d8, 0x4af10498, 0xf741ecda, 0x0e7fcd50, 0x2f1791f6,
+    0x8d764dd6, 0x4d43efb0, 0x54ccaa4d, 0xdfe49604, 0xe39ed1b5, 0x1b4c6a88, 0xb8c12c1f, 0x7f466551,
+    0x049d5eea, 0x5d018c35, 0x73fa8774, 0x2efb0b41, 0x5ab3671d, 0x5292dbd2, 0x33e91056, 0x136dd647,
+    0x8c9ad761, 0x7a37a10c, 0x8e59f814, 0x89eb133c, 0xeecea927, 0x35b761c9, 0xede11ce5, 0x3c7a47b1,
+    0x599cd2df, 0x3f55f273, 0x791814ce, 0xbf73c737, 0xea53f7cd, 0x5b5ffdaa, 0x14df3d6f, 0x867844db,
+    0x81caaff3, 0x3eb968c4, 0x2c382434, 0x5fc2a340, 0x72161dc3, 0x0cbce225, 0x8b283c49, 0x41ff0d95,
+    0x7139a801, 0xde080cb3, 0x9cd8b4e4, 0x906456c1, 0x617bcb84, 0x70d532b6, 0x74486c5c, 0x42d0b857
+};
+
+static const uint32_t Td2[256] =
+{
+    0xa75051f4, 0x65537e41, 0xa4c31a17, 0x5e963a27, 0x6bcb3bab, 0x45f11f9d, 0x58abacfa, 0x03934be3,
+    0xfa552030, 0x6df6ad76, 0x769188cc, 0x4c25f502, 0xd7fc4fe5, 0xcbd7c52a, 0x44802635, 0xa38fb562,
+    0x5a49deb1, 0x1b6725ba, 0x0e9845ea, 0xc0e15dfe, 0x7502c32f, 0xf012814c, 0x97a38d46, 0xf9c66bd3,
+    0x5fe7038f, 0x9c951592, 0x7aebbf6d, 0x59da9552, 0x832dd4be, 0x21d35874, 0x692949e0, 0xc8448ec9,
+    0x896a75c2, 0x7978f48e, 0x3e6b9958, 0x71dd27b9, 0x4fb6bee1, 0xad17f088, 0xac66c920, 0x3ab47dce,
+    0x4a1863df, 0x3182e51a, 0x33609751, 0x7f456253, 0x77e0b164, 0xae84bb6b, 0xa01cfe81, 0x2b94f908,
+    0x68587048, 0xfd198f45, 0x6c8794de, 0xf8b7527b, 0xd323ab73, 0x02e2724b, 0x8f57e31f, 0xab2a6655,
+    0x2807b2eb, 0xc2032fb5, 0x7b9a86c5, 0x08a5d337, 0x87f23028, 0xa5b223bf, 0x6aba0203, 0x825ced16,
+    0x1c2b8acf, 0xb492a779, 0xf2f0f307, 0xe2a14e69, 0xf4cd65da, 0xbed50605, 0x621fd134, 0xfe8ac4a6,
+    0x539d342e, 0x55a0a2f3, 0xe132058a, 0xeb75a4f6, 0xec390b83, 0xefaa4060, 0x9f065e71, 0x1051bd6e,
+    0x8af93e21, 0x063d96dd, 0x05aedd3e, 0xbd464de6, 0x8db59154, 0x5d0571c4, 0xd46f0406, 0x15ff6050,
+    0xfb241998, 0xe997d6bd, 0x43cc8940, 0x9e7767d9, 0x42bdb0e8, 0x8b880789, 0x5b38e719, 0xeedb79c8,
+    0x0a47a17c, 0x0fe97c42, 0x1ec9f884, 0x00000000, 0x86830980, 0xed48322b, 0x70ac1e11, 0x724e6c5a,
+    0xfffbfd0e, 0x38560f85, 0xd51e3dae, 0x3927362d, 0xd9640a0f, 0xa621685c, 0x54d19b5b, 0x2e3a2436,
+    0x67b10c0a, 0xe70f9357, 0x96d2b4ee, 0x919e1b9b, 0xc54f80c0, 0x20a261dc, 0x4b695a77, 0x1a161c12,
+    0xba0ae293, 0x2ae5c0a0, 0xe0433c22, 0x171d121b, 0x0d0b0e09, 0xc7adf28b, 0xa8b92db6, 0xa9c8141e,
+    0x198557f1, 0x074caf75, 0xddbbee99, 0x60fda37f, 0x269ff701, 0xf5bc5c72, 0x3bc54466, 0x7e345bfb,
+    0x29768b43, 0xc6dccb23, 0xfc68b6ed, 0xf163b8e4, 0xdccad731, 0x85104263, 0x22401397, 0x112084c6,
+    0x247d854a, 0x3df8d2bb, 0x3211aef9, 0xa16dc729, 0x2f4b1d9e, 0x30f3dcb2, 0x52ec0d86, 0xe3d077c1,
+    0x166c2bb3, 0xb999a970, 0x48fa1194, 0x642247e9, 0x8cc4a8fc, 0x3f1aa0f0, 0x2cd8567d, 0x90ef2233,
+    0x4ec78749, 0xd1c1d938, 0xa2fe8cca, 0x0b3698d4, 0x81cfa6f5, 0xde28a57a, 0x8e26dab7, 0xbfa43fad,
+    0x9de42c3a, 0x920d5078, 0xcc9b6a5f, 0x4662547e, 0x13c2f68d, 0xb8e890d8, 0xf75e2e39, 0xaff582c3,
+    0x80be9f5d, 0x937c69d0, 0x2da96fd5, 0x12b3cf25, 0x993bc8ac, 0x7da71018, 0x636ee89c, 0xbb7bdb3b,
+    0x7809cd26, 0x18f46e59, 0xb701ec9a, 0x9aa8834f, 0x6e65e695, 0xe67eaaff, 0xcf0821bc, 0xe8e6ef15,
+    0x9bd9bae7, 0x36ce4a6f, 0x09d4ea9f, 0x7cd629b0, 0xb2af31a4, 0x23312a3f, 0x9430c6a5, 0x66c035a2,
+    0xbc37744e, 0xcaa6fc82, 0xd0b0e090, 0xd81533a7, 0x984af104, 0xdaf741ec, 0x500e7fcd, 0xf62f1791,
+    0xd68d764d, 0xb04d43ef, 0x4d54ccaa, 0x04dfe496, 0xb5e39ed1, 0x881b4c6a, 0x1fb8c12c, 0x517f4665,
+    0xea049d5e, 0x355d018c, 0x7473fa87, 0x412efb0b, 0x1d5ab367, 0xd25292db, 0x5633e910, 0x47136dd6,
+    0x618c9ad7, 0x0c7a37a1, 0x148e59f8, 0x3c89eb13, 0x27eecea9, 0xc935b761, 0xe5ede11c, 0xb13c7a47,
+    0xdf599cd2, 0x733f55f2, 0xce791814, 0x37bf73c7, 0xcdea53f7, 0xaa5b5ffd, 0x6f14df3d, 0xdb867844,
+    0xf381caaf, 0xc43eb968, 0x342c3824, 0x405fc2a3, 0xc372161d, 0x250cbce2, 0x498b283c, 0x9541ff0d,
+    0x017139a8, 0xb3de080c, 0xe49cd8b4, 0xc1906456, 0x84617bcb, 0xb670d532, 0x5c74486c, 0x5742d0b8
+};
+
+static const uint32_t Td3[256] =
+{
+    0xf4a75051, 0x4165537e, 0x17a4c31a, 0x275e963a, 0xab6bcb3b, 0x9d45f11f, 0xfa58abac, 0xe303934b,
+    0x30fa5520, 0x766df6ad, 0xcc769188, 0x024c25f5, 0xe5d7fc4f, 0x2acbd7c5, 0x35448026, 0x62a38fb5,
+    0xb15a49de, 0xba1b6725, 0xea0e9845, 0xfec0e15d, 0x2f7502c3, 0x4cf01281, 0x4697a38d, 0xd3f9c66b,
+    0x8f5fe703, 0x929c9515, 0x6d7aebbf, 0x5259da95, 0xbe832dd4, 0x7421d358, 0xe0692949, 0xc9c8448e,
+    0xc2896a75, 0x8e7978f4, 0x583e6b99, 0xb971dd27, 0xe14fb6be, 0x88ad17f0, 0x20ac66c9, 0xce3ab47d,
+    0xdf4a1863, 0x1a3182e5, 0x51336097, 0x537f4562, 0x6477e0b1, 0x6bae84bb, 0x81a01cfe, 0x082b94f9,
+    0x48685870, 0x45fd198f, 0xde6c8794, 0x7bf8b752, 0x73d323ab, 0x4b02e272, 0x1f8f57e3, 0x55ab2a66,
+    0xeb2807b2, 0xb5c2032f, 0xc57b9a86, 0x3708a5d3, 0x2887f230, 0xbfa5b223, 0x036aba02, 0x16825ced,
+    0xcf1c2b8a, 0x79b492a7, 0x07f2f0f3, 0x69e2a14e, 0xdaf4cd65, 0x05bed506, 0x34621fd1, 0xa6fe8ac4,
+    0x2e539d34, 0xf355a0a2, 0x8ae13205, 0xf6eb75a4, 0x83ec390b, 0x60efaa40, 0x719f065e, 0x6e1051bd,
+    0x218af93e, 0xdd063d96, 0x3e05aedd, 0xe6bd464d, 0x548db591, 0xc45d0571, 0x06d46f04, 0x5015ff60,
+    0x98fb2419, 0xbde997d6, 0x4043cc89, 0xd99e7767, 0xe842bdb0, 0x898b8807, 0x195b38e7, 0xc8eedb79,
+    0x7c0a47a1, 0x420fe97c, 0x841ec9f8, 0x00000000, 0x80868309, 0x2bed4832, 0x1170ac1e, 0x5a724e6c,
+    0x0efffbfd, 0x8538560f, 0xaed51e3d, 0x2d392736, 0x0fd9640a, 0x5ca62168, 0x5b54d19b, 0x362e3a24,
+    0x0a67b10c, 0x57e70f93, 0xee96d2b4, 0x9b919e1b, 0xc0c54f80, 0xdc20a261, 0x774b695a, 0x121a161c,
+    0x93ba0ae2, 0xa02ae5c0, 0x22e0433c, 0x1b171d12, 0x090d0b0e, 0x8bc7adf2, 0xb6a8b92d, 0x1ea9c814,
+    0xf1198557, 0x75074caf, 0x99ddbbee, 0x7f60fda3, 0x01269ff7, 0x72f5bc5c, 0x663bc544, 0xfb7e345b,
+    0x4329768b, 0x23c6dccb, 0xedfc68b6, 0xe4f163b8, 0x31dccad7, 0x63851042, 0x97224013, 0xc6112084,
+    0x4a247d85, 0xbb3df8d2, 0xf93211ae, 0x29a16dc7, 0x9e2f4b1d, 0xb230f3dc, 0x8652ec0d, 0xc1e3d077,
+    0xb3166c2b, 0x70b999a9, 0x9448fa11, 0xe9642247, 0xfc8cc4a8, 0xf03f1aa0, 0x7d2cd856, 0x3390ef22,
+    0x494ec787, 0x38d1c1d9, 0xcaa2fe8c, 0xd40b3698, 0xf581cfa6, 0x7ade28a5, 0xb78e26da, 0xadbfa43f,
+    0x3a9de42c, 0x78920d50, 0x5fcc9b6a, 0x7e466254, 0x8d13c2f6, 0xd8b8e890, 0x39f75e2e, 0xc3aff582,
+    0x5d80be9f, 0xd0937c69, 0xd52da96f, 0x2512b3cf, 0xac993bc8, 0x187da710, 0x9c636ee8, 0x3bbb7bdb,
+    0x267809cd, 0x5918f46e, 0x9ab701ec, 0x4f9aa883, 0x956e65e6, 0xffe67eaa, 0xbccf0821, 0x15e8e6ef,
+    0xe79bd9ba, 0x6f36ce4a, 0x9f09d4ea, 0xb07cd629, 0xa4b2af31, 0x3f23312a, 0xa59430c6, 0xa266c035,
+    0x4ebc3774, 0x82caa6fc, 0x90d0b0e0, 0xa7d81533, 0x04984af1, 0xecdaf741, 0xcd500e7f, 0x91f62f17,
+    0x4dd68d76, 0xefb04d43, 0xaa4d54cc, 0x9604dfe4, 0xd1b5e39e, 0x6a881b4c, 0x2c1fb8c1, 0x65517f46,
+    0x5eea049d, 0x8c355d01, 0x877473fa, 0x0b412efb, 0x671d5ab3, 0xdbd25292, 0x105633e9, 0xd647136d,
+    0xd7618c9a, 0xa10c7a37, 0xf8148e59, 0x133c89eb, 0xa927eece, 0x61c935b7, 0x1ce5ede1, 0x47b13c7a,
+    0xd2df599c, 0xf2733f55, 0x14ce7918, 0xc737bf73, 0xf7cdea53, 0xfdaa5b5f, 0x3d6f14df, 0x44db8678,
+    0xaff381ca, 0x68c43eb9, 0x24342c38, 0xa3405fc2, 0x1dc37216, 0xe2250cbc, 0x3c498b28, 0x0d9541ff,
+    0xa8017139, 0x0cb3de08, 0xb4e49cd8, 0x56c19064, 0xcb84617b, 0x32b670d5, 0x6c5c7448, 0xb85742d0
+};
+
 /**
  * GFMult - Multiply two 8-bit numbers as elements of GF(2^8) (see FIPS 197). Multiply
  * the two 8-bit values as polynomials mod 2, then reduce by the irreducible/prime polynomial 
@@ -99,148 +392,18 @@ static uint8_t GFMult(uint8_t a, uint8_t b)
     return out;
 }
 
-/**
- * AESStreamer::AESStreamer - Constructor. Initialize offset and bitrate based on
- * AES mode.
- *
- * @param modeIn    [in] Input AES mode.
- */
-
-AESStreamer::AESStreamer(AESMode modeIn) : bitOffset(0), mode(modeIn)
-{
-    switch (mode)
-    {
-        case CFB1:
-
-            r = 1;
-            break;
-
-        case CFB8:
-
-            r = 8;
-            break;
-
-        case CFB128:
-        case OFB:
-        case CBC:
-        case ECB:
-        default:
-
-            r = 128;
-            break;
-    }
-}
-
-/**
- * AESStreamer::SetData - Set message data in the AES streamer. Pad data according
- * to the bitrate set for the current AES mode.
- *
- * @param dataIn            [in] Message data to encrypt.
- */
-
-void AESStreamer::SetData(const vector<uint8_t>& dataIn)
-{
-    const uint32_t rateBytes    = (r <= 8) ? 1 : 16;
-    const uint32_t sizeIn       = dataIn.size();
-    const uint8_t padBytes      = (uint8_t)(sizeIn % rateBytes);
-
-    if (sizeIn)
-    {
-        data.resize(sizeIn + padBytes);
-        memcpy(&data[0], &dataIn[0], sizeIn);
-
-        if (mode == ECB || mode == CBC || mode == CFB128)
-        {
-            for (uint32_t i = 0; i < sizeIn; i += 4)
-            {
-                uint8_t tmp = data[i];
-                data[i]     = data[i + 3];
-                data[i + 3] = tmp;
-
-                tmp         = data[i + 1];
-                data[i + 1] = data[i + 2];
-                data[i + 2] = tmp;
-            }
-        }
-    }
-
-    for (uint32_t i = 0; i < padBytes; i++)
-        data[sizeIn + i] = padBytes;
-
-    Reset();
-}
-
-/**
- * AESStreamer::Reset - Set the streamer back to the beginning of the message.
- */
-
-void AESStreamer::Reset()
-{
-    bitOffset = 0;
-}
-
-/**
- * AESStreamer::Next - Get the next r bits from the message stream.
- */
-
-void AESStreamer::Next(uint32_t block[4])
-{
-    assert((bitOffset + r) <= (8 * data.size()));
-
-    uint32_t byte   = 0;
-    uint32_t mask   = 0;
-    uint32_t shift  = 0;
-    uint32_t bit    = 0;
-
-    switch (r)
-    {
-    case 1:
-
-        byte        = bitOffset / 8;
-        shift       = bitOffset % 8;
-        mask        = 1LU << shift;
-        bit         = (data[byte] & mask) >> shift;
-        block[0]    = bit;
-
-        break;
-
-    case 8:
-
-        block[0] = data[bitOffset / 8];
-        break;
-
-    case 128:
-
-        memcpy(&block[0], &data[bitOffset / 8], 16);
-        break;
-    }
-
-    bitOffset += r;
-}
-
-/**
- * AESStreamer::End - Return true if input all message blocks have been
- * processed.
- *
- * @return True if at the end of the message, false otherwise.
- */
-
-bool AESStreamer::End()
-{
-    if (bitOffset == 8 * data.size())
-        return true;
-
-    return false;
-}
-
 /**
  * AES - Constructor. Takes an AES key size and sets number of rounds and
- * key expansion size.
+ * key expansion size. Defaults to the AES-NI engine when the CPU supports it,
+ * otherwise the T-table engine, and to one worker thread per hardware thread for
+ * large parallelizable messages.
  * 
  * @param sz [in]   AES key size to use.
  */
 
-AES::AES(AESSize sz, AESMode modeIn) : stream(modeIn), mode(modeIn), w{0}
+AES::AES(AESSize sz, AESMode modeIn) : mode(modeIn),
+    engine(AESNISupported() ? AES_AESNI : AES_TTABLE), sharedSched(nullptr),
+    numThreads(max(1u, thread::hardware_concurrency())), parallelThreshold(AES_DEFAULT_PARALLEL_THRESHOLD)
 {
     switch (sz)
     {
@@ -455,7 +618,8 @@ void AES::MixColumns()
 
 void AES::AddRoundKey(const uint32_t round)
 {
-    uint32_t offset = 4 * round;
+    const uint32_t* w   = Keys().w;
+    uint32_t offset     = 4 * round;
 
     state[0] ^= w[offset];
     state[1] ^= w[offset + 1];
@@ -525,65 +689,6 @@ void AES::SetIV(const vector<uint32_t>& ivIn)
     iv = ivIn;
 }
 
-/**
- * AES::RotateIVLeft - For CFB mode, plaintext/ciphertext are processed s bits
- * at a time, with bits from prior input blocks rotated left s bits each
- * iteration.
- * 
- * @param s [in]    Number of bits to rotate (support 1, 8, or 128 only).
- */
-
-void AES::RotateIVLeft(const uint32_t s)
-{
-    assert(s == 1 || s == 8 || s == 128);
-
-    if (s == 1)
-    {
-        uint32_t hi1    = ((iv[3] & 0x80000000) >> 31);
-        uint32_t hi2    = 0;
-        iv[3]           <<= 1;
-
-        hi2     = ((iv[2] & 0x80000000) >> 31);
-        iv[2]   <<= 1;
-        iv[2]   |= hi1;
-        hi1     = hi2;
-
-        hi2     = ((iv[1] & 0x80000000) >> 31);
-        iv[1]   <<= 1;
-        iv[1]   |= hi1;
-        hi1     = hi2;
-
-        iv[0]   <<= 1;
-        iv[0]   |= hi1;
-    }
-    else if (s == 8)
-    {
-        uint32_t hi1    = ((iv[3] & 0xFF000000) >> 24);
-        uint32_t hi2    = 0;
-        iv[3]           <<= 8;
-
-        hi2     = ((iv[2] & 0xFF000000) >> 24);
-        iv[2]   <<= 8;
-        iv[2]   |= hi1;
-        hi1     = hi2;
-
-        hi2     = ((iv[1] & 0xFF000000) >> 24);
-        iv[1]   <<= 8;
-        iv[1]   |= hi1;
-        hi1     = hi2;
-
-        iv[0]   <<= 8;
-        iv[0]   |= hi1;
-    }
-    else if (s == 128)
-    {
-        iv[3] = 0;
-        iv[2] = 0;
-        iv[1] = 0;
-        iv[2] = 0;
-    }
-}
-
 /**
  * AES::InvMixColumns - AES inverse round InvMixColumns. Apply an inverse
  * mix columns matrix.
@@ -652,16 +757,22 @@ void AES::InvMixColumns()
 }
 
 /**
- * AES::ExpandKey - Expand an input encryption key into a schedule of
- * round keys for AES rounds.
+ * ExpandWords - FIPS 197 KeyExpansion: expand a key into the 4 * (nk + 7) round key
+ * words w used by the reference and T-table encryption rounds.
  *
- * @param key   [in]    Cryptographic key to expand.
+ * @param key       [in]    Key words (nk of them).
+ * @param nk        [in]    Key length in 32-bit words (4, 6 or 8).
+ * @param w         [out]   Round key words.
+ * @param subWord   [in]    SubWord implementation: the table-driven SBox, or the
+ *                          bitsliced AESBSSubWord for constant-time expansion.
  */
 
-void AES::ExpandKey(const vector<uint32_t>& key)
+static void ExpandWords(const uint32_t* key, const uint32_t nk, uint32_t* w,
+    uint32_t (*subWord)(uint32_t) = SBox)
 {
-    assert(key.size() == nk);
-    memcpy(w, &key[0], 4 * key.size());
+    const uint32_t nr = nk + 6;
+
+    memcpy(w, key, 4 * nk);
 
     for (uint32_t i = nk; i <= 4 * nr + 3; i++)
     {
@@ -670,12 +781,12 @@ void AES::ExpandKey(const vector<uint32_t>& key)
         if ((i % nk) == 0)
         {
             tmp = RotLeft32(tmp, 1);
-            tmp = SBox(tmp);
+            tmp = subWord(tmp);
             tmp ^= rcs[i / nk];
         }
         else if ((nk == 8) && (i % nk == 4))
         {
-            tmp = SBox(tmp);
+            tmp = subWord(tmp);
         }
 
         w[i] = w[i - nk] ^ tmp;
@@ -683,621 +794,1530 @@ void AES::ExpandKey(const vector<uint32_t>& key)
 }
 
 /**
- * AES::Encrypt - AES encryption entry. Route to the appropriate encryption routine based on
- * AES mode.
- *
- * @param plainTxtIn    [in]        Plaintext to be encrypted.
- * @param ciphTxtOut    [in/out]    Output ciphertext.
- * @param key           [in]        AES key for encryption.
+ * AESKeySchedule - Constructor. Builds an empty schedule; call Expand before use.
  */
 
-void AES::Encrypt(const vector<uint8_t>& plainTxtIn, vector<uint8_t>& ciphTxtOut, const vector<uint32_t>& key)
+AESKeySchedule::AESKeySchedule() : nk(0), nr(0), w{0}, dw{0}, niEnc{0}, niDec{0}, bTables(true)
 {
-    switch (mode)
-    {
-        case ECB:
-        case CBC:
-
-            EncryptECBCBC(plainTxtIn, ciphTxtOut, key);
-            break;
-
-        case CFB1:
-
-            EncryptCFB(plainTxtIn, 1, ciphTxtOut, key);
-            break;
-
-        case CFB8:
+}
 
-            EncryptCFB(plainTxtIn, 8, ciphTxtOut, key);
-            break;
+/**
+ * AESKeySchedule - Constructor. Expand a key once so it can be handed to any
+ * number of AES objects with AES::SetKey.
+ *
+ * @param key           [in]    Cryptographic key to expand (4, 6 or 8 words).
+ * @param bConstantTime [in]    Expand for the bitsliced engine only. See Expand.
+ */
 
-        case CFB128:
+AESKeySchedule::AESKeySchedule(const vector<uint32_t>& key, const bool bConstantTime) : AESKeySchedule()
+{
+    Expand(key, bConstantTime);
+}
 
-            EncryptCFB(plainTxtIn, 128, ciphTxtOut, key);
-            break;
+/**
+ * AESKeySchedule::Expand - Expand an input encryption key into a schedule of
+ * round keys for AES rounds, then build the table-derived round keys with
+ * ExpandTables. Nothing writes to the schedule afterwards, so one instance can
+ * be shared read-only across threads.
+ *
+ * @param key           [in]    Cryptographic key to expand.
+ * @param bConstantTime [in]    Run SubWord through the bitsliced S-box and skip
+ *                              ExpandTables, so no key-dependent table lookups
+ *                              are made. Such a schedule only backs the bitsliced
+ *                              and reference engines until ExpandTables is called.
+ */
 
+void AESKeySchedule::Expand(const vector<uint32_t>& key, const bool bConstantTime)
+{
+    assert(key.size() == 4 || key.size() == 6 || key.size() == 8);
 
-        case OFB:
+    nk = key.size();
+    nr = nk + 6;
 
-            EncryptOFB(plainTxtIn, ciphTxtOut, key);
-            break;
+    ExpandWords(&key[0], nk, w, bConstantTime ? AESBSSubWord : SBox);
 
-        default:
+    bTables = false;
 
-            break;
-    }
+    if (!bConstantTime)
+        ExpandTables();
 }
 
 /**
- * AES::Decrypt - AES decryption entry. Route to the appropriate decryption routine based on
- * AES mode.
- * 
- * @param ciphTxtIn     [in]        Ciphertext to be decrypted.
- * @param plainTxtOut   [in/out]    Output plaintext.
- * @param key           [in]        AES key for decryption.
+ * AESKeySchedule::ExpandTables - Build the equivalent inverse schedule dw (round
+ * keys in reverse order, with InvMixColumns applied to the middle rounds) used by
+ * the table-driven decryption path, and the byte-oriented AES-NI round keys when
+ * the CPU supports them. Both are derived from w with table lookups.
  */
 
-void AES::Decrypt(const vector<uint8_t>& ciphTxtIn, vector<uint8_t>& plainTxtOut, const vector<uint32_t>& key)
+void AESKeySchedule::ExpandTables()
 {
-    switch (mode)
-    {
-    case ECB:
-    case CBC:
-
-        DecryptECBCBC(ciphTxtIn, plainTxtOut, key);
-        break;
-
-    case CFB1:
+    if (bTables)
+        return;
 
-        DecryptCFB(ciphTxtIn, 1, plainTxtOut, key);
-        break;
-
-    case CFB8:
-
-        DecryptCFB(ciphTxtIn, 8, plainTxtOut, key);
-        break;
+    const uint32_t* fwdS = &sbox[0][0];
 
-    case CFB128:
+    for (uint32_t r = 0; r <= nr; r++)
+    {
+        for (uint32_t j = 0; j < 4; j++)
+        {
+            uint32_t rk = w[4 * (nr - r) + j];
 
-        DecryptCFB(ciphTxtIn, 128, plainTxtOut, key);
-        break;
+            if (r > 0 && r < nr)
+            {
+                rk = Td0[fwdS[rk >> 24]] ^ Td1[fwdS[(rk >> 16) & 0xFF]] ^
+                     Td2[fwdS[(rk >> 8) & 0xFF]] ^ Td3[fwdS[rk & 0xFF]];
+            }
 
-    case OFB:
+            dw[4 * r + j] = rk;
+        }
+    }
 
-        DecryptOFB(ciphTxtIn, plainTxtOut, key);
-        break;
+    if (AESNISupported())
+    {
+        uint32_t keyBytes[8];
 
-    default:
+        for (uint32_t i = 0; i < nk; i++)
+            keyBytes[i] = REVERSE_ENDIAN32(w[i]);
 
-        break;
+        AESNIExpandKey((const uint8_t*)keyBytes, nk, niEnc, niDec);
     }
+
+    bTables = true;
 }
 
 /**
- * AES::EncryptECBCBC - Encrypt input plaintext in ECB or CBC modes.
+ * AES::ExpandKey - Expand a key into this object's own key schedule and use it
+ * for subsequent Encrypt/Decrypt calls. With the bitsliced engine selected the
+ * expansion is constant-time.
  *
- * @param plainTxtIn    [in]        Plaintext to be encrypted.
- * @param msgOut        [in/out]    Output ciphertext.
- * @param key           [in]        AES key for encryption.
+ * @param key   [in]    Cryptographic key to expand.
  */
 
-void AES::EncryptECBCBC(const vector<uint8_t>& plainTxtIn, vector<uint8_t>& ciphTxtOut,
-    const vector<uint32_t>& key)
+void AES::ExpandKey(const vector<uint32_t>& key)
 {
-    assert(ciphTxtOut.size() == 0);
-    ciphTxtOut.resize(plainTxtIn.size());
-    uint32_t offset = 0;
+    assert(key.size() == nk);
 
-    stream.SetData(plainTxtIn);
-    ExpandKey(key);
+    sched.Expand(key, engine == AES_BITSLICED);
+    sharedSched = nullptr;
 
-    while (!stream.End())
-    {
-        ClearState();
-        uint32_t plainTxt[4];
-        stream.Next(plainTxt);
+    ExpandBitsliced();
+}
 
-        state[0] ^= plainTxt[0];
-        state[1] ^= plainTxt[1];
-        state[2] ^= plainTxt[2];
-        state[3] ^= plainTxt[3];
+/**
+ * AES::SetKey - Use an already expanded key schedule for subsequent Encrypt/Decrypt
+ * calls instead of expanding the key on every call. The schedule is only read, so
+ * one schedule may back many AES objects on different threads. It must stay alive
+ * until this object is destroyed or given another key, and must be passed to
+ * SetKey again after it is re-expanded. A schedule expanded with bConstantTime
+ * can only back the bitsliced and reference engines.
+ *
+ * @param schedIn   [in]    Expanded key schedule matching this object's key size.
+ */
 
-        if (mode == CBC)
-        {
-            state[0] ^= iv[0];
-            state[1] ^= iv[1];
-            state[2] ^= iv[2];
-            state[3] ^= iv[3];
-        }
+void AES::SetKey(const AESKeySchedule& schedIn)
+{
+    if (schedIn.nk != nk)
+        throw invalid_argument("AES key schedule size does not match AES key size.");
 
-        AddRoundKey(0);
+    if (!schedIn.bTables && (engine == AES_TTABLE || engine == AES_AESNI))
+        throw invalid_argument("AES key schedule was expanded for the bitsliced engine only.");
 
-        for (uint32_t i = 1; i < nr; i++)
-        {
-            SubBytes();
-            ShiftRows();
-            MixColumns();
-            AddRoundKey(i);
-        }
+    sharedSched = &schedIn;
 
-        SubBytes();
-        ShiftRows();
-        AddRoundKey(nr);
+    ExpandBitsliced();
+}
 
-        memcpy(&ciphTxtOut[offset], state, 16);
+/**
+ * AES::Keys - Key schedule in use: the shared schedule from SetKey, or the one
+ * built by the last ExpandKey call.
+ *
+ * @return Active key schedule.
+ */
 
-        if (mode == CBC)
-            memcpy(&iv[0], &state[0], 16);
+const AESKeySchedule& AES::Keys() const
+{
+    return sharedSched ? *sharedSched : sched;
+}
 
-        offset += 16;
-    }
+/**
+ * AES::ExpandBitsliced - Pack the active key schedule into bitsliced round keys
+ * when the bitsliced engine is selected. The packing costs several times the
+ * key expansion itself, so the other engines never pay for it.
+ */
 
-    for (uint32_t i = 0; i < ciphTxtOut.size(); i += 4)
-    {
-        uint8_t tmp         = ciphTxtOut[i];
-        ciphTxtOut[i]       = ciphTxtOut[i + 3];
-        ciphTxtOut[i + 3]   = ciphTxtOut[i + 1];
-        ciphTxtOut[i + 1]   = ciphTxtOut[i + 2];
-        ciphTxtOut[i + 2]   = ciphTxtOut[i + 3];
-        ciphTxtOut[i + 3]   = tmp;
-    }
+void AES::ExpandBitsliced()
+{
+    if (engine != AES_BITSLICED || Keys().nk == 0)
+        return;
+
+    bsKeys.resize(AESBS_KEY_WORDS);
+    AESBSExpandKey(Keys().w, nr, &bsKeys[0]);
 }
 
 /**
- * AES::DecryptECBCBC - Decrypt input ciphertext in ECB or CBC modes.
+ * AES::SetEngine - Select the block cipher implementation used by all modes.
  *
- * @param ciphTxtIn     [in]        Ciphertext to be decrypted.
- * @param plainTxtOut   [in/out]    Output plaintext.
- * @param key           [in]        AES key for decryption.
+ * @param engineIn  [in] AES_REFERENCE for the step-by-step FIPS 197 rounds,
+ *                       AES_TTABLE for the table-driven rounds, AES_AESNI
+ *                       for the hardware AES instructions, or AES_BITSLICED for
+ *                       the constant-time bitsliced rounds (eight blocks at a
+ *                       time in ECB, CTR, and CBC/CFB128 decryption). Key setup
+ *                       is constant-time too when the key is expanded after the
+ *                       engine is selected, or comes from a schedule expanded
+ *                       with bConstantTime. Leaving the bitsliced engine fills in
+ *                       the table-derived round keys of the object's own schedule.
  */
 
-void AES::DecryptECBCBC(const vector<uint8_t>& ciphTxtIn, vector<uint8_t>& plainTxtOut,
-    const vector<uint32_t>& key)
+void AES::SetEngine(const AESEngine engineIn)
 {
-    assert(plainTxtOut.size() == 0);
-    plainTxtOut.resize(ciphTxtIn.size());
-    uint32_t offset = 0;
-
-    stream.SetData(ciphTxtIn);
-    ExpandKey(key);
+    if (engineIn == AES_AESNI && !AESNISupported())
+        throw invalid_argument("AES-NI is not supported on this CPU.");
 
-    while (!stream.End())
+    if (!Keys().bTables && (engineIn == AES_TTABLE || engineIn == AES_AESNI))
     {
-        ClearState();
-        uint32_t ciphTxt[4];
-        stream.Next(ciphTxt);
-
-        state[0] ^= ciphTxt[0];
-        state[1] ^= ciphTxt[1];
-        state[2] ^= ciphTxt[2];
-        state[3] ^= ciphTxt[3];
+        if (sharedSched)
+            throw invalid_argument("AES key schedule was expanded for the bitsliced engine only.");
 
-        AddRoundKey(nr);
-        InvShiftRows();
-        InvSubBytes();
+        sched.ExpandTables();
+    }
 
-        for (uint32_t i = nr; i-- > 1;)
-        {
-            AddRoundKey(i);
-            InvMixColumns();
-            InvShiftRows();
-            InvSubBytes();
-        }
+    engine = engineIn;
 
-        AddRoundKey(0);
+    ExpandBitsliced();
+}
 
-        if (mode == CBC)
-        {
-            state[0] ^= iv[0];
-            state[1] ^= iv[1];
-            state[2] ^= iv[2];
-            state[3] ^= iv[3];
-
-            iv[0] = ciphTxt[0];
-            iv[1] = ciphTxt[1];
-            iv[2] = ciphTxt[2];
-            iv[3] = ciphTxt[3];
-        }
+/**
+ * AES::SetThreading - Configure multi-threaded processing of large messages in
+ * modes whose blocks are independent.
+ *
+ * @param numThreadsIn          [in] Maximum number of worker threads. 1 disables threading.
+ * @param parallelThresholdIn   [in] Minimum message size in bytes before work is split
+ *                                   across threads.
+ */
 
-        memcpy(&plainTxtOut[offset], state, 16);
-        offset += 16;
-    }
+void AES::SetThreading(const uint32_t numThreadsIn, const uint64_t parallelThresholdIn)
+{
+    if (numThreadsIn == 0)
+        throw invalid_argument("AES thread count must be at least 1.");
 
-    for (uint32_t i = 0; i < plainTxtOut.size(); i += 4)
-    {
-        uint8_t tmp         = plainTxtOut[i];
-        plainTxtOut[i]      = plainTxtOut[i + 3];
-        plainTxtOut[i + 3]  = plainTxtOut[i + 1];
-        plainTxtOut[i + 1]  = plainTxtOut[i + 2];
-        plainTxtOut[i + 2]  = plainTxtOut[i + 3];
-        plainTxtOut[i + 3]  = tmp;
-    }
+    numThreads          = numThreadsIn;
+    parallelThreshold   = parallelThresholdIn;
 }
 
 /**
- * AES::WriteBits - Helper for CFB mode. Write s MSB bits from the AES state to an output buffer.
+ * EncryptBlockTTable - Encrypt the state with combined SubBytes, ShiftRows and MixColumns
+ * lookup tables. Each output column of a round is four table lookups XORed with the
+ * round key.
  *
- * @param s         [in]        Number of bits to write. Supports 1, 8, or 128 bits.
- * @param msgOut    [in/out]    Output buffer to write.
- * @param offset    [in]        Output buffer write offset in bits.
+ * @param rk    [in]        Expanded encryption key schedule.
+ * @param nr    [in]        Number of rounds.
+ * @param st    [in/out]    State columns to encrypt.
  */
 
-void AES::WriteBits(const uint32_t s, vector<uint8_t>& msgOut, const uint32_t offset)
+static void EncryptBlockTTable(const uint32_t* rk, const uint32_t nr, uint32_t st[4])
 {
-    assert(s == 1 || s == 8 || s == 128);
-    assert(offset <= 8 * msgOut.size());
+    uint32_t s0 = st[0] ^ rk[0];
+    uint32_t s1 = st[1] ^ rk[1];
+    uint32_t s2 = st[2] ^ rk[2];
+    uint32_t s3 = st[3] ^ rk[3];
+    uint32_t t0, t1, t2, t3;
 
-    if (s == 8 || s == 128)
+    for (uint32_t r = 1; r < nr; r++)
     {
-        const uint32_t offsetBytes = offset / 8;
+        rk += 4;
 
-        if (s == 8)
-            msgOut[offsetBytes] = ((state[0] & 0xFF000000) >> 24);
+        t0 = Te0[s0 >> 24] ^ Te1[(s1 >> 16) & 0xFF] ^ Te2[(s2 >> 8) & 0xFF] ^ Te3[s3 & 0xFF] ^ rk[0];
+        t1 = Te0[s1 >> 24] ^ Te1[(s2 >> 16) & 0xFF] ^ Te2[(s3 >> 8) & 0xFF] ^ Te3[s0 & 0xFF] ^ rk[1];
+        t2 = Te0[s2 >> 24] ^ Te1[(s3 >> 16) & 0xFF] ^ Te2[(s0 >> 8) & 0xFF] ^ Te3[s1 & 0xFF] ^ rk[2];
+        t3 = Te0[s3 >> 24] ^ Te1[(s0 >> 16) & 0xFF] ^ Te2[(s1 >> 8) & 0xFF] ^ Te3[s2 & 0xFF] ^ rk[3];
 
-        if (s == 128)
-        {
-            uint32_t tmp[4];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
 
-            tmp[0] = REVERSE_ENDIAN32(state[0]);
-            tmp[1] = REVERSE_ENDIAN32(state[1]);
-            tmp[2] = REVERSE_ENDIAN32(state[2]);
-            tmp[3] = REVERSE_ENDIAN32(state[3]);
+    rk += 4;
 
-            memcpy(&msgOut[offsetBytes], &tmp[0], 16);
-        }
-    }
-    else
-    {
-        uint32_t byte   = offset / 8;
-        uint32_t shift  = offset % 8;
-        uint32_t bit    = ((state[0] & 0x80000000) >> 31);
-        msgOut[byte]    |= (bit << shift);
-    }
+    st[0] = (Te2[s0 >> 24] & 0xFF000000) ^ (Te3[(s1 >> 16) & 0xFF] & 0x00FF0000) ^
+            (Te0[(s2 >> 8) & 0xFF] & 0x0000FF00) ^ (Te1[s3 & 0xFF] & 0x000000FF) ^ rk[0];
+    st[1] = (Te2[s1 >> 24] & 0xFF000000) ^ (Te3[(s2 >> 16) & 0xFF] & 0x00FF0000) ^
+            (Te0[(s3 >> 8) & 0xFF] & 0x0000FF00) ^ (Te1[s0 & 0xFF] & 0x000000FF) ^ rk[1];
+    st[2] = (Te2[s2 >> 24] & 0xFF000000) ^ (Te3[(s3 >> 16) & 0xFF] & 0x00FF0000) ^
+            (Te0[(s0 >> 8) & 0xFF] & 0x0000FF00) ^ (Te1[s1 & 0xFF] & 0x000000FF) ^ rk[2];
+    st[3] = (Te2[s3 >> 24] & 0xFF000000) ^ (Te3[(s0 >> 16) & 0xFF] & 0x00FF0000) ^
+            (Te0[(s1 >> 8) & 0xFF] & 0x0000FF00) ^ (Te1[s2 & 0xFF] & 0x000000FF) ^ rk[3];
 }
 
 /**
- * AES::UpdateInputBlock - Helper for CFB mode. After processing each chunk of s bits of plaintext,
- * input blocks are shifted left by s bits and the s MSB bits of the previous iteration's ciphertext 
- * are moved to the s LSB bits of input for the next round.
- * 
- * Move the s MSB bits of the previous iteration's ciphertext to the s LSB bits of the next
- * iteration's input block here.
+ * DecryptBlockTTable - Decrypt the state with combined InvSubBytes, InvShiftRows and
+ * InvMixColumns lookup tables. Uses the equivalent inverse cipher (FIPS 197 5.3.5),
+ * so the key schedule must already have InvMixColumns applied to the middle round keys.
  *
- * @param s     [in]    Number of ciphertext bits to add to the input block.
+ * @param rk    [in]        Equivalent inverse key schedule, last round key first.
+ * @param nr    [in]        Number of rounds.
+ * @param st    [in/out]    State columns to decrypt.
  */
 
-void AES::UpdateInputBlock(const uint32_t s)
+static void DecryptBlockTTable(const uint32_t* rk, const uint32_t nr, uint32_t st[4])
 {
-    assert(s == 1 || s == 8 || s == 128);
+    const uint32_t* invS = &sboxInv[0][0];
+
+    uint32_t s0 = st[0] ^ rk[0];
+    uint32_t s1 = st[1] ^ rk[1];
+    uint32_t s2 = st[2] ^ rk[2];
+    uint32_t s3 = st[3] ^ rk[3];
+    uint32_t t0, t1, t2, t3;
 
-    switch (s)
+    for (uint32_t r = 1; r < nr; r++)
     {
-    case 1:
+        rk += 4;
 
-        iv[3] &= 0xFFFFFFFE;
-        iv[3] |= ((state[0] & 0x80000000) >> 31);
+        t0 = Td0[s0 >> 24] ^ Td1[(s3 >> 16) & 0xFF] ^ Td2[(s2 >> 8) & 0xFF] ^ Td3[s1 & 0xFF] ^ rk[0];
+        t1 = Td0[s1 >> 24] ^ Td1[(s0 >> 16) & 0xFF] ^ Td2[(s3 >> 8) & 0xFF] ^ Td3[s2 & 0xFF] ^ rk[1];
+        t2 = Td0[s2 >> 24] ^ Td1[(s1 >> 16) & 0xFF] ^ Td2[(s0 >> 8) & 0xFF] ^ Td3[s3 & 0xFF] ^ rk[2];
+        t3 = Td0[s3 >> 24] ^ Td1[(s2 >> 16) & 0xFF] ^ Td2[(s1 >> 8) & 0xFF] ^ Td3[s0 & 0xFF] ^ rk[3];
+
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    rk += 4;
+
+    st[0] = (invS[s0 >> 24] << 24) ^ (invS[(s3 >> 16) & 0xFF] << 16) ^
+            (invS[(s2 >> 8) & 0xFF] << 8) ^ invS[s1 & 0xFF] ^ rk[0];
+    st[1] = (invS[s1 >> 24] << 24) ^ (invS[(s0 >> 16) & 0xFF] << 16) ^
+            (invS[(s3 >> 8) & 0xFF] << 8) ^ invS[s2 & 0xFF] ^ rk[1];
+    st[2] = (invS[s2 >> 24] << 24) ^ (invS[(s1 >> 16) & 0xFF] << 16) ^
+            (invS[(s0 >> 8) & 0xFF] << 8) ^ invS[s3 & 0xFF] ^ rk[2];
+    st[3] = (invS[s3 >> 24] << 24) ^ (invS[(s2 >> 16) & 0xFF] << 16) ^
+            (invS[(s1 >> 8) & 0xFF] << 8) ^ invS[s0 & 0xFF] ^ rk[3];
+}
+
+/**
+ * AES::Cipher - Encrypt the state array in place with the current key schedule
+ * using the selected engine.
+ */
+
+void AES::Cipher()
+{
+    if (engine == AES_TTABLE)
+    {
+        EncryptBlockTTable(Keys().w, nr, state);
+        return;
+    }
+
+    if (engine == AES_AESNI)
+    {
+        uint32_t block[4];
+
+        for (uint32_t i = 0; i < 4; i++)
+            block[i] = REVERSE_ENDIAN32(state[i]);
+
+        AESNIEncryptBlock(Keys().niEnc, nr, (const uint8_t*)block, (uint8_t*)block);
+
+        for (uint32_t i = 0; i < 4; i++)
+            state[i] = REVERSE_ENDIAN32(block[i]);
+
+        return;
+    }
+
+    if (engine == AES_BITSLICED)
+    {
+        uint32_t block[4];
+
+        for (uint32_t i = 0; i < 4; i++)
+            block[i] = REVERSE_ENDIAN32(state[i]);
+
+        AESBSEncryptBlocks(&bsKeys[0], nr, (const uint8_t*)block, (uint8_t*)block, 1);
+
+        for (uint32_t i = 0; i < 4; i++)
+            state[i] = REVERSE_ENDIAN32(block[i]);
+
+        return;
+    }
+
+    AddRoundKey(0);
+
+    for (uint32_t i = 1; i < nr; i++)
+    {
+        SubBytes();
+        ShiftRows();
+        MixColumns();
+        AddRoundKey(i);
+    }
+
+    SubBytes();
+    ShiftRows();
+    AddRoundKey(nr);
+}
+
+/**
+ * AES::InvCipher - Decrypt the state array in place with the current key schedule
+ * using the selected engine.
+ */
+
+void AES::InvCipher()
+{
+    if (engine == AES_TTABLE)
+    {
+        DecryptBlockTTable(Keys().dw, nr, state);
+        return;
+    }
+
+    if (engine == AES_AESNI)
+    {
+        uint32_t block[4];
+
+        for (uint32_t i = 0; i < 4; i++)
+            block[i] = REVERSE_ENDIAN32(state[i]);
+
+        AESNIDecryptBlock(Keys().niDec, nr, (const uint8_t*)block, (uint8_t*)block);
+
+        for (uint32_t i = 0; i < 4; i++)
+            state[i] = REVERSE_ENDIAN32(block[i]);
+
+        return;
+    }
+
+    if (engine == AES_BITSLICED)
+    {
+        uint32_t block[4];
+
+        for (uint32_t i = 0; i < 4; i++)
+            block[i] = REVERSE_ENDIAN32(state[i]);
+
+        AESBSDecryptBlocks(&bsKeys[0], nr, (const uint8_t*)block, (uint8_t*)block, 1);
+
+        for (uint32_t i = 0; i < 4; i++)
+            state[i] = REVERSE_ENDIAN32(block[i]);
+
+        return;
+    }
+
+    AddRoundKey(nr);
+    InvShiftRows();
+    InvSubBytes();
+
+    for (uint32_t i = nr; i-- > 1;)
+    {
+        AddRoundKey(i);
+        InvMixColumns();
+        InvShiftRows();
+        InvSubBytes();
+    }
+
+    AddRoundKey(0);
+}
+
+/**
+ * AES::Encrypt - AES encryption entry. Expand the key, then encrypt with it. Callers
+ * encrypting many messages under one key should expand an AESKeySchedule once and
+ * use SetKey instead.
+ *
+ * @param plainTxtIn    [in]        Plaintext to be encrypted.
+ * @param ciphTxtOut    [in/out]    Output ciphertext.
+ * @param key           [in]        AES key to expand and encrypt with.
+ */
+
+void AES::Encrypt(const vector<uint8_t>& plainTxtIn, vector<uint8_t>& ciphTxtOut, const vector<uint32_t>& key)
+{
+    ExpandKey(key);
+    Encrypt(plainTxtIn, ciphTxtOut);
+}
+
+/**
+ * AES::Decrypt - AES decryption entry. Expand the key, then decrypt with it.
+ *
+ * @param ciphTxtIn     [in]        Ciphertext to be decrypted.
+ * @param plainTxtOut   [in/out]    Output plaintext.
+ * @param key           [in]        AES key to expand and decrypt with.
+ */
+
+void AES::Decrypt(const vector<uint8_t>& ciphTxtIn, vector<uint8_t>& plainTxtOut, const vector<uint32_t>& key)
+{
+    ExpandKey(key);
+    Decrypt(ciphTxtIn, plainTxtOut);
+}
+
+/**
+ * AES::Encrypt - Encrypt with the key schedule set by SetKey or ExpandKey into an
+ * output vector sized to match. Wrapper over the buffer overload.
+ *
+ * @param plainTxtIn    [in]        Plaintext to be encrypted.
+ * @param ciphTxtOut    [in/out]    Output ciphertext. Must be empty.
+ */
+
+void AES::Encrypt(const vector<uint8_t>& plainTxtIn, vector<uint8_t>& ciphTxtOut)
+{
+    assert(ciphTxtOut.size() == 0);
+    ciphTxtOut.resize(plainTxtIn.size());
+
+    Encrypt(plainTxtIn.data(), ciphTxtOut.data(), plainTxtIn.size());
+}
+
+/**
+ * AES::Decrypt - Decrypt with the key schedule set by SetKey or ExpandKey into an
+ * output vector sized to match. Wrapper over the buffer overload.
+ *
+ * @param ciphTxtIn     [in]        Ciphertext to be decrypted.
+ * @param plainTxtOut   [in/out]    Output plaintext. Must be empty.
+ */
+
+void AES::Decrypt(const vector<uint8_t>& ciphTxtIn, vector<uint8_t>& plainTxtOut)
+{
+    assert(plainTxtOut.size() == 0);
+    plainTxtOut.resize(ciphTxtIn.size());
+
+    Decrypt(ciphTxtIn.data(), plainTxtOut.data(), ciphTxtIn.size());
+}
+
+/**
+ * AES::Encrypt - Encrypt a caller-owned buffer with the key schedule set by SetKey or
+ * ExpandKey. Runs in a single pass over the data and, apart from splitting large
+ * messages across threads, does not allocate. Route to the appropriate encryption
+ * routine based on AES mode and engine. ECB and CBC take whole blocks; the other
+ * modes take any number of bytes.
+ *
+ * @param in    [in]    Plaintext to be encrypted.
+ * @param out   [out]   Output ciphertext, len bytes. May be the same buffer as in.
+ * @param len   [in]    Length in bytes.
+ */
+
+void AES::Encrypt(const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    if ((mode == ECB || mode == CBC) && (len % 16) != 0)
+        throw invalid_argument("AES ECB and CBC modes need a whole number of blocks.");
+
+    if (engine == AES_AESNI && mode != CFB1 && mode != CFB8 && mode != CTR)
+    {
+        EncryptAESNI(in, out, len);
+        return;
+    }
+
+    if (engine == AES_BITSLICED && mode == ECB)
+    {
+        AESBSEncryptBlocks(&bsKeys[0], nr, in, out, len / 16);
+        return;
+    }
+
+    switch (mode)
+    {
+        case ECB:
+        case CBC:
+
+            EncryptECBCBC(in, out, len);
+            break;
+
+        case CFB1:
+
+            CryptCFB(in, out, len, 1, true);
+            break;
+
+        case CFB8:
+
+            CryptCFB(in, out, len, 8, true);
+            break;
+
+        case CFB128:
+
+            CryptCFB(in, out, len, 128, true);
+            break;
+
+        case OFB:
+
+            CryptOFB(in, out, len);
+            break;
+
+        case CTR:
+
+            CryptCTR(in, out, len);
+            break;
+
+        default:
+
+            break;
+    }
+}
+
+/**
+ * AES::Decrypt - Decrypt a caller-owned buffer with the key schedule set by SetKey or
+ * ExpandKey. Runs in a single pass over the data and, apart from splitting large
+ * messages across threads, does not allocate. Route to the appropriate decryption
+ * routine based on AES mode and engine. ECB and CBC take whole blocks; the other
+ * modes take any number of bytes.
+ *
+ * @param in    [in]    Ciphertext to be decrypted.
+ * @param out   [out]   Output plaintext, len bytes. May be the same buffer as in.
+ * @param len   [in]    Length in bytes.
+ */
+
+void AES::Decrypt(const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    if ((mode == ECB || mode == CBC) && (len % 16) != 0)
+        throw invalid_argument("AES ECB and CBC modes need a whole number of blocks.");
+
+    if (engine != AES_REFERENCE && (mode == CBC || mode == CFB128))
+    {
+        DecryptChained(in, out, len);
+        return;
+    }
+
+    if (engine == AES_AESNI && mode != CFB1 && mode != CFB8 && mode != CTR)
+    {
+        DecryptAESNI(in, out, len);
+        return;
+    }
+
+    if (engine == AES_BITSLICED && mode == ECB)
+    {
+        AESBSDecryptBlocks(&bsKeys[0], nr, in, out, len / 16);
+        return;
+    }
+
+    switch (mode)
+    {
+    case ECB:
+    case CBC:
+
+        DecryptECBCBC(in, out, len);
+        break;
+
+    case CFB1:
+
+        CryptCFB(in, out, len, 1, false);
+        break;
+
+    case CFB8:
+
+        CryptCFB(in, out, len, 8, false);
+        break;
+
+    case CFB128:
+
+        CryptCFB(in, out, len, 128, false);
+        break;
+
+    case OFB:
+
+        CryptOFB(in, out, len);
+        break;
+
+    case CTR:
+
+        CryptCTR(in, out, len);
+        break;
+
+    default:
+
+        break;
+    }
+}
+
+/**
+ * IVToBytes - Convert big-endian IV words to the 16-byte block the buffer routines chain on.
+ *
+ * @param iv        [in]    IV words.
+ * @param ivBytes   [out]   IV as bytes.
+ */
+
+static void IVToBytes(const vector<uint32_t>& iv, uint8_t ivBytes[16])
+{
+    assert(iv.size() == 4);
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t word = REVERSE_ENDIAN32(iv[i]);
+        memcpy(&ivBytes[4 * i], &word, 4);
+    }
+}
+
+/**
+ * BytesToIV - Convert a 16-byte chaining block back to big-endian IV words.
+ *
+ * @param ivBytes   [in]    IV as bytes.
+ * @param iv        [out]   IV words.
+ */
+
+static void BytesToIV(const uint8_t ivBytes[16], vector<uint32_t>& iv)
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t word;
+        memcpy(&word, &ivBytes[4 * i], 4);
+        iv[i] = REVERSE_ENDIAN32(word);
+    }
+}
+
+/**
+ * AES::CipherBlock - Encrypt one 16-byte block through the state array with the
+ * current engine.
+ *
+ * @param in    [in]    Input block.
+ * @param out   [out]   Output block. May be the same as in.
+ */
+
+void AES::CipherBlock(const uint8_t in[16], uint8_t out[16])
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        state[i] = (uint32_t)in[4 * i] << 24 | (uint32_t)in[4 * i + 1] << 16 |
+            (uint32_t)in[4 * i + 2] << 8 | in[4 * i + 3];
+    }
+
+    Cipher();
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t word = REVERSE_ENDIAN32(state[i]);
+        memcpy(&out[4 * i], &word, 4);
+    }
+}
+
+/**
+ * AES::InvCipherBlock - Decrypt one 16-byte block through the state array with the
+ * current engine.
+ *
+ * @param in    [in]    Input block.
+ * @param out   [out]   Output block. May be the same as in.
+ */
+
+void AES::InvCipherBlock(const uint8_t in[16], uint8_t out[16])
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        state[i] = (uint32_t)in[4 * i] << 24 | (uint32_t)in[4 * i + 1] << 16 |
+            (uint32_t)in[4 * i + 2] << 8 | in[4 * i + 3];
+    }
+
+    InvCipher();
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t word = REVERSE_ENDIAN32(state[i]);
+        memcpy(&out[4 * i], &word, 4);
+    }
+}
+
+/**
+ * AES::EncryptAESNI - Encrypt in ECB, CBC, CFB128 or OFB mode with the AES-NI bulk
+ * routines.
+ *
+ * @param in    [in]    Plaintext to be encrypted.
+ * @param out   [out]   Output ciphertext. May be the same buffer as in.
+ * @param len   [in]    Length in bytes. Whole blocks for ECB and CBC.
+ */
+
+void AES::EncryptAESNI(const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    uint8_t ivBytes[16];
+
+    const AESKeySchedule& ks = Keys();
+
+    if (mode != ECB)
+        IVToBytes(iv, ivBytes);
+
+    switch (mode)
+    {
+    case ECB:
+
+        AESNIEncryptECB(ks.niEnc, nr, in, out, len / 16);
+        break;
+
+    case CBC:
+
+        AESNIEncryptCBC(ks.niEnc, nr, ivBytes, in, out, len / 16);
+        break;
+
+    case CFB128:
+
+        AESNIEncryptCFB128(ks.niEnc, nr, ivBytes, in, out, len);
+        break;
+
+    case OFB:
+
+        AESNICryptOFB(ks.niEnc, nr, ivBytes, in, out, len);
+        break;
+
+    default:
+
+        throw invalid_argument("Unsupported mode for AES-NI bulk encryption.");
+    }
+
+    if (mode != ECB)
+        BytesToIV(ivBytes, iv);
+}
+
+/**
+ * AES::DecryptAESNI - Decrypt in ECB, CBC, CFB128 or OFB mode with the AES-NI bulk
+ * routines.
+ *
+ * @param in    [in]    Ciphertext to be decrypted.
+ * @param out   [out]   Output plaintext. May be the same buffer as in.
+ * @param len   [in]    Length in bytes. Whole blocks for ECB and CBC.
+ */
+
+void AES::DecryptAESNI(const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    uint8_t ivBytes[16];
+
+    const AESKeySchedule& ks = Keys();
+
+    if (mode != ECB)
+        IVToBytes(iv, ivBytes);
+
+    switch (mode)
+    {
+    case ECB:
+
+        AESNIDecryptECB(ks.niDec, nr, in, out, len / 16);
+        break;
+
+    case CBC:
+
+        AESNIDecryptCBC(ks.niDec, nr, ivBytes, in, out, len / 16);
         break;
 
-    case 8:
+    case CFB128:
 
-        iv[3] &= 0xFFFFFFF0;
-        iv[3] |= ((state[0] & 0xFF000000) >> 24);
+        AESNIDecryptCFB128(ks.niEnc, nr, ivBytes, in, out, len);
         break;
 
-    case 128:
+    case OFB:
 
-        memcpy(&iv[0], &state[0], 16);
+        AESNICryptOFB(ks.niEnc, nr, ivBytes, in, out, len);
         break;
+
+    default:
+
+        throw invalid_argument("Unsupported mode for AES-NI bulk decryption.");
     }
+
+    if (mode != ECB)
+        BytesToIV(ivBytes, iv);
 }
 
 /**
- * AES::UpdateInputBlock - Helper for CFB mode. After processing each chunk of s bits of plaintext,
- * input blocks are shifted left by s bits and the s MSB bits of the previous iteration's ciphertext
- * are moved to the s LSB bits of input for the next round.
+ * AES::EncryptECBCBC - Encrypt whole blocks in ECB or CBC mode.
  *
- * Move the s MSB bits of the previous iteration's ciphertext to the s LSB bits of the next
- * iteration's input block here.
- *
- * @param s     [in]    Number of ciphertext bits to add to the input block.
- * @param txt   [in]    Text to shift into input block for CFB mode. Mostly used for CFB decryption.
+ * @param in    [in]    Plaintext to be encrypted.
+ * @param out   [out]   Output ciphertext. May be the same buffer as in.
+ * @param len   [in]    Length in bytes, a multiple of 16.
  */
 
-void AES::UpdateInputBlock(const uint32_t s, const uint32_t txt[4])
+void AES::EncryptECBCBC(const uint8_t* in, uint8_t* out, const uint64_t len)
 {
-    assert(s == 1 || s == 8 || s == 128);
+    assert(len % 16 == 0);
+
+    uint8_t chain[16] = { 0 };
+
+    if (mode == CBC)
+        IVToBytes(iv, chain);
 
-    switch (s)
+    for (uint64_t offset = 0; offset < len; offset += 16)
     {
-    case 1:
+        uint8_t block[16];
 
-        iv[3] &= 0xFFFFFFFE;
-        iv[3] |= txt[0];
-        break;
+        for (uint32_t i = 0; i < 16; i++)
+            block[i] = in[offset + i] ^ chain[i];
 
-    case 8:
+        CipherBlock(block, &out[offset]);
 
-        iv[3] &= 0xFFFFFF00;
-        iv[3] |= txt[0];
-        break;
+        if (mode == CBC)
+            memcpy(chain, &out[offset], 16);
+    }
 
-    case 128:
+    if (mode == CBC)
+        BytesToIV(chain, iv);
+}
 
-        memcpy(&iv[0], &txt[0], 16);
-        break;
+/**
+ * AES::DecryptECBCBC - Decrypt whole blocks in ECB or CBC mode.
+ *
+ * @param in    [in]    Ciphertext to be decrypted.
+ * @param out   [out]   Output plaintext. May be the same buffer as in.
+ * @param len   [in]    Length in bytes, a multiple of 16.
+ */
+
+void AES::DecryptECBCBC(const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    assert(len % 16 == 0);
+
+    uint8_t chain[16] = { 0 };
+
+    if (mode == CBC)
+        IVToBytes(iv, chain);
+
+    for (uint64_t offset = 0; offset < len; offset += 16)
+    {
+        uint8_t ciphTxt[16];
+        uint8_t block[16];
+
+        memcpy(ciphTxt, &in[offset], 16);
+        InvCipherBlock(ciphTxt, block);
+
+        for (uint32_t i = 0; i < 16; i++)
+            out[offset + i] = block[i] ^ chain[i];
+
+        if (mode == CBC)
+            memcpy(chain, ciphTxt, 16);
     }
+
+    if (mode == CBC)
+        BytesToIV(chain, iv);
 }
 
 /**
- * AES::XORPlainText - For CFB mode, XOR s bits of text into the AES
- * after each cipher iteration.
+ * ShiftInBit - Helper for CFB1 mode. Shift a 128-bit input block left by one bit and
+ * move a new bit into the LSB.
  *
- * @param text      [in]    Plaintext to XOR.
- * @param s         [in]    Number of bits to XOR from the text.
+ * @param block     [in/out]    Input block.
+ * @param bit       [in]        Bit to shift in.
  */
 
-void AES::XORText(uint32_t txt[4], const uint32_t s)
+static void ShiftInBit(uint8_t block[16], const uint8_t bit)
 {
-    assert(s == 1 || s == 8 || s == 128);
+    for (uint32_t i = 0; i < 15; i++)
+        block[i] = (uint8_t)(block[i] << 1) | (block[i + 1] >> 7);
+
+    block[15] = (uint8_t)(block[15] << 1) | bit;
+}
+
+/**
+ * CryptCFBSegmentsTTable - CFB1 or CFB8 with T-table rounds. The shift register is
+ * kept as two 64-bit halves whose 32-bit pieces are exactly the big-endian state
+ * columns the rounds take, so each segment costs one block encryption plus a
+ * couple of shifts. CFB1 walks the bits of each byte LSB first.
+ *
+ * @param w         [in]        Encryption round key words.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Shift register as four big-endian words.
+ * @param in        [in]        Input text.
+ * @param out       [out]       Output text. May be the same buffer as in.
+ * @param len       [in]        Length in bytes.
+ * @param s         [in]        Segment size in bits, 1 or 8.
+ * @param bEncrypt  [in]        True to encrypt, false to decrypt.
+ */
+
+static void CryptCFBSegmentsTTable(const uint32_t* w, const uint32_t nr, vector<uint32_t>& iv,
+    const uint8_t* in, uint8_t* out, const uint64_t len, const uint32_t s, const bool bEncrypt)
+{
+    uint64_t hi = (uint64_t)iv[0] << 32 | iv[1];
+    uint64_t lo = (uint64_t)iv[2] << 32 | iv[3];
 
-    switch (s)
+    for (uint64_t i = 0; i < len; i++)
     {
-    case 1:
+        const uint32_t txt = in[i];
+        uint32_t outByte;
 
-        state[0] ^= (txt[0] << 31);
-        break;
+        if (s == 8)
+        {
+            uint32_t st[4] = { (uint32_t)(hi >> 32), (uint32_t)hi, (uint32_t)(lo >> 32), (uint32_t)lo };
 
-    case 8:
+            EncryptBlockTTable(w, nr, st);
+            outByte = (txt ^ (st[0] >> 24)) & 0xFF;
 
-        state[0] ^= (txt[0] << 24);
-        break;
+            hi = (hi << 8) | (lo >> 56);
+            lo = (lo << 8) | (bEncrypt ? outByte : txt);
+        }
+        else
+        {
+            outByte = 0;
 
-    case 128:
+            for (uint32_t bit = 0; bit < 8; bit++)
+            {
+                uint32_t st[4] = { (uint32_t)(hi >> 32), (uint32_t)hi, (uint32_t)(lo >> 32), (uint32_t)lo };
 
-        state[0] ^= txt[0];
-        state[1] ^= txt[1];
-        state[2] ^= txt[2];
-        state[3] ^= txt[3];
-        break;
+                EncryptBlockTTable(w, nr, st);
+
+                const uint32_t txtBit   = (txt >> bit) & 1;
+                const uint32_t outBit   = txtBit ^ (st[0] >> 31);
+
+                outByte |= outBit << bit;
+                hi      = (hi << 1) | (lo >> 63);
+                lo      = (lo << 1) | (bEncrypt ? outBit : txtBit);
+            }
+        }
+
+        out[i] = (uint8_t)outByte;
     }
+
+    iv[0] = (uint32_t)(hi >> 32);
+    iv[1] = (uint32_t)hi;
+    iv[2] = (uint32_t)(lo >> 32);
+    iv[3] = (uint32_t)lo;
 }
 
 /**
- * AES::EncryptCFB - Encrypt input plaintext in CFB mode.
+ * AES::CryptCFB - Encrypt or decrypt in CFB mode with an s-bit segment size. Each
+ * segment is XORed with the s MSBs of the encrypted input block, then the input
+ * block shifts left s bits and takes the s bits of ciphertext in its LSBs. CFB1
+ * walks the bits of each byte LSB first. A trailing partial CFB128 block is XORed
+ * with a keystream prefix and ends the chain. CFB1 and CFB8 on the AES-NI and
+ * T-table engines go to dedicated loops that keep the shift register in registers.
  *
- * @param plainTxtIn    [in]        Plaintext to be encrypted.
- * @param s             [in]        Segment size for CFB mode.
- * @param ciphTxtOut    [in/out]    Output ciphertext.
- * @param key           [in]        AES key for encryption.
+ * @param in        [in]    Input text.
+ * @param out       [out]   Output text. May be the same buffer as in.
+ * @param len       [in]    Length in bytes.
+ * @param s         [in]    Segment size in bits. Supports 1, 8, or 128.
+ * @param bEncrypt  [in]    True to encrypt, false to decrypt.
  */
 
-void AES::EncryptCFB(const vector<uint8_t>& plainTxtIn, const uint32_t s,
-    vector<uint8_t>& ciphTxtOut, const vector<uint32_t>& key)
+void AES::CryptCFB(const uint8_t* in, uint8_t* out, const uint64_t len, const uint32_t s,
+    const bool bEncrypt)
 {
-    assert(ciphTxtOut.size() == 0);
     assert(s == 1 || s == 8 || s == 128);
 
-    ciphTxtOut.resize(plainTxtIn.size());
-    stream.SetData(plainTxtIn);
-    ExpandKey(key);
+    if (s != 128 && engine == AES_AESNI)
+    {
+        uint8_t ivBytes[16];
+
+        IVToBytes(iv, ivBytes);
+
+        if (s == 1)
+            AESNICryptCFB1(Keys().niEnc, nr, ivBytes, in, out, len, bEncrypt);
+        else
+            AESNICryptCFB8(Keys().niEnc, nr, ivBytes, in, out, len, bEncrypt);
 
-    uint32_t writeOffset = 0;
+        BytesToIV(ivBytes, iv);
+        return;
+    }
 
-    while (!stream.End())
+    if (s != 128 && engine == AES_TTABLE)
     {
-        ClearState();
-        uint32_t plainTxt[4];
-        stream.Next(plainTxt);
+        CryptCFBSegmentsTTable(Keys().w, nr, iv, in, out, len, s, bEncrypt);
+        return;
+    }
 
-        state[0] ^= iv[0];
-        state[1] ^= iv[1];
-        state[2] ^= iv[2];
-        state[3] ^= iv[3];
+    uint8_t inBlock[16];
+    uint8_t keyStream[16];
 
-        AddRoundKey(0);
+    IVToBytes(iv, inBlock);
 
-        for (uint32_t i = 1; i < nr; i++)
+    if (s == 128)
+    {
+        for (uint64_t offset = 0; offset < len; offset += 16)
         {
-            SubBytes();
-            ShiftRows();
-            MixColumns();
-            AddRoundKey(i);
+            const uint64_t n = min((uint64_t)16, len - offset);
+            uint8_t ciphTxt[16];
+
+            CipherBlock(inBlock, keyStream);
+
+            for (uint64_t i = 0; i < n; i++)
+            {
+                const uint8_t txt = in[offset + i];
+
+                out[offset + i] = txt ^ keyStream[i];
+                ciphTxt[i]      = bEncrypt ? out[offset + i] : txt;
+            }
+
+            if (n == 16)
+                memcpy(inBlock, ciphTxt, 16);
         }
+    }
+    else if (s == 8)
+    {
+        for (uint64_t i = 0; i < len; i++)
+        {
+            const uint8_t txt = in[i];
 
-        SubBytes();
-        ShiftRows();
-        AddRoundKey(nr);
-        XORText(plainTxt, s);
+            CipherBlock(inBlock, keyStream);
+            out[i] = txt ^ keyStream[0];
 
-        WriteBits(s, ciphTxtOut, writeOffset);
-        RotateIVLeft(s);
-        UpdateInputBlock(s);
+            memmove(inBlock, &inBlock[1], 15);
+            inBlock[15] = bEncrypt ? out[i] : txt;
+        }
+    }
+    else
+    {
+        for (uint64_t i = 0; i < len; i++)
+        {
+            const uint8_t txt   = in[i];
+            uint8_t outByte     = 0;
+
+            for (uint32_t bit = 0; bit < 8; bit++)
+            {
+                const uint8_t txtBit = (txt >> bit) & 1;
+
+                CipherBlock(inBlock, keyStream);
 
-        writeOffset += s;
+                const uint8_t outBit = txtBit ^ (keyStream[0] >> 7);
+                outByte |= (uint8_t)(outBit << bit);
+
+                ShiftInBit(inBlock, bEncrypt ? outBit : txtBit);
+            }
+
+            out[i] = outByte;
+        }
     }
+
+    BytesToIV(inBlock, iv);
 }
 
 /**
- * AES::DecryptCFB - Decrypt input ciphertext in CFB mode
+ * AES::CryptOFB - Encrypt or decrypt in OFB mode (the two are identical). On return
+ * the IV holds the last keystream block.
  *
- * @param ciphTxtIn     [in]        Ciphertext to be decrypted.
- * @param s             [in]        Segment size for CFB mode.
- * @param plainTxtOut   [in/out]    Output plaintext.
- * @param key           [in]        AES key for decryption.
+ * @param in    [in]    Input text.
+ * @param out   [out]   Output text. May be the same buffer as in.
+ * @param len   [in]    Length in bytes.
  */
 
-void AES::DecryptCFB(const vector<uint8_t>& ciphTxtIn, const uint32_t s,
-    vector<uint8_t>& plainTxtOut, const vector<uint32_t>& key)
+void AES::CryptOFB(const uint8_t* in, uint8_t* out, const uint64_t len)
 {
-    assert(plainTxtOut.size() == 0);
-    assert(s == 1 || s == 8 || s == 128);
+    uint8_t keyStream[16];
 
-    plainTxtOut.resize(ciphTxtIn.size());
-    stream.SetData(ciphTxtIn);
-    ExpandKey(key);
+    IVToBytes(iv, keyStream);
+
+    for (uint64_t offset = 0; offset < len; offset += 16)
+    {
+        const uint64_t n = min((uint64_t)16, len - offset);
+
+        CipherBlock(keyStream, keyStream);
+
+        for (uint64_t i = 0; i < n; i++)
+            out[offset + i] = in[offset + i] ^ keyStream[i];
+    }
+
+    BytesToIV(keyStream, iv);
+}
+
+/**
+ * AddCounter - Add to a 128-bit big-endian counter block, wrapping modulo 2^128.
+ *
+ * @param ctr   [in/out]    Counter block.
+ * @param n     [in]        Value to add.
+ */
+
+static void AddCounter(uint8_t ctr[16], uint64_t n)
+{
+    for (uint32_t i = 16; i-- > 0 && n;)
+    {
+        n       += ctr[i];
+        ctr[i]  = (uint8_t)n;
+        n       >>= 8;
+    }
+}
+
+/**
+ * AES::CryptCTR - Encrypt or decrypt in CTR mode (the two are identical). The IV is
+ * the initial counter block. Messages at or above the parallel threshold are split
+ * into contiguous block ranges run on the shared thread pool, each starting from the
+ * initial counter plus its block offset. On return the IV holds the next unused
+ * counter, so consecutive calls continue the keystream as long as each message is a
+ * whole number of blocks.
+ *
+ * @param in    [in]    Input text.
+ * @param out   [out]   Output text. May be the same buffer as in.
+ * @param len   [in]    Length in bytes.
+ */
+
+void AES::CryptCTR(const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    const uint64_t nBlocks  = (len + 15) / 16;
+    uint64_t nWorkers       = (len >= parallelThreshold) ? numThreads : 1;
+    uint8_t ctr[16];
+
+    IVToBytes(iv, ctr);
+
+    if (engine == AES_REFERENCE || nWorkers > nBlocks)
+        nWorkers = 1;
+
+    if (nWorkers == 1)
+    {
+        CryptCTRBlocks(in, out, len, ctr);
+        BytesToIV(ctr, iv);
+        return;
+    }
+
+    const uint64_t blocksPerWorker = (nBlocks + nWorkers - 1) / nWorkers;
+
+    ThreadPool::Global().ParallelFor(nWorkers, [&](uint64_t i)
+    {
+        const uint64_t startBlock = i * blocksPerWorker;
+
+        if (startBlock >= nBlocks)
+            return;
+
+        const uint64_t startByte    = 16 * startBlock;
+        const uint64_t endByte      = min(len, startByte + 16 * blocksPerWorker);
+        uint8_t workerCtr[16];
+
+        memcpy(workerCtr, ctr, 16);
+        AddCounter(workerCtr, startBlock);
+
+        CryptCTRBlocks(&in[startByte], &out[startByte], endByte - startByte, workerCtr);
+    });
+
+    AddCounter(ctr, nBlocks);
+    BytesToIV(ctr, iv);
+}
+
+/**
+ * AES::CryptCTRBlocks - Serial CTR over one contiguous range. Counter blocks are
+ * encrypted in batches so independent block encryptions overlap in the pipeline;
+ * AES-NI and the bitsliced engine do eight at a time. Only the reference engine
+ * touches the state array, so with the other engines this may run on several
+ * threads at once.
+ *
+ * @param in    [in]        Input text.
+ * @param out   [out]       Output text.
+ * @param len   [in]        Length in bytes.
+ * @param ctr   [in/out]    Counter block for the first block. Holds the next unused
+ *                          counter on return.
+ */
+
+void AES::CryptCTRBlocks(const uint8_t* in, uint8_t* out, const uint64_t len, uint8_t ctr[16])
+{
+    const AESKeySchedule& ks = Keys();
 
-    uint32_t writeOffset = 0;
+    if (engine == AES_AESNI)
+    {
+        AESNICryptCTR(ks.niEnc, nr, ctr, in, out, len);
+        return;
+    }
 
-    while (!stream.End())
+    if (engine == AES_BITSLICED)
     {
-        ClearState();
-        uint32_t cipherTxt[4];
-        stream.Next(cipherTxt);
+        for (uint64_t offset = 0; offset < len; offset += 16 * AESBS_BLOCKS)
+        {
+            const uint64_t n        = min((uint64_t)16 * AESBS_BLOCKS, len - offset);
+            const uint64_t batch    = (n + 15) / 16;
+            uint8_t keyStream[16 * AESBS_BLOCKS];
 
-        state[0] ^= iv[0];
-        state[1] ^= iv[1];
-        state[2] ^= iv[2];
-        state[3] ^= iv[3];
+            for (uint64_t j = 0; j < batch; j++)
+            {
+                memcpy(&keyStream[16 * j], ctr, 16);
+                AddCounter(ctr, 1);
+            }
+
+            AESBSEncryptBlocks(&bsKeys[0], nr, keyStream, keyStream, batch);
+
+            for (uint64_t k = 0; k < n; k++)
+                out[offset + k] = in[offset + k] ^ keyStream[k];
+        }
+
+        return;
+    }
+
+    const uint64_t nBlocks = (len + 15) / 16;
 
-        AddRoundKey(0);
+    for (uint64_t i = 0; i < nBlocks; i += ctrBatchBlocks)
+    {
+        const uint64_t batch = min((uint64_t)ctrBatchBlocks, nBlocks - i);
+        uint32_t blocks[ctrBatchBlocks][4];
 
-        for (uint32_t i = 1; i < nr; i++)
+        for (uint64_t j = 0; j < batch; j++)
         {
-            SubBytes();
-            ShiftRows();
-            MixColumns();
-            AddRoundKey(i);
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                blocks[j][k] = (uint32_t)ctr[4 * k] << 24 | (uint32_t)ctr[4 * k + 1] << 16 |
+                    (uint32_t)ctr[4 * k + 2] << 8 | ctr[4 * k + 3];
+            }
+
+            AddCounter(ctr, 1);
         }
 
-        SubBytes();
-        ShiftRows();
-        AddRoundKey(nr);
-        XORText(cipherTxt, s);
+        for (uint64_t j = 0; j < batch; j++)
+        {
+            if (engine == AES_TTABLE)
+            {
+                EncryptBlockTTable(ks.w, nr, blocks[j]);
+            }
+            else
+            {
+                memcpy(state, blocks[j], 16);
+                Cipher();
+                memcpy(blocks[j], state, 16);
+            }
+        }
 
-        WriteBits(s, plainTxtOut, writeOffset);
-        RotateIVLeft(s);
-        UpdateInputBlock(s, cipherTxt);
+        for (uint64_t j = 0; j < batch; j++)
+        {
+            const uint64_t offset   = 16 * (i + j);
+            const uint64_t n        = min((uint64_t)16, len - offset);
+            uint8_t keyStream[16];
+
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                uint32_t word = REVERSE_ENDIAN32(blocks[j][k]);
+                memcpy(&keyStream[4 * k], &word, 4);
+            }
 
-        writeOffset += s;
+            for (uint64_t k = 0; k < n; k++)
+                out[offset + k] = in[offset + k] ^ keyStream[k];
+        }
     }
 }
 
 /**
- * AES::EncryptOFB - Encrypt input plaintext in OFB mode.
+ * AES::DecryptChained - Decrypt in CBC or CFB128 mode. Each plaintext block depends
+ * only on two ciphertext blocks, so unlike encryption the block ciphers are
+ * independent. Messages at or above the parallel threshold are split into
+ * contiguous block ranges run on the shared thread pool, each chaining from the
+ * ciphertext block just before it. On return the IV holds the last whole ciphertext
+ * block. A trailing partial CFB128 block is XORed with a keystream prefix.
  *
- * @param plainTxt      [in]        Plaintext to be encrypted.
- * @param ciphTxtOut    [in/out]    Output ciphertext.
- * @param key           [in]        AES key for encryption.
+ * @param in    [in]    Ciphertext to be decrypted.
+ * @param out   [out]   Output plaintext. May be the same buffer as in.
+ * @param len   [in]    Length in bytes. Whole blocks for CBC.
  */
 
-void AES::EncryptOFB(const vector<uint8_t>& plainTxtIn,
-    vector<uint8_t>& ciphTxtOut, const vector<uint32_t>& key)
+void AES::DecryptChained(const uint8_t* in, uint8_t* out, const uint64_t len)
 {
-    assert(ciphTxtOut.size() == 0);
+    const uint64_t nBlocks  = len / 16;
+    const uint64_t tail     = len % 16;
+    uint64_t nWorkers       = (len >= parallelThreshold) ? numThreads : 1;
+    uint8_t chain[16];
 
-    ciphTxtOut.resize(plainTxtIn.size());
-    stream.SetData(plainTxtIn);
-    ExpandKey(key);
+    assert(mode == CFB128 || tail == 0);
 
-    uint32_t writeOffset = 0;
-    uint32_t tmp[4];
+    IVToBytes(iv, chain);
 
-    while (!stream.End())
+    if (nWorkers > nBlocks)
+        nWorkers = max((uint64_t)1, nBlocks);
+
+    if (nWorkers == 1)
+    {
+        if (nBlocks > 0)
+            DecryptChainedBlocks(in, out, nBlocks, chain);
+    }
+    else
     {
-        ClearState();
-        uint32_t plainTxt[4];
-        stream.Next(plainTxt);
+        const uint64_t blocksPerWorker = (nBlocks + nWorkers - 1) / nWorkers;
+        vector<uint8_t> prevs(16 * nWorkers);
 
-        state[0] = iv[0];
-        state[1] = iv[1];
-        state[2] = iv[2];
-        state[3] = iv[3];
+        // Ranges may overwrite their input in place, so take each range's chaining
+        // block up front.
 
-        AddRoundKey(0);
+        for (uint64_t i = 0; i < nWorkers && i * blocksPerWorker < nBlocks; i++)
+            memcpy(&prevs[16 * i], (i == 0) ? chain : &in[16 * (i * blocksPerWorker - 1)], 16);
 
-        for (uint32_t i = 1; i < nr; i++)
+        memcpy(chain, &in[16 * (nBlocks - 1)], 16);
+
+        ThreadPool::Global().ParallelFor(nWorkers, [&](uint64_t i)
         {
-            SubBytes();
-            ShiftRows();
-            MixColumns();
-            AddRoundKey(i);
-        }
+            const uint64_t startBlock = i * blocksPerWorker;
 
-        SubBytes();
-        ShiftRows();
-        AddRoundKey(nr);
+            if (startBlock >= nBlocks)
+                return;
 
-        iv[0] = state[0];
-        iv[1] = state[1];
-        iv[2] = state[2];
-        iv[3] = state[3];
+            const uint64_t endBlock = min(nBlocks, startBlock + blocksPerWorker);
+
+            DecryptChainedBlocks(&in[16 * startBlock], &out[16 * startBlock],
+                endBlock - startBlock, &prevs[16 * i]);
+        });
+    }
 
-        state[0] ^= REVERSE_ENDIAN32(plainTxt[0]);
-        state[1] ^= REVERSE_ENDIAN32(plainTxt[1]);
-        state[2] ^= REVERSE_ENDIAN32(plainTxt[2]);
-        state[3] ^= REVERSE_ENDIAN32(plainTxt[3]);
+    BytesToIV(chain, iv);
 
-        tmp[0] = REVERSE_ENDIAN32(state[0]);
-        tmp[1] = REVERSE_ENDIAN32(state[1]);
-        tmp[2] = REVERSE_ENDIAN32(state[2]);
-        tmp[3] = REVERSE_ENDIAN32(state[3]);
+    if (tail)
+    {
+        uint8_t keyStream[16];
+        CipherBlock(chain, keyStream);
 
-        memcpy(&ciphTxtOut[writeOffset], &tmp[0], 16);
-        writeOffset += 16;
+        for (uint64_t i = 0; i < tail; i++)
+            out[16 * nBlocks + i] = in[16 * nBlocks + i] ^ keyStream[i];
     }
 }
 
 /**
- * AES::DecryptOFB - Decrypt input ciphertext in OFB mode.
+ * AES::DecryptChainedBlocks - Serial CBC or CFB128 decryption of one contiguous
+ * range. The T-table and bitsliced engines run the block ciphers in batches of
+ * eight and XOR afterwards, so the batch overlaps in the pipeline; AES-NI keeps
+ * four blocks in flight. Never touches the state array, so several ranges may run at once.
  *
- * @param ciphTxtIn      [in]        Ciphertext to be decrypted.
- * @param plainTxtOut    [in/out]    Output plaintext.
- * @param key            [in]        AES key for decryption.
+ * @param in        [in]        Ciphertext.
+ * @param out       [out]       Plaintext. May be the same buffer as in.
+ * @param nBlocks   [in]        Number of blocks.
+ * @param prev      [in/out]    Ciphertext block before the range (the IV for the
+ *                              first range). Holds the last ciphertext block on return.
  */
 
-void AES::DecryptOFB(const vector<uint8_t>& ciphTxtIn,
-    vector<uint8_t>& plainTxtOut, const vector<uint32_t>& key)
+void AES::DecryptChainedBlocks(const uint8_t* in, uint8_t* out, const uint64_t nBlocks, uint8_t prev[16])
 {
-    assert(plainTxtOut.size() == 0);
+    const AESKeySchedule& ks = Keys();
 
-    plainTxtOut.resize(ciphTxtIn.size());
-    stream.SetData(ciphTxtIn);
-    ExpandKey(key);
+    if (engine == AES_AESNI)
+    {
+        if (mode == CBC)
+            AESNIDecryptCBC(ks.niDec, nr, prev, in, out, nBlocks);
+        else
+            AESNIDecryptCFB128(ks.niEnc, nr, prev, in, out, 16 * nBlocks);
 
-    uint32_t writeOffset = 0;
-    uint32_t tmp[4];
+        return;
+    }
+
+    if (engine == AES_BITSLICED)
+    {
+        for (uint64_t i = 0; i < nBlocks; i += AESBS_BLOCKS)
+        {
+            const uint64_t batch = min((uint64_t)AESBS_BLOCKS, nBlocks - i);
+            uint8_t ciphTxt[AESBS_BLOCKS][16];
+            uint8_t blocks[AESBS_BLOCKS][16];
+
+            memcpy(ciphTxt, &in[16 * i], 16 * batch);
+
+            if (mode == CBC)
+            {
+                AESBSDecryptBlocks(&bsKeys[0], nr, ciphTxt[0], blocks[0], batch);
+            }
+            else
+            {
+                memcpy(blocks[0], prev, 16);
+                memcpy(blocks[1], ciphTxt[0], 16 * (batch - 1));
+                AESBSEncryptBlocks(&bsKeys[0], nr, blocks[0], blocks[0], batch);
+            }
+
+            for (uint64_t j = 0; j < batch; j++)
+            {
+                const uint8_t* mask = (mode == CFB128) ? ciphTxt[j] : ((j == 0) ? prev : ciphTxt[j - 1]);
+
+                for (uint32_t k = 0; k < 16; k++)
+                    out[16 * (i + j) + k] = blocks[j][k] ^ mask[k];
+            }
+
+            memcpy(prev, ciphTxt[batch - 1], 16);
+        }
 
-    while (!stream.End())
+        return;
+    }
+
+    assert(engine == AES_TTABLE);
+
+    for (uint64_t i = 0; i < nBlocks; i += chainBatchBlocks)
     {
-        ClearState();
-        uint32_t ciphTxt[4];
-        stream.Next(ciphTxt);
+        const uint64_t batch = min((uint64_t)chainBatchBlocks, nBlocks - i);
+        uint8_t ciphTxt[chainBatchBlocks][16];
+        uint32_t blocks[chainBatchBlocks][4];
+
+        memcpy(ciphTxt, &in[16 * i], 16 * batch);
 
-        state[0] = iv[0];
-        state[1] = iv[1];
-        state[2] = iv[2];
-        state[3] = iv[3];
+        for (uint64_t j = 0; j < batch; j++)
+        {
+            const uint8_t* src = (mode == CBC) ? ciphTxt[j] : ((j == 0) ? prev : ciphTxt[j - 1]);
 
-        AddRoundKey(0);
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                blocks[j][k] = (uint32_t)src[4 * k] << 24 | (uint32_t)src[4 * k + 1] << 16 |
+                    (uint32_t)src[4 * k + 2] << 8 | src[4 * k + 3];
+            }
+        }
 
-        for (uint32_t i = 1; i < nr; i++)
+        for (uint64_t j = 0; j < batch; j++)
         {
-            SubBytes();
-            ShiftRows();
-            MixColumns();
-            AddRoundKey(i);
+            if (mode == CBC)
+                DecryptBlockTTable(ks.dw, nr, blocks[j]);
+            else
+                EncryptBlockTTable(ks.w, nr, blocks[j]);
         }
 
-        SubBytes();
-        ShiftRows();
-        AddRoundKey(nr);
+        for (uint64_t j = 0; j < batch; j++)
+        {
+            const uint8_t* mask = (mode == CFB128) ? ciphTxt[j] : ((j == 0) ? prev : ciphTxt[j - 1]);
+            uint8_t* dst        = &out[16 * (i + j)];
+
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                uint32_t word = REVERSE_ENDIAN32(blocks[j][k]);
+                memcpy(&dst[4 * k], &word, 4);
+            }
+
+            for (uint32_t k = 0; k < 16; k++)
+                dst[k] ^= mask[k];
+        }
 
-        iv[0] = state[0];
-        iv[1] = state[1];
-        iv[2] = state[2];
-        iv[3] = state[3];
+        memcpy(prev, ciphTxt[batch - 1], 16);
+    }
+}
+
+/**
+ * AESEncryptMultiKey - Encrypt a few blocks under each of many keys, e.g. wrapping
+ * data keys for thousands of recipients. With AES-NI, keys are expanded and used
+ * AESNI_MULTIKEY_LANES at a time with their instructions interleaved; otherwise
+ * each key gets only the encryption round words and T-table rounds, skipping the
+ * decryption and engine-specific schedules an AESKeySchedule builds. The
+ * reference and bitsliced engines go through an AES object per key.
+ *
+ * @param sz            [in]    AES key size of every key.
+ * @param engine        [in]    AES engine to use.
+ * @param keys          [in]    Keys back to back, nk words each, as for ExpandKey.
+ * @param in            [in]    Plaintext, blocksPerKey consecutive blocks per key.
+ * @param out           [out]   Ciphertext. May be the same buffer as in.
+ * @param numKeys       [in]    Number of keys.
+ * @param blocksPerKey  [in]    Number of 16-byte blocks encrypted under each key.
+ */
+
+void AESEncryptMultiKey(const AESSize sz, const AESEngine engine, const uint32_t* keys,
+    const uint8_t* in, uint8_t* out, const uint64_t numKeys, const uint64_t blocksPerKey)
+{
+    const uint32_t nk           = (sz == AES128) ? 4 : (sz == AES192) ? 6 : 8;
+    const uint32_t nr           = nk + 6;
+    const uint64_t keyBytes     = 16 * blocksPerKey;
+
+    if (engine == AES_AESNI && !AESNISupported())
+        throw invalid_argument("AES-NI is not supported on this CPU.");
+
+    if (engine == AES_AESNI)
+    {
+        uint32_t keyWords[8 * multiKeyChunk];
+
+        for (uint64_t i = 0; i < numKeys; i += multiKeyChunk)
+        {
+            const uint64_t n = min((uint64_t)multiKeyChunk, numKeys - i);
+
+            for (uint64_t j = 0; j < nk * n; j++)
+                keyWords[j] = REVERSE_ENDIAN32(keys[nk * i + j]);
+
+            AESNIEncryptMultiKey((const uint8_t*)keyWords, nk, &in[keyBytes * i], &out[keyBytes * i],
+                n, blocksPerKey);
+        }
 
-        state[0] ^= REVERSE_ENDIAN32(ciphTxt[0]);
-        state[1] ^= REVERSE_ENDIAN32(ciphTxt[1]);
-        state[2] ^= REVERSE_ENDIAN32(ciphTxt[2]);
-        state[3] ^= REVERSE_ENDIAN32(ciphTxt[3]);
+        return;
+    }
+
+    if (engine == AES_TTABLE)
+    {
+        uint32_t w[60];
+
+        for (uint64_t i = 0; i < numKeys; i++)
+        {
+            ExpandWords(&keys[nk * i], nk, w);
+
+            for (uint64_t offset = keyBytes * i; offset < keyBytes * (i + 1); offset += 16)
+            {
+                uint32_t st[4];
+
+                for (uint32_t j = 0; j < 4; j++)
+                {
+                    st[j] = (uint32_t)in[offset + 4 * j] << 24 | (uint32_t)in[offset + 4 * j + 1] << 16 |
+                        (uint32_t)in[offset + 4 * j + 2] << 8 | in[offset + 4 * j + 3];
+                }
 
-        tmp[0] = REVERSE_ENDIAN32(state[0]);
-        tmp[1] = REVERSE_ENDIAN32(state[1]);
-        tmp[2] = REVERSE_ENDIAN32(state[2]);
-        tmp[3] = REVERSE_ENDIAN32(state[3]);
+                EncryptBlockTTable(w, nr, st);
 
-        memcpy(&plainTxtOut[writeOffset], &tmp[0], 16);
-        writeOffset += 16;
+                for (uint32_t j = 0; j < 4; j++)
+                {
+                    uint32_t word = REVERSE_ENDIAN32(st[j]);
+                    memcpy(&out[offset + 4 * j], &word, 4);
+                }
+            }
+        }
+
+        return;
+    }
+
+    AES aes(sz, ECB);
+    AESKeySchedule sched;
+
+    aes.SetEngine(engine);
+
+    for (uint64_t i = 0; i < numKeys; i++)
+    {
+        sched.Expand(vector<uint32_t>(&keys[nk * i], &keys[nk * (i + 1)]), engine == AES_BITSLICED);
+        aes.SetKey(sched);
+        aes.Encrypt(&in[keyBytes * i], &out[keyBytes * i], keyBytes);
     }
 }
\ No newline at end of file
@@ -0,0 +1,667 @@
+#include "aesbitslice.h"
+
+typedef uint32_t BSWord __attribute__((vector_size(16)));
+typedef uint8_t BSBytes __attribute__((vector_size(16)));
+
+/**
+ * Bitsliced AES over eight blocks at a time. The 128 bytes of a batch are stored as
+ * eight bit planes: plane b holds bit b of every byte. Within a plane, state byte k
+ * of block j sits at bit 8 * k + j, so each byte of a plane covers one state
+ * position across all eight blocks, and each 32-bit lane of a plane is one state
+ * column. The plane is a GCC vector type, so on x86-64 every step works on the
+ * whole plane in one SSE2 instruction. SubBytes becomes a fixed Boolean circuit
+ * over the planes, and ShiftRows and MixColumns become byte moves within the
+ * planes, so no step indexes memory with secret data. The byte moves are single
+ * SSSE3 byte shuffles where the CPU has them, and lane shuffles and rotates
+ * otherwise.
+ */
+
+/**
+ * SwapMove - Exchange the bits of b selected by mask with the bits of a selected
+ * by mask << n.
+ *
+ * @param a     [in/out]    First word.
+ * @param b     [in/out]    Second word.
+ * @param mask  [in]        Bits of b to exchange.
+ * @param n     [in]        Distance between the exchanged bits.
+ */
+
+static inline void SwapMove(BSWord& a, BSWord& b, const uint32_t mask, const uint32_t n)
+{
+    BSWord t = ((a >> n) ^ b) & mask;
+
+    b ^= t;
+    a ^= t << n;
+}
+
+/**
+ * Transpose - Transpose the 8x8 bit matrix formed by byte k of eight words, for
+ * all 16 byte positions at once, so bit c of byte k of word r moves to bit r of
+ * byte k of word c. The transpose is its own inverse.
+ *
+ * @param q     [in/out]    Words to transpose.
+ */
+
+static inline void Transpose(BSWord q[8])
+{
+    SwapMove(q[0], q[1], 0x55555555, 1);
+    SwapMove(q[2], q[3], 0x55555555, 1);
+    SwapMove(q[4], q[5], 0x55555555, 1);
+    SwapMove(q[6], q[7], 0x55555555, 1);
+
+    SwapMove(q[0], q[2], 0x33333333, 2);
+    SwapMove(q[1], q[3], 0x33333333, 2);
+    SwapMove(q[4], q[6], 0x33333333, 2);
+    SwapMove(q[5], q[7], 0x33333333, 2);
+
+    SwapMove(q[0], q[4], 0x0F0F0F0F, 4);
+    SwapMove(q[1], q[5], 0x0F0F0F0F, 4);
+    SwapMove(q[2], q[6], 0x0F0F0F0F, 4);
+    SwapMove(q[3], q[7], 0x0F0F0F0F, 4);
+}
+
+/**
+ * Pack - Convert up to eight 16-byte blocks to bit planes. Missing blocks are zero.
+ *
+ * @param in        [in]    Input blocks.
+ * @param nBlocks   [in]    Number of blocks, at most eight.
+ * @param q         [out]   Bit planes.
+ */
+
+static void Pack(const uint8_t* in, const uint64_t nBlocks, BSWord q[8])
+{
+    memset(q, 0, 8 * sizeof(BSWord));
+    memcpy(q, in, 16 * nBlocks);
+
+    Transpose(q);
+}
+
+/**
+ * Unpack - Convert bit planes back to blocks.
+ *
+ * @param q         [in/out]    Bit planes. Used as scratch.
+ * @param out       [out]       Output blocks.
+ * @param nBlocks   [in]        Number of blocks to write, at most eight.
+ */
+
+static void Unpack(BSWord q[8], uint8_t* out, const uint64_t nBlocks)
+{
+    Transpose(q);
+
+    memcpy(out, q, 16 * nBlocks);
+}
+
+/**
+ * Sbox - Apply the AES S-box to every byte of the state, using the
+ * Boyar-Peralta circuit (inversion in GF(2^8) through a tower field, with the
+ * affine map folded into the linear layers).
+ *
+ * @param q     [in/out]    Bit planes, q[0] the LSB.
+ */
+
+static void Sbox(BSWord q[8])
+{
+    BSWord x0, x1, x2, x3, x4, x5, x6, x7;
+    BSWord y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15;
+    BSWord y16, y17, y18, y19, y20, y21;
+    BSWord z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+    BSWord t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15;
+    BSWord t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    BSWord t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41, t42, t43;
+    BSWord t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57;
+    BSWord t58, t59, t60, t61, t62, t63, t64, t65, t66, t67;
+    BSWord s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    // Top linear layer.
+
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9  = x0 ^ x3;
+    y8  = x0 ^ x5;
+    t0  = x1 ^ x2;
+    y1  = t0 ^ x7;
+    y4  = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2  = y1 ^ x0;
+    y5  = y1 ^ x6;
+    y3  = y5 ^ y8;
+    t1  = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6  = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7  = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    // Non-linear layer.
+
+    t2  = y12 & y15;
+    t3  = y3 & y6;
+    t4  = t3 ^ t2;
+    t5  = y4 & x7;
+    t6  = t5 ^ t2;
+    t7  = y13 & y16;
+    t8  = y5 & y1;
+    t9  = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0  = t44 & y15;
+    z1  = t37 & y6;
+    z2  = t33 & x7;
+    z3  = t43 & y16;
+    z4  = t40 & y1;
+    z5  = t29 & y7;
+    z6  = t42 & y11;
+    z7  = t45 & y17;
+    z8  = t41 & y10;
+    z9  = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    // Bottom linear layer.
+
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0  = t59 ^ t63;
+    s6  = t56 ^ ~t62;
+    s7  = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3  = t53 ^ t66;
+    s4  = t51 ^ t66;
+    s5  = t47 ^ t65;
+    s1  = t64 ^ ~s3;
+    s2  = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/**
+ * InvAffine - Inverse of the S-box affine map, including its 0x63 constant.
+ *
+ * @param q     [in/out]    Bit planes, q[0] the LSB.
+ */
+
+static void InvAffine(BSWord q[8])
+{
+    const BSWord y0 = q[0];
+    const BSWord y1 = q[1];
+    const BSWord y2 = q[2];
+    const BSWord y3 = q[3];
+    const BSWord y4 = q[4];
+    const BSWord y5 = q[5];
+    const BSWord y6 = q[6];
+    const BSWord y7 = q[7];
+
+    q[0] = ~(y2 ^ y5 ^ y7);
+    q[1] = y3 ^ y6 ^ y0;
+    q[2] = ~(y4 ^ y7 ^ y1);
+    q[3] = y5 ^ y0 ^ y2;
+    q[4] = y6 ^ y1 ^ y3;
+    q[5] = y7 ^ y2 ^ y4;
+    q[6] = y0 ^ y3 ^ y5;
+    q[7] = y1 ^ y4 ^ y6;
+}
+
+/**
+ * InvSbox - Apply the inverse S-box to every byte of the state. With S(x) =
+ * A(x^-1) + c and G the inverse affine map, x^-1 = G(S(x)), so the inverse S-box is
+ * G(S(G(y))) and reuses the forward circuit.
+ *
+ * @param q     [in/out]    Bit planes, q[0] the LSB.
+ */
+
+static void InvSbox(BSWord q[8])
+{
+    InvAffine(q);
+    Sbox(q);
+    InvAffine(q);
+}
+
+/**
+ * ShiftRows - Cyclically shift state row r left by r columns (right for the
+ * inverse) in every bit plane. Row r is byte r of each column lane, so with SSSE3
+ * this is one byte shuffle per plane. Otherwise each row is a masked copy of the
+ * plane with its lanes rotated by r columns.
+ *
+ * @param q         [in/out]    Bit planes.
+ * @param bInverse  [in]        True for InvShiftRows.
+ */
+
+template <bool bSSSE3>
+static inline __attribute__((always_inline)) void ShiftRows(BSWord q[8], const bool bInverse)
+{
+    if constexpr (bSSSE3)
+    {
+        const BSBytes fwd = { 0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11 };
+        const BSBytes inv = { 0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3 };
+
+        for (uint32_t b = 0; b < 8; b++)
+            q[b] = (BSWord)__builtin_shuffle((BSBytes)q[b], bInverse ? inv : fwd);
+    }
+    else
+    {
+        for (uint32_t b = 0; b < 8; b++)
+        {
+            const BSWord x  = q[b];
+            const BSWord x1 = __builtin_shuffle(x, BSWord{ 1, 2, 3, 0 });
+            const BSWord x2 = __builtin_shuffle(x, BSWord{ 2, 3, 0, 1 });
+            const BSWord x3 = __builtin_shuffle(x, BSWord{ 3, 0, 1, 2 });
+
+            if (bInverse)
+                q[b] = (x & 0x000000FF) | (x3 & 0x0000FF00) | (x2 & 0x00FF0000) | (x1 & 0xFF000000);
+            else
+                q[b] = (x & 0x000000FF) | (x1 & 0x0000FF00) | (x2 & 0x00FF0000) | (x3 & 0xFF000000);
+        }
+    }
+}
+
+/**
+ * RotRows8 - Within each column, move row r + 1 into row r.
+ */
+
+template <bool bSSSE3>
+static inline __attribute__((always_inline)) BSWord RotRows8(const BSWord x)
+{
+    if constexpr (bSSSE3)
+        return (BSWord)__builtin_shuffle((BSBytes)x,
+            BSBytes{ 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12 });
+    else
+        return (x >> 8) | (x << 24);
+}
+
+/**
+ * RotRows16 - Within each column, move row r + 2 into row r.
+ */
+
+template <bool bSSSE3>
+static inline __attribute__((always_inline)) BSWord RotRows16(const BSWord x)
+{
+    if constexpr (bSSSE3)
+        return (BSWord)__builtin_shuffle((BSBytes)x,
+            BSBytes{ 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 });
+    else
+        return (x >> 16) | (x << 16);
+}
+
+/**
+ * MixColumns - Multiply each column by {03}x^3 + {01}x^2 + {01}x + {02}, computed per
+ * row as 2 * (a[r] + a[r + 1]) + a[r + 1] + a[r + 2] + a[r + 3]. Doubling a byte
+ * shifts it up one plane and folds the carry out of plane 7 into planes 0, 1, 3
+ * and 4 (x^8 = x^4 + x^3 + x + 1).
+ *
+ * @param q     [in/out]    Bit planes.
+ */
+
+template <bool bSSSE3>
+static inline __attribute__((always_inline)) void MixColumns(BSWord q[8])
+{
+    const BSWord r0 = RotRows8<bSSSE3>(q[0]);
+    const BSWord r1 = RotRows8<bSSSE3>(q[1]);
+    const BSWord r2 = RotRows8<bSSSE3>(q[2]);
+    const BSWord r3 = RotRows8<bSSSE3>(q[3]);
+    const BSWord r4 = RotRows8<bSSSE3>(q[4]);
+    const BSWord r5 = RotRows8<bSSSE3>(q[5]);
+    const BSWord r6 = RotRows8<bSSSE3>(q[6]);
+    const BSWord r7 = RotRows8<bSSSE3>(q[7]);
+
+    const BSWord t0 = q[0] ^ r0;
+    const BSWord t1 = q[1] ^ r1;
+    const BSWord t2 = q[2] ^ r2;
+    const BSWord t3 = q[3] ^ r3;
+    const BSWord t4 = q[4] ^ r4;
+    const BSWord t5 = q[5] ^ r5;
+    const BSWord t6 = q[6] ^ r6;
+    const BSWord t7 = q[7] ^ r7;
+
+    q[0] = t7 ^ r0 ^ RotRows16<bSSSE3>(t0);
+    q[1] = t0 ^ t7 ^ r1 ^ RotRows16<bSSSE3>(t1);
+    q[2] = t1 ^ r2 ^ RotRows16<bSSSE3>(t2);
+    q[3] = t2 ^ t7 ^ r3 ^ RotRows16<bSSSE3>(t3);
+    q[4] = t3 ^ t7 ^ r4 ^ RotRows16<bSSSE3>(t4);
+    q[5] = t4 ^ r5 ^ RotRows16<bSSSE3>(t5);
+    q[6] = t5 ^ r6 ^ RotRows16<bSSSE3>(t6);
+    q[7] = t6 ^ r7 ^ RotRows16<bSSSE3>(t7);
+}
+
+/**
+ * InvMixColumns - Inverse MixColumns, factored as MixColumns after adding
+ * 4 * (a[r] + a[r + 2]) to each row.
+ *
+ * @param q     [in/out]    Bit planes.
+ */
+
+template <bool bSSSE3>
+static inline __attribute__((always_inline)) void InvMixColumns(BSWord q[8])
+{
+    const BSWord u0 = q[0] ^ RotRows16<bSSSE3>(q[0]);
+    const BSWord u1 = q[1] ^ RotRows16<bSSSE3>(q[1]);
+    const BSWord u2 = q[2] ^ RotRows16<bSSSE3>(q[2]);
+    const BSWord u3 = q[3] ^ RotRows16<bSSSE3>(q[3]);
+    const BSWord u4 = q[4] ^ RotRows16<bSSSE3>(q[4]);
+    const BSWord u5 = q[5] ^ RotRows16<bSSSE3>(q[5]);
+    const BSWord u6 = q[6] ^ RotRows16<bSSSE3>(q[6]);
+    const BSWord u7 = q[7] ^ RotRows16<bSSSE3>(q[7]);
+
+    q[0] ^= u6;
+    q[1] ^= u6 ^ u7;
+    q[2] ^= u0 ^ u7;
+    q[3] ^= u1 ^ u6;
+    q[4] ^= u2 ^ u6 ^ u7;
+    q[5] ^= u3 ^ u7;
+    q[6] ^= u4;
+    q[7] ^= u5;
+
+    MixColumns<bSSSE3>(q);
+}
+
+/**
+ * AddRoundKey - XOR a bitsliced round key into the state.
+ *
+ * @param q     [in/out]    Bit planes.
+ * @param rk    [in]        Bitsliced round key, 16 words.
+ */
+
+static inline void AddRoundKey(BSWord q[8], const uint64_t* rk)
+{
+    BSWord k[8];
+    memcpy(k, rk, sizeof(k));
+
+    for (uint32_t b = 0; b < 8; b++)
+        q[b] ^= k[b];
+}
+
+/**
+ * AESBSSubWord - Apply the S-box to the four bytes of a word with the bitsliced
+ * circuit, so key expansion for the bitsliced engine does no table lookups on key
+ * material either.
+ *
+ * @param word  [in]    Word to substitute.
+ *
+ * @return Word with every byte replaced by its S-box value.
+ */
+
+uint32_t AESBSSubWord(const uint32_t word)
+{
+    uint8_t block[16] = { 0 };
+    BSWord q[8];
+    uint32_t res;
+
+    memcpy(block, &word, 4);
+
+    Pack(block, 1, q);
+    Sbox(q);
+    Unpack(q, block, 1);
+
+    memcpy(&res, block, 4);
+
+    return res;
+}
+
+/**
+ * AESBSExpandKey - Convert an expanded key schedule to bitsliced round keys. Each
+ * key bit is broadcast to all eight block lanes of its byte.
+ *
+ * @param w         [in]    Round key words, big-endian, 4 * (nr + 1) of them.
+ * @param nr        [in]    Number of rounds.
+ * @param bsKeys    [out]   Bitsliced round keys, 16 words per round.
+ */
+
+void AESBSExpandKey(const uint32_t* w, const uint32_t nr, uint64_t bsKeys[AESBS_KEY_WORDS])
+{
+    assert(nr + 1 <= AESBS_MAX_ROUND_KEYS);
+
+    for (uint32_t r = 0; r <= nr; r++)
+    {
+        uint64_t* rk = &bsKeys[16 * r];
+
+        memset(rk, 0, 16 * sizeof(uint64_t));
+
+        for (uint32_t k = 0; k < 16; k++)
+        {
+            const uint8_t keyByte = (uint8_t)(w[4 * r + k / 4] >> (24 - 8 * (k % 4)));
+
+            for (uint32_t b = 0; b < 8; b++)
+            {
+                const uint64_t lane = (uint64_t)0 - ((keyByte >> b) & 1);
+                rk[2 * b + k / 8] |= (lane & 0xFF) << (8 * (k % 8));
+            }
+        }
+    }
+}
+
+/**
+ * EncryptBlocks - Bitsliced encryption of whole batches of up to eight blocks.
+ *
+ * @param bsKeys    [in]    Bitsliced round keys from AESBSExpandKey.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Input blocks.
+ * @param out       [out]   Output blocks.
+ * @param nBlocks   [in]    Number of blocks.
+ */
+
+template <bool bSSSE3>
+static inline __attribute__((always_inline)) void EncryptBlocks(const uint64_t* bsKeys,
+    const uint32_t nr, const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    for (uint64_t i = 0; i < nBlocks; i += AESBS_BLOCKS)
+    {
+        const uint64_t batch = min((uint64_t)AESBS_BLOCKS, nBlocks - i);
+        BSWord q[8];
+
+        Pack(&in[16 * i], batch, q);
+        AddRoundKey(q, &bsKeys[0]);
+
+        for (uint32_t r = 1; r < nr; r++)
+        {
+            Sbox(q);
+            ShiftRows<bSSSE3>(q, false);
+            MixColumns<bSSSE3>(q);
+            AddRoundKey(q, &bsKeys[16 * r]);
+        }
+
+        Sbox(q);
+        ShiftRows<bSSSE3>(q, false);
+        AddRoundKey(q, &bsKeys[16 * nr]);
+
+        Unpack(q, &out[16 * i], batch);
+    }
+}
+
+/**
+ * DecryptBlocks - Bitsliced decryption of whole batches of up to eight blocks.
+ *
+ * @param bsKeys    [in]    Bitsliced round keys from AESBSExpandKey.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Input blocks.
+ * @param out       [out]   Output blocks.
+ * @param nBlocks   [in]    Number of blocks.
+ */
+
+template <bool bSSSE3>
+static inline __attribute__((always_inline)) void DecryptBlocks(const uint64_t* bsKeys,
+    const uint32_t nr, const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    for (uint64_t i = 0; i < nBlocks; i += AESBS_BLOCKS)
+    {
+        const uint64_t batch = min((uint64_t)AESBS_BLOCKS, nBlocks - i);
+        BSWord q[8];
+
+        Pack(&in[16 * i], batch, q);
+        AddRoundKey(q, &bsKeys[16 * nr]);
+
+        for (uint32_t r = nr - 1; r > 0; r--)
+        {
+            ShiftRows<bSSSE3>(q, true);
+            InvSbox(q);
+            AddRoundKey(q, &bsKeys[16 * r]);
+            InvMixColumns<bSSSE3>(q);
+        }
+
+        ShiftRows<bSSSE3>(q, true);
+        InvSbox(q);
+        AddRoundKey(q, &bsKeys[0]);
+
+        Unpack(q, &out[16 * i], batch);
+    }
+}
+
+#ifdef NISTCRYPTO_X86
+
+/**
+ * EncryptBlocksSSSE3 - EncryptBlocks with SSSE3 byte shuffles.
+ */
+
+__attribute__((target("ssse3"))) static void EncryptBlocksSSSE3(const uint64_t* bsKeys,
+    const uint32_t nr, const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    EncryptBlocks<true>(bsKeys, nr, in, out, nBlocks);
+}
+
+/**
+ * DecryptBlocksSSSE3 - DecryptBlocks with SSSE3 byte shuffles.
+ */
+
+__attribute__((target("ssse3"))) static void DecryptBlocksSSSE3(const uint64_t* bsKeys,
+    const uint32_t nr, const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    DecryptBlocks<true>(bsKeys, nr, in, out, nBlocks);
+}
+
+#endif
+
+/**
+ * AESBSEncryptBlocks - Encrypt blocks eight at a time with bitsliced AES. Input of
+ * each batch is read before its output is written, so in and out may be the same.
+ *
+ * @param bsKeys    [in]    Bitsliced round keys from AESBSExpandKey.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Input blocks.
+ * @param out       [out]   Output blocks.
+ * @param nBlocks   [in]    Number of blocks.
+ */
+
+void AESBSEncryptBlocks(const uint64_t* bsKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+#ifdef NISTCRYPTO_X86
+
+    if (CPUHasFeature(CPU_SSSE3))
+    {
+        EncryptBlocksSSSE3(bsKeys, nr, in, out, nBlocks);
+        return;
+    }
+
+#endif
+
+    EncryptBlocks<false>(bsKeys, nr, in, out, nBlocks);
+}
+
+/**
+ * AESBSDecryptBlocks - Decrypt blocks eight at a time with bitsliced AES, running
+ * the inverse cipher with the encryption round keys in reverse. In and out may be
+ * the same.
+ *
+ * @param bsKeys    [in]    Bitsliced round keys from AESBSExpandKey.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Input blocks.
+ * @param out       [out]   Output blocks.
+ * @param nBlocks   [in]    Number of blocks.
+ */
+
+void AESBSDecryptBlocks(const uint64_t* bsKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+#ifdef NISTCRYPTO_X86
+
+    if (CPUHasFeature(CPU_SSSE3))
+    {
+        DecryptBlocksSSSE3(bsKeys, nr, in, out, nBlocks);
+        return;
+    }
+
+#endif
+
+    DecryptBlocks<false>(bsKeys, nr, in, out, nBlocks);
+}
\ No newline at end of file
@@ -0,0 +1,1397 @@
+#include "aesni.h"
+
+#ifdef NISTCRYPTO_X86
+
+#include <immintrin.h>
+
+#define AESNI_TARGET __attribute__((target("aes,sse4.1")))
+
+static const uint32_t rconLE[11] =
+{
+    0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
+};
+
+/**
+ * AESNISupported - Check if the CPU has the AES-NI instructions this backend needs.
+ *
+ * @return True if AESENC/AESDEC/AESKEYGENASSIST and SSE4.1 are available.
+ */
+
+bool AESNISupported()
+{
+    return CPUHasFeature(CPU_AESNI);
+}
+
+/**
+ * ExpandEncKeys - Expand a key into AES-NI encryption round keys. AESKEYGENASSIST
+ * supplies SubWord and RotWord(SubWord) for each schedule word; the round constant
+ * is XORed in afterwards so one routine covers 128, 192 and 256-bit keys.
+ *
+ * @param key       [in]        Key bytes in FIPS 197 byte order.
+ * @param nk        [in]        Key length in 32-bit words (4, 6 or 8).
+ * @param encKeys   [in/out]    Encryption round keys, 16 bytes per round.
+ */
+
+AESNI_TARGET static void ExpandEncKeys(const uint8_t* key, const uint32_t nk,
+    uint8_t encKeys[16 * AESNI_MAX_ROUND_KEYS])
+{
+    const uint32_t nr       = nk + 6;
+    const uint32_t nWords   = 4 * (nr + 1);
+    uint32_t wk[4 * AESNI_MAX_ROUND_KEYS];
+
+    memcpy(wk, key, 4 * nk);
+
+    for (uint32_t i = nk; i < nWords; i++)
+    {
+        uint32_t tmp = wk[i - 1];
+
+        if ((i % nk) == 0)
+        {
+            __m128i assist = _mm_aeskeygenassist_si128(_mm_set1_epi32((int)tmp), 0);
+            tmp = (uint32_t)_mm_extract_epi32(assist, 1) ^ rconLE[i / nk];
+        }
+        else if ((nk == 8) && (i % nk == 4))
+        {
+            __m128i assist = _mm_aeskeygenassist_si128(_mm_set1_epi32((int)tmp), 0);
+            tmp = (uint32_t)_mm_extract_epi32(assist, 0);
+        }
+
+        wk[i] = wk[i - nk] ^ tmp;
+    }
+
+    memcpy(encKeys, wk, 4 * nWords);
+}
+
+/**
+ * AESNIExpandKey - Expand a key into AES-NI round keys. Decryption keys are the
+ * encryption keys in reverse order with AESIMC applied to the middle rounds
+ * (equivalent inverse cipher).
+ *
+ * @param key       [in]        Key bytes in FIPS 197 byte order.
+ * @param nk        [in]        Key length in 32-bit words (4, 6 or 8).
+ * @param encKeys   [in/out]    Encryption round keys, 16 bytes per round.
+ * @param decKeys   [in/out]    Decryption round keys, 16 bytes per round.
+ */
+
+AESNI_TARGET void AESNIExpandKey(const uint8_t* key, const uint32_t nk,
+    uint8_t encKeys[16 * AESNI_MAX_ROUND_KEYS], uint8_t decKeys[16 * AESNI_MAX_ROUND_KEYS])
+{
+    assert(nk == 4 || nk == 6 || nk == 8);
+
+    const uint32_t nr = nk + 6;
+
+    ExpandEncKeys(key, nk, encKeys);
+
+    memcpy(&decKeys[0], &encKeys[16 * nr], 16);
+    memcpy(&decKeys[16 * nr], &encKeys[0], 16);
+
+    for (uint32_t r = 1; r < nr; r++)
+    {
+        __m128i k = _mm_loadu_si128((const __m128i*)&encKeys[16 * (nr - r)]);
+        _mm_storeu_si128((__m128i*)&decKeys[16 * r], _mm_aesimc_si128(k));
+    }
+}
+
+/**
+ * EncryptBlock - Run the full AES-NI round sequence on one block held in a register.
+ *
+ * @param k     [in] Encryption round keys.
+ * @param nr    [in] Number of rounds.
+ * @param b     [in] Block to encrypt.
+ *
+ * @return Encrypted block.
+ */
+
+AESNI_TARGET static inline __m128i EncryptBlock(const __m128i* k, const uint32_t nr, __m128i b)
+{
+    b = _mm_xor_si128(b, _mm_loadu_si128(&k[0]));
+
+    for (uint32_t r = 1; r < nr; r++)
+        b = _mm_aesenc_si128(b, _mm_loadu_si128(&k[r]));
+
+    return _mm_aesenclast_si128(b, _mm_loadu_si128(&k[nr]));
+}
+
+/**
+ * DecryptBlock - Run the full AES-NI inverse round sequence on one block.
+ *
+ * @param k     [in] Decryption round keys from AESNIExpandKey.
+ * @param nr    [in] Number of rounds.
+ * @param b     [in] Block to decrypt.
+ *
+ * @return Decrypted block.
+ */
+
+AESNI_TARGET static inline __m128i DecryptBlock(const __m128i* k, const uint32_t nr, __m128i b)
+{
+    b = _mm_xor_si128(b, _mm_loadu_si128(&k[0]));
+
+    for (uint32_t r = 1; r < nr; r++)
+        b = _mm_aesdec_si128(b, _mm_loadu_si128(&k[r]));
+
+    return _mm_aesdeclast_si128(b, _mm_loadu_si128(&k[nr]));
+}
+
+/**
+ * EncryptBlocks4 - Encrypt four independent blocks with their rounds interleaved
+ * so the AESENC pipeline stays full.
+ *
+ * @param k     [in]        Encryption round keys.
+ * @param nr    [in]        Number of rounds.
+ * @param b     [in/out]    Blocks to encrypt.
+ */
+
+AESNI_TARGET static inline void EncryptBlocks4(const __m128i* k, const uint32_t nr, __m128i b[4])
+{
+    __m128i rk = _mm_loadu_si128(&k[0]);
+
+    b[0] = _mm_xor_si128(b[0], rk);
+    b[1] = _mm_xor_si128(b[1], rk);
+    b[2] = _mm_xor_si128(b[2], rk);
+    b[3] = _mm_xor_si128(b[3], rk);
+
+    for (uint32_t r = 1; r < nr; r++)
+    {
+        rk = _mm_loadu_si128(&k[r]);
+
+        b[0] = _mm_aesenc_si128(b[0], rk);
+        b[1] = _mm_aesenc_si128(b[1], rk);
+        b[2] = _mm_aesenc_si128(b[2], rk);
+        b[3] = _mm_aesenc_si128(b[3], rk);
+    }
+
+    rk = _mm_loadu_si128(&k[nr]);
+
+    b[0] = _mm_aesenclast_si128(b[0], rk);
+    b[1] = _mm_aesenclast_si128(b[1], rk);
+    b[2] = _mm_aesenclast_si128(b[2], rk);
+    b[3] = _mm_aesenclast_si128(b[3], rk);
+}
+
+/**
+ * DecryptBlocks4 - Decrypt four independent blocks with their rounds interleaved.
+ *
+ * @param k     [in]        Decryption round keys.
+ * @param nr    [in]        Number of rounds.
+ * @param b     [in/out]    Blocks to decrypt.
+ */
+
+AESNI_TARGET static inline void DecryptBlocks4(const __m128i* k, const uint32_t nr, __m128i b[4])
+{
+    __m128i rk = _mm_loadu_si128(&k[0]);
+
+    b[0] = _mm_xor_si128(b[0], rk);
+    b[1] = _mm_xor_si128(b[1], rk);
+    b[2] = _mm_xor_si128(b[2], rk);
+    b[3] = _mm_xor_si128(b[3], rk);
+
+    for (uint32_t r = 1; r < nr; r++)
+    {
+        rk = _mm_loadu_si128(&k[r]);
+
+        b[0] = _mm_aesdec_si128(b[0], rk);
+        b[1] = _mm_aesdec_si128(b[1], rk);
+        b[2] = _mm_aesdec_si128(b[2], rk);
+        b[3] = _mm_aesdec_si128(b[3], rk);
+    }
+
+    rk = _mm_loadu_si128(&k[nr]);
+
+    b[0] = _mm_aesdeclast_si128(b[0], rk);
+    b[1] = _mm_aesdeclast_si128(b[1], rk);
+    b[2] = _mm_aesdeclast_si128(b[2], rk);
+    b[3] = _mm_aesdeclast_si128(b[3], rk);
+}
+
+/**
+ * AESNIEncryptBlock - Encrypt a single block.
+ *
+ * @param encKeys   [in]    Encryption round keys.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Plaintext block.
+ * @param out       [out]   Ciphertext block. May alias in.
+ */
+
+AESNI_TARGET void AESNIEncryptBlock(const uint8_t* encKeys, const uint32_t nr, const uint8_t in[16], uint8_t out[16])
+{
+    const __m128i* k = (const __m128i*)encKeys;
+    _mm_storeu_si128((__m128i*)out, EncryptBlock(k, nr, _mm_loadu_si128((const __m128i*)in)));
+}
+
+/**
+ * AESNIDecryptBlock - Decrypt a single block.
+ *
+ * @param decKeys   [in]    Decryption round keys.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Ciphertext block.
+ * @param out       [out]   Plaintext block. May alias in.
+ */
+
+AESNI_TARGET void AESNIDecryptBlock(const uint8_t* decKeys, const uint32_t nr, const uint8_t in[16], uint8_t out[16])
+{
+    const __m128i* k = (const __m128i*)decKeys;
+    _mm_storeu_si128((__m128i*)out, DecryptBlock(k, nr, _mm_loadu_si128((const __m128i*)in)));
+}
+
+/**
+ * AESNIEncryptECB - Encrypt whole blocks in ECB mode, four at a time.
+ *
+ * @param encKeys   [in]    Encryption round keys.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Plaintext.
+ * @param out       [out]   Ciphertext. May alias in.
+ * @param nBlocks   [in]    Number of 16-byte blocks.
+ */
+
+AESNI_TARGET void AESNIEncryptECB(const uint8_t* encKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    const __m128i* k = (const __m128i*)encKeys;
+    uint64_t i = 0;
+
+    for (; i + 4 <= nBlocks; i += 4)
+    {
+        __m128i b[4];
+
+        for (uint32_t j = 0; j < 4; j++)
+            b[j] = _mm_loadu_si128((const __m128i*)&in[16 * (i + j)]);
+
+        EncryptBlocks4(k, nr, b);
+
+        for (uint32_t j = 0; j < 4; j++)
+            _mm_storeu_si128((__m128i*)&out[16 * (i + j)], b[j]);
+    }
+
+    for (; i < nBlocks; i++)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        _mm_storeu_si128((__m128i*)&out[16 * i], EncryptBlock(k, nr, b));
+    }
+}
+
+/**
+ * AESNIDecryptECB - Decrypt whole blocks in ECB mode, four at a time.
+ *
+ * @param decKeys   [in]    Decryption round keys.
+ * @param nr        [in]    Number of rounds.
+ * @param in        [in]    Ciphertext.
+ * @param out       [out]   Plaintext. May alias in.
+ * @param nBlocks   [in]    Number of 16-byte blocks.
+ */
+
+AESNI_TARGET void AESNIDecryptECB(const uint8_t* decKeys, const uint32_t nr,
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    const __m128i* k = (const __m128i*)decKeys;
+    uint64_t i = 0;
+
+    for (; i + 4 <= nBlocks; i += 4)
+    {
+        __m128i b[4];
+
+        for (uint32_t j = 0; j < 4; j++)
+            b[j] = _mm_loadu_si128((const __m128i*)&in[16 * (i + j)]);
+
+        DecryptBlocks4(k, nr, b);
+
+        for (uint32_t j = 0; j < 4; j++)
+            _mm_storeu_si128((__m128i*)&out[16 * (i + j)], b[j]);
+    }
+
+    for (; i < nBlocks; i++)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        _mm_storeu_si128((__m128i*)&out[16 * i], DecryptBlock(k, nr, b));
+    }
+}
+
+/**
+ * AESNIEncryptCBC - Encrypt whole blocks in CBC mode. Encryption is serial since
+ * each block is chained to the previous ciphertext.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Chaining value. Holds the last ciphertext block on return.
+ * @param in        [in]        Plaintext.
+ * @param out       [out]       Ciphertext. May alias in.
+ * @param nBlocks   [in]        Number of 16-byte blocks.
+ */
+
+AESNI_TARGET void AESNIEncryptCBC(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    const __m128i* k    = (const __m128i*)encKeys;
+    __m128i chain       = _mm_loadu_si128((const __m128i*)iv);
+
+    for (uint64_t i = 0; i < nBlocks; i++)
+    {
+        __m128i b   = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        chain       = EncryptBlock(k, nr, _mm_xor_si128(b, chain));
+        _mm_storeu_si128((__m128i*)&out[16 * i], chain);
+    }
+
+    _mm_storeu_si128((__m128i*)iv, chain);
+}
+
+/**
+ * AESNIDecryptCBC - Decrypt whole blocks in CBC mode. Block decryptions do not
+ * depend on each other, so four are run in flight and XORed with the preceding
+ * ciphertext afterwards.
+ *
+ * @param decKeys   [in]        Decryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Chaining value. Holds the last ciphertext block on return.
+ * @param in        [in]        Ciphertext.
+ * @param out       [out]       Plaintext. May alias in.
+ * @param nBlocks   [in]        Number of 16-byte blocks.
+ */
+
+AESNI_TARGET void AESNIDecryptCBC(const uint8_t* decKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t nBlocks)
+{
+    const __m128i* k    = (const __m128i*)decKeys;
+    __m128i chain       = _mm_loadu_si128((const __m128i*)iv);
+    uint64_t i          = 0;
+
+    for (; i + 4 <= nBlocks; i += 4)
+    {
+        __m128i c[4];
+        __m128i b[4];
+
+        for (uint32_t j = 0; j < 4; j++)
+            b[j] = c[j] = _mm_loadu_si128((const __m128i*)&in[16 * (i + j)]);
+
+        DecryptBlocks4(k, nr, b);
+
+        b[0] = _mm_xor_si128(b[0], chain);
+        b[1] = _mm_xor_si128(b[1], c[0]);
+        b[2] = _mm_xor_si128(b[2], c[1]);
+        b[3] = _mm_xor_si128(b[3], c[2]);
+        chain = c[3];
+
+        for (uint32_t j = 0; j < 4; j++)
+            _mm_storeu_si128((__m128i*)&out[16 * (i + j)], b[j]);
+    }
+
+    for (; i < nBlocks; i++)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        __m128i b = _mm_xor_si128(DecryptBlock(k, nr, c), chain);
+
+        chain = c;
+        _mm_storeu_si128((__m128i*)&out[16 * i], b);
+    }
+
+    _mm_storeu_si128((__m128i*)iv, chain);
+}
+
+/**
+ * AESNIEncryptCFB128 - Encrypt in CFB mode with a 128-bit segment size. A trailing
+ * partial block is XORed with the leading bytes of the last keystream block.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Input block. Holds the last ciphertext block on return.
+ * @param in        [in]        Plaintext.
+ * @param out       [out]       Ciphertext. May alias in.
+ * @param len       [in]        Length in bytes.
+ */
+
+AESNI_TARGET void AESNIEncryptCFB128(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    const __m128i* k    = (const __m128i*)encKeys;
+    __m128i chain       = _mm_loadu_si128((const __m128i*)iv);
+    const uint64_t n    = len / 16;
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        __m128i p   = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        chain       = _mm_xor_si128(EncryptBlock(k, nr, chain), p);
+        _mm_storeu_si128((__m128i*)&out[16 * i], chain);
+    }
+
+    _mm_storeu_si128((__m128i*)iv, chain);
+
+    if (len % 16)
+    {
+        uint8_t ks[16];
+        _mm_storeu_si128((__m128i*)ks, EncryptBlock(k, nr, chain));
+
+        for (uint64_t j = 0; j < len % 16; j++)
+            out[16 * n + j] = in[16 * n + j] ^ ks[j];
+    }
+}
+
+/**
+ * AESNIDecryptCFB128 - Decrypt in CFB mode with a 128-bit segment size. The cipher
+ * inputs are all known ciphertext blocks, so four are encrypted in flight.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Input block. Holds the last ciphertext block on return.
+ * @param in        [in]        Ciphertext.
+ * @param out       [out]       Plaintext. May alias in.
+ * @param len       [in]        Length in bytes.
+ */
+
+AESNI_TARGET void AESNIDecryptCFB128(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    const __m128i* k    = (const __m128i*)encKeys;
+    __m128i chain       = _mm_loadu_si128((const __m128i*)iv);
+    const uint64_t n    = len / 16;
+    uint64_t i          = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i c[4];
+        __m128i b[4];
+
+        for (uint32_t j = 0; j < 4; j++)
+            c[j] = _mm_loadu_si128((const __m128i*)&in[16 * (i + j)]);
+
+        b[0] = chain;
+        b[1] = c[0];
+        b[2] = c[1];
+        b[3] = c[2];
+        chain = c[3];
+
+        EncryptBlocks4(k, nr, b);
+
+        for (uint32_t j = 0; j < 4; j++)
+            _mm_storeu_si128((__m128i*)&out[16 * (i + j)], _mm_xor_si128(b[j], c[j]));
+    }
+
+    for (; i < n; i++)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        _mm_storeu_si128((__m128i*)&out[16 * i], _mm_xor_si128(EncryptBlock(k, nr, chain), c));
+        chain = c;
+    }
+
+    _mm_storeu_si128((__m128i*)iv, chain);
+
+    if (len % 16)
+    {
+        uint8_t ks[16];
+        _mm_storeu_si128((__m128i*)ks, EncryptBlock(k, nr, chain));
+
+        for (uint64_t j = 0; j < len % 16; j++)
+            out[16 * n + j] = in[16 * n + j] ^ ks[j];
+    }
+}
+
+/**
+ * RegisterBlock - Load a CFB shift register held as two big-endian 64-bit halves
+ * into an AES input block.
+ *
+ * @param hi    [in] Bytes 0-7 of the register.
+ * @param lo    [in] Bytes 8-15 of the register.
+ *
+ * @return Register as an AES input block.
+ */
+
+AESNI_TARGET static inline __m128i RegisterBlock(const uint64_t hi, const uint64_t lo)
+{
+    return _mm_set_epi64x((long long)__builtin_bswap64(lo), (long long)__builtin_bswap64(hi));
+}
+
+/**
+ * AESNICryptCFB1 - Encrypt or decrypt in CFB mode with a 1-bit segment size, walking
+ * the bits of each byte LSB first. The shift register lives in two general purpose
+ * registers and each byte's eight segments are unrolled. Decryption feeds back
+ * ciphertext bits that are all known up front, so four segments are encrypted in
+ * flight.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Shift register. Holds the last 128 ciphertext bits on return.
+ * @param in        [in]        Input text.
+ * @param out       [out]       Output text. May alias in.
+ * @param len       [in]        Length in bytes.
+ * @param bEncrypt  [in]        True to encrypt, false to decrypt.
+ */
+
+AESNI_TARGET void AESNICryptCFB1(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt)
+{
+    const __m128i* k = (const __m128i*)encKeys;
+    uint64_t hi;
+    uint64_t lo;
+
+    memcpy(&hi, &iv[0], 8);
+    memcpy(&lo, &iv[8], 8);
+
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+
+    for (uint64_t i = 0; i < len; i++)
+    {
+        const uint32_t txt  = in[i];
+        uint32_t outByte    = 0;
+
+        if (bEncrypt)
+        {
+#pragma GCC unroll 8
+            for (uint32_t bit = 0; bit < 8; bit++)
+            {
+                const __m128i ks        = EncryptBlock(k, nr, RegisterBlock(hi, lo));
+                const uint32_t outBit   = ((txt >> bit) ^ (uint32_t)_mm_movemask_epi8(ks)) & 1;
+
+                outByte |= outBit << bit;
+                hi      = (hi << 1) | (lo >> 63);
+                lo      = (lo << 1) | outBit;
+            }
+        }
+        else
+        {
+            for (uint32_t half = 0; half < 8; half += 4)
+            {
+                __m128i b[4];
+
+                for (uint32_t j = 0; j < 4; j++)
+                {
+                    b[j]    = RegisterBlock(hi, lo);
+                    hi      = (hi << 1) | (lo >> 63);
+                    lo      = (lo << 1) | ((txt >> (half + j)) & 1);
+                }
+
+                EncryptBlocks4(k, nr, b);
+
+                for (uint32_t j = 0; j < 4; j++)
+                    outByte |= (((txt >> (half + j)) ^ (uint32_t)_mm_movemask_epi8(b[j])) & 1) << (half + j);
+            }
+        }
+
+        out[i] = (uint8_t)outByte;
+    }
+
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+
+    memcpy(&iv[0], &hi, 8);
+    memcpy(&iv[8], &lo, 8);
+}
+
+/**
+ * AESNICryptCFB8 - Encrypt or decrypt in CFB mode with an 8-bit segment size. The
+ * shift register stays in an XMM register on encryption. Decryption slides a
+ * window over the previous 16 ciphertext bytes, so four segments are encrypted in
+ * flight; the window is a copy, which keeps in-place decryption correct.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Shift register. Holds the last 16 ciphertext bytes on return.
+ * @param in        [in]        Input text.
+ * @param out       [out]       Output text. May alias in.
+ * @param len       [in]        Length in bytes.
+ * @param bEncrypt  [in]        True to encrypt, false to decrypt.
+ */
+
+AESNI_TARGET void AESNICryptCFB8(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt)
+{
+    const __m128i* k = (const __m128i*)encKeys;
+
+    if (bEncrypt)
+    {
+        __m128i sr = _mm_loadu_si128((const __m128i*)iv);
+
+        for (uint64_t i = 0; i < len; i++)
+        {
+            const __m128i ks    = EncryptBlock(k, nr, sr);
+            const uint8_t c     = in[i] ^ (uint8_t)_mm_cvtsi128_si32(ks);
+
+            out[i]  = c;
+            sr      = _mm_insert_epi8(_mm_srli_si128(sr, 1), c, 15);
+        }
+
+        _mm_storeu_si128((__m128i*)iv, sr);
+        return;
+    }
+
+    uint8_t window[20];
+    uint64_t i = 0;
+
+    memcpy(window, iv, 16);
+
+    for (; i + 4 <= len; i += 4)
+    {
+        __m128i b[4];
+
+        memcpy(&window[16], &in[i], 4);
+
+        for (uint32_t j = 0; j < 4; j++)
+            b[j] = _mm_loadu_si128((const __m128i*)&window[j]);
+
+        EncryptBlocks4(k, nr, b);
+
+        for (uint32_t j = 0; j < 4; j++)
+            out[i + j] = window[16 + j] ^ (uint8_t)_mm_cvtsi128_si32(b[j]);
+
+        memmove(window, &window[4], 16);
+    }
+
+    for (; i < len; i++)
+    {
+        const __m128i ks    = EncryptBlock(k, nr, _mm_loadu_si128((const __m128i*)window));
+        const uint8_t c     = in[i];
+
+        out[i] = c ^ (uint8_t)_mm_cvtsi128_si32(ks);
+
+        memmove(window, &window[1], 15);
+        window[15] = c;
+    }
+
+    memcpy(iv, window, 16);
+}
+
+/**
+ * AESNICryptOFB - Encrypt or decrypt in OFB mode (the two are identical).
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param iv        [in/out]    Output feedback block. Holds the last keystream block on return.
+ * @param in        [in]        Input text.
+ * @param out       [out]       Output text. May alias in.
+ * @param len       [in]        Length in bytes.
+ */
+
+AESNI_TARGET void AESNICryptOFB(const uint8_t* encKeys, const uint32_t nr, uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    const __m128i* k    = (const __m128i*)encKeys;
+    __m128i ks          = _mm_loadu_si128((const __m128i*)iv);
+    const uint64_t n    = len / 16;
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        ks          = EncryptBlock(k, nr, ks);
+        __m128i p   = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        _mm_storeu_si128((__m128i*)&out[16 * i], _mm_xor_si128(ks, p));
+    }
+
+    if (len % 16)
+    {
+        uint8_t ksBytes[16];
+
+        ks = EncryptBlock(k, nr, ks);
+        _mm_storeu_si128((__m128i*)ksBytes, ks);
+
+        for (uint64_t j = 0; j < len % 16; j++)
+            out[16 * n + j] = in[16 * n + j] ^ ksBytes[j];
+    }
+
+    _mm_storeu_si128((__m128i*)iv, ks);
+}
+
+/**
+ * CounterBlock - Build a counter block from the high and low halves of a 128-bit
+ * big-endian counter.
+ *
+ * @param hi    [in] Upper 64 bits of the counter.
+ * @param lo    [in] Lower 64 bits of the counter.
+ *
+ * @return Counter block in FIPS 197 byte order.
+ */
+
+AESNI_TARGET static inline __m128i CounterBlock(const uint64_t hi, const uint64_t lo)
+{
+    return _mm_set_epi64x((long long)__builtin_bswap64(lo), (long long)__builtin_bswap64(hi));
+}
+
+/**
+ * AESNICryptCTR - Encrypt or decrypt in CTR mode (the two are identical). Counter
+ * blocks are independent, so eight are encrypted in flight. The counter is the
+ * whole 128-bit block incremented as a big-endian integer (SP 800-38A B.1). A
+ * trailing partial block uses the leading bytes of one more keystream block.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param ctr       [in/out]    Initial counter block. Holds the next unused counter on return.
+ * @param in        [in]        Input text.
+ * @param out       [out]       Output text. May alias in.
+ * @param len       [in]        Length in bytes.
+ */
+
+AESNI_TARGET void AESNICryptCTR(const uint8_t* encKeys, const uint32_t nr, uint8_t ctr[16],
+    const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    const __m128i* k    = (const __m128i*)encKeys;
+    const uint64_t n    = len / 16;
+    uint64_t hi;
+    uint64_t lo;
+    uint64_t i          = 0;
+
+    memcpy(&hi, &ctr[0], 8);
+    memcpy(&lo, &ctr[8], 8);
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i b[8];
+        __m128i rk = _mm_loadu_si128(&k[0]);
+
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            b[j] = _mm_xor_si128(CounterBlock(hi, lo), rk);
+            hi += (++lo == 0);
+        }
+
+        for (uint32_t r = 1; r < nr; r++)
+        {
+            rk = _mm_loadu_si128(&k[r]);
+
+            for (uint32_t j = 0; j < 8; j++)
+                b[j] = _mm_aesenc_si128(b[j], rk);
+        }
+
+        rk = _mm_loadu_si128(&k[nr]);
+
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            b[j] = _mm_aesenclast_si128(b[j], rk);
+            __m128i t = _mm_loadu_si128((const __m128i*)&in[16 * (i + j)]);
+            _mm_storeu_si128((__m128i*)&out[16 * (i + j)], _mm_xor_si128(b[j], t));
+        }
+    }
+
+    for (; i < n; i++)
+    {
+        __m128i ks = EncryptBlock(k, nr, CounterBlock(hi, lo));
+        __m128i t  = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+
+        _mm_storeu_si128((__m128i*)&out[16 * i], _mm_xor_si128(ks, t));
+        hi += (++lo == 0);
+    }
+
+    if (len % 16)
+    {
+        uint8_t ksBytes[16];
+        _mm_storeu_si128((__m128i*)ksBytes, EncryptBlock(k, nr, CounterBlock(hi, lo)));
+
+        for (uint64_t j = 0; j < len % 16; j++)
+            out[16 * n + j] = in[16 * n + j] ^ ksBytes[j];
+
+        hi += (++lo == 0);
+    }
+
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+    memcpy(&ctr[0], &hi, 8);
+    memcpy(&ctr[8], &lo, 8);
+}
+
+/**
+ * ExpandStep - One AES-NI key expansion step: fold the round key two steps back
+ * (AES-256) or the previous round key into itself with three 4-byte shifts, then
+ * XOR in the substituted word.
+ *
+ * @param k     [in] Round key being extended.
+ * @param t     [in] SubWord (and RotWord, round constant) result in every column.
+ *
+ * @return Next round key.
+ */
+
+AESNI_TARGET static inline __m128i ExpandStep(__m128i k, const __m128i t)
+{
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+
+    return _mm_xor_si128(k, t);
+}
+
+/**
+ * EncryptLanes - Expand up to AESNI_MULTIKEY_LANES keys side by side and encrypt
+ * each key's blocks. SubWord comes from AESENCLAST on the broadcast (rotated) last
+ * word, where ShiftRows has no effect and the round key operand supplies Rcon;
+ * unlike AESKEYGENASSIST this takes the round constant from a register and
+ * pipelines at full AESENC rate. Each expansion step runs across all lanes before
+ * the next so independent keys overlap, and each block index is then encrypted
+ * for every lane with the rounds interleaved, as bulk ECB does for a single key.
+ * AES-192, whose schedule does not fall on round key boundaries, is expanded word
+ * by word per lane and shares the interleaved encryption.
+ *
+ * @param keys          [in]    Keys in FIPS 197 byte order, 4 * nk bytes each.
+ * @param nk            [in]    Key length in 32-bit words (4, 6 or 8).
+ * @param in            [in]    Plaintext, blocksPerKey blocks per key.
+ * @param out           [out]   Ciphertext. May alias in.
+ * @param lanes         [in]    Number of keys in this group.
+ * @param blocksPerKey  [in]    Number of blocks encrypted under each key.
+ */
+
+AESNI_TARGET static inline void EncryptLanes(const uint8_t* keys, const uint32_t nk,
+    const uint8_t* in, uint8_t* out, const uint32_t lanes, const uint64_t blocksPerKey)
+{
+    const uint32_t nr       = nk + 6;
+    const __m128i rotWord   = _mm_set1_epi32(0x0c0f0e0d);
+    __m128i rk[AESNI_MULTIKEY_LANES][AESNI_MAX_ROUND_KEYS];
+
+    if (nk == 4)
+    {
+        for (uint32_t l = 0; l < lanes; l++)
+            rk[l][0] = _mm_loadu_si128((const __m128i*)&keys[16 * l]);
+
+        for (uint32_t r = 1; r <= nr; r++)
+        {
+            const __m128i rcon = _mm_set1_epi32((int)rconLE[r]);
+
+            for (uint32_t l = 0; l < lanes; l++)
+            {
+                __m128i t = _mm_aesenclast_si128(_mm_shuffle_epi8(rk[l][r - 1], rotWord), rcon);
+                rk[l][r] = ExpandStep(rk[l][r - 1], t);
+            }
+        }
+    }
+    else if (nk == 8)
+    {
+        for (uint32_t l = 0; l < lanes; l++)
+        {
+            rk[l][0] = _mm_loadu_si128((const __m128i*)&keys[32 * l]);
+            rk[l][1] = _mm_loadu_si128((const __m128i*)&keys[32 * l + 16]);
+        }
+
+        for (uint32_t r = 2; r <= nr; r += 2)
+        {
+            const __m128i rcon = _mm_set1_epi32((int)rconLE[r / 2]);
+
+            for (uint32_t l = 0; l < lanes; l++)
+            {
+                __m128i t = _mm_aesenclast_si128(_mm_shuffle_epi8(rk[l][r - 1], rotWord), rcon);
+                rk[l][r] = ExpandStep(rk[l][r - 2], t);
+
+                if (r < nr)
+                {
+                    t = _mm_aesenclast_si128(_mm_shuffle_epi32(rk[l][r], 0xff), _mm_setzero_si128());
+                    rk[l][r + 1] = ExpandStep(rk[l][r - 1], t);
+                }
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t l = 0; l < lanes; l++)
+            ExpandEncKeys(&keys[4 * nk * l], nk, (uint8_t*)rk[l]);
+    }
+
+    for (uint64_t j = 0; j < blocksPerKey; j++)
+    {
+        __m128i b[AESNI_MULTIKEY_LANES];
+
+        for (uint32_t l = 0; l < lanes; l++)
+            b[l] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&in[16 * (l * blocksPerKey + j)]), rk[l][0]);
+
+        for (uint32_t r = 1; r < nr; r++)
+        {
+            for (uint32_t l = 0; l < lanes; l++)
+                b[l] = _mm_aesenc_si128(b[l], rk[l][r]);
+        }
+
+        for (uint32_t l = 0; l < lanes; l++)
+        {
+            b[l] = _mm_aesenclast_si128(b[l], rk[l][nr]);
+            _mm_storeu_si128((__m128i*)&out[16 * (l * blocksPerKey + j)], b[l]);
+        }
+    }
+}
+
+/**
+ * AESNIEncryptMultiKey - Encrypt a few blocks under each of many keys, such as
+ * key wrapping for many recipients. Keys are expanded and used in groups of
+ * AESNI_MULTIKEY_LANES so the expansion and encryption of different keys
+ * pipeline like bulk encryption under one key, and no schedule leaves registers
+ * and the stack.
+ *
+ * @param keys          [in]    Keys in FIPS 197 byte order, 4 * nk bytes each.
+ * @param nk            [in]    Key length in 32-bit words (4, 6 or 8).
+ * @param in            [in]    Plaintext, blocksPerKey consecutive blocks per key.
+ * @param out           [out]   Ciphertext. May alias in.
+ * @param numKeys       [in]    Number of keys.
+ * @param blocksPerKey  [in]    Number of blocks encrypted under each key.
+ */
+
+AESNI_TARGET void AESNIEncryptMultiKey(const uint8_t* keys, const uint32_t nk,
+    const uint8_t* in, uint8_t* out, const uint64_t numKeys, const uint64_t blocksPerKey)
+{
+    assert(nk == 4 || nk == 6 || nk == 8);
+
+    const uint64_t groupBytes = 16 * blocksPerKey * AESNI_MULTIKEY_LANES;
+    uint64_t i = 0;
+
+    for (; i + AESNI_MULTIKEY_LANES <= numKeys; i += AESNI_MULTIKEY_LANES)
+    {
+        const uint64_t g = i / AESNI_MULTIKEY_LANES;
+
+        EncryptLanes(&keys[4 * nk * i], nk, &in[groupBytes * g], &out[groupBytes * g],
+            AESNI_MULTIKEY_LANES, blocksPerKey);
+    }
+
+    if (i < numKeys)
+    {
+        EncryptLanes(&keys[4 * nk * i], nk, &in[16 * blocksPerKey * i], &out[16 * blocksPerKey * i],
+            numKeys - i, blocksPerKey);
+    }
+}
+
+#define GCM_TARGET __attribute__((target("aes,sse4.1,pclmul")))
+
+/**
+ * AESNIGCMSupported - Check if the CPU has the AES-NI and PCLMULQDQ instructions
+ * the fused GCM routines need.
+ *
+ * @return True if both are available.
+ */
+
+bool AESNIGCMSupported()
+{
+    return CPUHasFeature(CPU_AESNI) && CPUHasFeature(CPU_PCLMUL);
+}
+
+/**
+ * ReflectBytes - Reverse the byte order of a block so GHASH's bit-reflected field
+ * elements line up with PCLMULQDQ's polynomial bit order.
+ *
+ * @param x     [in] Block to reverse.
+ *
+ * @return Byte-reversed block.
+ */
+
+GCM_TARGET static inline __m128i ReflectBytes(const __m128i x)
+{
+    const __m128i mask = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+/**
+ * ClMul - Unreduced 128 x 128 -> 256-bit carry-less product.
+ *
+ * @param a     [in]    First operand.
+ * @param b     [in]    Second operand.
+ * @param lo    [out]   Low 128 bits of the product.
+ * @param hi    [out]   High 128 bits of the product.
+ */
+
+GCM_TARGET static inline void ClMul(const __m128i a, const __m128i b, __m128i& lo, __m128i& hi)
+{
+    __m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i t1 = _mm_clmulepi64_si128(a, b, 0x10);
+    __m128i t2 = _mm_clmulepi64_si128(a, b, 0x01);
+    __m128i t3 = _mm_clmulepi64_si128(a, b, 0x11);
+
+    t1 = _mm_xor_si128(t1, t2);
+    lo = _mm_xor_si128(t0, _mm_slli_si128(t1, 8));
+    hi = _mm_xor_si128(t3, _mm_srli_si128(t1, 8));
+}
+
+/**
+ * GFReduce - Reduce a 256-bit carry-less product of byte-reflected operands modulo
+ * the GCM polynomial x^128 + x^7 + x^2 + x + 1. The product is first shifted left
+ * one bit to undo the bit reflection, then folded (Intel carry-less multiplication
+ * white paper, algorithm 5). Reduction is linear, so several unreduced products
+ * may be XORed together and reduced once.
+ *
+ * @param lo    [in] Low 128 bits of the product.
+ * @param hi    [in] High 128 bits of the product.
+ *
+ * @return Reduced field element.
+ */
+
+GCM_TARGET static inline __m128i GFReduce(__m128i lo, __m128i hi)
+{
+    __m128i t7 = _mm_srli_epi32(lo, 31);
+    __m128i t8 = _mm_srli_epi32(hi, 31);
+    __m128i t9;
+
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+
+    t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    lo = _mm_or_si128(lo, t7);
+    hi = _mm_or_si128(hi, t8);
+    hi = _mm_or_si128(hi, t9);
+
+    t7 = _mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30));
+    t7 = _mm_xor_si128(t7, _mm_slli_epi32(lo, 25));
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    lo = _mm_xor_si128(lo, t7);
+
+    __m128i t2 = _mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2));
+    t2 = _mm_xor_si128(t2, _mm_srli_epi32(lo, 7));
+    t2 = _mm_xor_si128(t2, t8);
+    lo = _mm_xor_si128(lo, t2);
+
+    return _mm_xor_si128(hi, lo);
+}
+
+/**
+ * GFMul - Multiply two byte-reflected GHASH field elements.
+ *
+ * @param a     [in] First operand.
+ * @param b     [in] Second operand.
+ *
+ * @return Reduced product.
+ */
+
+GCM_TARGET static inline __m128i GFMul(const __m128i a, const __m128i b)
+{
+    __m128i lo;
+    __m128i hi;
+
+    ClMul(a, b, lo, hi);
+    return GFReduce(lo, hi);
+}
+
+/**
+ * GHASH4 - Absorb four blocks into the GHASH accumulator with one reduction:
+ * X = (X + C0)H^4 + C1 H^3 + C2 H^2 + C3 H.
+ *
+ * @param hp    [in] Byte-reflected H, H^2, H^3, H^4.
+ * @param x     [in] Byte-reflected accumulator.
+ * @param c     [in] Byte-reflected blocks.
+ *
+ * @return Updated accumulator.
+ */
+
+GCM_TARGET static inline __m128i GHASH4(const __m128i hp[4], const __m128i x, const __m128i c[4])
+{
+    __m128i lo;
+    __m128i hi;
+    __m128i tlo;
+    __m128i thi;
+
+    ClMul(_mm_xor_si128(x, c[0]), hp[3], lo, hi);
+
+    for (uint32_t j = 1; j < 4; j++)
+    {
+        ClMul(c[j], hp[3 - j], tlo, thi);
+        lo = _mm_xor_si128(lo, tlo);
+        hi = _mm_xor_si128(hi, thi);
+    }
+
+    return GFReduce(lo, hi);
+}
+
+/**
+ * LoadHPowers - Load the precomputed hash key powers.
+ *
+ * @param hPowers   [in]    Powers stored by AESNIGHASHPrecompute.
+ * @param hp        [out]   Byte-reflected H, H^2, H^3, H^4.
+ */
+
+GCM_TARGET static inline void LoadHPowers(const uint8_t* hPowers, __m128i hp[4])
+{
+    for (uint32_t j = 0; j < 4; j++)
+        hp[j] = _mm_loadu_si128((const __m128i*)&hPowers[16 * j]);
+}
+
+/**
+ * AESNIGHASHPrecompute - Store H, H^2, H^3 and H^4 in the byte-reflected form the
+ * PCLMULQDQ GHASH routines use, so four blocks can share one reduction.
+ *
+ * @param H         [in]    Hash subkey E(K, 0^128).
+ * @param hPowers   [out]   Powers of H, 16 bytes each.
+ */
+
+GCM_TARGET void AESNIGHASHPrecompute(const uint8_t H[16], uint8_t hPowers[16 * 4])
+{
+    __m128i h   = ReflectBytes(_mm_loadu_si128((const __m128i*)H));
+    __m128i pow = h;
+
+    for (uint32_t j = 0; j < 4; j++)
+    {
+        _mm_storeu_si128((__m128i*)&hPowers[16 * j], pow);
+        pow = GFMul(pow, h);
+    }
+}
+
+/**
+ * AESNIGHASH - Absorb whole blocks into a GHASH accumulator with PCLMULQDQ.
+ *
+ * @param hPowers   [in]        Powers from AESNIGHASHPrecompute.
+ * @param X         [in/out]    GHASH accumulator.
+ * @param data      [in]        Blocks to absorb.
+ * @param nBlocks   [in]        Number of 16-byte blocks.
+ */
+
+GCM_TARGET void AESNIGHASH(const uint8_t* hPowers, uint8_t X[16], const uint8_t* data, const uint64_t nBlocks)
+{
+    __m128i hp[4];
+    __m128i x   = ReflectBytes(_mm_loadu_si128((const __m128i*)X));
+    uint64_t i  = 0;
+
+    LoadHPowers(hPowers, hp);
+
+    for (; i + 4 <= nBlocks; i += 4)
+    {
+        __m128i c[4];
+
+        for (uint32_t j = 0; j < 4; j++)
+            c[j] = ReflectBytes(_mm_loadu_si128((const __m128i*)&data[16 * (i + j)]));
+
+        x = GHASH4(hp, x, c);
+    }
+
+    for (; i < nBlocks; i++)
+    {
+        __m128i c = ReflectBytes(_mm_loadu_si128((const __m128i*)&data[16 * i]));
+        x = GFMul(_mm_xor_si128(x, c), hp[0]);
+    }
+
+    _mm_storeu_si128((__m128i*)X, ReflectBytes(x));
+}
+
+/**
+ * GCMCounterBlocks4 - Build four GCM counter blocks. Only the last 32 bits of the
+ * counter block are incremented (inc32 in SP 800-38D).
+ *
+ * @param base  [in]        Counter block with the current 32-bit counter.
+ * @param ctr   [in/out]    Current 32-bit counter value; advanced by four.
+ * @param b     [out]       Counter blocks.
+ */
+
+GCM_TARGET static inline void GCMCounterBlocks4(const __m128i base, uint32_t& ctr, __m128i b[4])
+{
+    for (uint32_t j = 0; j < 4; j++)
+        b[j] = _mm_insert_epi32(base, (int)__builtin_bswap32(ctr++), 3);
+}
+
+/**
+ * GCMCrypt - Fused GCM CTR encryption/decryption and GHASH. Each iteration runs four
+ * AES-NI counter block encryptions and the aggregated GHASH of the same four
+ * ciphertext blocks, so one pass over the data does both. A trailing partial block
+ * is zero-padded for GHASH.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param hPowers   [in]        Powers from AESNIGHASHPrecompute.
+ * @param ctr       [in/out]    Counter block for the first data block. Advanced past the
+ *                              last block used on return.
+ * @param X         [in/out]    GHASH accumulator.
+ * @param in        [in]        Input text.
+ * @param out       [out]       Output text. May alias in.
+ * @param len       [in]        Length in bytes.
+ * @param bEncrypt  [in]        True to hash the output (encryption), false to hash the
+ *                              input (decryption).
+ */
+
+GCM_TARGET static void GCMCrypt(const uint8_t* encKeys, const uint32_t nr, const uint8_t* hPowers,
+    uint8_t ctr[16], uint8_t X[16], const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt)
+{
+    const __m128i* k    = (const __m128i*)encKeys;
+    const uint64_t n    = len / 16;
+    __m128i base        = _mm_loadu_si128((const __m128i*)ctr);
+    __m128i x           = ReflectBytes(_mm_loadu_si128((const __m128i*)X));
+    uint32_t ctr32      = __builtin_bswap32((uint32_t)_mm_extract_epi32(base, 3));
+    uint64_t i          = 0;
+    __m128i hp[4];
+
+    LoadHPowers(hPowers, hp);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i b[4];
+        __m128i t[4];
+        __m128i c[4];
+
+        GCMCounterBlocks4(base, ctr32, b);
+        EncryptBlocks4(k, nr, b);
+
+        for (uint32_t j = 0; j < 4; j++)
+        {
+            t[j] = _mm_loadu_si128((const __m128i*)&in[16 * (i + j)]);
+            b[j] = _mm_xor_si128(b[j], t[j]);
+            _mm_storeu_si128((__m128i*)&out[16 * (i + j)], b[j]);
+            c[j] = ReflectBytes(bEncrypt ? b[j] : t[j]);
+        }
+
+        x = GHASH4(hp, x, c);
+    }
+
+    for (; i < n; i++)
+    {
+        __m128i t   = _mm_loadu_si128((const __m128i*)&in[16 * i]);
+        __m128i b   = _mm_insert_epi32(base, (int)__builtin_bswap32(ctr32++), 3);
+
+        b = _mm_xor_si128(EncryptBlock(k, nr, b), t);
+        _mm_storeu_si128((__m128i*)&out[16 * i], b);
+
+        x = GFMul(_mm_xor_si128(x, ReflectBytes(bEncrypt ? b : t)), hp[0]);
+    }
+
+    if (len % 16)
+    {
+        uint8_t ks[16];
+        uint8_t pad[16] = { 0 };
+
+        __m128i b = _mm_insert_epi32(base, (int)__builtin_bswap32(ctr32++), 3);
+        _mm_storeu_si128((__m128i*)ks, EncryptBlock(k, nr, b));
+
+        for (uint64_t j = 0; j < len % 16; j++)
+        {
+            uint8_t inByte  = in[16 * n + j];
+            out[16 * n + j] = inByte ^ ks[j];
+            pad[j]          = bEncrypt ? out[16 * n + j] : inByte;
+        }
+
+        x = GFMul(_mm_xor_si128(x, ReflectBytes(_mm_loadu_si128((const __m128i*)pad))), hp[0]);
+    }
+
+    base = _mm_insert_epi32(base, (int)__builtin_bswap32(ctr32), 3);
+    _mm_storeu_si128((__m128i*)ctr, base);
+    _mm_storeu_si128((__m128i*)X, ReflectBytes(x));
+}
+
+/**
+ * AESNIGCMEncrypt - GCM encryption of the message body with fused AES-NI CTR and
+ * PCLMULQDQ GHASH over the ciphertext.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param hPowers   [in]        Powers from AESNIGHASHPrecompute.
+ * @param ctr       [in/out]    Counter block for the first plaintext block (inc32(J0)).
+ * @param X         [in/out]    GHASH accumulator, already holding the hashed AAD.
+ * @param in        [in]        Plaintext.
+ * @param out       [out]       Ciphertext. May alias in.
+ * @param len       [in]        Length in bytes.
+ */
+
+GCM_TARGET void AESNIGCMEncrypt(const uint8_t* encKeys, const uint32_t nr, const uint8_t* hPowers,
+    uint8_t ctr[16], uint8_t X[16], const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    GCMCrypt(encKeys, nr, hPowers, ctr, X, in, out, len, true);
+}
+
+/**
+ * AESNIGCMDecrypt - GCM decryption of the message body with fused AES-NI CTR and
+ * PCLMULQDQ GHASH over the ciphertext.
+ *
+ * @param encKeys   [in]        Encryption round keys.
+ * @param nr        [in]        Number of rounds.
+ * @param hPowers   [in]        Powers from AESNIGHASHPrecompute.
+ * @param ctr       [in/out]    Counter block for the first ciphertext block (inc32(J0)).
+ * @param X         [in/out]    GHASH accumulator, already holding the hashed AAD.
+ * @param in        [in]        Ciphertext.
+ * @param out       [out]       Plaintext. May alias in.
+ * @param len       [in]        Length in bytes.
+ */
+
+GCM_TARGET void AESNIGCMDecrypt(const uint8_t* encKeys, const uint32_t nr, const uint8_t* hPowers,
+    uint8_t ctr[16], uint8_t X[16], const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    GCMCrypt(encKeys, nr, hPowers, ctr, X, in, out, len, false);
+}
+
+#else
+
+bool AESNISupported()
+{
+    return false;
+}
+
+void AESNIExpandKey(const uint8_t*, const uint32_t, uint8_t*, uint8_t*)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIEncryptBlock(const uint8_t*, const uint32_t, const uint8_t*, uint8_t*)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIDecryptBlock(const uint8_t*, const uint32_t, const uint8_t*, uint8_t*)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIEncryptECB(const uint8_t*, const uint32_t, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIDecryptECB(const uint8_t*, const uint32_t, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIEncryptCBC(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIDecryptCBC(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIEncryptCFB128(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIDecryptCFB128(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNICryptCFB1(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t,
+    const bool)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNICryptCFB8(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t,
+    const bool)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNICryptOFB(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNICryptCTR(const uint8_t*, const uint32_t, uint8_t*, const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIEncryptMultiKey(const uint8_t*, const uint32_t, const uint8_t*, uint8_t*, const uint64_t,
+    const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+bool AESNIGCMSupported()
+{
+    return false;
+}
+
+void AESNIGHASHPrecompute(const uint8_t*, uint8_t*)
+{
+    throw runtime_error("PCLMULQDQ is not available on this platform.");
+}
+
+void AESNIGHASH(const uint8_t*, uint8_t*, const uint8_t*, const uint64_t)
+{
+    throw runtime_error("PCLMULQDQ is not available on this platform.");
+}
+
+void AESNIGCMEncrypt(const uint8_t*, const uint32_t, const uint8_t*, uint8_t*, uint8_t*,
+    const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+void AESNIGCMDecrypt(const uint8_t*, const uint32_t, const uint8_t*, uint8_t*, uint8_t*,
+    const uint8_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AES-NI is not available on this platform.");
+}
+
+#endif
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "bigint.h"
 
-#define BIGINT_DIV_BRUTE 1
+typedef unsigned __int128 uint128_t;
 
-static void DivideU8(const BigInt& dividend, const uint8_t divisor, BigInt& quotient, uint8_t& rem);
+static void DivideU64(const BigInt& dividend, const uint64_t divisor, BigInt& quotient, uint64_t& rem);
 
 /**
  * BigInt - Copy constructor. Create a new BigInt from another BigInt.
@@ -16,6 +16,592 @@ BigInt::BigInt(const BigInt& rhs)
     data    = rhs.data;
 }
 
+/**
+ * BigInt::Normalize - Strip leading zero limbs and recompute the bit length.
+ * Every operation that writes limbs directly calls this before returning so
+ * comparisons can rely on limb counts. Zero is stored as a single zero limb
+ * with a bit length of 1.
+ */
+
+void BigInt::Normalize()
+{
+    uint64_t nLimbs = data.size();
+
+    while (nLimbs > 1 && data[nLimbs - 1] == 0)
+        nLimbs--;
+
+    if (nLimbs == 0)
+    {
+        data.assign(1, 0);
+        nBits = 1;
+        return;
+    }
+
+    data.resize(nLimbs);
+
+    const uint64_t top = data[nLimbs - 1];
+
+    if (top == 0)
+        nBits = 1;
+    else
+        nBits = BIGINT_LIMB_BITS * (nLimbs - 1) + (BIGINT_LIMB_BITS - __builtin_clzll(top));
+}
+
+/**
+ * CompareLimbs - Three way comparison of two normalized big integers.
+ *
+ * @param lhs       [in] First integer.
+ * @param rhs       [in] Second integer.
+ *
+ * @return          -1 if lhs < rhs, 0 if equal, 1 if lhs > rhs.
+ */
+
+static int CompareLimbs(const BigInt& lhs, const BigInt& rhs)
+{
+    if (lhs.data.size() != rhs.data.size())
+        return lhs.data.size() > rhs.data.size() ? 1 : -1;
+
+    for (uint64_t i = lhs.data.size(); i-- > 0;)
+        if (lhs.data[i] != rhs.data[i])
+            return lhs.data[i] > rhs.data[i] ? 1 : -1;
+
+    return 0;
+}
+
+/**
+ * MulLimbs - Schoolbook product of two limb arrays. Output must hold n + m
+ * limbs and must not alias either input.
+ *
+ * @param a         [in]        First factor limbs.
+ * @param n         [in]        Number of limbs in a.
+ * @param b         [in]        Second factor limbs.
+ * @param m         [in]        Number of limbs in b.
+ * @param out       [in/out]    Product limbs.
+ */
+
+static void MulLimbs(const uint64_t* a, const uint64_t n, const uint64_t* b, const uint64_t m, uint64_t* out)
+{
+    memset(out, 0, (n + m) * sizeof(uint64_t));
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint64_t carry = 0;
+
+        for (uint64_t j = 0; j < m; j++)
+        {
+            uint128_t t = (uint128_t)a[i] * b[j] + out[i + j] + carry;
+            out[i + j]  = (uint64_t)t;
+            carry       = (uint64_t)(t >> 64);
+        }
+
+        out[i + m] = carry;
+    }
+}
+
+static uint64_t gKaratsubaThreshold     = BIGINT_KARATSUBA_THRESHOLD;
+static uint64_t gToom3Threshold         = BIGINT_TOOM3_THRESHOLD;
+static uint64_t gSqrKaratsubaThreshold  = BIGINT_SQR_KARATSUBA_THRESHOLD;
+static uint64_t gSqrToom3Threshold      = BIGINT_SQR_TOOM3_THRESHOLD;
+
+/**
+ * BigIntSetMulThresholds - Override the limb counts at which multiplication and
+ * squaring switch from schoolbook to Karatsuba and from Karatsuba to Toom-3.
+ * Used by the tuning benchmark; not thread safe against concurrent multiplies.
+ * Below 4 limbs the (h + 1) limb middle Karatsuba product would not shrink.
+ *
+ * @param karatsuba     [in] Smallest operand size in limbs that multiplies with Karatsuba.
+ * @param toom3         [in] Smallest operand size in limbs that multiplies with Toom-3.
+ * @param sqrKaratsuba  [in] Smallest operand size in limbs that squares with Karatsuba.
+ * @param sqrToom3      [in] Smallest operand size in limbs that squares with Toom-3.
+ */
+
+void BigIntSetMulThresholds(const uint64_t karatsuba, const uint64_t toom3,
+    const uint64_t sqrKaratsuba, const uint64_t sqrToom3)
+{
+    if (karatsuba < 4 || toom3 < 4 || sqrKaratsuba < 4 || sqrToom3 < 4)
+        throw invalid_argument("BigInt multiplication thresholds must be at least 4 limbs.");
+
+    gKaratsubaThreshold     = karatsuba;
+    gToom3Threshold         = toom3;
+    gSqrKaratsubaThreshold  = sqrKaratsuba;
+    gSqrToom3Threshold      = sqrToom3;
+}
+
+/**
+ * SqrLimbs - Schoolbook square of a limb array. Each cross product a[i] * a[j]
+ * with i < j is computed once and doubled, then the diagonal squares are added,
+ * which roughly halves the multiplies of MulLimbs. Output must hold 2n limbs and
+ * must not alias the input.
+ *
+ * @param a         [in]        Limbs to square.
+ * @param n         [in]        Number of limbs in a.
+ * @param out       [in/out]    Square limbs.
+ */
+
+static void SqrLimbs(const uint64_t* a, const uint64_t n, uint64_t* out)
+{
+    memset(out, 0, 2 * n * sizeof(uint64_t));
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint64_t carry = 0;
+
+        for (uint64_t j = i + 1; j < n; j++)
+        {
+            uint128_t t = (uint128_t)a[i] * a[j] + out[i + j] + carry;
+            out[i + j]  = (uint64_t)t;
+            carry       = (uint64_t)(t >> 64);
+        }
+
+        out[i + n] = carry;
+    }
+
+    uint64_t top = 0;
+
+    for (uint64_t i = 0; i < 2 * n; i++)
+    {
+        uint64_t next   = out[i] >> 63;
+        out[i]          = (out[i] << 1) | top;
+        top             = next;
+    }
+
+    uint64_t carry = 0;
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint128_t sq    = (uint128_t)a[i] * a[i];
+        uint128_t lo    = (uint128_t)out[2 * i] + (uint64_t)sq + carry;
+        out[2 * i]      = (uint64_t)lo;
+
+        uint128_t hi    = (uint128_t)out[2 * i + 1] + (uint64_t)(sq >> 64) + (uint64_t)(lo >> 64);
+        out[2 * i + 1]  = (uint64_t)hi;
+        carry           = (uint64_t)(hi >> 64);
+    }
+}
+
+/**
+ * AddLimbs - Add two limb arrays. Output must hold max(na, nb) + 1 limbs.
+ *
+ * @param a         [in]        First addend limbs.
+ * @param na        [in]        Number of limbs in a.
+ * @param b         [in]        Second addend limbs.
+ * @param nb        [in]        Number of limbs in b.
+ * @param out       [in/out]    Sum limbs.
+ */
+
+static void AddLimbs(const uint64_t* a, const uint64_t na, const uint64_t* b, const uint64_t nb, uint64_t* out)
+{
+    const uint64_t n    = max(na, nb);
+    uint64_t carry      = 0;
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint128_t sum   = (uint128_t)(i < na ? a[i] : 0) + (i < nb ? b[i] : 0) + carry;
+        out[i]          = (uint64_t)sum;
+        carry           = (uint64_t)(sum >> 64);
+    }
+
+    out[n] = carry;
+}
+
+/**
+ * AddLimbsInPlace - Add b into a, propagating the carry through the top of a.
+ * The caller guarantees the sum fits in na limbs.
+ *
+ * @param a         [in/out]    Accumulator limbs.
+ * @param na        [in]        Number of limbs in a.
+ * @param b         [in]        Addend limbs.
+ * @param nb        [in]        Number of limbs in b. Must not exceed na.
+ */
+
+static void AddLimbsInPlace(uint64_t* a, const uint64_t na, const uint64_t* b, const uint64_t nb)
+{
+    uint64_t carry = 0;
+
+    for (uint64_t i = 0; i < na; i++)
+    {
+        if (i >= nb && carry == 0)
+            break;
+
+        uint128_t sum   = (uint128_t)a[i] + (i < nb ? b[i] : 0) + carry;
+        a[i]            = (uint64_t)sum;
+        carry           = (uint64_t)(sum >> 64);
+    }
+
+    assert(carry == 0);
+}
+
+/**
+ * SubLimbsInPlace - Subtract b from a. The caller guarantees a >= b.
+ *
+ * @param a         [in/out]    Minuend limbs.
+ * @param na        [in]        Number of limbs in a.
+ * @param b         [in]        Subtrahend limbs.
+ * @param nb        [in]        Number of limbs in b. Must not exceed na.
+ */
+
+static void SubLimbsInPlace(uint64_t* a, const uint64_t na, const uint64_t* b, const uint64_t nb)
+{
+    uint64_t borrow = 0;
+
+    for (uint64_t i = 0; i < na; i++)
+    {
+        if (i >= nb && borrow == 0)
+            break;
+
+        uint128_t diff  = (uint128_t)a[i] - (i < nb ? b[i] : 0) - borrow;
+        a[i]            = (uint64_t)diff;
+        borrow          = (diff >> 64) ? 1 : 0;
+    }
+
+    assert(borrow == 0);
+}
+
+static void MulDispatch(const uint64_t* a, uint64_t n, const uint64_t* b, uint64_t m, uint64_t* out);
+static void SqrDispatch(const uint64_t* a, const uint64_t n, uint64_t* out);
+
+/**
+ * FromLimbs - Build a normalized BigInt from a slice of limbs.
+ *
+ * @param p         [in] Limbs, least significant first.
+ * @param len       [in] Number of limbs. May be zero.
+ *
+ * @return          Integer value of the slice.
+ */
+
+static BigInt FromLimbs(const uint64_t* p, const uint64_t len)
+{
+    BigInt out;
+    out.data.assign(p, p + len);
+    out.Normalize();
+    return out;
+}
+
+/**
+ * MulBig - Multiply two normalized BigInts through the size dispatcher. When
+ * both arguments are the same object the square path is taken.
+ *
+ * @param x         [in] First factor.
+ * @param y         [in] Second factor.
+ *
+ * @return          Product x * y.
+ */
+
+static BigInt MulBig(const BigInt& x, const BigInt& y)
+{
+    BigInt out;
+    out.data.resize(x.data.size() + y.data.size());
+
+    if (&x == &y)
+        SqrDispatch(&x.data[0], x.data.size(), &out.data[0]);
+    else
+        MulDispatch(&x.data[0], x.data.size(), &y.data[0], y.data.size(), &out.data[0]);
+
+    out.Normalize();
+    return out;
+}
+
+/**
+ * DivExact3 - Divide an integer known to be a multiple of 3 by 3, in place.
+ * Each limb is multiplied by the inverse of 3 mod 2^64 instead of dividing, and
+ * the high half of q * 3 is carried into the next limb as a borrow.
+ *
+ * @param x         [in/out] Multiple of 3 to divide.
+ */
+
+static void DivExact3(BigInt& x)
+{
+    const uint64_t inv3 = 0xAAAAAAAAAAAAAAABULL;
+    uint64_t borrow     = 0;
+
+    for (uint64_t i = 0; i < x.data.size(); i++)
+    {
+        uint64_t limb   = x.data[i];
+        uint64_t under  = limb < borrow;
+        uint64_t q      = (limb - borrow) * inv3;
+
+        x.data[i]       = q;
+        borrow          = under + (uint64_t)(((uint128_t)q * 3) >> 64);
+    }
+
+    assert(borrow == 0);
+    x.Normalize();
+}
+
+/**
+ * Toom3Interpolate - Recover the five coefficients of a product of two
+ * quadratics from its values at 0, 1, 2, 1/2 and infinity, and accumulate
+ * them into the output at multiples of k limbs. The point 1/2 is evaluated as
+ * 4 x0 + 2 x1 + x2, which is 4 times the value there, so every evaluation and
+ * every intermediate below stays non-negative and unsigned BigInts suffice:
+ *
+ *      s1 = c1 + c2 + c3,  s2 = c1 + 2 c2 + 4 c3,  sh = 4 c1 + 2 c2 + c3
+ *      c2 = 3 s1 - (s2 - s1) - (sh - s1)
+ *      c3 = ((s2 - s1) - c2) / 3,  c1 = ((sh - s1) - c2) / 3
+ *
+ * @param r0        [in]        Product value at 0 (c0).
+ * @param r1        [in]        Product value at 1.
+ * @param r2        [in]        Product value at 2.
+ * @param rh        [in]        Product of the scaled values at 1/2.
+ * @param rInf      [in]        Product value at infinity (c4).
+ * @param k         [in]        Split size in limbs.
+ * @param out       [in/out]    Output limbs, zeroed by the caller.
+ * @param outLen    [in]        Number of output limbs.
+ */
+
+static void Toom3Interpolate(const BigInt& r0, const BigInt& r1, const BigInt& r2, const BigInt& rh,
+    const BigInt& rInf, const uint64_t k, uint64_t* out, const uint64_t outLen)
+{
+    BigInt s1   = r1;
+    BigInt s2   = r2;
+    BigInt sh   = rh;
+
+    s1 -= r0;
+    s1 -= rInf;
+    s2 -= r0;
+    s2 -= rInf << 4;
+    s2 >>= 1;
+    sh -= r0 << 4;
+    sh -= rInf;
+    sh >>= 1;
+
+    BigInt c3   = s2;
+    BigInt c1   = sh;
+    BigInt c2   = s1 * (uint8_t)3;
+
+    c3 -= s1;
+    c1 -= s1;
+    c2 -= c3;
+    c2 -= c1;
+    c3 -= c2;
+    c1 -= c2;
+
+    DivExact3(c1);
+    DivExact3(c3);
+
+    const BigInt* coeffs[5] = { &r0, &c1, &c2, &c3, &rInf };
+
+    for (uint64_t i = 0; i < 5; i++)
+    {
+        const BigInt& c = *coeffs[i];
+
+        if (c.data.size() == 1 && c.data[0] == 0)
+            continue;
+
+        AddLimbsInPlace(out + i * k, outLen - i * k, &c.data[0], c.data.size());
+    }
+}
+
+/**
+ * Toom3Mul - Toom-3 product of a (n limbs) and b (m limbs) with n >= m > 2k,
+ * where k = ceil(n / 3). Both operands are split into three k-limb pieces,
+ * evaluated at five points, multiplied recursively and interpolated.
+ *
+ * @param a         [in]        First factor limbs.
+ * @param n         [in]        Number of limbs in a.
+ * @param b         [in]        Second factor limbs.
+ * @param m         [in]        Number of limbs in b.
+ * @param out       [in/out]    Product limbs, n + m of them.
+ */
+
+static void Toom3Mul(const uint64_t* a, const uint64_t n, const uint64_t* b, const uint64_t m, uint64_t* out)
+{
+    const uint64_t k = (n + 2) / 3;
+
+    BigInt a0 = FromLimbs(a, k);
+    BigInt a1 = FromLimbs(a + k, k);
+    BigInt a2 = FromLimbs(a + 2 * k, n - 2 * k);
+    BigInt b0 = FromLimbs(b, k);
+    BigInt b1 = FromLimbs(b + k, k);
+    BigInt b2 = FromLimbs(b + 2 * k, m - 2 * k);
+
+    BigInt a1x2 = a1 << 1;
+    BigInt b1x2 = b1 << 1;
+
+    BigInt r0   = MulBig(a0, b0);
+    BigInt r1   = MulBig(a0 + a1 + a2, b0 + b1 + b2);
+    BigInt r2   = MulBig(a0 + a1x2 + (a2 << 2), b0 + b1x2 + (b2 << 2));
+    BigInt rh   = MulBig((a0 << 2) + a1x2 + a2, (b0 << 2) + b1x2 + b2);
+    BigInt rInf = MulBig(a2, b2);
+
+    memset(out, 0, (n + m) * sizeof(uint64_t));
+    Toom3Interpolate(r0, r1, r2, rh, rInf, k, out, n + m);
+}
+
+/**
+ * Toom3Sqr - Toom-3 square of a (n limbs), sharing each evaluation between
+ * both factors so the five pointwise products are squares.
+ *
+ * @param a         [in]        Limbs to square.
+ * @param n         [in]        Number of limbs in a.
+ * @param out       [in/out]    Square limbs, 2n of them.
+ */
+
+static void Toom3Sqr(const uint64_t* a, const uint64_t n, uint64_t* out)
+{
+    const uint64_t k = (n + 2) / 3;
+
+    BigInt a0 = FromLimbs(a, k);
+    BigInt a1 = FromLimbs(a + k, k);
+    BigInt a2 = FromLimbs(a + 2 * k, n - 2 * k);
+
+    BigInt a1x2 = a1 << 1;
+    BigInt e1   = a0 + a1 + a2;
+    BigInt e2   = a0 + a1x2 + (a2 << 2);
+    BigInt eh   = (a0 << 2) + a1x2 + a2;
+
+    BigInt r0   = MulBig(a0, a0);
+    BigInt r1   = MulBig(e1, e1);
+    BigInt r2   = MulBig(e2, e2);
+    BigInt rh   = MulBig(eh, eh);
+    BigInt rInf = MulBig(a2, a2);
+
+    memset(out, 0, 2 * n * sizeof(uint64_t));
+    Toom3Interpolate(r0, r1, r2, rh, rInf, k, out, 2 * n);
+}
+
+/**
+ * KaratsubaMul - Karatsuba product of a (n limbs) and b (m limbs) with
+ * n >= m > h, where h = ceil(n / 2). Uses three half size products:
+ * a0 b0, a1 b1 and (a0 + a1)(b0 + b1), the middle term being recovered by
+ * subtracting the other two.
+ *
+ * @param a         [in]        First factor limbs.
+ * @param n         [in]        Number of limbs in a.
+ * @param b         [in]        Second factor limbs.
+ * @param m         [in]        Number of limbs in b.
+ * @param out       [in/out]    Product limbs, n + m of them.
+ */
+
+static void KaratsubaMul(const uint64_t* a, const uint64_t n, const uint64_t* b, const uint64_t m, uint64_t* out)
+{
+    const uint64_t h = (n + 1) / 2;
+
+    vector<uint64_t> sa(h + 1);
+    vector<uint64_t> sb(h + 1);
+    vector<uint64_t> mid(2 * h + 2);
+
+    AddLimbs(a, h, a + h, n - h, &sa[0]);
+    AddLimbs(b, h, b + h, m - h, &sb[0]);
+
+    MulDispatch(a, h, b, h, out);
+    MulDispatch(a + h, n - h, b + h, m - h, out + 2 * h);
+    MulDispatch(&sa[0], h + 1, &sb[0], h + 1, &mid[0]);
+
+    SubLimbsInPlace(&mid[0], 2 * h + 2, out, 2 * h);
+    SubLimbsInPlace(&mid[0], 2 * h + 2, out + 2 * h, n + m - 2 * h);
+
+    uint64_t midLen = 2 * h + 2;
+
+    while (midLen > 1 && mid[midLen - 1] == 0)
+        midLen--;
+
+    AddLimbsInPlace(out + h, n + m - h, &mid[0], midLen);
+}
+
+/**
+ * KaratsubaSqr - Karatsuba square of a (n limbs), using the squares of a0, a1
+ * and a0 + a1.
+ *
+ * @param a         [in]        Limbs to square.
+ * @param n         [in]        Number of limbs in a.
+ * @param out       [in/out]    Square limbs, 2n of them.
+ */
+
+static void KaratsubaSqr(const uint64_t* a, const uint64_t n, uint64_t* out)
+{
+    const uint64_t h = (n + 1) / 2;
+
+    vector<uint64_t> sa(h + 1);
+    vector<uint64_t> mid(2 * h + 2);
+
+    AddLimbs(a, h, a + h, n - h, &sa[0]);
+
+    SqrDispatch(a, h, out);
+    SqrDispatch(a + h, n - h, out + 2 * h);
+    SqrDispatch(&sa[0], h + 1, &mid[0]);
+
+    SubLimbsInPlace(&mid[0], 2 * h + 2, out, 2 * h);
+    SubLimbsInPlace(&mid[0], 2 * h + 2, out + 2 * h, 2 * n - 2 * h);
+
+    uint64_t midLen = 2 * h + 2;
+
+    while (midLen > 1 && mid[midLen - 1] == 0)
+        midLen--;
+
+    AddLimbsInPlace(out + h, 2 * n - h, &mid[0], midLen);
+}
+
+/**
+ * MulDispatch - Multiply two limb arrays, picking schoolbook, Karatsuba or
+ * Toom-3 from the operand sizes and the current thresholds. Operands much
+ * longer than the other are cut into slices of the shorter length so each
+ * recursive product stays balanced. Output must hold n + m limbs and must not
+ * alias either input.
+ *
+ * @param a         [in]        First factor limbs.
+ * @param n         [in]        Number of limbs in a.
+ * @param b         [in]        Second factor limbs.
+ * @param m         [in]        Number of limbs in b.
+ * @param out       [in/out]    Product limbs.
+ */
+
+static void MulDispatch(const uint64_t* a, uint64_t n, const uint64_t* b, uint64_t m, uint64_t* out)
+{
+    if (n < m)
+    {
+        swap(a, b);
+        swap(n, m);
+    }
+
+    if (m < gKaratsubaThreshold)
+    {
+        MulLimbs(a, n, b, m, out);
+        return;
+    }
+
+    if (m <= (n + 1) / 2)
+    {
+        vector<uint64_t> partial(2 * m);
+        memset(out, 0, (n + m) * sizeof(uint64_t));
+
+        for (uint64_t off = 0; off < n; off += m)
+        {
+            const uint64_t len = min(m, n - off);
+
+            MulDispatch(a + off, len, b, m, &partial[0]);
+            AddLimbsInPlace(out + off, n + m - off, &partial[0], len + m);
+        }
+
+        return;
+    }
+
+    if (m >= gToom3Threshold && m > 2 * ((n + 2) / 3))
+        Toom3Mul(a, n, b, m, out);
+    else
+        KaratsubaMul(a, n, b, m, out);
+}
+
+/**
+ * SqrDispatch - Square a limb array with schoolbook, Karatsuba or Toom-3
+ * squaring depending on size. Output must hold 2n limbs and must not alias the
+ * input.
+ *
+ * @param a         [in]        Limbs to square.
+ * @param n         [in]        Number of limbs in a.
+ * @param out       [in/out]    Square limbs.
+ */
+
+static void SqrDispatch(const uint64_t* a, const uint64_t n, uint64_t* out)
+{
+    if (n < gSqrKaratsubaThreshold)
+        SqrLimbs(a, n, out);
+    else if (n >= gSqrToom3Threshold)
+        Toom3Sqr(a, n, out);
+    else
+        KaratsubaSqr(a, n, out);
+}
+
 /**
  * ParseBinaryString - Convert an integer represented as a binary string to a
  * binary integer stored as an array of bytes.
@@ -189,7 +775,9 @@ BigInt::BigInt(string val, uint64_t base)
 }
 
 /**
- * BigInt - Construct a big int from a byte array.
+ * BigInt - Construct a big int from a little endian byte array. Leading zero
+ * bytes are trimmed from the input array and the remaining bytes are packed
+ * into 64-bit limbs.
  *
  * @param data       [in] Input integer bytes.
  */
@@ -219,19 +807,12 @@ BigInt::BigInt(vector<uint8_t>& dataIn)
     }
 
     dataIn.resize(nBytes);
-    data.resize(nBytes);
+    data.assign((nBytes + BIGINT_LIMB_BYTES - 1) / BIGINT_LIMB_BYTES, 0);
 
-    if (dataIn.size() == 1 && dataIn[0] == 0)
-    {
-        nBits   = 1;
-        data[0] = 0;
-    }
-    else
-    {
-        nBits = (dataIn.size() - 1) * 8 + (uint64_t)(log2(dataIn[dataIn.size() - 1]) + 1);
-        memcpy(&this->data[0], &dataIn[0], data.size());
-    }
+    for (uint64_t i = 0; i < nBytes; i++)
+        data[i / BIGINT_LIMB_BYTES] |= (uint64_t)dataIn[i] << (8 * (i % BIGINT_LIMB_BYTES));
 
+    Normalize();
 }
 
 /**
@@ -242,48 +823,60 @@ BigInt::BigInt(vector<uint8_t>& dataIn)
 
 BigInt::BigInt(uint64_t val)
 {
-    if (val == 0)
-    {
-        nBits = 1;
-        data.push_back(0);
-        return;
-    }
+    data.assign(1, val);
+    Normalize();
+}
 
-    nBits           = (uint64_t)log2(val) + 1;
-    uint64_t bytes  = BYTES(nBits);
+/**
+ * BigInt::GetBytes - Export this integer as a little endian byte array with
+ * no leading zero bytes. Zero is exported as a single zero byte.
+ *
+ * @param bytes     [in/out] Output integer bytes.
+ */
+
+void BigInt::GetBytes(vector<uint8_t>& bytes) const
+{
+    const uint64_t nBytes = BYTES(nBits);
+    bytes.resize(nBytes);
 
-    data.resize(bytes);
-    memcpy(&data[0], &val, bytes);
+    for (uint64_t i = 0; i < nBytes; i++)
+        bytes[i] = (uint8_t)(data[i / BIGINT_LIMB_BYTES] >> (8 * (i % BIGINT_LIMB_BYTES)));
 }
 
 /**
  * GetDecimalString - Get a decimal string representation of this integer.
+ * Peels off 19 decimal digits at a time, the largest power of ten that fits
+ * in a limb.
  *
  * @return Decimal string representation of this integer.
  */
 
 string BigInt::GetDecimalString()
 {
-    uint8_t remainder   = 0;
-    uint8_t divisor     = 0xA;
-    BigInt quot;
+    const uint64_t chunkDiv     = 10000000000000000000ULL;
+    const uint64_t chunkDigits  = 19;
 
-    const char digitChars[10] =
-    {
-        '0', '1', '2', '3', '4',
-        '5', '6', '7', '8', '9'
-    };
+    uint64_t remainder = 0;
+    BigInt quot;
 
     BigInt tmp = *this;
     string out = "";
 
-    do
+    while (1)
     {
-        DivideU8(tmp, divisor, quot, remainder);
-        out = string{ digitChars[remainder] } + out;
+        DivideU64(tmp, chunkDiv, quot, remainder);
+
+        string chunk = to_string(remainder);
+
+        if (quot == 0)
+        {
+            out = chunk + out;
+            break;
+        }
+
+        out = string(chunkDigits - chunk.length(), '0') + chunk + out;
         tmp = quot;
     }
-    while (quot.data.size() != 0 && quot.data[0] != 0);
 
     return out;
 }
@@ -296,20 +889,23 @@ string BigInt::GetDecimalString()
 
 string BigInt::GetBinaryString()
 {
-    string out = "";
+    string out(nBits, '0');
 
     for (uint64_t i = 0; i < nBits; i++)
     {
-        uint64_t byte   = i / 8;
-        uint64_t bit    = i % 8;
-        out             = (data[byte] & (1 << bit) ? "1" : "0") + out;
+        uint64_t limb   = i / BIGINT_LIMB_BITS;
+        uint64_t bit    = i % BIGINT_LIMB_BITS;
+
+        if ((data[limb] >> bit) & 0x1)
+            out[nBits - i - 1] = '1';
     }
 
     return out;
 }
 
 /**
- * GetHexString - Get a hex string representation of this integer.
+ * GetHexString - Get a hex string representation of this integer. Bytes are
+ * emitted least significant first, low nibble before high nibble.
  *
  * @return Hex string representation of this integer.
  */
@@ -322,14 +918,17 @@ string BigInt::GetHexString()
         '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
     };
 
+    vector<uint8_t> bytes;
+    GetBytes(bytes);
+
     string out = "";
 
-    for (uint64_t i = 0; i < data.size(); i++)
+    for (uint64_t i = 0; i < bytes.size(); i++)
     {
-        uint8_t valLo = data[i] & 0xF;
-        uint8_t valHi = (data[i] & 0xF0) >> 4;
+        uint8_t valLo = bytes[i] & 0xF;
+        uint8_t valHi = (bytes[i] & 0xF0) >> 4;
 
-        if (i == data.size() - 1 && valHi == 0)
+        if (i == bytes.size() - 1 && valHi == 0)
             out = out + string{ hexChars[valLo] };
         else
             out = out + string{ hexChars[valLo] } + string{ hexChars[valHi] };
@@ -354,10 +953,7 @@ bool BigInt::operator==(const BigInt& rhs) const
     if (nBits != rhs.nBits)
         return false;
 
-    if (memcmp(&data[0], &rhs.data[0], data.size()) != 0)
-        return false;
-
-    return true;
+    return CompareLimbs(*this, rhs) == 0;
 }
 
 /**
@@ -370,13 +966,7 @@ bool BigInt::operator==(const BigInt& rhs) const
 
 bool BigInt::operator!=(const BigInt& rhs) const
 {
-    if (nBits != rhs.nBits)
-        return true;
-
-    if (memcmp(&data[0], &rhs.data[0], data.size()) != 0)
-        return true;
-
-    return false;
+    return !(*this == rhs);
 }
 
 /**
@@ -389,17 +979,7 @@ bool BigInt::operator!=(const BigInt& rhs) const
 
 bool BigInt::operator==(const uint64_t rhs)
 {
-    uint64_t nBitsRhs = rhs == 0 ? 1 : (uint64_t)(log2(rhs) + 1);
-    uint64_t rhsBytes = BYTES(nBitsRhs);
-
-    if (rhsBytes != data.size())
-        return false;
-
-    for (uint64_t i = 0; i < data.size(); i++)
-        if (data[i] != (rhs & (0xFF << (8 * i))))
-            return false;
-
-    return true;
+    return data.size() == 1 && data[0] == rhs;
 }
 
 /**
@@ -412,22 +992,7 @@ bool BigInt::operator==(const uint64_t rhs)
 
 bool BigInt::operator>(const BigInt &rhs) const
 {
-    if (nBits > rhs.nBits)
-        return true;
-
-    if (nBits < rhs.nBits)
-        return false;
-
-    for (uint64_t i = data.size(); i-- > 0;)
-        if (data[i] != rhs.data[i])
-        {
-            if (data[i] > rhs.data[i])
-                return true;
-            else
-                return false;
-        }
-
-    return false;
+    return CompareLimbs(*this, rhs) > 0;
 }
 
 /**
@@ -440,22 +1005,7 @@ bool BigInt::operator>(const BigInt &rhs) const
 
 bool BigInt::operator<(const BigInt& rhs) const
 {
-    if (nBits < rhs.nBits)
-        return true;
-
-    if (nBits > rhs.nBits)
-        return false;
-
-    for (uint64_t i = data.size(); i-- > 0;)
-        if (data[i] != rhs.data[i])
-        {
-            if (data[i] < rhs.data[i])
-                return true;
-            else
-                return false;
-        }
-
-    return false;
+    return CompareLimbs(*this, rhs) < 0;
 }
 
 /**
@@ -463,30 +1013,12 @@ bool BigInt::operator<(const BigInt& rhs) const
  *
  * @param rhs       [in] BigInt to compare against.
  *
- * @return          True if this is geq than RHS, false otherwise.
- */
-
-bool BigInt::operator>=(const BigInt& rhs) const
-{
-    if (nBits > rhs.nBits)
-        return true;
-
-    if (nBits < rhs.nBits)
-        return false;
-
-    if (memcmp(&data[0], &rhs.data[0], data.size()) == 0)
-        return true;
-
-    for (uint64_t i = data.size(); i-- > 0;)
-        if (data[i] != rhs.data[i])
-        {
-            if (data[i] > rhs.data[i])
-                return true;
-            else
-                return false;
-        }
+ * @return          True if this is geq than RHS, false otherwise.
+ */
 
-    return false;
+bool BigInt::operator>=(const BigInt& rhs) const
+{
+    return CompareLimbs(*this, rhs) >= 0;
 }
 
 /**
@@ -499,27 +1031,7 @@ bool BigInt::operator>=(const BigInt& rhs) const
 
 bool BigInt::operator<=(const BigInt& rhs) const
 {
-    if (nBits < rhs.nBits)
-        return true;
-
-    if (nBits > rhs.nBits)
-        return false;
-
-    if (memcmp(&data[0], &rhs.data[0], data.size()) == 0)
-        return true;
-
-    for (uint64_t i = data.size(); i-- > 0;)
-    {
-        if (data[i] != rhs.data[i])
-        {
-            if (data[i] < rhs.data[i])
-                return true;
-            else
-                return false;
-        }
-    }
-
-    return false;
+    return CompareLimbs(*this, rhs) <= 0;
 }
 
 /**
@@ -535,9 +1047,8 @@ BigInt& BigInt::operator=(const BigInt& rhs)
 {
     if (this != &rhs)
     {
-        nBits = rhs.nBits;
-        data.resize(rhs.data.size());
-        memcpy(&data[0], &rhs.data[0], data.size());
+        nBits   = rhs.nBits;
+        data    = rhs.data;
     }
 
     return *this;
@@ -553,29 +1064,32 @@ BigInt& BigInt::operator=(const BigInt& rhs)
 
 BigInt& BigInt::operator<<=(uint64_t shift)
 {
-    if (shift == 0)
+    if (shift == 0 || (data.size() == 1 && data[0] == 0))
         return *this;
 
-    uint8_t hiMasks[8]      = { 0x00, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE };
-    uint8_t loMasks[8]      = { 0xFF, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01 };
-    uint8_t shiftCarry      = shift % 8;
+    const uint64_t limbShift    = shift / BIGINT_LIMB_BITS;
+    const uint64_t bitShift     = shift % BIGINT_LIMB_BITS;
+    const uint64_t nLimbs       = data.size();
 
-    uint8_t maskHi          = hiMasks[shiftCarry];
-    uint8_t maskLo          = loMasks[shiftCarry];
+    data.resize(nLimbs + limbShift + 1, 0);
 
-    vector<uint8_t> valsOut(BYTES(8 * data.size() + shift));
-    uint64_t byteShift      = shift / 8;
-
-    for (uint64_t i = 0; i < data.size(); i++)
+    for (uint64_t i = nLimbs; i-- > 0;)
     {
-        uint64_t targetHi   = byteShift + i + ((shift % 8) ? 1 : 0);
-        uint64_t targetLo   = byteShift + i;
-
-        valsOut[targetHi]   |= ((data[i] & maskHi) >> (8 - shiftCarry));
-        valsOut[targetLo]   |= (data[i] & maskLo) << shiftCarry;
+        if (bitShift)
+        {
+            data[i + limbShift + 1] |= data[i] >> (BIGINT_LIMB_BITS - bitShift);
+            data[i + limbShift]     = data[i] << bitShift;
+        }
+        else
+        {
+            data[i + limbShift] = data[i];
+        }
     }
 
-    *this = BigInt(valsOut);
+    for (uint64_t i = 0; i < limbShift; i++)
+        data[i] = 0;
+
+    Normalize();
     return *this;
 }
 
@@ -600,32 +1114,55 @@ BigInt& BigInt::operator>>=(uint64_t shift)
         return *this;
     }
 
-    uint8_t loMasks[8]  = { 0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F };
-    uint8_t hiMasks[8]  = { 0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80 };
-    uint8_t shiftCarry  = shift % 8;
-
-    uint8_t maskLo      = loMasks[shiftCarry];
-    uint8_t maskHi      = hiMasks[shiftCarry];
+    const uint64_t limbShift    = shift / BIGINT_LIMB_BITS;
+    const uint64_t bitShift     = shift % BIGINT_LIMB_BITS;
+    const uint64_t nLimbs       = data.size() - limbShift;
 
-    vector<uint8_t> valsOut(BYTES(8 * data.size() + shift));
-    uint64_t byteShift  = shift / 8;
-
-    for (uint64_t i = 0; i < data.size(); i++)
+    for (uint64_t i = 0; i < nLimbs; i++)
     {
-        int64_t targetLo = i - byteShift - ((shift % 8) ? 1 : 0);
-        int64_t targetHi = i - byteShift;
+        uint64_t lo = data[i + limbShift] >> bitShift;
 
-        if (targetHi >= 0)
-            valsOut[targetHi] |= ((data[i] & maskHi) >> shiftCarry);
+        if (bitShift && i + limbShift + 1 < data.size())
+            lo |= data[i + limbShift + 1] << (BIGINT_LIMB_BITS - bitShift);
 
-        if (targetLo >= 0)
-            valsOut[targetLo] |= (data[i] & maskLo) << (8 - shiftCarry);
+        data[i] = lo;
     }
 
-    *this = BigInt(valsOut);
+    data.resize(nLimbs);
+    Normalize();
     return *this;
 }
 
+/**
+ * BigInt::operator<< - Left shift operator.
+ *
+ * @param shift     [in] How many bits to shift left.
+ *
+ * @return This int shifted left.
+ */
+
+BigInt BigInt::operator<<(uint64_t shift) const
+{
+    BigInt res  = *this;
+    res         <<= shift;
+    return res;
+}
+
+/**
+ * BigInt::operator>> - Right shift operator.
+ *
+ * @param shift     [in] How many bits to shift right.
+ *
+ * @return This int shifted right.
+ */
+
+BigInt BigInt::operator>>(uint64_t shift) const
+{
+    BigInt res  = *this;
+    res         >>= shift;
+    return res;
+}
+
 /**
  * BigInt::operator+= - Compound integer addition operator.
  *
@@ -636,36 +1173,24 @@ BigInt& BigInt::operator>>=(uint64_t shift)
 
 BigInt& BigInt::operator+=(const BigInt& rhs)
 {
-    uint64_t maxBits    = max(nBits, rhs.nBits) + 1;
-    uint64_t outBytes   = BYTES(maxBits);
+    const uint64_t rSize    = rhs.data.size();
+    const uint64_t outLimbs = max(data.size(), rSize) + 1;
 
-    data.resize(outBytes);
+    data.resize(outLimbs, 0);
 
-    uint64_t lSize      = data.size();
-    uint64_t rSize      = rhs.data.size();
-    uint8_t carry       = 0;
+    uint64_t carry = 0;
 
-    for (uint64_t i = 0; i < outBytes; i++)
+    for (uint64_t i = 0; i < outLimbs; i++)
     {
-        uint8_t lVal    = i < lSize ? data[i] : 0;
-        uint8_t rVal    = i < rSize ? rhs.data[i] : 0;
-        uint16_t sum    = lVal + rVal + carry;
-
-        data[i]         = sum & 0xFF;
-        carry           = (sum >> 8) != 0;
-    }
-
-    uint64_t nBytes = data.size();
-
-    for (uint64_t i = data.size(); i-- > 0;)
-        if (data[i] == 0)
-            nBytes--;
-        else 
+        if (i >= rSize && carry == 0)
             break;
 
-    data.resize(nBytes);
-    nBits = 8 * (nBytes - 1) + (uint64_t)(log2(data[data.size() - 1]) + 1);
+        uint128_t sum   = (uint128_t)data[i] + (i < rSize ? rhs.data[i] : 0) + carry;
+        data[i]         = (uint64_t)sum;
+        carry           = (uint64_t)(sum >> 64);
+    }
 
+    Normalize();
     return *this;
 }
 
@@ -685,7 +1210,8 @@ BigInt BigInt::operator+(const BigInt& rhs) const
 }
 
 /**
- * BigInt::operator-= - Compound integer subtraction operator.
+ * BigInt::operator-= - Compound integer subtraction operator. BigInts are
+ * unsigned, so the difference saturates at zero when rhs >= this.
  *
  * @param rhs       [in] Int to subtract from this one.
  *
@@ -694,7 +1220,7 @@ BigInt BigInt::operator+(const BigInt& rhs) const
 
 BigInt& BigInt::operator-=(const BigInt& rhs)
 {
-    if (rhs > *this || rhs == *this)
+    if (CompareLimbs(rhs, *this) >= 0)
     {
         data.resize(1);
         data[0] = 0;
@@ -702,49 +1228,20 @@ BigInt& BigInt::operator-=(const BigInt& rhs)
         return *this;
     }
 
-    uint64_t maxBits    = max(nBits, rhs.nBits) + 1;
-    uint64_t outBytes   = BYTES(maxBits);
-    uint64_t borrow     = 0;
-
-    data.resize(outBytes);
-
-    uint64_t lSize      = data.size();
-    uint64_t rSize      = rhs.data.size();
-
-    for (uint64_t i = 0; i < outBytes; i++)
-    {
-        uint16_t lVal    = i < lSize ? data[i] : 0;
-        uint16_t rVal    = i < rSize ? rhs.data[i] : 0;
-
-        if (borrow)
-        {
-            if (lVal > 0)
-                borrow = 0;
-
-            uint8_t tmp = lVal & 0xFF;
-            tmp--;
-            lVal = tmp;
-        }
-
-        if (rVal > lVal)
-            borrow = 1;
-
-        data[i] = (uint8_t)(256 * borrow + lVal - rVal);
-    }
-
-    uint64_t nBytes = outBytes;
+    const uint64_t rSize    = rhs.data.size();
+    uint64_t borrow         = 0;
 
-    for (uint64_t i = outBytes; i-- > 0; )
+    for (uint64_t i = 0; i < data.size(); i++)
     {
-        if (data[i] == 0)
-            nBytes--;
-        else
+        if (i >= rSize && borrow == 0)
             break;
-    }
 
-    data.resize(nBytes);
-    nBits = 8 * (nBytes - 1) + (uint64_t)(log2(data[nBytes - 1]) + 1);
+        uint128_t diff  = (uint128_t)data[i] - (i < rSize ? rhs.data[i] : 0) - borrow;
+        data[i]         = (uint64_t)diff;
+        borrow          = (diff >> 64) ? 1 : 0;
+    }
 
+    Normalize();
     return *this;
 }
 
@@ -773,39 +1270,7 @@ BigInt BigInt::operator-(const BigInt& rhs) const
 
 BigInt& BigInt::operator*=(const BigInt& rhs)
 {
-    uint64_t n          = data.size();
-    uint64_t m          = rhs.data.size();
-    uint64_t bytesOut   = n + m - 1;
-
-    vector<uint8_t> product;
-    uint32_t carry = 0;
-
-    for (uint64_t i = 0; i < bytesOut; i++)
-    {
-        uint32_t sum = 0;
-
-        for (uint64_t j = 0; j <= i; j++)
-        {
-            uint64_t k = i - j;
-
-            if (j >= n || k >= m)
-                continue;
-
-            sum += data[j] * rhs.data[k];
-        }
-
-        sum += carry;
-
-        uint8_t out     = sum & 0xFF;
-        carry           = sum >> 8;
-
-        product.push_back(out);
-    }
-
-    if (carry)
-        product.push_back(carry);
-
-    *this = BigInt(product);
+    *this = (this == &rhs) ? MulBig(*this, *this) : MulBig(*this, rhs);
     return *this;
 }
 
@@ -824,6 +1289,18 @@ BigInt BigInt::operator*(const BigInt& rhs) const
     return res;
 }
 
+/**
+ * BigInt::Square - Square this integer. Cheaper than a general multiply since
+ * every cross product is only computed once.
+ *
+ * @return  This int squared.
+ */
+
+BigInt BigInt::Square() const
+{
+    return MulBig(*this, *this);
+}
+
 /**
  * BigInt::operator*= - Compound integer multiplication.
  *
@@ -834,22 +1311,19 @@ BigInt BigInt::operator*(const BigInt& rhs) const
 
 BigInt& BigInt::operator*=(const uint8_t rhs)
 {
-    uint16_t dig;
-    uint16_t carry = 0;
-
-    vector<uint8_t> vals;
+    uint64_t carry = 0;
 
     for (uint64_t i = 0; i < data.size(); i++)
     {
-        dig = data[i] * rhs;
-        vals.push_back(dig & 0xFF);
-        carry = dig >> 8;
+        uint128_t prod  = (uint128_t)data[i] * rhs + carry;
+        data[i]         = (uint64_t)prod;
+        carry           = (uint64_t)(prod >> 64);
     }
 
     if (carry)
-        vals.push_back((uint8_t)carry);
+        data.push_back(carry);
 
-    *this = BigInt(vals);
+    Normalize();
     return *this;
 }
 
@@ -878,90 +1352,9 @@ BigInt BigInt::operator*(const uint8_t rhs) const
 
 BigInt& BigInt::operator/=(const BigInt& rhs)
 {
-    if (rhs > *this)
-    {
-        data.resize(1);
-        data[0]     = 0;
-        nBits       = 1;
-        
-        return *this;
-    }
-
-    if (this == &rhs || *this == rhs)
-    {
-        data.resize(1);
-        data[0]     = 1;
-        nBits       = 1;
-        
-        return *this;
-    }
-
-#ifdef BIGINT_DIV_BRUTE
-
-    BigInt rem = *this;
-    BigInt res(0);
-
-    while (1)
-    {
-        BigInt cur = rhs;
-        BigInt quot(1);
-
-        while (cur < rem)
-        {
-            cur     <<= 8;
-            quot    <<= 8;
-        }
-
-        cur     >>= 8;
-        quot    >>= 8;
-
-        BigInt i = 2;
-
-        while ((i * cur) <= rem)
-            i++;
-
-        i--;
-        res += (i * quot);
-        rem -= (i * cur);
-
-        if (rem < rhs)
-            break;
-    }
-
-    *this = res;
+    BigInt rem;
+    DivMod(*this, rhs, *this, rem);
     return *this;
-
-#else
-
-    vector<uint8_t> vals;
-
-    BigInt rem      = *this;
-    uint8_t leadRHS = rhs.data[rhs.data.size() - 1];
-
-    while (1)
-    {
-        uint32_t remSize    = rem.data.size();
-        uint32_t leadDiv    = rem.data[remSize - 1];
-        
-        if (leadDiv < leadRHS)
-            leadDiv = 256 * leadDiv + rem.data[remSize - 2];
-
-        uint8_t curQuot     = leadDiv / leadRHS;
-        BigInt cur          = BigInt(curQuot);
-
-        cur <<= (rem.data[remSize - 1] < leadRHS) ? (8 * (remSize - 2)) : (8 * (remSize - 1));
-
-        vals.insert(vals.begin(), curQuot);
-        rem                 = rem - rhs * cur;
-
-        if (rhs > rem)
-            break;
-    }
-
-    *this = BigInt(vals);
-    return *this;
-
-#endif
 }
 
 /**
@@ -974,82 +1367,9 @@ BigInt& BigInt::operator/=(const BigInt& rhs)
 
 BigInt& BigInt::operator%=(const BigInt& rhs)
 {
-    if (this == &rhs || *this == rhs)
-    {
-        data.resize(1);
-        data[0] = 0;
-        nBits   = 1;
-
-        return *this;
-    }
-
-#ifdef BIGINT_DIV_BRUTE
-
-    BigInt rem = *this;
-
-    while (1)
-    {
-        BigInt cur = rhs;
-        BigInt quot(1);
-
-        while (cur < rem)
-        {
-            cur     <<= 8;
-            quot    <<= 8;
-        }
-
-        cur  >>= 8;
-        quot >>= 8;
-
-        BigInt i = 2;
-
-        while ((i * cur) <= rem)
-            i++;
-
-        i--;
-        rem -= (i * cur);
-
-        if (rem < rhs)
-            break;
-    }
-
-    *this = rem;
-    return *this;
-
-#else
-
-    vector<uint8_t> vals;
-
-    BigInt rem      = *this;
-    uint8_t leadRHS = rhs.data[rhs.data.size() - 1];
-
-    while (1)
-    {
-        uint32_t leadDiv    = rem.data[rem.data.size() - 1];
-        uint64_t i          = 1;
-
-        uint8_t curQuot     = leadDiv / leadRHS;
-        BigInt cur          = BigInt(curQuot);
-
-        vals.insert(vals.begin(), curQuot);
-
-        uint32_t remSzPrev  = rem.data.size();
-        rem                 = rem - rhs * cur;
-
-        if (rhs > rem)
-            break;
-
-        while (remSzPrev - rem.data.size() > 1)
-        {
-            vals.insert(vals.begin(), 0);
-            remSzPrev--;
-        }
-    }
-
-    *this = BigInt(rem);
+    BigInt quot;
+    DivMod(*this, rhs, quot, *this);
     return *this;
-
-#endif
 }
 
 /**
@@ -1078,11 +1398,10 @@ BigInt BigInt::operator%(const BigInt& rhs) const
 BigInt& BigInt::operator/=(const uint8_t rhs)
 {
     BigInt dividend = *this;
-    uint8_t divisor = rhs;
     BigInt quot;
-    uint8_t rem;
+    uint64_t rem;
 
-    DivideU8(dividend, divisor, quot, rem);
+    DivideU64(dividend, rhs, quot, rem);
     *this = quot;
     return *this;
 }
@@ -1110,54 +1429,35 @@ BigInt BigInt::operator/(const BigInt& rhs) const
 
 BigInt& BigInt::operator++(int)
 {
-    uint8_t carry       = 1;
-
     for (uint64_t i = 0; i < data.size(); i++)
-    {
-        uint16_t inc    = (uint16_t)data[i] + carry;
-        data[i]         = inc & 0xFF;
-        carry           = inc >> 8;
-        
-        if (!carry)
-            break;
-    }
-
-    if (carry)
-    {
-        data.push_back(1);
-        nBits++;
-    }
+        if (++data[i] != 0)
+        {
+            Normalize();
+            return *this;
+        }
 
+    data.push_back(1);
+    Normalize();
     return *this;
 }
 
 /**
- * BigInt::operator-- - Decrement this int by 1.
+ * BigInt::operator-- - Decrement this int by 1. Saturates at zero like
+ * subtraction.
  *
  * @return This int - 1.
  */
 
 BigInt& BigInt::operator--(int)
 {
+    if (data.size() == 1 && data[0] == 0)
+        return *this;
+
     for (uint64_t i = 0; i < data.size(); i++)
-    {
-        if (data[i] == 0)
-        {
-            data[i] = 0xFF;
-        }
-        else
-        {
-            data[i]--;
+        if (data[i]-- != 0)
             break;
-        }
-    }
-
-    if (data[data.size() - 1] == 0)
-    {
-        data.resize(data.size() - 1);
-        nBits--;
-    }
 
+    Normalize();
     return *this;
 }
 
@@ -1170,6 +1470,9 @@ BigInt& BigInt::operator--(int)
 
 BigInt BigInt::Sqrt() const
 {
+    if (nBits < 2)
+        return *this;
+
     BigInt out;
     string lo   = string("1") + string(nBits / 2 - 1, '0');
     string hi   = string("1") + string(nBits / 2 + 1, '0');
@@ -1207,34 +1510,145 @@ BigInt BigInt::Sqrt() const
 }
 
 /**
- * DivideU8 - Divide an arbitrary size integer by an input 8-bit int.
+ * DivideU64 - Divide an arbitrary size integer by an input 64-bit int.
  *
  * @param dividend      [in]        Input integer to divide.
- * @param divisor       [in]        Input 8-bit int to divide by.
+ * @param divisor       [in]        Input 64-bit int to divide by.
  * @param quotient      [in/out]    Output quotient.
  * @param rem           [in/out]    Output remainder.
  */
 
-static void DivideU8(const BigInt& dividend, const uint8_t divisor, BigInt& quotient, uint8_t &rem)
+static void DivideU64(const BigInt& dividend, const uint64_t divisor, BigInt& quotient, uint64_t &rem)
 {
-    vector<uint8_t> quot;
-    uint16_t remainder  = 0;
-    uint16_t cur        = 0;
+    if (divisor == 0)
+        throw invalid_argument("BigInt division by zero.");
+
+    vector<uint64_t> quot(dividend.data.size());
+    uint64_t remainder = 0;
 
     for (uint64_t i = dividend.data.size(); i-- > 0;)
     {
-        remainder   <<= 8;
-        cur         = remainder + dividend.data[i];
-        remainder   = cur % divisor;
+        uint128_t cur   = ((uint128_t)remainder << 64) | dividend.data[i];
+        quot[i]         = (uint64_t)(cur / divisor);
+        remainder       = (uint64_t)(cur % divisor);
+    }
 
-        if (i == dividend.data.size() - 1 && cur / divisor == 0)
-            continue;
+    rem             = remainder;
+    quotient.data.swap(quot);
+    quotient.Normalize();
+}
+
+/**
+ * DivMod - Divide two big integers, producing quotient and remainder in one
+ * pass with Knuth's Algorithm D (TAOCP Vol. 2, 4.3.1). The divisor is
+ * normalized so its top limb has the high bit set, which keeps each 2-by-1
+ * limb quotient estimate at most two above the true digit. Outputs may alias
+ * the inputs.
+ *
+ * @param dividend      [in]        Integer to divide.
+ * @param divisor       [in]        Integer to divide by. Must be non-zero.
+ * @param quotient      [in/out]    Output quotient.
+ * @param remainder     [in/out]    Output remainder.
+ */
+
+void DivMod(const BigInt& dividend, const BigInt& divisor, BigInt& quotient, BigInt& remainder)
+{
+    if (divisor.data.size() == 1 && divisor.data[0] == 0)
+        throw invalid_argument("BigInt division by zero.");
+
+    if (CompareLimbs(dividend, divisor) < 0)
+    {
+        remainder   = dividend;
+        quotient    = BigInt(0);
+        return;
+    }
+
+    const uint64_t n = divisor.data.size();
 
-        quot.insert(quot.begin(), cur / divisor);
+    if (n == 1)
+    {
+        uint64_t rem;
+        DivideU64(dividend, divisor.data[0], quotient, rem);
+        remainder = BigInt(rem);
+        return;
+    }
+
+    const uint64_t m        = dividend.data.size() - n;
+    const uint64_t shift    = __builtin_clzll(divisor.data[n - 1]);
+
+    vector<uint64_t> v(n);
+    vector<uint64_t> u(m + n + 1);
+    vector<uint64_t> q(m + 1);
+
+    for (uint64_t i = n; i-- > 0;)
+        v[i] = (divisor.data[i] << shift) | ((shift && i) ? (divisor.data[i - 1] >> (BIGINT_LIMB_BITS - shift)) : 0);
+
+    u[m + n] = shift ? (dividend.data[m + n - 1] >> (BIGINT_LIMB_BITS - shift)) : 0;
+
+    for (uint64_t i = m + n; i-- > 0;)
+        u[i] = (dividend.data[i] << shift) | ((shift && i) ? (dividend.data[i - 1] >> (BIGINT_LIMB_BITS - shift)) : 0);
+
+    const uint64_t vTop     = v[n - 1];
+    const uint64_t vNext    = v[n - 2];
+
+    for (uint64_t j = m + 1; j-- > 0;)
+    {
+        uint128_t num   = ((uint128_t)u[j + n] << 64) | u[j + n - 1];
+        uint128_t qHat  = num / vTop;
+        uint128_t rHat  = num % vTop;
+
+        while ((qHat >> 64) || qHat * vNext > ((rHat << 64) | u[j + n - 2]))
+        {
+            qHat--;
+            rHat += vTop;
+
+            if (rHat >> 64)
+                break;
+        }
+
+        uint64_t carry  = 0;
+        uint64_t borrow = 0;
+
+        for (uint64_t i = 0; i < n; i++)
+        {
+            uint128_t prod  = qHat * v[i] + carry;
+            carry           = (uint64_t)(prod >> 64);
+
+            uint128_t diff  = (uint128_t)u[i + j] - (uint64_t)prod - borrow;
+            u[i + j]        = (uint64_t)diff;
+            borrow          = (diff >> 64) ? 1 : 0;
+        }
+
+        uint128_t diff  = (uint128_t)u[j + n] - carry - borrow;
+        u[j + n]        = (uint64_t)diff;
+
+        if (diff >> 64)
+        {
+            qHat--;
+            carry = 0;
+
+            for (uint64_t i = 0; i < n; i++)
+            {
+                uint128_t sum   = (uint128_t)u[i + j] + v[i] + carry;
+                u[i + j]        = (uint64_t)sum;
+                carry           = (uint64_t)(sum >> 64);
+            }
+
+            u[j + n] += carry;
+        }
+
+        q[j] = (uint64_t)qHat;
     }
 
-    rem         = (uint8_t)remainder;
-    quotient    = BigInt(quot);
+    for (uint64_t i = 0; i < n; i++)
+        u[i] = (u[i] >> shift) | ((shift && i + 1 < n) ? (u[i + 1] << (BIGINT_LIMB_BITS - shift)) : 0);
+
+    u.resize(n);
+
+    quotient.data.swap(q);
+    quotient.Normalize();
+    remainder.data.swap(u);
+    remainder.Normalize();
 }
 
 /**
@@ -1274,8 +1688,7 @@ BigInt GetGCD(BigInt aIn, BigInt bIn)
 
     while (1)
     {
-        q = a / b;
-        r = a % b;
+        DivMod(a, b, q, r);
 
         if (r == 0)
             break;
@@ -1291,7 +1704,8 @@ BigInt GetGCD(BigInt aIn, BigInt bIn)
 
 /**
  * GetModInverse - Solve for the modular inverse k^-1 mod n
- * using the euclidean algorithm. Needed for ECDSA signature generation.
+ * using the euclidean algorithm. Needed for ECDSA signature generation. BigInts
+ * are unsigned, so the Bezout coefficients are kept reduced mod n.
  *
  * @param   k   [in] Value whose inverse to compute.
  * @param   n   [in] Modulus for the inverse.
@@ -1311,14 +1725,18 @@ BigInt GetModInverse(BigInt k, BigInt n)
 
     while (1)
     {
-        q = a / b;
-        r = a % b;
+        DivMod(a, b, q, r);
 
         if (r == 0)
             break;
 
         remainders.push_back(r);
-        coeffsT.push_back(coeffsT[coeffsT.size() - 2] - q * coeffsT[coeffsT.size() - 1]);
+
+        BigInt t = coeffsT[coeffsT.size() - 2] + n;
+        t       -= (q * coeffsT[coeffsT.size() - 1]) % n;
+        t       %= n;
+
+        coeffsT.push_back(t);
 
         a = b;
         b = r;
@@ -1326,8 +1744,5 @@ BigInt GetModInverse(BigInt k, BigInt n)
 
     assert(remainders[remainders.size() - 1] == 1);
 
-    if (coeffsT[coeffsT.size() - 1] < 0)
-        coeffsT[coeffsT.size() - 1] += n;
-
     return coeffsT[coeffsT.size() - 1];
 }
\ No newline at end of file
@@ -32,36 +32,228 @@ map<NISTCurve, DPStrings> curveDomainParams =
     //{ E448, {}}
 };
 
+/**
+ * EllipticCurve - Build a curve from its domain parameters. Field arithmetic mod
+ * q runs in Montgomery form, so the context for q and the Montgomery form of the
+ * curve coefficient a are set up once here, along with a Barrett reducer for the
+ * group order n used by the signature arithmetic.
+ *
+ * @param   paramsIn    [in]    Curve domain parameters.
+ */
+
+EllipticCurve::EllipticCurve(DomainParams& paramsIn) :
+    params(paramsIn),
+    G(paramsIn.G),
+    field(paramsIn.q),
+    aMont(field.ToMont(paramsIn.a)),
+    order(paramsIn.n)
+{
+}
+
+/**
+ * IsInfinity - Affine points store the point at infinity as (0, 0),
+ * which is never on a prime curve with b != 0. Zero is zero in Montgomery form
+ * too, so the check holds in either representation.
+ *
+ * @param   p   [in]    Point to check.
+ *
+ * @return True if p is the point at infinity.
+ */
+
+static bool IsInfinity(const ECPoint& p)
+{
+    return p.x == BigInt(0) && p.y == BigInt(0);
+}
+
+/**
+ * EllipticCurve::InverseMont - Field inverse by Fermat's little theorem,
+ * x^(q - 2) mod q, so no division is needed.
+ *
+ * @param   x   [in]    Non-zero field element in Montgomery form.
+ *
+ * @return x^-1 in Montgomery form.
+ */
+
+BigInt EllipticCurve::InverseMont(const BigInt& x) const
+{
+    return field.Exp(x, params.q - BigInt(2));
+}
+
+/**
+ * EllipticCurve::DoubleMont - Double a point with coordinates in Montgomery form.
+ *
+ * @param   r   [in]    Point to double.
+ *
+ * @return 2r in Montgomery form.
+ */
+
+ECPoint EllipticCurve::DoubleMont(const ECPoint& r) const
+{
+    if (IsInfinity(r) || r.y == BigInt(0))
+        return ECPoint();
+
+    BigInt x2       = field.Sqr(r.x);
+    BigInt num      = field.Add(field.Add(field.Add(x2, x2), x2), aMont);
+    BigInt lambda   = field.Mul(num, InverseMont(field.Add(r.y, r.y)));
+
+    ECPoint res;
+
+    res.x   = field.Sub(field.Sub(field.Sqr(lambda), r.x), r.x);
+    res.y   = field.Sub(field.Mul(lambda, field.Sub(r.x, res.x)), r.y);
+
+    return res;
+}
+
+/**
+ * EllipticCurve::AddMont - Add two points with coordinates in Montgomery form.
+ *
+ * @param   r   [in]    First point.
+ * @param   s   [in]    Second point.
+ *
+ * @return r + s in Montgomery form.
+ */
+
+ECPoint EllipticCurve::AddMont(const ECPoint& r, const ECPoint& s) const
+{
+    if (IsInfinity(r))
+        return s;
+
+    if (IsInfinity(s))
+        return r;
+
+    if (r.x == s.x)
+        return (r.y == s.y) ? DoubleMont(r) : ECPoint();
+
+    BigInt lambda = field.Mul(field.Sub(s.y, r.y), InverseMont(field.Sub(s.x, r.x)));
+
+    ECPoint res;
+
+    res.x   = field.Sub(field.Sub(field.Sqr(lambda), r.x), s.x);
+    res.y   = field.Sub(field.Mul(lambda, field.Sub(r.x, res.x)), r.y);
+
+    return res;
+}
+
 /**
  * EllipticCurve::Add - Add two points on an elliptic curve.
  *
- * @param   k   [in]    Per message k value.
+ * @param   r   [in]    First point.
+ * @param   s   [in]    Second point.
  *
  * @return Sum of r and s over this curve.
  */
 
 ECPoint EllipticCurve::Add(ECPoint r, ECPoint s)
 {
-    assert(r.x != s.x);
-    assert(r.y != s.y);
+    ECPoint rm(field.ToMont(r.x), field.ToMont(r.y));
+    ECPoint sm(field.ToMont(s.x), field.ToMont(s.y));
+    ECPoint res = AddMont(rm, sm);
 
-    BigInt lambda = (s.y - r.y) / (s.x - r.x);
-    lambda %= params.q;
+    return ECPoint(field.FromMont(res.x), field.FromMont(res.y));
+}
 
-    ECPoint res;
+/**
+ * EllipticCurve::DoubleJacobian - Double a point in Jacobian coordinates with
+ * Montgomery form field elements. (X, Y, Z) is the affine point (X/Z^2, Y/Z^3),
+ * so no field inversion is needed. Z = 0 is the point at infinity.
+ *
+ * @param   r   [in]    Point to double.
+ *
+ * @return 2r in Jacobian coordinates.
+ */
+
+ECJacobianPoint EllipticCurve::DoubleJacobian(const ECJacobianPoint& r) const
+{
+    if (r.z == BigInt(0) || r.y == BigInt(0))
+        return ECJacobianPoint();
+
+    BigInt xx   = field.Sqr(r.x);
+    BigInt yy   = field.Sqr(r.y);
+    BigInt zz   = field.Sqr(r.z);
+    BigInt s    = field.Mul(r.x, yy);
+    BigInt m    = field.Add(field.Add(field.Add(xx, xx), xx), field.Mul(aMont, field.Sqr(zz)));
+    BigInt yyyy = field.Sqr(yy);
+
+    s       = field.Add(s, s);
+    s       = field.Add(s, s);
+    yyyy    = field.Add(yyyy, yyyy);
+    yyyy    = field.Add(yyyy, yyyy);
+    yyyy    = field.Add(yyyy, yyyy);
+
+    ECJacobianPoint res;
+
+    res.x   = field.Sub(field.Sub(field.Sqr(m), s), s);
+    res.y   = field.Sub(field.Mul(m, field.Sub(s, res.x)), yyyy);
+    res.z   = field.Mul(field.Add(r.y, r.y), r.z);
+
+    return res;
+}
+
+/**
+ * EllipticCurve::AddMixed - Add an affine point to a point in Jacobian
+ * coordinates, both with Montgomery form field elements.
+ *
+ * @param   r   [in]    Point in Jacobian coordinates.
+ * @param   s   [in]    Affine point.
+ *
+ * @return r + s in Jacobian coordinates.
+ */
+
+ECJacobianPoint EllipticCurve::AddMixed(const ECJacobianPoint& r, const ECPoint& s) const
+{
+    if (IsInfinity(s))
+        return r;
+
+    if (r.z == BigInt(0))
+        return ECJacobianPoint(s.x, s.y, field.one);
+
+    BigInt zz   = field.Sqr(r.z);
+    BigInt u    = field.Mul(s.x, zz);
+    BigInt v    = field.Mul(s.y, field.Mul(r.z, zz));
+    BigInt h    = field.Sub(u, r.x);
+    BigInt w    = field.Sub(v, r.y);
+
+    if (h == BigInt(0))
+        return (w == BigInt(0)) ? DoubleJacobian(r) : ECJacobianPoint();
 
-    res.x   = lambda * lambda - r.x - r.y;
-    res.x   %= params.q;
-    
-    res.y   = lambda * (r.x - res.x) - r.y;
-    res.y   %= params.q;
+    BigInt hh   = field.Sqr(h);
+    BigInt hhh  = field.Mul(h, hh);
+    BigInt xhh  = field.Mul(r.x, hh);
+
+    ECJacobianPoint res;
+
+    res.x   = field.Sub(field.Sub(field.Sub(field.Sqr(w), hhh), xhh), xhh);
+    res.y   = field.Sub(field.Mul(w, field.Sub(xhh, res.x)), field.Mul(r.y, hhh));
+    res.z   = field.Mul(r.z, h);
 
     return res;
 }
 
+/**
+ * EllipticCurve::ToAffine - Convert a point in Jacobian coordinates to affine
+ * coordinates with a single field inversion.
+ *
+ * @param   r   [in]    Point in Jacobian coordinates.
+ *
+ * @return Affine r, still in Montgomery form.
+ */
+
+ECPoint EllipticCurve::ToAffine(const ECJacobianPoint& r) const
+{
+    if (r.z == BigInt(0))
+        return ECPoint();
+
+    BigInt zInv     = InverseMont(r.z);
+    BigInt zInv2    = field.Sqr(zInv);
+
+    return ECPoint(field.Mul(r.x, zInv2), field.Mul(r.y, field.Mul(zInv2, zInv)));
+}
+
 /**
  * EllipticCurve::MultiplyBase - For ECDSA, a per-message random number k
- * is generated. Compute R = kG, where G is the base point of the curve.
+ * is generated. Compute R = kG, where G is the base point of the curve, by
+ * double and add from the most significant bit of k. The running sum is kept
+ * in Jacobian coordinates and converted back to affine once at the end.
  *
  * @param   k   [in]    Per message k value.
  *
@@ -70,36 +262,20 @@ ECPoint EllipticCurve::Add(ECPoint r, ECPoint s)
 
 ECPoint EllipticCurve::MultiplyBase(BigInt k)
 {
-    ECPoint R = G;
-    ECPoint res;
+    ECPoint base(field.ToMont(G.x), field.ToMont(G.y));
+    ECJacobianPoint R;
 
-    for (uint32_t i = 0; i < k.data.size(); i++)
+    for (uint64_t i = k.nBits; i-- > 0;)
     {
-        uint8_t tmp = k.data[i];
-
-        while (tmp)
-        {
-            if (tmp & 0x1)
-            {
-                res.x += R.x;
-                res.y += R.y;
-            }
+        R = DoubleJacobian(R);
 
-            BigInt lambda   = (BigInt(3) * R.x * R.x + params.a) / (BigInt(2) * R.y);
-            lambda %= params.q;
-
-            BigInt x        = lambda * lambda - BigInt(2) * R.x;
-            x %= params.q;
-
-            BigInt y        = lambda * (R.x - x) - R.y;
-            y %= params.q;
-
-            R.x = x;
-            R.y = y;
-        }
+        if ((k.data[i / BIGINT_LIMB_BITS] >> (i % BIGINT_LIMB_BITS)) & 0x1)
+            R = AddMixed(R, base);
     }
 
-    return R;
+    ECPoint res = ToAffine(R);
+
+    return ECPoint(field.FromMont(res.x), field.FromMont(res.y));
 }
 
 /**
@@ -134,11 +310,9 @@ DigSign EllipticCurve::GenerateSignature(vector<uint8_t>& msg, BigInt d, SHASize
     BigInt kInv = GetModInverse(k, params.n);
 
     ECPoint R   = MultiplyBase(k);
-    BigInt r    = R.x;
-    r           %= params.n;
-
-    BigInt s    = kInv * (e + r * d);
-    s           %= params.n;
+    BigInt r    = order.Reduce(R.x);
+    BigInt s    = order.Reduce(order.Mul(r, order.Reduce(d)) + e);
+    s           = order.Mul(kInv, s);
 
     return DigSign({ r, s });
 }
\ No newline at end of file
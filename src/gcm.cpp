@@ -0,0 +1,538 @@
+#include "gcm.h"
+
+static const uint64_t last4[16] =
+{
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static const uint64_t last8[256] =
+{
+    0x0000, 0x01c2, 0x0384, 0x0246, 0x0708, 0x06ca, 0x048c, 0x054e,
+    0x0e10, 0x0fd2, 0x0d94, 0x0c56, 0x0918, 0x08da, 0x0a9c, 0x0b5e,
+    0x1c20, 0x1de2, 0x1fa4, 0x1e66, 0x1b28, 0x1aea, 0x18ac, 0x196e,
+    0x1230, 0x13f2, 0x11b4, 0x1076, 0x1538, 0x14fa, 0x16bc, 0x177e,
+    0x3840, 0x3982, 0x3bc4, 0x3a06, 0x3f48, 0x3e8a, 0x3ccc, 0x3d0e,
+    0x3650, 0x3792, 0x35d4, 0x3416, 0x3158, 0x309a, 0x32dc, 0x331e,
+    0x2460, 0x25a2, 0x27e4, 0x2626, 0x2368, 0x22aa, 0x20ec, 0x212e,
+    0x2a70, 0x2bb2, 0x29f4, 0x2836, 0x2d78, 0x2cba, 0x2efc, 0x2f3e,
+    0x7080, 0x7142, 0x7304, 0x72c6, 0x7788, 0x764a, 0x740c, 0x75ce,
+    0x7e90, 0x7f52, 0x7d14, 0x7cd6, 0x7998, 0x785a, 0x7a1c, 0x7bde,
+    0x6ca0, 0x6d62, 0x6f24, 0x6ee6, 0x6ba8, 0x6a6a, 0x682c, 0x69ee,
+    0x62b0, 0x6372, 0x6134, 0x60f6, 0x65b8, 0x647a, 0x663c, 0x67fe,
+    0x48c0, 0x4902, 0x4b44, 0x4a86, 0x4fc8, 0x4e0a, 0x4c4c, 0x4d8e,
+    0x46d0, 0x4712, 0x4554, 0x4496, 0x41d8, 0x401a, 0x425c, 0x439e,
+    0x54e0, 0x5522, 0x5764, 0x56a6, 0x53e8, 0x522a, 0x506c, 0x51ae,
+    0x5af0, 0x5b32, 0x5974, 0x58b6, 0x5df8, 0x5c3a, 0x5e7c, 0x5fbe,
+    0xe100, 0xe0c2, 0xe284, 0xe346, 0xe608, 0xe7ca, 0xe58c, 0xe44e,
+    0xef10, 0xeed2, 0xec94, 0xed56, 0xe818, 0xe9da, 0xeb9c, 0xea5e,
+    0xfd20, 0xfce2, 0xfea4, 0xff66, 0xfa28, 0xfbea, 0xf9ac, 0xf86e,
+    0xf330, 0xf2f2, 0xf0b4, 0xf176, 0xf438, 0xf5fa, 0xf7bc, 0xf67e,
+    0xd940, 0xd882, 0xdac4, 0xdb06, 0xde48, 0xdf8a, 0xddcc, 0xdc0e,
+    0xd750, 0xd692, 0xd4d4, 0xd516, 0xd058, 0xd19a, 0xd3dc, 0xd21e,
+    0xc560, 0xc4a2, 0xc6e4, 0xc726, 0xc268, 0xc3aa, 0xc1ec, 0xc02e,
+    0xcb70, 0xcab2, 0xc8f4, 0xc936, 0xcc78, 0xcdba, 0xcffc, 0xce3e,
+    0x9180, 0x9042, 0x9204, 0x93c6, 0x9688, 0x974a, 0x950c, 0x94ce,
+    0x9f90, 0x9e52, 0x9c14, 0x9dd6, 0x9898, 0x995a, 0x9b1c, 0x9ade,
+    0x8da0, 0x8c62, 0x8e24, 0x8fe6, 0x8aa8, 0x8b6a, 0x892c, 0x88ee,
+    0x83b0, 0x8272, 0x8034, 0x81f6, 0x84b8, 0x857a, 0x873c, 0x86fe,
+    0xa9c0, 0xa802, 0xaa44, 0xab86, 0xaec8, 0xaf0a, 0xad4c, 0xac8e,
+    0xa7d0, 0xa612, 0xa454, 0xa596, 0xa0d8, 0xa11a, 0xa35c, 0xa29e,
+    0xb5e0, 0xb422, 0xb664, 0xb7a6, 0xb2e8, 0xb32a, 0xb16c, 0xb0ae,
+    0xbbf0, 0xba32, 0xb874, 0xb9b6, 0xbcf8, 0xbd3a, 0xbf7c, 0xbebe
+};
+
+/**
+ * LoadBE64 - Read a big-endian 64-bit value.
+ *
+ * @param p [in] Bytes to read.
+ *
+ * @return Value.
+ */
+
+static inline uint64_t LoadBE64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return REVERSE_ENDIAN64(v);
+}
+
+/**
+ * StoreBE64 - Write a 64-bit value big-endian.
+ *
+ * @param p [out]   Destination bytes.
+ * @param v [in]    Value to write.
+ */
+
+static inline void StoreBE64(uint8_t* p, uint64_t v)
+{
+    v = REVERSE_ENDIAN64(v);
+    memcpy(p, &v, 8);
+}
+
+/**
+ * Inc32 - Increment the rightmost 32 bits of a counter block modulo 2^32
+ * (inc32 in SP 800-38D).
+ *
+ * @param ctr   [in/out] Counter block.
+ */
+
+static inline void Inc32(uint8_t ctr[GCM_BLOCK_BYTES])
+{
+    for (uint32_t i = GCM_BLOCK_BYTES; i-- > GCM_BLOCK_BYTES - 4;)
+    {
+        if (++ctr[i] != 0)
+            break;
+    }
+}
+
+/**
+ * GCM - Constructor. Defaults to fused AES-NI/PCLMULQDQ processing when the CPU
+ * supports it, otherwise to the 8-bit table GHASH.
+ *
+ * @param sz    [in] AES key size to use.
+ */
+
+GCM::GCM(AESSize sz) : cipher(sz, ECB),
+    ghashEngine(AESNIGCMSupported() ? GHASH_PCLMUL : GHASH_8BIT), H{0}, HL4{0}, HH4{0},
+    HL8{0}, HH8{0}, hPowers{0}
+{
+}
+
+/**
+ * GCM::SetKey - Expand the AES key, derive the hash subkey H = E(K, 0^128) and
+ * precompute the GHASH tables for it.
+ *
+ * @param key   [in]    AES key words.
+ */
+
+void GCM::SetKey(const vector<uint32_t>& key)
+{
+    sched.Expand(key, cipher.engine == AES_BITSLICED);
+    cipher.SetKey(sched);
+
+    const uint8_t zero[GCM_BLOCK_BYTES] = { 0 };
+    EncryptBlock(zero, H);
+
+    BuildTables();
+}
+
+/**
+ * GCM::SetEngine - Select the block cipher implementation.
+ *
+ * @param engineIn  [in] AES engine used for the CTR keystream. Leaving the bitsliced
+ *                       engine fills in the table-derived round keys of the schedule.
+ */
+
+void GCM::SetEngine(const AESEngine engineIn)
+{
+    if (engineIn != AES_BITSLICED)
+        sched.ExpandTables();
+
+    cipher.SetEngine(engineIn);
+}
+
+/**
+ * GCM::SetGHASHEngine - Select the GHASH implementation.
+ *
+ * @param ghashEngineIn [in] GHASH_4BIT or GHASH_8BIT for the portable Shoup table
+ *                           methods, or GHASH_PCLMUL for carry-less multiplication.
+ */
+
+void GCM::SetGHASHEngine(const GHASHEngine ghashEngineIn)
+{
+    if (ghashEngineIn == GHASH_PCLMUL && !AESNIGCMSupported())
+        throw invalid_argument("PCLMULQDQ is not supported on this CPU.");
+
+    ghashEngine = ghashEngineIn;
+}
+
+/**
+ * GCM::BuildTables - Precompute multiples of H for Shoup's table-driven GHASH. The
+ * 4-bit table holds H times every 4-bit polynomial (16 entries, 256 bytes) and the
+ * 8-bit table H times every 8-bit polynomial (256 entries, 4 KiB), trading cache
+ * footprint for half the lookups per block. Also store the powers of H used by the
+ * PCLMULQDQ path when it is available.
+ */
+
+void GCM::BuildTables()
+{
+    uint64_t vh = LoadBE64(&H[0]);
+    uint64_t vl = LoadBE64(&H[8]);
+
+    HL4[0] = HH4[0] = HL8[0] = HH8[0] = 0;
+    HL8[128] = vl;
+    HH8[128] = vh;
+
+    for (uint32_t i = 64; i > 0; i >>= 1)
+    {
+        uint64_t t = (vl & 1) * 0xe1000000U;
+
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ (t << 32);
+
+        HL8[i] = vl;
+        HH8[i] = vh;
+    }
+
+    for (uint32_t i = 2; i <= 128; i *= 2)
+    {
+        for (uint32_t j = 1; j < i; j++)
+        {
+            HH8[i + j] = HH8[i] ^ HH8[j];
+            HL8[i + j] = HL8[i] ^ HL8[j];
+        }
+    }
+
+    for (uint32_t i = 1; i < 16; i++)
+    {
+        HL4[i] = HL8[i << 4];
+        HH4[i] = HH8[i << 4];
+    }
+
+    if (AESNIGCMSupported())
+        AESNIGHASHPrecompute(H, hPowers);
+}
+
+/**
+ * GCM::EncryptBlock - Encrypt one block with the selected AES engine.
+ *
+ * @param in    [in]    Input block.
+ * @param out   [out]   Output block. May alias in.
+ */
+
+void GCM::EncryptBlock(const uint8_t in[GCM_BLOCK_BYTES], uint8_t out[GCM_BLOCK_BYTES])
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        cipher.state[i] = (uint32_t)in[4 * i] << 24 | (uint32_t)in[4 * i + 1] << 16 |
+            (uint32_t)in[4 * i + 2] << 8 | in[4 * i + 3];
+    }
+
+    cipher.Cipher();
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t word = REVERSE_ENDIAN32(cipher.state[i]);
+        memcpy(&out[4 * i], &word, 4);
+    }
+}
+
+/**
+ * GCM::MultH - Multiply a field element by H with the selected Shoup table. Bytes are
+ * consumed from the last (highest degree) to the first, shifting the accumulator
+ * right by one table index width per lookup and folding the bits shifted out back in
+ * with the precomputed reduction table.
+ *
+ * @param X [in/out]    Field element to multiply.
+ */
+
+void GCM::MultH(uint8_t X[GCM_BLOCK_BYTES])
+{
+    uint64_t zh;
+    uint64_t zl;
+
+    if (ghashEngine == GHASH_8BIT)
+    {
+        zh = HH8[X[15]];
+        zl = HL8[X[15]];
+
+        for (int32_t i = 14; i >= 0; i--)
+        {
+            uint8_t rem = (uint8_t)zl;
+
+            zl = (zh << 56) | (zl >> 8);
+            zh = (zh >> 8) ^ (last8[rem] << 48);
+            zh ^= HH8[X[i]];
+            zl ^= HL8[X[i]];
+        }
+    }
+    else
+    {
+        zh = HH4[X[15] & 0xF];
+        zl = HL4[X[15] & 0xF];
+
+        for (int32_t i = 15; i >= 0; i--)
+        {
+            uint8_t lo = X[i] & 0xF;
+            uint8_t hi = X[i] >> 4;
+            uint8_t rem;
+
+            if (i != 15)
+            {
+                rem = zl & 0xF;
+                zl  = (zh << 60) | (zl >> 4);
+                zh  = (zh >> 4) ^ (last4[rem] << 48);
+                zh  ^= HH4[lo];
+                zl  ^= HL4[lo];
+            }
+
+            rem = zl & 0xF;
+            zl  = (zh << 60) | (zl >> 4);
+            zh  = (zh >> 4) ^ (last4[rem] << 48);
+            zh  ^= HH4[hi];
+            zl  ^= HL4[hi];
+        }
+    }
+
+    StoreBE64(&X[0], zh);
+    StoreBE64(&X[8], zl);
+}
+
+/**
+ * GCM::GHASHBlocks - Absorb whole blocks into the GHASH accumulator, X = (X + B) H
+ * for each block B.
+ *
+ * @param X         [in/out]    GHASH accumulator.
+ * @param data      [in]        Blocks to absorb.
+ * @param nBlocks   [in]        Number of 16-byte blocks.
+ */
+
+void GCM::GHASHBlocks(uint8_t X[GCM_BLOCK_BYTES], const uint8_t* data, const uint64_t nBlocks)
+{
+    if (ghashEngine == GHASH_PCLMUL)
+    {
+        AESNIGHASH(hPowers, X, data, nBlocks);
+        return;
+    }
+
+    for (uint64_t i = 0; i < nBlocks; i++)
+    {
+        for (uint32_t j = 0; j < GCM_BLOCK_BYTES; j++)
+            X[j] ^= data[GCM_BLOCK_BYTES * i + j];
+
+        MultH(X);
+    }
+}
+
+/**
+ * GCM::GHASHPadded - Absorb a byte string into the GHASH accumulator, zero-padding
+ * the final partial block.
+ *
+ * @param X     [in/out]    GHASH accumulator.
+ * @param data  [in]        Bytes to absorb.
+ * @param len   [in]        Length in bytes.
+ */
+
+void GCM::GHASHPadded(uint8_t X[GCM_BLOCK_BYTES], const uint8_t* data, const uint64_t len)
+{
+    const uint64_t nBlocks = len / GCM_BLOCK_BYTES;
+
+    GHASHBlocks(X, data, nBlocks);
+
+    if (len % GCM_BLOCK_BYTES)
+    {
+        uint8_t pad[GCM_BLOCK_BYTES] = { 0 };
+
+        memcpy(pad, &data[GCM_BLOCK_BYTES * nBlocks], len % GCM_BLOCK_BYTES);
+        GHASHBlocks(X, pad, 1);
+    }
+}
+
+/**
+ * GCM::GHASHLengths - Absorb the final length block [len(A)]64 || [len(C)]64.
+ *
+ * @param X         [in/out]    GHASH accumulator.
+ * @param aadLen    [in]        AAD length in bytes.
+ * @param txtLen    [in]        Text length in bytes.
+ */
+
+void GCM::GHASHLengths(uint8_t X[GCM_BLOCK_BYTES], const uint64_t aadLen, const uint64_t txtLen)
+{
+    uint8_t lenBlock[GCM_BLOCK_BYTES];
+
+    StoreBE64(&lenBlock[0], 8 * aadLen);
+    StoreBE64(&lenBlock[8], 8 * txtLen);
+
+    GHASHBlocks(X, lenBlock, 1);
+}
+
+/**
+ * GCM::ComputeJ0 - Derive the pre-counter block J0 from the IV. A 96-bit IV is used
+ * directly with a 32-bit counter of 1; any other length is hashed.
+ *
+ * @param iv    [in]    Initialization vector.
+ * @param J0    [out]   Pre-counter block.
+ */
+
+void GCM::ComputeJ0(const vector<uint8_t>& iv, uint8_t J0[GCM_BLOCK_BYTES])
+{
+    if (iv.size() == 0)
+        throw invalid_argument("GCM IV must not be empty.");
+
+    if (iv.size() == 12)
+    {
+        memcpy(J0, &iv[0], 12);
+        J0[12] = 0;
+        J0[13] = 0;
+        J0[14] = 0;
+        J0[15] = 1;
+        return;
+    }
+
+    memset(J0, 0, GCM_BLOCK_BYTES);
+    GHASHPadded(J0, &iv[0], iv.size());
+    GHASHLengths(J0, 0, iv.size());
+}
+
+/**
+ * GCM::CryptChunked - Portable CTR encryption/decryption and GHASH in one pass. The
+ * text is processed GCM_CHUNK_BLOCKS blocks at a time: the keystream for a chunk is
+ * generated, applied, and the chunk's ciphertext hashed while it is still in L1.
+ * The chunk's counter blocks go through the cipher in one ECB call, so engines
+ * that work on several blocks at once, like the bitsliced one, get full batches.
+ *
+ * @param ctr       [in/out]    Counter block for the first text block.
+ * @param X         [in/out]    GHASH accumulator.
+ * @param in        [in]        Input text.
+ * @param out       [out]       Output text.
+ * @param len       [in]        Length in bytes.
+ * @param bEncrypt  [in]        True to hash the output, false to hash the input.
+ */
+
+void GCM::CryptChunked(uint8_t ctr[GCM_BLOCK_BYTES], uint8_t X[GCM_BLOCK_BYTES],
+    const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt)
+{
+    const uint64_t chunkBytes = GCM_CHUNK_BLOCKS * GCM_BLOCK_BYTES;
+    uint8_t keyStream[GCM_CHUNK_BLOCKS * GCM_BLOCK_BYTES];
+
+    for (uint64_t offset = 0; offset < len; offset += chunkBytes)
+    {
+        const uint64_t n        = min(chunkBytes, len - offset);
+        const uint64_t nBlocks  = (n + GCM_BLOCK_BYTES - 1) / GCM_BLOCK_BYTES;
+
+        for (uint64_t i = 0; i < nBlocks; i++)
+        {
+            memcpy(&keyStream[GCM_BLOCK_BYTES * i], ctr, GCM_BLOCK_BYTES);
+            Inc32(ctr);
+        }
+
+        cipher.Encrypt(keyStream, keyStream, GCM_BLOCK_BYTES * nBlocks);
+
+        if (!bEncrypt)
+            GHASHPadded(X, &in[offset], n);
+
+        for (uint64_t i = 0; i < n; i++)
+            out[offset + i] = in[offset + i] ^ keyStream[i];
+
+        if (bEncrypt)
+            GHASHPadded(X, &out[offset], n);
+    }
+}
+
+/**
+ * GCM::Crypt - Shared body of GCM encryption and decryption. Hash the AAD, run CTR
+ * from inc32(J0) over the text while hashing the ciphertext, hash the lengths, and
+ * return S = E(K, J0) xor GHASH.
+ *
+ * @param iv        [in]        Initialization vector.
+ * @param aad       [in]        Additional authenticated data.
+ * @param txtIn     [in]        Input text.
+ * @param txtOut    [in/out]    Output text.
+ * @param S         [out]       Full-length authentication tag.
+ * @param bEncrypt  [in]        True for encryption, false for decryption.
+ */
+
+void GCM::Crypt(const vector<uint8_t>& iv, const vector<uint8_t>& aad,
+    const vector<uint8_t>& txtIn, vector<uint8_t>& txtOut,
+    uint8_t S[GCM_BLOCK_BYTES], const bool bEncrypt)
+{
+    assert(txtOut.size() == 0);
+
+    if (txtIn.size() > (1ULL << 36) - 32)
+        throw invalid_argument("GCM text exceeds 2^39 - 256 bits.");
+
+    txtOut.resize(txtIn.size());
+
+    uint8_t J0[GCM_BLOCK_BYTES];
+    uint8_t ctr[GCM_BLOCK_BYTES];
+    uint8_t X[GCM_BLOCK_BYTES] = { 0 };
+
+    ComputeJ0(iv, J0);
+    memcpy(ctr, J0, GCM_BLOCK_BYTES);
+    Inc32(ctr);
+
+    GHASHPadded(X, aad.data(), aad.size());
+
+    if (cipher.engine == AES_AESNI && ghashEngine == GHASH_PCLMUL)
+    {
+        if (bEncrypt)
+            AESNIGCMEncrypt(sched.niEnc, sched.nr, hPowers, ctr, X, txtIn.data(), txtOut.data(), txtIn.size());
+        else
+            AESNIGCMDecrypt(sched.niEnc, sched.nr, hPowers, ctr, X, txtIn.data(), txtOut.data(), txtIn.size());
+    }
+    else
+    {
+        CryptChunked(ctr, X, txtIn.data(), txtOut.data(), txtIn.size(), bEncrypt);
+    }
+
+    GHASHLengths(X, aad.size(), txtIn.size());
+    EncryptBlock(J0, S);
+
+    for (uint32_t i = 0; i < GCM_BLOCK_BYTES; i++)
+        S[i] ^= X[i];
+}
+
+/**
+ * GCM::Encrypt - Authenticated encryption (SP 800-38D GCM-AE).
+ *
+ * @param iv            [in]        Initialization vector. 12 bytes recommended.
+ * @param aad           [in]        Additional authenticated data.
+ * @param plainTxtIn    [in]        Plaintext to be encrypted.
+ * @param ciphTxtOut    [in/out]    Output ciphertext.
+ * @param tagOut        [out]       Authentication tag.
+ * @param tagBytes      [in]        Tag length: 4, 8, or 12 to 16 bytes.
+ */
+
+void GCM::Encrypt(const vector<uint8_t>& iv, const vector<uint8_t>& aad,
+    const vector<uint8_t>& plainTxtIn, vector<uint8_t>& ciphTxtOut,
+    vector<uint8_t>& tagOut, const uint32_t tagBytes)
+{
+    if (tagBytes != 4 && tagBytes != 8 && (tagBytes < 12 || tagBytes > GCM_BLOCK_BYTES))
+        throw invalid_argument("Unsupported GCM tag length.");
+
+    uint8_t S[GCM_BLOCK_BYTES];
+    Crypt(iv, aad, plainTxtIn, ciphTxtOut, S, true);
+
+    tagOut.assign(S, S + tagBytes);
+}
+
+/**
+ * GCM::Decrypt - Authenticated decryption (SP 800-38D GCM-AD). The tag comparison
+ * does not exit early. On failure the plaintext is cleared.
+ *
+ * @param iv            [in]        Initialization vector.
+ * @param aad           [in]        Additional authenticated data.
+ * @param ciphTxtIn     [in]        Ciphertext to be decrypted.
+ * @param tagIn         [in]        Authentication tag to check.
+ * @param plainTxtOut   [in/out]    Output plaintext.
+ *
+ * @return True if the tag is valid.
+ */
+
+bool GCM::Decrypt(const vector<uint8_t>& iv, const vector<uint8_t>& aad,
+    const vector<uint8_t>& ciphTxtIn, const vector<uint8_t>& tagIn,
+    vector<uint8_t>& plainTxtOut)
+{
+    const uint32_t tagBytes = tagIn.size();
+
+    if (tagBytes != 4 && tagBytes != 8 && (tagBytes < 12 || tagBytes > GCM_BLOCK_BYTES))
+        throw invalid_argument("Unsupported GCM tag length.");
+
+    uint8_t S[GCM_BLOCK_BYTES];
+    Crypt(iv, aad, ciphTxtIn, plainTxtOut, S, false);
+
+    uint8_t diff = 0;
+
+    for (uint32_t i = 0; i < tagBytes; i++)
+        diff |= S[i] ^ tagIn[i];
+
+    if (diff != 0)
+    {
+        memset(plainTxtOut.data(), 0, plainTxtOut.size());
+        plainTxtOut.clear();
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
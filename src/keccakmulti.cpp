@@ -0,0 +1,124 @@
+#include "keccakmulti.h"
+
+#ifdef NISTCRYPTO_X86
+
+typedef uint64_t V64x4 __attribute__((vector_size(32)));
+typedef uint64_t V64x8 __attribute__((vector_size(64)));
+
+#define VROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+/**
+ * KeccakF1600Lanes - Keccak-f[1600] on L interleaved states at once. Lane i of
+ * state s lives at a[L * i + s], so each of the 25 lanes loads as one vector and
+ * the round is the same folded Theta/Rho/Pi/Chi/Iota pass as KeccakF1600.
+ *
+ * @param rc    [in]        Round constants.
+ * @param a     [in/out]    25 * L interleaved lanes.
+ */
+
+template <typename V>
+static inline __attribute__((always_inline)) void KeccakF1600Lanes(const uint64_t rc[24], uint64_t* a)
+{
+    const uint32_t L = sizeof(V) / sizeof(uint64_t);
+
+    V s[25];
+    V b[25];
+
+    for (uint32_t i = 0; i < 25; i++)
+        memcpy(&s[i], &a[L * i], sizeof(V));
+
+    for (uint32_t round = 0; round < 24; round++)
+    {
+        const V c0 = s[0] ^ s[5] ^ s[10] ^ s[15] ^ s[20];
+        const V c1 = s[1] ^ s[6] ^ s[11] ^ s[16] ^ s[21];
+        const V c2 = s[2] ^ s[7] ^ s[12] ^ s[17] ^ s[22];
+        const V c3 = s[3] ^ s[8] ^ s[13] ^ s[18] ^ s[23];
+        const V c4 = s[4] ^ s[9] ^ s[14] ^ s[19] ^ s[24];
+
+        const V d0 = c4 ^ VROTL64(c1, 1);
+        const V d1 = c0 ^ VROTL64(c2, 1);
+        const V d2 = c1 ^ VROTL64(c3, 1);
+        const V d3 = c2 ^ VROTL64(c4, 1);
+        const V d4 = c3 ^ VROTL64(c0, 1);
+
+        b[0]  = s[0] ^ d0;
+        b[1]  = VROTL64(s[6] ^ d1, 44);
+        b[2]  = VROTL64(s[12] ^ d2, 43);
+        b[3]  = VROTL64(s[18] ^ d3, 21);
+        b[4]  = VROTL64(s[24] ^ d4, 14);
+        b[5]  = VROTL64(s[3] ^ d3, 28);
+        b[6]  = VROTL64(s[9] ^ d4, 20);
+        b[7]  = VROTL64(s[10] ^ d0, 3);
+        b[8]  = VROTL64(s[16] ^ d1, 45);
+        b[9]  = VROTL64(s[22] ^ d2, 61);
+        b[10] = VROTL64(s[1] ^ d1, 1);
+        b[11] = VROTL64(s[7] ^ d2, 6);
+        b[12] = VROTL64(s[13] ^ d3, 25);
+        b[13] = VROTL64(s[19] ^ d4, 8);
+        b[14] = VROTL64(s[20] ^ d0, 18);
+        b[15] = VROTL64(s[4] ^ d4, 27);
+        b[16] = VROTL64(s[5] ^ d0, 36);
+        b[17] = VROTL64(s[11] ^ d1, 10);
+        b[18] = VROTL64(s[17] ^ d2, 15);
+        b[19] = VROTL64(s[23] ^ d3, 56);
+        b[20] = VROTL64(s[2] ^ d2, 62);
+        b[21] = VROTL64(s[8] ^ d3, 55);
+        b[22] = VROTL64(s[14] ^ d4, 39);
+        b[23] = VROTL64(s[15] ^ d0, 41);
+        b[24] = VROTL64(s[21] ^ d1, 2);
+
+        for (uint32_t y = 0; y < 25; y += 5)
+        {
+            s[y + 0] = b[y + 0] ^ (~b[y + 1] & b[y + 2]);
+            s[y + 1] = b[y + 1] ^ (~b[y + 2] & b[y + 3]);
+            s[y + 2] = b[y + 2] ^ (~b[y + 3] & b[y + 4]);
+            s[y + 3] = b[y + 3] ^ (~b[y + 4] & b[y + 0]);
+            s[y + 4] = b[y + 4] ^ (~b[y + 0] & b[y + 1]);
+        }
+
+        s[0] ^= rc[round];
+    }
+
+    for (uint32_t i = 0; i < 25; i++)
+        memcpy(&a[L * i], &s[i], sizeof(V));
+}
+
+/**
+ * KeccakF1600x4AVX2 - Keccak-f[1600] on four interleaved states.
+ *
+ * @param rc    [in]        Round constants.
+ * @param a     [in/out]    100 interleaved lanes, a[4 * i + s] is lane i of state s.
+ */
+
+__attribute__((target("avx2"))) void KeccakF1600x4AVX2(const uint64_t rc[24],
+    uint64_t a[25 * KECCAK_AVX2_LANES])
+{
+    KeccakF1600Lanes<V64x4>(rc, a);
+}
+
+/**
+ * KeccakF1600x8AVX512 - Keccak-f[1600] on eight interleaved states.
+ *
+ * @param rc    [in]        Round constants.
+ * @param a     [in/out]    200 interleaved lanes, a[8 * i + s] is lane i of state s.
+ */
+
+__attribute__((target("avx512f"))) void KeccakF1600x8AVX512(const uint64_t rc[24],
+    uint64_t a[25 * KECCAK_AVX512_LANES])
+{
+    KeccakF1600Lanes<V64x8>(rc, a);
+}
+
+#else
+
+void KeccakF1600x4AVX2(const uint64_t*, uint64_t*)
+{
+    throw runtime_error("AVX2 is not available on this platform.");
+}
+
+void KeccakF1600x8AVX512(const uint64_t*, uint64_t*)
+{
+    throw runtime_error("AVX-512 is not available on this platform.");
+}
+
+#endif
\ No newline at end of file
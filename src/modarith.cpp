@@ -0,0 +1,575 @@
+#include "modarith.h"
+
+typedef unsigned __int128 uint128_t;
+
+/**
+ * MontgomeryCtx - Build a Montgomery context for an odd modulus m. With
+ * R = 2^(64 n) for an n-limb modulus, precompute -m^-1 mod 2^64 for the
+ * per-limb reduction step, R^2 mod m for conversion into Montgomery form, and
+ * R mod m, the Montgomery form of 1.
+ *
+ * @param modulus   [in] Odd modulus greater than 1.
+ */
+
+MontgomeryCtx::MontgomeryCtx(const BigInt& modulus) : m(modulus)
+{
+    if ((m.data[0] & 0x1) == 0 || m.nBits < 2)
+        throw invalid_argument("Montgomery context requires an odd modulus greater than 1.");
+
+    nLimbs = m.data.size();
+
+    uint64_t inv = m.data[0];
+
+    for (uint32_t i = 0; i < 5; i++)
+        inv *= 2 - m.data[0] * inv;
+
+    mInv = 0 - inv;
+
+    one = BigInt(1);
+    one <<= BIGINT_LIMB_BITS * nLimbs;
+    one %= m;
+
+    r2 = BigInt(1);
+    r2 <<= 2 * BIGINT_LIMB_BITS * nLimbs;
+    r2 %= m;
+}
+
+/**
+ * MontgomeryCtx::Load - Copy an integer less than m into a zero padded n-limb
+ * buffer.
+ *
+ * @param a     [in]        Integer to load.
+ * @param out   [in/out]    Output limbs, nLimbs of them.
+ */
+
+void MontgomeryCtx::Load(const BigInt& a, uint64_t* out) const
+{
+    assert(a.data.size() <= nLimbs);
+
+    memset(out, 0, nLimbs * sizeof(uint64_t));
+    memcpy(out, &a.data[0], a.data.size() * sizeof(uint64_t));
+}
+
+/**
+ * MontgomeryCtx::Reduce - Montgomery reduction of a double width value,
+ * t R^-1 mod m. One limb is cleared per step by adding a multiple of m chosen
+ * with mInv, then the top half is the result up to a final subtraction.
+ *
+ * @param t     [in/out]    Value to reduce, 2 nLimbs + 1 limbs, top limb zero.
+ *                          Used as scratch.
+ *
+ * @return      Reduced value in [0, m).
+ */
+
+BigInt MontgomeryCtx::Reduce(vector<uint64_t>& t) const
+{
+    const uint64_t n    = nLimbs;
+    const uint64_t* mm  = &m.data[0];
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint64_t u      = t[i] * mInv;
+        uint64_t carry  = 0;
+
+        for (uint64_t j = 0; j < n; j++)
+        {
+            uint128_t s = (uint128_t)u * mm[j] + t[i + j] + carry;
+            t[i + j]    = (uint64_t)s;
+            carry       = (uint64_t)(s >> 64);
+        }
+
+        for (uint64_t k = i + n; carry; k++)
+        {
+            uint128_t s = (uint128_t)t[k] + carry;
+            t[k]        = (uint64_t)s;
+            carry       = (uint64_t)(s >> 64);
+        }
+    }
+
+    return Finish(&t[n]);
+}
+
+/**
+ * MontgomeryCtx::ToMont - Convert an integer into Montgomery form, a R mod m.
+ *
+ * @param a     [in] Integer to convert. Reduced mod m first if needed.
+ *
+ * @return      a R mod m.
+ */
+
+BigInt MontgomeryCtx::ToMont(const BigInt& a) const
+{
+    if (a >= m)
+        return Mul(a % m, r2);
+
+    return Mul(a, r2);
+}
+
+/**
+ * MontgomeryCtx::FromMont - Convert an integer out of Montgomery form.
+ *
+ * @param a     [in] Value in Montgomery form, less than m.
+ *
+ * @return      a R^-1 mod m.
+ */
+
+BigInt MontgomeryCtx::FromMont(const BigInt& a) const
+{
+    vector<uint64_t> t(2 * nLimbs + 1, 0);
+    Load(a, &t[0]);
+
+    return Reduce(t);
+}
+
+/**
+ * MontgomeryCtx::Mul - Montgomery product a b R^-1 mod m using the Coarsely
+ * Integrated Operand Scanning (CIOS) method: each limb of b is multiplied in
+ * and one limb of the running sum is reduced away in the same outer pass, so
+ * the working buffer is only n + 2 limbs.
+ *
+ * @param a     [in] First factor in Montgomery form, less than m.
+ * @param b     [in] Second factor in Montgomery form, less than m.
+ *
+ * @return      Product in Montgomery form.
+ */
+
+BigInt MontgomeryCtx::Mul(const BigInt& a, const BigInt& b) const
+{
+    const uint64_t n = nLimbs;
+
+    uint64_t stackBuf[3 * MONTGOMERY_STACK_LIMBS + 2];
+    vector<uint64_t> heapBuf;
+    uint64_t* buf = stackBuf;
+
+    if (n > MONTGOMERY_STACK_LIMBS)
+    {
+        heapBuf.resize(3 * n + 2);
+        buf = &heapBuf[0];
+    }
+
+    uint64_t* aa    = buf;
+    uint64_t* bb    = buf + n;
+    uint64_t* t     = buf + 2 * n;
+
+    Load(a, aa);
+    Load(b, bb);
+    MulLimbs(aa, bb, t);
+
+    return Finish(t);
+}
+
+/**
+ * MontgomeryCtx::MulLimbs - CIOS inner loops on padded n-limb operands.
+ *
+ * @param a     [in]        First factor limbs.
+ * @param b     [in]        Second factor limbs.
+ * @param t     [in/out]    Working buffer of n + 2 limbs. On return the low
+ *                          n + 1 limbs hold a b R^-1, which is less than 2m.
+ */
+
+void MontgomeryCtx::MulLimbs(const uint64_t* a, const uint64_t* b, uint64_t* t) const
+{
+    const uint64_t n    = nLimbs;
+    const uint64_t* mm  = &m.data[0];
+
+    memset(t, 0, (n + 2) * sizeof(uint64_t));
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        uint64_t carry = 0;
+
+        for (uint64_t j = 0; j < n; j++)
+        {
+            uint128_t s = (uint128_t)a[j] * b[i] + t[j] + carry;
+            t[j]        = (uint64_t)s;
+            carry       = (uint64_t)(s >> 64);
+        }
+
+        uint128_t s = (uint128_t)t[n] + carry;
+        t[n]        = (uint64_t)s;
+        t[n + 1]    = (uint64_t)(s >> 64);
+
+        uint64_t u  = t[0] * mInv;
+        s           = (uint128_t)u * mm[0] + t[0];
+        carry       = (uint64_t)(s >> 64);
+
+        for (uint64_t j = 1; j < n; j++)
+        {
+            s           = (uint128_t)u * mm[j] + t[j] + carry;
+            t[j - 1]    = (uint64_t)s;
+            carry       = (uint64_t)(s >> 64);
+        }
+
+        s           = (uint128_t)t[n] + carry;
+        t[n - 1]    = (uint64_t)s;
+        t[n]        = t[n + 1] + (uint64_t)(s >> 64);
+    }
+}
+
+/**
+ * MontgomeryCtx::Finish - Bring an (n + 1)-limb value below 2m into [0, m)
+ * with at most one subtraction and return it as a BigInt.
+ *
+ * @param r     [in/out] Value limbs, n + 1 of them. Used as scratch.
+ *
+ * @return      Reduced value.
+ */
+
+BigInt MontgomeryCtx::Finish(uint64_t* r) const
+{
+    const uint64_t n    = nLimbs;
+    const uint64_t* mm  = &m.data[0];
+
+    bool bGeq = r[n] != 0;
+
+    if (!bGeq)
+    {
+        bGeq = true;
+
+        for (uint64_t i = n; i-- > 0;)
+            if (r[i] != mm[i])
+            {
+                bGeq = r[i] > mm[i];
+                break;
+            }
+    }
+
+    if (bGeq)
+    {
+        uint64_t borrow = 0;
+
+        for (uint64_t i = 0; i < n; i++)
+        {
+            uint128_t diff  = (uint128_t)r[i] - mm[i] - borrow;
+            r[i]            = (uint64_t)diff;
+            borrow          = (diff >> 64) ? 1 : 0;
+        }
+    }
+
+    BigInt out;
+    out.data.assign(r, r + n);
+    out.Normalize();
+
+    return out;
+}
+
+/**
+ * MontgomeryCtx::Sqr - Montgomery square a^2 R^-1 mod m. From
+ * MONTGOMERY_SQR_THRESHOLD limbs up, the full square is formed with
+ * BigInt::Square, which computes each cross product once, and reduced in a
+ * separate pass. Below that the fused CIOS multiply is faster.
+ *
+ * @param a     [in] Value in Montgomery form, less than m.
+ *
+ * @return      Square in Montgomery form.
+ */
+
+BigInt MontgomeryCtx::Sqr(const BigInt& a) const
+{
+    assert(a < m);
+
+    if (nLimbs < MONTGOMERY_SQR_THRESHOLD)
+        return Mul(a, a);
+
+    BigInt sq = a.Square();
+
+    vector<uint64_t> t(2 * nLimbs + 1, 0);
+    memcpy(&t[0], &sq.data[0], sq.data.size() * sizeof(uint64_t));
+
+    return Reduce(t);
+}
+
+/**
+ * MontgomeryCtx::Add - Modular addition. Works in or out of Montgomery form.
+ *
+ * @param a     [in] First addend, less than m.
+ * @param b     [in] Second addend, less than m.
+ *
+ * @return      a + b mod m.
+ */
+
+BigInt MontgomeryCtx::Add(const BigInt& a, const BigInt& b) const
+{
+    BigInt out = a + b;
+
+    if (out >= m)
+        out -= m;
+
+    return out;
+}
+
+/**
+ * MontgomeryCtx::Sub - Modular subtraction. Works in or out of Montgomery form.
+ *
+ * @param a     [in] Minuend, less than m.
+ * @param b     [in] Subtrahend, less than m.
+ *
+ * @return      a - b mod m.
+ */
+
+BigInt MontgomeryCtx::Sub(const BigInt& a, const BigInt& b) const
+{
+    if (a >= b)
+        return a - b;
+
+    return (a + m) - b;
+}
+
+/**
+ * MontgomeryCtx::Exp - Modular exponentiation in Montgomery form with a fixed
+ * window of MONTGOMERY_EXP_WINDOW_BITS bits: the powers a^0 through a^(2^w - 1)
+ * are tabulated, then each window of the exponent costs w squares and at most
+ * one multiply.
+ *
+ * @param a     [in] Base in Montgomery form, less than m.
+ * @param e     [in] Exponent.
+ *
+ * @return      a^e in Montgomery form.
+ */
+
+BigInt MontgomeryCtx::Exp(const BigInt& a, const BigInt& e) const
+{
+    const uint64_t w        = MONTGOMERY_EXP_WINDOW_BITS;
+    const uint64_t tblSize  = 1ULL << w;
+
+    vector<BigInt> tbl(tblSize);
+    tbl[0] = one;
+    tbl[1] = a;
+
+    for (uint64_t i = 2; i < tblSize; i++)
+        tbl[i] = Mul(tbl[i - 1], a);
+
+    const uint64_t nWindows = (e.nBits + w - 1) / w;
+    BigInt out              = one;
+
+    for (uint64_t i = nWindows; i-- > 0;)
+    {
+        if (i != nWindows - 1)
+            for (uint64_t j = 0; j < w; j++)
+                out = Sqr(out);
+
+        uint64_t bit    = i * w;
+        uint64_t win    = e.data[bit / BIGINT_LIMB_BITS] >> (bit % BIGINT_LIMB_BITS);
+
+        if (bit % BIGINT_LIMB_BITS + w > BIGINT_LIMB_BITS && bit / BIGINT_LIMB_BITS + 1 < e.data.size())
+            win |= e.data[bit / BIGINT_LIMB_BITS + 1] << (BIGINT_LIMB_BITS - bit % BIGINT_LIMB_BITS);
+
+        win &= tblSize - 1;
+
+        if (win)
+            out = Mul(out, tbl[win]);
+    }
+
+    return out;
+}
+
+/**
+ * BarrettCtx - Build a Barrett reducer for a modulus m of k limbs. With base
+ * b = 2^64, precompute mu = floor(b^2k / m) once so each later reduction of a
+ * value below b^2k needs two multiplications and no division.
+ *
+ * @param modulus   [in] Modulus greater than 1.
+ */
+
+BarrettCtx::BarrettCtx(const BigInt& modulus) : m(modulus)
+{
+    if (m.nBits < 2)
+        throw invalid_argument("Barrett reducer requires a modulus greater than 1.");
+
+    nLimbs = m.data.size();
+
+    mu = BigInt(1);
+    mu <<= 2 * BIGINT_LIMB_BITS * nLimbs;
+    mu /= m;
+}
+
+/**
+ * BarrettCtx::Reduce - Barrett reduction of x mod m (HAC 14.42). The quotient
+ * estimate floor(floor(x / b^(k-1)) mu / b^(k+1)) is at most two below the true
+ * quotient, so the remainder taken mod b^(k+1) is fixed up with at most two
+ * subtractions of m.
+ *
+ * @param x     [in] Value to reduce, less than b^2k, e.g. a product of two
+ *                   values less than m.
+ *
+ * @return      x mod m.
+ */
+
+BigInt BarrettCtx::Reduce(const BigInt& x) const
+{
+    const uint64_t k    = nLimbs;
+    const uint64_t nx   = x.data.size();
+    const uint64_t nMu  = mu.data.size();
+
+    if (nx > 2 * k)
+        throw invalid_argument("Barrett reduction input must be less than b^2k.");
+
+    if (x < m)
+        return x;
+
+    uint64_t stackBuf[4 * BARRETT_STACK_LIMBS + 8];
+    vector<uint64_t> heapBuf;
+    uint64_t* buf = stackBuf;
+
+    if (k > BARRETT_STACK_LIMBS)
+    {
+        heapBuf.resize(4 * k + 8);
+        buf = &heapBuf[0];
+    }
+
+    const uint64_t* xx  = &x.data[0];
+    const uint64_t* mm  = &m.data[0];
+    const uint64_t* uu  = &mu.data[0];
+    const uint64_t n1   = nx - (k - 1);
+    const uint64_t n2   = n1 + nMu;
+
+    uint64_t* q2    = buf;
+    uint64_t* r     = buf + n2;
+
+    memset(q2, 0, n2 * sizeof(uint64_t));
+
+    for (uint64_t i = 0; i < n1; i++)
+    {
+        uint64_t carry = 0;
+
+        for (uint64_t j = 0; j < nMu; j++)
+        {
+            uint128_t s = (uint128_t)xx[k - 1 + i] * uu[j] + q2[i + j] + carry;
+            q2[i + j]   = (uint64_t)s;
+            carry       = (uint64_t)(s >> 64);
+        }
+
+        q2[i + nMu] = carry;
+    }
+
+    const uint64_t* q3  = q2 + (k + 1);
+    const uint64_t n3   = n2 > k + 1 ? n2 - (k + 1) : 0;
+
+    memset(r, 0, (k + 1) * sizeof(uint64_t));
+
+    for (uint64_t i = 0; i < n3 && i <= k; i++)
+    {
+        uint64_t carry = 0;
+
+        for (uint64_t j = 0; j < k && i + j <= k; j++)
+        {
+            uint128_t s = (uint128_t)q3[i] * mm[j] + r[i + j] + carry;
+            r[i + j]    = (uint64_t)s;
+            carry       = (uint64_t)(s >> 64);
+        }
+
+        if (i == 0)
+            r[k] += carry;
+    }
+
+    uint64_t borrow = 0;
+
+    for (uint64_t i = 0; i <= k; i++)
+    {
+        uint128_t diff  = (uint128_t)(i < nx ? xx[i] : 0) - r[i] - borrow;
+        r[i]            = (uint64_t)diff;
+        borrow          = (diff >> 64) ? 1 : 0;
+    }
+
+    while (1)
+    {
+        bool bGeq = r[k] != 0;
+
+        if (!bGeq)
+        {
+            bGeq = true;
+
+            for (uint64_t i = k; i-- > 0;)
+                if (r[i] != mm[i])
+                {
+                    bGeq = r[i] > mm[i];
+                    break;
+                }
+        }
+
+        if (!bGeq)
+            break;
+
+        borrow = 0;
+
+        for (uint64_t i = 0; i <= k; i++)
+        {
+            uint128_t diff  = (uint128_t)r[i] - (i < k ? mm[i] : 0) - borrow;
+            r[i]            = (uint64_t)diff;
+            borrow          = (diff >> 64) ? 1 : 0;
+        }
+    }
+
+    BigInt out;
+    out.data.assign(r, r + k);
+    out.Normalize();
+
+    return out;
+}
+
+/**
+ * BarrettCtx::Mul - Modular multiplication through the reducer.
+ *
+ * @param a     [in] First factor, less than m.
+ * @param b     [in] Second factor, less than m.
+ *
+ * @return      a b mod m.
+ */
+
+BigInt BarrettCtx::Mul(const BigInt& a, const BigInt& b) const
+{
+    return Reduce(a * b);
+}
+
+/**
+ * BarrettCtx::Sqr - Modular square through the reducer.
+ *
+ * @param a     [in] Value less than m.
+ *
+ * @return      a^2 mod m.
+ */
+
+BigInt BarrettCtx::Sqr(const BigInt& a) const
+{
+    return Reduce(a.Square());
+}
+
+/**
+ * ModExp - Compute base^exp mod m. Odd moduli go through a Montgomery context
+ * so no step needs a division; even moduli fall back to square and multiply
+ * with a reduction after each step.
+ *
+ * @param base  [in] Base.
+ * @param exp   [in] Exponent.
+ * @param mod   [in] Modulus. Must be non-zero.
+ *
+ * @return      base^exp mod m.
+ */
+
+BigInt ModExp(const BigInt& base, const BigInt& exp, const BigInt& mod)
+{
+    if (mod == BigInt(0))
+        throw invalid_argument("ModExp modulus must be non-zero.");
+
+    if (mod == BigInt(1))
+        return BigInt(0);
+
+    if (mod.data[0] & 0x1)
+    {
+        MontgomeryCtx ctx(mod);
+        return ctx.FromMont(ctx.Exp(ctx.ToMont(base), exp));
+    }
+
+    BigInt b    = base % mod;
+    BigInt out  = 1;
+
+    for (uint64_t i = exp.nBits; i-- > 0;)
+    {
+        out = out.Square() % mod;
+
+        if ((exp.data[i / BIGINT_LIMB_BITS] >> (i % BIGINT_LIMB_BITS)) & 0x1)
+            out = (out * b) % mod;
+    }
+
+    return out;
+}
\ No newline at end of file
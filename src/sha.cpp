@@ -1,4 +1,8 @@
 #include "sha.h"
+#include "shani.h"
+#include "sha2multi.h"
+#include "keccakmulti.h"
+#include "threadpool.h"
 
 #define VERBOSE 0
 
@@ -322,6 +326,31 @@ uint64_t SHA2::sig164(uint64_t x)
     return ROTR64(x, 19) ^ ROTR64(x, 61) ^ (x >> 6);
 }
 
+/**
+ * SHA2 - Constructor. Use the SHA extensions for SHA224/256 when the CPU has them.
+ */
+
+SHA2::SHA2() : sz(SHA256), engine(SHANISupported() ? SHA2_SHANI : SHA2_SCALAR),
+    H32{}, H64{}, buf{}, bufLen(0), msgLen(0)
+{
+}
+
+/**
+ * SHA2::SetEngine - Select the SHA224/256 compression implementation. SHA384/512
+ * always use the scalar rounds.
+ *
+ * @param engineIn  [in] SHA2_SCALAR for the portable rounds or SHA2_SHANI for the
+ *                       SHA256RNDS2/SHA256MSG1/SHA256MSG2 instructions.
+ */
+
+void SHA2::SetEngine(const SHA2Engine engineIn)
+{
+    if (engineIn == SHA2_SHANI && !SHANISupported())
+        throw invalid_argument("SHA extensions are not supported on this CPU.");
+
+    engine = engineIn;
+}
+
 void SHA2::Hash(SHASize sz, vector<uint8_t>& msg, vector<uint8_t>& md)
 {
     switch (sz)
@@ -352,186 +381,251 @@ void SHA2::Hash(SHASize sz, vector<uint8_t>& msg, vector<uint8_t>& md)
 }
 
 /**
- * SHA2::Hash224 - Compute the SHA224 of an input message.
+ * SHA2::Init - Reset the streaming context to the initial hash value for the
+ * requested digest size. Must be called before Update/Final.
  *
- * @param msg       [in]        Message to be hashed.
- * @param md        [in/out]    Computed MD of input message.
+ * @param szIn      [in] Digest size to compute.
  */
 
-void SHA2::Hash224(vector<uint8_t>& msg, vector<uint8_t>& md)
+void SHA2::Init(SHASize szIn)
 {
-    assert(md.size() == 0);
-
-    const uint64_t sz               = msg.size();
-    const uint64_t l                = 8 * sz;
-    const uint32_t blockBits        = 512;
-    const uint32_t blockBytes       = 64;
-    const uint32_t scheduleWords    = 64;
-    uint32_t padBytes               = (blockBits - (l % blockBits)) / 8;
+    static const uint32_t init224[8] =
+    {
+        0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+        0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+    };
 
-    if (padBytes <= 8)
-        padBytes += blockBytes;
+    static const uint32_t init256[8] =
+    {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
 
-    vector<uint8_t> tmp(sz + padBytes);
+    static const uint64_t init384[8] =
+    {
+        0xcbbb9d5dc1059ed8, 0x629a292a367cd507, 0x9159015a3070dd17, 0x152fecd8f70e5939,
+        0x67332667ffc00b31, 0x8eb44a8768581511, 0xdb0c2e0d64f98fa7, 0x47b5481dbefa4fa4
+    };
 
-    if (sz)
-        memcpy(&tmp[0], &msg[0], sz);
+    static const uint64_t init512[8] =
+    {
+        0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+        0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+    };
 
-    tmp[sz > 0 ? sz : 0] = 0x80;
+    sz      = szIn;
+    bufLen  = 0;
+    msgLen  = 0;
 
-    for (uint32_t i = 0; i < tmp.size() / 4; i++)
+    switch (sz)
     {
-        uint8_t a       = tmp[4 * i];
-        tmp[4 * i]      = tmp[4 * i + 3];
-        tmp[4 * i + 3]  = a;
+        case SHA224:
+
+            memcpy(H32, init224, sizeof(H32));
+            break;
 
-        a               = tmp[4 * i + 1];
-        tmp[4 * i + 1]  = tmp[4 * i + 2];
-        tmp[4 * i + 2]  = a;
+        case SHA256:
+
+            memcpy(H32, init256, sizeof(H32));
+            break;
+
+        case SHA384:
+
+            memcpy(H64, init384, sizeof(H64));
+            break;
+
+        case SHA512:
+
+            memcpy(H64, init512, sizeof(H64));
+            break;
+
+        default:
+            break;
     }
+}
+
+/**
+ * SHA2::BlockBytes - Get the message block size for the current digest size.
+ *
+ * @return 64 for SHA224/256, 128 for SHA384/512.
+ */
 
-    memcpy(&tmp[tmp.size() - 4], &l, 4);
-    const uint64_t n = tmp.size() / blockBytes;
+uint64_t SHA2::BlockBytes()
+{
+    return (sz == SHA224 || sz == SHA256) ? 64 : 128;
+}
 
-    uint32_t H[8] =
-    {
-        0xc1059ed8,
-        0x367cd507,
-        0x3070dd17,
-        0xf70e5939,
-        0xffc00b31,
-        0x68581511,
-        0x64f98fa7,
-        0xbefa4fa4
-    };
+/**
+ * SHA2::Update - Feed more message bytes into the hash. Any partial block left
+ * over from the previous call is completed first. Full blocks are then compressed
+ * straight out of the caller's buffer and only the trailing partial block is
+ * copied into the context.
+ *
+ * @param data      [in] Message bytes to hash.
+ * @param len       [in] Number of bytes in data.
+ */
+
+void SHA2::Update(const uint8_t* data, uint64_t len)
+{
+    const uint64_t blockBytes = BlockBytes();
 
-    for (uint32_t i = 0; i < n; i++)
+    msgLen += len;
+
+    if (bufLen)
     {
-        uint32_t w[scheduleWords];
+        uint64_t fill = min(blockBytes - bufLen, len);
 
-        memcpy(&w[0], &tmp[blockBytes * i], blockBytes);
+        memcpy(&buf[bufLen], data, fill);
+        bufLen  += fill;
+        data    += fill;
+        len     -= fill;
 
-        for (uint32_t t = 16; t < scheduleWords; t++)
-            w[t] = sig132(w[t - 2]) + w[t - 7] + sig032(w[t - 15]) + w[t - 16];
+        if (bufLen < blockBytes)
+            return;
 
-        uint32_t a = H[0];
-        uint32_t b = H[1];
-        uint32_t c = H[2];
-        uint32_t d = H[3];
-        uint32_t e = H[4];
-        uint32_t f = H[5];
-        uint32_t g = H[6];
-        uint32_t h = H[7];
+        if (blockBytes == 64)
+            Compress256(buf, 1);
+        else
+            Compress512(buf, 1);
 
-        for (uint32_t t = 0; t < scheduleWords; t++)
-        {
-            uint32_t T1 = h + Sig132(e) + ch32(e, f, g) + shaConst32[t] + w[t];
-            uint32_t T2 = Sig032(a) + maj32(a, b, c);
-            h = g;
-            g = f;
-            f = e;
-            e = d + T1;
-            d = c;
-            c = b;
-            b = a;
-            a = T1 + T2;
-        }
+        bufLen = 0;
+    }
+
+    const uint64_t nBlocks = len / blockBytes;
 
-        H[0] = a + H[0];
-        H[1] = b + H[1];
-        H[2] = c + H[2];
-        H[3] = d + H[3];
-        H[4] = e + H[4];
-        H[5] = f + H[5];
-        H[6] = g + H[6];
-        H[7] = h + H[7];
+    if (nBlocks)
+    {
+        if (blockBytes == 64)
+            Compress256(data, nBlocks);
+        else
+            Compress512(data, nBlocks);
+
+        data    += nBlocks * blockBytes;
+        len     -= nBlocks * blockBytes;
+    }
+
+    if (len)
+    {
+        memcpy(buf, data, len);
+        bufLen = len;
     }
+}
 
-    H[0] = REVERSE_ENDIAN32(H[0]);
-    H[1] = REVERSE_ENDIAN32(H[1]);
-    H[2] = REVERSE_ENDIAN32(H[2]);
-    H[3] = REVERSE_ENDIAN32(H[3]);
-    H[4] = REVERSE_ENDIAN32(H[4]);
-    H[5] = REVERSE_ENDIAN32(H[5]);
-    H[6] = REVERSE_ENDIAN32(H[6]);
-    H[7] = REVERSE_ENDIAN32(H[7]);
+/**
+ * SHA2::Update - Feed more message bytes into the hash.
+ *
+ * @param data      [in] Message bytes to hash.
+ */
 
-    md.resize(28);
-    memcpy(&md[0], &H[0], 28);
+void SHA2::Update(const vector<uint8_t>& data)
+{
+    if (data.size())
+        Update(&data[0], data.size());
 }
 
 /**
- * SHA2::Hash256 - Compute the SHA256 of an input message.
+ * SHA2::Final - Pad the buffered tail of the message, compress the last block(s)
+ * and write out the MD. The context must be re-initialized with Init before reuse.
  *
- * @param msg       [in]        Message to be hashed.
- * @param md        [in/out]    Computed MD of input message.
+ * @param md        [in/out] Computed MD of the streamed message. Assumed empty on input.
  */
 
-void SHA2::Hash256(vector<uint8_t>& msg, vector<uint8_t>& md)
+void SHA2::Final(vector<uint8_t>& md)
 {
     assert(md.size() == 0);
 
-    const uint64_t sz               = msg.size();
-    const uint64_t l                = 8 * sz;
-    const uint32_t blockBits        = 512;
-    const uint32_t blockBytes       = 64;
-    const uint32_t scheduleWords    = 64;
-    uint32_t padBytes               = (blockBits - (l % blockBits)) / 8;
+    const uint64_t blockBytes   = BlockBytes();
+    const uint64_t lenBytes     = blockBytes / 8;
+    const uint64_t l            = 8 * msgLen;
+
+    buf[bufLen++] = 0x80;
 
-    if (padBytes <= 8)
-        padBytes += blockBytes;
+    if (bufLen > blockBytes - lenBytes)
+    {
+        memset(&buf[bufLen], 0, blockBytes - bufLen);
+
+        if (blockBytes == 64)
+            Compress256(buf, 1);
+        else
+            Compress512(buf, 1);
+
+        bufLen = 0;
+    }
+
+    memset(&buf[bufLen], 0, blockBytes - bufLen);
 
-    vector<uint8_t> tmp(sz + padBytes);
+    for (uint64_t i = 0; i < 8; i++)
+        buf[blockBytes - 1 - i] = (uint8_t)(l >> (8 * i));
 
-    if (sz)
-        memcpy(&tmp[0], &msg[0], sz);
+    if (lenBytes == 16)
+        buf[blockBytes - 9] = (uint8_t)(msgLen >> 61);
+
+    if (blockBytes == 64)
+    {
+        Compress256(buf, 1);
 
-    tmp[sz > 0 ? sz : 0] = 0x80;
+        md.resize(sz == SHA224 ? 28 : 32);
 
-    for (uint32_t i = 0; i < tmp.size() / 4; i++)
+        for (uint64_t i = 0; i < md.size(); i++)
+            md[i] = (uint8_t)(H32[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    else
     {
-        uint8_t a       = tmp[4 * i];
-        tmp[4 * i]      = tmp[4 * i + 3];
-        tmp[4 * i + 3]  = a;
+        Compress512(buf, 1);
 
-        a               = tmp[4 * i + 1];
-        tmp[4 * i + 1]  = tmp[4 * i + 2];
-        tmp[4 * i + 2]  = a;
+        md.resize(sz == SHA384 ? 48 : 64);
+
+        for (uint64_t i = 0; i < md.size(); i++)
+            md[i] = (uint8_t)(H64[i / 8] >> (56 - 8 * (i % 8)));
     }
 
-    memcpy(&tmp[tmp.size() - 4], &l, 4);
+    bufLen = 0;
+}
 
-    const uint64_t n = tmp.size() / blockBytes;
+/**
+ * SHA2::Compress256 - Run the SHA224/256 compression function over a run of
+ * consecutive 64-byte message blocks. Message words are read big endian directly
+ * from the input so no byte-swapped copy of the message is needed. Hands off to
+ * the SHA extensions when that engine is selected.
+ *
+ * @param blocks    [in] Pointer to the first message block.
+ * @param nBlocks   [in] Number of 64-byte blocks to compress.
+ */
 
-    uint32_t H[8] =
+void SHA2::Compress256(const uint8_t* blocks, uint64_t nBlocks)
+{
+    if (engine == SHA2_SHANI)
     {
-        0x6a09e667,
-        0xbb67ae85,
-        0x3c6ef372,
-        0xa54ff53a,
-        0x510e527f,
-        0x9b05688c,
-        0x1f83d9ab,
-        0x5be0cd19,
-    };
+        SHANICompress256(shaConst32, H32, blocks, nBlocks);
+        return;
+    }
+
+    const uint32_t scheduleWords = 64;
 
-    for (uint32_t i = 0; i < n; i++)
+    for (uint64_t i = 0; i < nBlocks; i++)
     {
+        const uint8_t* block = blocks + 64 * i;
         uint32_t w[scheduleWords];
 
-        memcpy(&w[0], &tmp[blockBytes * i], blockBytes);
+        for (uint32_t t = 0; t < 16; t++)
+        {
+            w[t] = ((uint32_t)block[4 * t] << 24) |
+                ((uint32_t)block[4 * t + 1] << 16) |
+                ((uint32_t)block[4 * t + 2] << 8) |
+                ((uint32_t)block[4 * t + 3]);
+        }
 
         for (uint32_t t = 16; t < scheduleWords; t++)
             w[t] = sig132(w[t - 2]) + w[t - 7] + sig032(w[t - 15]) + w[t - 16];
 
-        uint32_t a = H[0];
-        uint32_t b = H[1];
-        uint32_t c = H[2];
-        uint32_t d = H[3];
-        uint32_t e = H[4];
-        uint32_t f = H[5];
-        uint32_t g = H[6];
-        uint32_t h = H[7];
+        uint32_t a = H32[0];
+        uint32_t b = H32[1];
+        uint32_t c = H32[2];
+        uint32_t d = H32[3];
+        uint32_t e = H32[4];
+        uint32_t f = H32[5];
+        uint32_t g = H32[6];
+        uint32_t h = H32[7];
 
         for (uint32_t t = 0; t < scheduleWords; t++)
         {
@@ -547,110 +641,55 @@ void SHA2::Hash256(vector<uint8_t>& msg, vector<uint8_t>& md)
             a = T1 + T2;
         }
 
-        H[0] = a + H[0];
-        H[1] = b + H[1];
-        H[2] = c + H[2];
-        H[3] = d + H[3];
-        H[4] = e + H[4];
-        H[5] = f + H[5];
-        H[6] = g + H[6];
-        H[7] = h + H[7];
+        H32[0] = a + H32[0];
+        H32[1] = b + H32[1];
+        H32[2] = c + H32[2];
+        H32[3] = d + H32[3];
+        H32[4] = e + H32[4];
+        H32[5] = f + H32[5];
+        H32[6] = g + H32[6];
+        H32[7] = h + H32[7];
     }
-
-    H[0] = REVERSE_ENDIAN32(H[0]);
-    H[1] = REVERSE_ENDIAN32(H[1]);
-    H[2] = REVERSE_ENDIAN32(H[2]);
-    H[3] = REVERSE_ENDIAN32(H[3]);
-    H[4] = REVERSE_ENDIAN32(H[4]);
-    H[5] = REVERSE_ENDIAN32(H[5]);
-    H[6] = REVERSE_ENDIAN32(H[6]);
-    H[7] = REVERSE_ENDIAN32(H[7]);
-
-    md.resize(32);
-    memcpy(&md[0], &H[0], 32);
 }
 
 /**
- * SHA2::Hash384 - Compute the SHA384 of an input message.
+ * SHA2::Compress512 - Run the SHA384/512 compression function over a run of
+ * consecutive 128-byte message blocks read big endian from the input.
  *
- * @param msg       [in]        Message to be hashed.
- * @param md        [in/out]    Computed MD of input message.
+ * @param blocks    [in] Pointer to the first message block.
+ * @param nBlocks   [in] Number of 128-byte blocks to compress.
  */
 
-void SHA2::Hash384(vector<uint8_t>& msg, vector<uint8_t>& md)
+void SHA2::Compress512(const uint8_t* blocks, uint64_t nBlocks)
 {
-    assert(md.size() == 0);
-
-    const uint64_t sz               = msg.size();
-    const uint32_t scheduleWords    = 80;
-    const uint32_t blockBits        = 1024;
-    const uint32_t blockBytes       = 128;
-    const uint64_t l                = 8 * sz;
-    uint64_t padBytes               = (blockBits - (l % blockBits)) / 8;
-
-    if (padBytes <= 16)
-        padBytes += 128;
-
-    vector<uint8_t> tmp(sz + padBytes);
+    const uint32_t scheduleWords = 80;
 
-    if (sz)
-        memcpy(&tmp[0], &msg[0], sz);
-
-    tmp[sz > 0 ? sz : 0] = 0x80;
-
-    for (uint64_t i = 0; i < tmp.size() / 8; i++)
+    for (uint64_t i = 0; i < nBlocks; i++)
     {
-        uint8_t a       = tmp[8 * i];
-        tmp[8 * i]      = tmp[8 * i + 7];
-        tmp[8 * i + 7]  = a;
-
-        a               = tmp[8 * i + 1];
-        tmp[8 * i + 1]  = tmp[8 * i + 6];
-        tmp[8 * i + 6]  = a;
-
-        a               = tmp[8 * i + 2];
-        tmp[8 * i + 2]  = tmp[8 * i + 5];
-        tmp[8 * i + 5]  = a;
-
-        a               = tmp[8 * i + 3];
-        tmp[8 * i + 3]  = tmp[8 * i + 4];
-        tmp[8 * i + 4]  = a;
-    }
-
-    memcpy(&tmp[tmp.size() - 8], &l, 8);
-
-    const uint64_t n = tmp.size() / blockBytes;
+        const uint8_t* block = blocks + 128 * i;
+        uint64_t w[scheduleWords];
 
-    uint64_t H[8] =
-    {
-        0xcbbb9d5dc1059ed8,
-        0x629a292a367cd507,
-        0x9159015a3070dd17,
-        0x152fecd8f70e5939,
-        0x67332667ffc00b31,
-        0x8eb44a8768581511,
-        0xdb0c2e0d64f98fa7,
-        0x47b5481dbefa4fa4,
-    };
+        for (uint32_t t = 0; t < 16; t++)
+        {
+            w[t] = 0;
 
-    for (uint64_t i = 0; i < n; i++)
-    {
-        uint64_t w[scheduleWords];
-        memcpy(&w[0], &tmp[blockBytes * i], blockBytes);
+            for (uint32_t j = 0; j < 8; j++)
+                w[t] = (w[t] << 8) | block[8 * t + j];
+        }
 
-        for (uint64_t t = 16; t < scheduleWords; t++)
+        for (uint32_t t = 16; t < scheduleWords; t++)
             w[t] = sig164(w[t - 2]) + w[t - 7] + sig064(w[t - 15]) + w[t - 16];
 
-        uint64_t a = H[0];
-        uint64_t b = H[1];
-        uint64_t c = H[2];
-        uint64_t d = H[3];
-        uint64_t e = H[4];
-        uint64_t f = H[5];
-        uint64_t g = H[6];
-        uint64_t h = H[7];
+        uint64_t a = H64[0];
+        uint64_t b = H64[1];
+        uint64_t c = H64[2];
+        uint64_t d = H64[3];
+        uint64_t e = H64[4];
+        uint64_t f = H64[5];
+        uint64_t g = H64[6];
+        uint64_t h = H64[7];
 
-        for (uint64_t t = 0; t < scheduleWords; t++)
+        for (uint32_t t = 0; t < scheduleWords; t++)
         {
             uint64_t T1 = h + Sig164(e) + ch64(e, f, g) + shaConst64[t] + w[t];
             uint64_t T2 = Sig064(a) + maj64(a, b, c);
@@ -664,27 +703,57 @@ void SHA2::Hash384(vector<uint8_t>& msg, vector<uint8_t>& md)
             a = T1 + T2;
         }
 
-        H[0] = a + H[0];
-        H[1] = b + H[1];
-        H[2] = c + H[2];
-        H[3] = d + H[3];
-        H[4] = e + H[4];
-        H[5] = f + H[5];
-        H[6] = g + H[6];
-        H[7] = h + H[7];
+        H64[0] = a + H64[0];
+        H64[1] = b + H64[1];
+        H64[2] = c + H64[2];
+        H64[3] = d + H64[3];
+        H64[4] = e + H64[4];
+        H64[5] = f + H64[5];
+        H64[6] = g + H64[6];
+        H64[7] = h + H64[7];
     }
+}
+
+/**
+ * SHA2::Hash224 - Compute the SHA224 of an input message.
+ *
+ * @param msg       [in]        Message to be hashed.
+ * @param md        [in/out]    Computed MD of input message.
+ */
+
+void SHA2::Hash224(vector<uint8_t>& msg, vector<uint8_t>& md)
+{
+    Init(SHA224);
+    Update(msg);
+    Final(md);
+}
+
+/**
+ * SHA2::Hash256 - Compute the SHA256 of an input message.
+ *
+ * @param msg       [in]        Message to be hashed.
+ * @param md        [in/out]    Computed MD of input message.
+ */
+
+void SHA2::Hash256(vector<uint8_t>& msg, vector<uint8_t>& md)
+{
+    Init(SHA256);
+    Update(msg);
+    Final(md);
+}
 
-    H[0] = REVERSE_ENDIAN64(H[0]);
-    H[1] = REVERSE_ENDIAN64(H[1]);
-    H[2] = REVERSE_ENDIAN64(H[2]);
-    H[3] = REVERSE_ENDIAN64(H[3]);
-    H[4] = REVERSE_ENDIAN64(H[4]);
-    H[5] = REVERSE_ENDIAN64(H[5]);
-    H[6] = REVERSE_ENDIAN64(H[6]);
-    H[7] = REVERSE_ENDIAN64(H[7]);
+/**
+ * SHA2::Hash384 - Compute the SHA384 of an input message.
+ *
+ * @param msg       [in]        Message to be hashed.
+ * @param md        [in/out]    Computed MD of input message.
+ */
 
-    md.resize(48);
-    memcpy(&md[0], &H[0], 48);
+void SHA2::Hash384(vector<uint8_t>& msg, vector<uint8_t>& md)
+{
+    Init(SHA384);
+    Update(msg);
+    Final(md);
 }
 
 /**
@@ -696,112 +765,149 @@ void SHA2::Hash384(vector<uint8_t>& msg, vector<uint8_t>& md)
 
 void SHA2::Hash512(vector<uint8_t>& msg, vector<uint8_t>& md)
 {
-    assert(md.size() == 0);
+    Init(SHA512);
+    Update(msg);
+    Final(md);
+}
+
+/**
+ * SHA2Multi::SHA2Multi - Pick the widest multi-buffer engine the CPU supports.
+ */
+
+SHA2Multi::SHA2Multi() : engine(CPUHasFeature(CPU_AVX512) ? SHA2_MULTI_AVX512 :
+    CPUHasFeature(CPU_AVX2) ? SHA2_MULTI_AVX2 : SHA2_MULTI_SERIAL)
+{
+}
 
-    const uint64_t sz               = msg.size();
-    const uint32_t scheduleWords    = 80;
-    const uint32_t blockBits        = 1024;
-    const uint32_t blockBytes       = 128;
-    const uint64_t l                = 8 * sz;
-    uint64_t padBytes               = (blockBits - (l % blockBits)) / 8;
+/**
+ * SHA2Multi::SetEngine - Select how a batch of messages is hashed.
+ *
+ * @param engineIn  [in] SHA2_MULTI_SERIAL to run SHA2 over each message in turn,
+ *                       SHA2_MULTI_AVX2 or SHA2_MULTI_AVX512 to hash one message
+ *                       per SIMD lane.
+ */
+
+void SHA2Multi::SetEngine(const SHA2MultiEngine engineIn)
+{
+    if (engineIn == SHA2_MULTI_AVX2 && !CPUHasFeature(CPU_AVX2))
+        throw invalid_argument("AVX2 is not supported on this CPU.");
 
-    if (padBytes <= 16)
-        padBytes += 128;
+    if (engineIn == SHA2_MULTI_AVX512 && !CPUHasFeature(CPU_AVX512))
+        throw invalid_argument("AVX-512 is not supported on this CPU.");
 
-    vector<uint8_t> tmp(sz + padBytes);
+    engine = engineIn;
+}
 
-    if (sz)
-        memcpy(&tmp[0], &msg[0], sz);
+/**
+ * SHA2Multi::Lanes - Number of messages the current engine hashes at once.
+ *
+ * @param sz    [in] SHA2 variant.
+ *
+ * @return Lane count, 1 for the serial engine.
+ */
 
-    tmp[sz > 0 ? sz : 0] = 0x80;
+uint32_t SHA2Multi::Lanes(const SHASize sz)
+{
+    const bool b256 = (sz == SHA224 || sz == SHA256);
 
-    for (uint64_t i = 0; i < tmp.size() / 8; i++)
+    switch (engine)
     {
-        uint8_t a       = tmp[8 * i];
-        tmp[8 * i]      = tmp[8 * i + 7];
-        tmp[8 * i + 7]  = a;
+        case SHA2_MULTI_AVX2:
+
+            return b256 ? SHA256_AVX2_LANES : SHA512_AVX2_LANES;
 
-        a               = tmp[8 * i + 1];
-        tmp[8 * i + 1]  = tmp[8 * i + 6];
-        tmp[8 * i + 6]  = a;
+        case SHA2_MULTI_AVX512:
 
-        a               = tmp[8 * i + 2];
-        tmp[8 * i + 2]  = tmp[8 * i + 5];
-        tmp[8 * i + 5]  = a;
+            return b256 ? SHA256_AVX512_LANES : SHA512_AVX512_LANES;
 
-        a               = tmp[8 * i + 3];
-        tmp[8 * i + 3]  = tmp[8 * i + 4];
-        tmp[8 * i + 4]  = a;
+        default:
+            return 1;
     }
+}
+
+/**
+ * SHA2Multi::Hash - Hash a batch of independent messages. The SIMD engines keep
+ * one message per lane and refill a lane as soon as its message is done, so the
+ * messages may have any mix of lengths.
+ *
+ * @param sz        [in]    SHA2 variant.
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param mds       [out]   Digests, numMsgs * digest bytes, back to back in message order.
+ * @param numMsgs   [in]    Number of messages.
+ */
 
-    memcpy(&tmp[tmp.size() - 8], &l, 8);
+void SHA2Multi::Hash(const SHASize sz, const uint8_t* const* msgs, const uint64_t* lens,
+    uint8_t* mds, const uint64_t numMsgs)
+{
+    static const uint32_t mdBytes[4] = { 28, 32, 48, 64 };
 
-    const uint64_t n = tmp.size() / blockBytes;
+    SHA2 sha;
+    sha.Init(sz);
 
-    uint64_t H[8] =
+    if (engine == SHA2_MULTI_SERIAL)
     {
-        0x6a09e667f3bcc908,
-        0xbb67ae8584caa73b,
-        0x3c6ef372fe94f82b,
-        0xa54ff53a5f1d36f1,
-        0x510e527fade682d1,
-        0x9b05688c2b3e6c1f,
-        0x1f83d9abfb41bd6b,
-        0x5be0cd19137e2179
-    };
+        for (uint64_t i = 0; i < numMsgs; i++)
+        {
+            vector<uint8_t> md;
+
+            sha.Init(sz);
+            sha.Update(msgs[i], lens[i]);
+            sha.Final(md);
+            memcpy(&mds[mdBytes[sz] * i], &md[0], mdBytes[sz]);
+        }
+
+        return;
+    }
 
-    for (uint64_t i = 0; i < n; i++)
+    const bool bAVX512 = (engine == SHA2_MULTI_AVX512);
+
+    if (sz == SHA224 || sz == SHA256)
     {
-        uint64_t w[scheduleWords];
-        memcpy(&w[0], &tmp[blockBytes * i], blockBytes);
+        if (bAVX512)
+            SHA256HashManyAVX512(shaConst32, sha.H32, mdBytes[sz], msgs, lens, mds, numMsgs);
+        else
+            SHA256HashManyAVX2(shaConst32, sha.H32, mdBytes[sz], msgs, lens, mds, numMsgs);
+    }
+    else
+    {
+        if (bAVX512)
+            SHA512HashManyAVX512(shaConst64, sha.H64, mdBytes[sz], msgs, lens, mds, numMsgs);
+        else
+            SHA512HashManyAVX2(shaConst64, sha.H64, mdBytes[sz], msgs, lens, mds, numMsgs);
+    }
+}
 
-        for (uint64_t t = 16; t < scheduleWords; t++)
-            w[t] = sig164(w[t - 2]) + w[t - 7] + sig064(w[t - 15]) + w[t - 16];
+/**
+ * SHA2Multi::Hash - Hash a batch of independent messages.
+ *
+ * @param sz    [in]    SHA2 variant.
+ * @param msgs  [in]    Messages.
+ * @param mds   [out]   One digest per message.
+ */
+
+void SHA2Multi::Hash(const SHASize sz, const vector<vector<uint8_t>>& msgs, vector<vector<uint8_t>>& mds)
+{
+    static const uint32_t mdBytes[4] = { 28, 32, 48, 64 };
 
-        uint64_t a = H[0];
-        uint64_t b = H[1];
-        uint64_t c = H[2];
-        uint64_t d = H[3];
-        uint64_t e = H[4];
-        uint64_t f = H[5];
-        uint64_t g = H[6];
-        uint64_t h = H[7];
+    const uint64_t numMsgs = msgs.size();
 
-        for (uint64_t t = 0; t < scheduleWords; t++)
-        {
-            uint64_t T1 = h + Sig164(e) + ch64(e, f, g) + shaConst64[t] + w[t];
-            uint64_t T2 = Sig064(a) + maj64(a, b, c);
-            h = g;
-            g = f;
-            f = e;
-            e = d + T1;
-            d = c;
-            c = b;
-            b = a;
-            a = T1 + T2;
-        }
+    vector<const uint8_t*> ptrs(numMsgs);
+    vector<uint64_t> lens(numMsgs);
+    vector<uint8_t> out(numMsgs * mdBytes[sz]);
 
-        H[0] = a + H[0];
-        H[1] = b + H[1];
-        H[2] = c + H[2];
-        H[3] = d + H[3];
-        H[4] = e + H[4];
-        H[5] = f + H[5];
-        H[6] = g + H[6];
-        H[7] = h + H[7];
+    for (uint64_t i = 0; i < numMsgs; i++)
+    {
+        ptrs[i] = msgs[i].data();
+        lens[i] = msgs[i].size();
     }
 
-    H[0] = REVERSE_ENDIAN64(H[0]);
-    H[1] = REVERSE_ENDIAN64(H[1]);
-    H[2] = REVERSE_ENDIAN64(H[2]);
-    H[3] = REVERSE_ENDIAN64(H[3]);
-    H[4] = REVERSE_ENDIAN64(H[4]);
-    H[5] = REVERSE_ENDIAN64(H[5]);
-    H[6] = REVERSE_ENDIAN64(H[6]);
-    H[7] = REVERSE_ENDIAN64(H[7]);
+    Hash(sz, ptrs.data(), lens.data(), out.data(), numMsgs);
 
-    md.resize(64);
-    memcpy(&md[0], &H[0], 64);
+    mds.resize(numMsgs);
+
+    for (uint64_t i = 0; i < numMsgs; i++)
+        mds[i].assign(&out[mdBytes[sz] * i], &out[mdBytes[sz] * (i + 1)]);
 }
 
 /**
@@ -890,7 +996,9 @@ SHA3::SHA3(SHASize sz)
     params.w    = 64;
     params.l    = 6;
     params.n    = 12 + 2 * params.l;
-    stream      = SHAStreamer(params.r);
+    stream          = SHAStreamer(params.r);
+    bufLen          = 0;
+    squeezeOffset   = 0;
 
     memset(state, 0, STATE_W * STATE_H * STATE_L / 8);
 }
@@ -954,11 +1062,28 @@ void SHA3::PrintState(PrintMode)
 
 void SHA3::SpongeAbsorbBlock(vector<uint64_t>& block)
 {
-    const uint8_t rateWords = params.r / 64;
-    assert(block.size() == rateWords);
+    assert(block.size() == params.r / 64);
+    SpongeAbsorbBlock(reinterpret_cast<const uint8_t*>(&block[0]));
+}
+
+/**
+ * SHA3::SpongeAbsorbBlock - XOR a rate-sized message block read directly
+ * from memory into the state array and run Keccak permutations on it. Lanes
+ * are loaded little endian, matching the SHAStreamer block layout.
+ *
+ * @param block    [in] Pointer to r / 8 bytes of message to absorb.
+ */
+
+void SHA3::SpongeAbsorbBlock(const uint8_t* block)
+{
+    const uint64_t rateWords = params.r / 64;
 
     for (uint64_t i = 0; i < rateWords; i++)
-        state[i] ^= block[i];
+    {
+        uint64_t lane;
+        memcpy(&lane, block + 8 * i, 8);
+        state[i] ^= lane;
+    }
 
 #if VERBOSE
 
@@ -977,18 +1102,103 @@ void SHA3::SpongeAbsorbBlock(vector<uint64_t>& block)
 }
 
 /**
- * SHA3::ApplyKeccak - Apply the step transformtions to the state array
- * for the specified number of rounds.
+ * KeccakF1600 - Apply the full 24 round Keccak-f[1600] permutation to a state
+ * array, operating on whole 64-bit lanes. Theta, Rho, Pi, Chi and Iota are
+ * folded together into a single pass over the lanes per round, so this matches
+ * SHA3::Theta() through SHA3::Iota() applied in sequence but without the
+ * per-bit GetBit/SetBit traffic.
+ *
+ * @param a    [in/out] State array of 25 lanes, indexed by LANE(x, y).
  */
 
-void SHA3::ApplyKeccak()
+void KeccakF1600(uint64_t a[STATE_W * STATE_H])
 {
-    for (uint64_t i = 0; i < params.n; i++)
+    uint64_t b[STATE_W * STATE_H];
+
+    for (uint64_t round = 0; round < NUM_SHA3_ROUNDS; round++)
     {
+        const uint64_t c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+        const uint64_t c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+        const uint64_t c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+        const uint64_t c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+        const uint64_t c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+
+        const uint64_t d0 = c4 ^ ROTL64(c1, 1);
+        const uint64_t d1 = c0 ^ ROTL64(c2, 1);
+        const uint64_t d2 = c1 ^ ROTL64(c3, 1);
+        const uint64_t d3 = c2 ^ ROTL64(c4, 1);
+        const uint64_t d4 = c3 ^ ROTL64(c0, 1);
+
+        b[0]  = a[0] ^ d0;
+        b[1]  = ROTL64(a[6] ^ d1, 44);
+        b[2]  = ROTL64(a[12] ^ d2, 43);
+        b[3]  = ROTL64(a[18] ^ d3, 21);
+        b[4]  = ROTL64(a[24] ^ d4, 14);
+        b[5]  = ROTL64(a[3] ^ d3, 28);
+        b[6]  = ROTL64(a[9] ^ d4, 20);
+        b[7]  = ROTL64(a[10] ^ d0, 3);
+        b[8]  = ROTL64(a[16] ^ d1, 45);
+        b[9]  = ROTL64(a[22] ^ d2, 61);
+        b[10] = ROTL64(a[1] ^ d1, 1);
+        b[11] = ROTL64(a[7] ^ d2, 6);
+        b[12] = ROTL64(a[13] ^ d3, 25);
+        b[13] = ROTL64(a[19] ^ d4, 8);
+        b[14] = ROTL64(a[20] ^ d0, 18);
+        b[15] = ROTL64(a[4] ^ d4, 27);
+        b[16] = ROTL64(a[5] ^ d0, 36);
+        b[17] = ROTL64(a[11] ^ d1, 10);
+        b[18] = ROTL64(a[17] ^ d2, 15);
+        b[19] = ROTL64(a[23] ^ d3, 56);
+        b[20] = ROTL64(a[2] ^ d2, 62);
+        b[21] = ROTL64(a[8] ^ d3, 55);
+        b[22] = ROTL64(a[14] ^ d4, 39);
+        b[23] = ROTL64(a[15] ^ d0, 41);
+        b[24] = ROTL64(a[21] ^ d1, 2);
+
+        a[0]  = b[0] ^ (~b[1] & b[2]);
+        a[1]  = b[1] ^ (~b[2] & b[3]);
+        a[2]  = b[2] ^ (~b[3] & b[4]);
+        a[3]  = b[3] ^ (~b[4] & b[0]);
+        a[4]  = b[4] ^ (~b[0] & b[1]);
+        a[5]  = b[5] ^ (~b[6] & b[7]);
+        a[6]  = b[6] ^ (~b[7] & b[8]);
+        a[7]  = b[7] ^ (~b[8] & b[9]);
+        a[8]  = b[8] ^ (~b[9] & b[5]);
+        a[9]  = b[9] ^ (~b[5] & b[6]);
+        a[10] = b[10] ^ (~b[11] & b[12]);
+        a[11] = b[11] ^ (~b[12] & b[13]);
+        a[12] = b[12] ^ (~b[13] & b[14]);
+        a[13] = b[13] ^ (~b[14] & b[10]);
+        a[14] = b[14] ^ (~b[10] & b[11]);
+        a[15] = b[15] ^ (~b[16] & b[17]);
+        a[16] = b[16] ^ (~b[17] & b[18]);
+        a[17] = b[17] ^ (~b[18] & b[19]);
+        a[18] = b[18] ^ (~b[19] & b[15]);
+        a[19] = b[19] ^ (~b[15] & b[16]);
+        a[20] = b[20] ^ (~b[21] & b[22]);
+        a[21] = b[21] ^ (~b[22] & b[23]);
+        a[22] = b[22] ^ (~b[23] & b[24]);
+        a[23] = b[23] ^ (~b[24] & b[20]);
+        a[24] = b[24] ^ (~b[20] & b[21]);
+
+        a[0] ^= rcs[round];
+    }
+}
 
-#if VERBOSE
+/**
+ * SHA3::ApplyKeccak - Apply the step transformtions to the state array
+ * for the specified number of rounds. The lane-based KeccakF1600 is used
+ * normally. With VERBOSE set, the reference bit-level steps are run one at
+ * a time instead so the state can be printed after each step.
+ */
+
+void SHA3::ApplyKeccak()
+{
+#if VERBOSE
 
-        printf("Round %llu:\n", i);
+    for (uint64_t i = 0; i < params.n; i++)
+    {
+        printf("Round %lu:\n", i);
 
         printf("Theta\n");
         Theta();
@@ -1009,23 +1219,19 @@ void SHA3::ApplyKeccak()
         printf("Iota\n\n");
         Iota(i);
         PrintState(LINEAR);
+    }
 
 #else
 
-        Theta();
-        Rho();
-        Pi();
-        Chi();
-        Iota(i);
+    KeccakF1600(state);
 
 #endif
-    }
 }
 
 /**
  * SHA3::SpongeSqueezeBlock - After absorbing all message inputs
  * and applying permutations, "squeeze" MD of desired length out
- * in blocks of size channel rate and put into an output MD byte
+ * in blocks of size channel rate and append it to an output MD byte
  * array.
  * 
  * @param md    [in/out] Hash of length d (512 for SHA512, 256 for
@@ -1034,28 +1240,45 @@ void SHA3::ApplyKeccak()
 
 void SHA3::SpongeSqueezeBlock(vector<uint8_t>& md)
 {
-    vector<uint64_t> z;
-    const uint64_t rateWords    = params.r / 64;
     const uint64_t digestBytes  = params.d / 8;
+    const uint64_t offset       = md.size();
 
-    while (z.size() < digestBytes)
+    md.resize(offset + digestBytes);
+
+    squeezeOffset = 0;
+    Squeeze(&md[offset], digestBytes);
+}
+
+/**
+ * SHA3::Squeeze - Copy the next len bytes of sponge output into a caller buffer,
+ * permuting whenever a rate block is used up. Output continues where the last
+ * call stopped, so repeated calls yield one contiguous output stream. Lanes are
+ * stored little endian, matching SpongeAbsorbBlock.
+ *
+ * @param out   [out]   Output buffer of at least len bytes.
+ * @param len   [in]    Number of bytes to squeeze.
+ */
+
+void SHA3::Squeeze(uint8_t* out, uint64_t len)
+{
+    const uint64_t rateBytes = params.r / 8;
+
+    while (len)
     {
-        for (uint64_t i = 0; i < rateWords; i++)
+        if (squeezeOffset == rateBytes)
         {
-            for (uint64_t j = 0; j < 8; j++)
-            {
-                uint64_t byte   = state[i] & (0xFFLLU << (j * 8));
-                byte            >>= (j * 8);
-
-                z.push_back((uint8_t)byte);
-            }
+            ApplyKeccak();
+            squeezeOffset = 0;
         }
 
-        ApplyKeccak();
-    }
+        const uint64_t n = min(rateBytes - squeezeOffset, len);
+
+        memcpy(out, reinterpret_cast<const uint8_t*>(state) + squeezeOffset, n);
 
-    for (uint64_t i = 0; i < digestBytes; i++)
-        md.push_back(z[i]);
+        squeezeOffset   += n;
+        out             += n;
+        len             -= n;
+    }
 }
 
 /**
@@ -1186,6 +1409,112 @@ void SHA3::Iota(uint64_t round)
     state[LANE(0, 0)] ^= rcs[round];
 }
 
+/**
+ * SHA3::Init - Clear the sponge so a new message can be streamed in with
+ * Update and finished with Final.
+ */
+
+void SHA3::Init()
+{
+    ClearState();
+    bufLen          = 0;
+    squeezeOffset   = 0;
+}
+
+/**
+ * SHA3::Update - Absorb more message bytes. A partial block left by the
+ * previous call is topped up first, then full rate-sized blocks are XORed
+ * into the state straight from the caller's buffer. Any trailing partial
+ * block is held in buf until more data or Final arrives.
+ *
+ * @param data    [in] Message bytes to absorb.
+ * @param len     [in] Number of bytes in data.
+ */
+
+void SHA3::Update(const uint8_t* data, uint64_t len)
+{
+    const uint64_t rateBytes = params.r / 8;
+
+    if (bufLen)
+    {
+        uint64_t fill = min(rateBytes - bufLen, len);
+
+        memcpy(&buf[bufLen], data, fill);
+        bufLen  += fill;
+        data    += fill;
+        len     -= fill;
+
+        if (bufLen < rateBytes)
+            return;
+
+        SpongeAbsorbBlock(buf);
+        bufLen = 0;
+    }
+
+    while (len >= rateBytes)
+    {
+        SpongeAbsorbBlock(data);
+        data    += rateBytes;
+        len     -= rateBytes;
+    }
+
+    if (len)
+    {
+        memcpy(buf, data, len);
+        bufLen = len;
+    }
+}
+
+/**
+ * SHA3::Update - Absorb more message bytes.
+ *
+ * @param data    [in] Message bytes to absorb.
+ */
+
+void SHA3::Update(const vector<uint8_t>& data)
+{
+    if (data.size())
+        Update(&data[0], data.size());
+}
+
+/**
+ * SHA3::Final - Pad the buffered tail of the message with the SHA3 0x06 ... 0x80
+ * suffix (see SHAStreamer::SetData), absorb it and squeeze out the MD.
+ *
+ * @param md      [in/out]  MD to populate as a byte vector. Assumed empty on input.
+ */
+
+void SHA3::Final(vector<uint8_t>& md)
+{
+    assert(md.size() == 0);
+
+    AbsorbFinal(0x06);
+
+    md.resize(params.d / 8);
+    Squeeze(&md[0], md.size());
+}
+
+/**
+ * SHA3::AbsorbFinal - Pad the buffered tail of the message with a domain suffix
+ * and pad10*1, absorb it and get ready to squeeze from the start of the state.
+ *
+ * @param suffix  [in] Domain bits followed by the first pad bit: 0x06 for SHA3,
+ *                     0x1F for SHAKE, 0x04 for cSHAKE.
+ */
+
+void SHA3::AbsorbFinal(const uint8_t suffix)
+{
+    const uint64_t rateBytes = params.r / 8;
+
+    memset(&buf[bufLen], 0, rateBytes - bufLen);
+    buf[bufLen]         |= suffix;
+    buf[rateBytes - 1]  |= 0x80;
+
+    SpongeAbsorbBlock(buf);
+    bufLen          = 0;
+    squeezeOffset   = 0;
+}
+
 /**
  * SHA3::Hash - Apply a SHA3 hash to an input message.
  *
@@ -1195,22 +1524,915 @@ void SHA3::Iota(uint64_t round)
 
 void SHA3::Hash(vector<uint8_t> &msg, vector<uint8_t> &md)
 {
-    assert(md.size() == 0);
+    Init();
+    Update(msg);
+    Final(md);
+}
 
-    ClearState();
-    stream.SetData(msg);
+/**
+ * SHAKE::SHAKE - Constructor. SHAKE128 and SHAKE256 are the Keccak sponge with
+ * capacity twice the security strength, i.e. rates of 1344 and 1088 bits.
+ *
+ * @param sz    [in] SHAKE128 or SHAKE256.
+ */
 
-    vector<uint64_t> curBlock(params.r / 64);
-    const uint64_t rateBytes = params.r / 8;
+SHAKE::SHAKE(SHAKESize sz) : sponge(sz == SHAKE128 ? SHA256 : SHA512), suffix(0x1F), bSqueezing(false)
+{
+    sponge.params.d = (sz == SHAKE128) ? 128 : 256;
+    sponge.params.c = 2 * sponge.params.d;
+    sponge.params.r = sponge.params.b - sponge.params.c;
+    sponge.stream   = SHAStreamer(sponge.params.r);
+}
+
+/**
+ * SHAKE::Init - Clear the sponge for a new message.
+ */
+
+void SHAKE::Init()
+{
+    sponge.Init();
+    bSqueezing = false;
+}
+
+/**
+ * SHAKE::Update - Absorb more message bytes. Only valid before the first Squeeze.
+ *
+ * @param data    [in] Message bytes to absorb.
+ * @param len     [in] Number of bytes in data.
+ */
+
+void SHAKE::Update(const uint8_t* data, uint64_t len)
+{
+    if (bSqueezing)
+        throw invalid_argument("SHAKE input cannot be added after output has been squeezed.");
+
+    sponge.Update(data, len);
+}
+
+/**
+ * SHAKE::Update - Absorb more message bytes. Only valid before the first Squeeze.
+ *
+ * @param data    [in] Message bytes to absorb.
+ */
+
+void SHAKE::Update(const vector<uint8_t>& data)
+{
+    if (data.size())
+        Update(&data[0], data.size());
+}
+
+/**
+ * SHAKE::Squeeze - Write the next len bytes of XOF output straight into the caller's
+ * buffer. The first call pads the message with the domain suffix (1111 for SHAKE,
+ * 00 for cSHAKE); later calls
+ * continue the same output stream, so any split of the output into calls gives the
+ * same bytes.
+ *
+ * @param out   [out]   Output buffer of at least len bytes.
+ * @param len   [in]    Number of bytes to produce.
+ */
+
+void SHAKE::Squeeze(uint8_t* out, uint64_t len)
+{
+    if (!bSqueezing)
+    {
+        sponge.AbsorbFinal(suffix);
+        bSqueezing = true;
+    }
+
+    sponge.Squeeze(out, len);
+}
 
-    while (!stream.End())
+/**
+ * SHAKE::Squeeze - Append the next len bytes of XOF output to a byte vector.
+ *
+ * @param out   [in/out]    Output vector to append to.
+ * @param len   [in]        Number of bytes to produce.
+ */
+
+void SHAKE::Squeeze(vector<uint8_t>& out, uint64_t len)
+{
+    const uint64_t offset = out.size();
+
+    out.resize(offset + len);
+
+    if (len)
+        Squeeze(&out[offset], len);
+}
+
+/**
+ * SHAKE::Hash - One-shot XOF of a message.
+ *
+ * @param msg   [in]        Message.
+ * @param out   [in/out]    Output, replaced with len bytes.
+ * @param len   [in]        Output length in bytes.
+ */
+
+void SHAKE::Hash(const vector<uint8_t>& msg, vector<uint8_t>& out, uint64_t len)
+{
+    Init();
+    Update(msg);
+    out.clear();
+    Squeeze(out, len);
+}
+
+/**
+ * LeftEncode - SP 800-185 left_encode: the byte count of x followed by x as big
+ * endian bytes, using at least one byte.
+ *
+ * @param x     [in]        Value to encode.
+ * @param out   [in/out]    Encoding is appended here.
+ */
+
+void LeftEncode(const uint64_t x, vector<uint8_t>& out)
+{
+    uint8_t n = 1;
+
+    while (n < 8 && (x >> (8 * n)))
+        n++;
+
+    out.push_back(n);
+
+    for (uint8_t i = n; i > 0; i--)
+        out.push_back((uint8_t)(x >> (8 * (i - 1))));
+}
+
+/**
+ * RightEncode - SP 800-185 right_encode: x as big endian bytes followed by the
+ * byte count, using at least one byte.
+ *
+ * @param x     [in]        Value to encode.
+ * @param out   [in/out]    Encoding is appended here.
+ */
+
+void RightEncode(const uint64_t x, vector<uint8_t>& out)
+{
+    uint8_t n = 1;
+
+    while (n < 8 && (x >> (8 * n)))
+        n++;
+
+    for (uint8_t i = n; i > 0; i--)
+        out.push_back((uint8_t)(x >> (8 * (i - 1))));
+
+    out.push_back(n);
+}
+
+/**
+ * EncodeString - SP 800-185 encode_string: left_encode of the bit length followed
+ * by the string.
+ *
+ * @param str   [in]        String bytes.
+ * @param len   [in]        String length in bytes, less than 2^61.
+ * @param out   [in/out]    Encoding is appended here.
+ */
+
+void EncodeString(const uint8_t* str, const uint64_t len, vector<uint8_t>& out)
+{
+    assert(len < (1LLU << 61));
+
+    LeftEncode(8 * len, out);
+    out.insert(out.end(), str, str + len);
+}
+
+/**
+ * BytePad - SP 800-185 bytepad: prepend left_encode(w) and zero fill to a multiple
+ * of w bytes.
+ *
+ * @param x     [in/out]    String to pad in place.
+ * @param w     [in]        Pad width in bytes, the sponge rate.
+ */
+
+void BytePad(vector<uint8_t>& x, const uint64_t w)
+{
+    vector<uint8_t> prefix;
+
+    LeftEncode(w, prefix);
+    x.insert(x.begin(), prefix.begin(), prefix.end());
+    x.resize((x.size() + w - 1) / w * w, 0);
+}
+
+/**
+ * CSHAKE::CSHAKE - Constructor. Absorb bytepad(encode_string(N) || encode_string(S))
+ * once and keep the resulting state, so every message starts from a copy of it.
+ * With N and S both empty cSHAKE is plain SHAKE.
+ *
+ * @param sz    [in] SHAKE128 or SHAKE256 sponge.
+ * @param N     [in] Function name string, reserved for NIST defined functions.
+ * @param S     [in] Customization string.
+ */
+
+CSHAKE::CSHAKE(SHAKESize sz, const vector<uint8_t>& N, const vector<uint8_t>& S) : xof(sz)
+{
+    xof.Init();
+
+    if (N.size() || S.size())
     {
-        memset(&curBlock[0], 0, rateBytes);
-        stream.Next(curBlock);
-        SpongeAbsorbBlock(curBlock);
+        vector<uint8_t> prefix;
+
+        EncodeString(N.data(), N.size(), prefix);
+        EncodeString(S.data(), S.size(), prefix);
+        BytePad(prefix, xof.sponge.params.r / 8);
+
+        xof.Update(prefix);
+        xof.suffix = 0x04;
     }
 
-    SpongeSqueezeBlock(md);
-    stream.Reset();
-    return;
+    memcpy(prefixState, xof.sponge.state, sizeof(prefixState));
+}
+
+/**
+ * CSHAKE::Init - Restore the state left by the N and S prefix for a new message.
+ */
+
+void CSHAKE::Init()
+{
+    xof.Init();
+    memcpy(xof.sponge.state, prefixState, sizeof(prefixState));
+}
+
+/**
+ * CSHAKE::Update - Absorb more message bytes.
+ *
+ * @param data    [in] Message bytes to absorb.
+ * @param len     [in] Number of bytes in data.
+ */
+
+void CSHAKE::Update(const uint8_t* data, uint64_t len)
+{
+    xof.Update(data, len);
+}
+
+/**
+ * CSHAKE::Update - Absorb more message bytes.
+ *
+ * @param data    [in] Message bytes to absorb.
+ */
+
+void CSHAKE::Update(const vector<uint8_t>& data)
+{
+    xof.Update(data);
+}
+
+/**
+ * CSHAKE::Squeeze - Write the next len bytes of output into the caller's buffer.
+ *
+ * @param out   [out]   Output buffer of at least len bytes.
+ * @param len   [in]    Number of bytes to produce.
+ */
+
+void CSHAKE::Squeeze(uint8_t* out, uint64_t len)
+{
+    xof.Squeeze(out, len);
+}
+
+/**
+ * CSHAKE::Squeeze - Append the next len bytes of output to a byte vector.
+ *
+ * @param out   [in/out]    Output vector to append to.
+ * @param len   [in]        Number of bytes to produce.
+ */
+
+void CSHAKE::Squeeze(vector<uint8_t>& out, uint64_t len)
+{
+    xof.Squeeze(out, len);
+}
+
+/**
+ * CSHAKE::Hash - One-shot cSHAKE of a message.
+ *
+ * @param msg   [in]        Message.
+ * @param out   [in/out]    Output, replaced with len bytes.
+ * @param len   [in]        Output length in bytes.
+ */
+
+void CSHAKE::Hash(const vector<uint8_t>& msg, vector<uint8_t>& out, uint64_t len)
+{
+    Init();
+    Update(msg);
+    out.clear();
+    Squeeze(out, len);
+}
+
+/**
+ * KMAC::KMAC - Constructor. Set up cSHAKE with N = "KMAC" and the customization
+ * string; SetKey must be called before hashing.
+ *
+ * @param sz    [in] KMAC128 (SHAKE128) or KMAC256 (SHAKE256).
+ * @param S     [in] Customization string.
+ */
+
+KMAC::KMAC(SHAKESize sz, const vector<uint8_t>& S) :
+    cshake(sz, { 'K', 'M', 'A', 'C' }, S), keyState{}, bKeySet(false)
+{
+}
+
+/**
+ * KMAC::SetKey - Absorb bytepad(encode_string(K), rate) once and keep the sponge
+ * state. The padded key is a whole number of rate blocks, so the saved state is
+ * all that is needed; each message then starts from a copy of it and costs only
+ * its own absorb plus the final permutation. Copying a keyed KMAC object clones
+ * the key state as well.
+ *
+ * @param key       [in] Key bytes.
+ * @param keyLen    [in] Key length in bytes.
+ */
+
+void KMAC::SetKey(const uint8_t* key, const uint64_t keyLen)
+{
+    vector<uint8_t> prefix;
+
+    EncodeString(key, keyLen, prefix);
+    BytePad(prefix, cshake.xof.sponge.params.r / 8);
+
+    cshake.Init();
+    cshake.Update(prefix);
+
+    assert(cshake.xof.sponge.bufLen == 0);
+
+    memcpy(keyState, cshake.xof.sponge.state, sizeof(keyState));
+    bKeySet = true;
+
+    Init();
+}
+
+/**
+ * KMAC::SetKey - Absorb the key prefix once and keep the sponge state.
+ *
+ * @param key   [in] Key bytes.
+ */
+
+void KMAC::SetKey(const vector<uint8_t>& key)
+{
+    SetKey(key.data(), key.size());
+}
+
+/**
+ * KMAC::Init - Restore the keyed state for a new message.
+ */
+
+void KMAC::Init()
+{
+    if (!bKeySet)
+        throw invalid_argument("KMAC key has not been set.");
+
+    cshake.xof.Init();
+    memcpy(cshake.xof.sponge.state, keyState, sizeof(keyState));
+}
+
+/**
+ * KMAC::Update - Absorb more message bytes.
+ *
+ * @param data    [in] Message bytes to absorb.
+ * @param len     [in] Number of bytes in data.
+ */
+
+void KMAC::Update(const uint8_t* data, uint64_t len)
+{
+    cshake.Update(data, len);
+}
+
+/**
+ * KMAC::Update - Absorb more message bytes.
+ *
+ * @param data    [in] Message bytes to absorb.
+ */
+
+void KMAC::Update(const vector<uint8_t>& data)
+{
+    cshake.Update(data);
+}
+
+/**
+ * KMAC::Final - Absorb right_encode(L) and squeeze an L bit MAC.
+ *
+ * @param mac       [out]   MAC buffer of macLen bytes.
+ * @param macLen    [in]    MAC length in bytes.
+ */
+
+void KMAC::Final(uint8_t* mac, const uint64_t macLen)
+{
+    vector<uint8_t> lenEnc;
+
+    RightEncode(8 * macLen, lenEnc);
+    cshake.Update(lenEnc);
+    cshake.Squeeze(mac, macLen);
+}
+
+/**
+ * KMAC::FinalXOF - KMACXOF: absorb right_encode(0) and squeeze the first len bytes
+ * of output. More output can follow through cshake.Squeeze.
+ *
+ * @param out   [out]   Output buffer of len bytes.
+ * @param len   [in]    Output length in bytes.
+ */
+
+void KMAC::FinalXOF(uint8_t* out, const uint64_t len)
+{
+    vector<uint8_t> lenEnc;
+
+    RightEncode(0, lenEnc);
+    cshake.Update(lenEnc);
+    cshake.Squeeze(out, len);
+}
+
+/**
+ * KMAC::Mac - One-shot MAC of a message with the current key.
+ *
+ * @param msg       [in]    Message.
+ * @param mac       [out]   MAC, replaced with macLen bytes.
+ * @param macLen    [in]    MAC length in bytes.
+ */
+
+void KMAC::Mac(const vector<uint8_t>& msg, vector<uint8_t>& mac, const uint64_t macLen)
+{
+    mac.resize(macLen);
+
+    Init();
+    Update(msg);
+    Final(mac.data(), macLen);
+}
+
+/**
+ * KMAC::Verify - Recompute the MAC of a message and compare it with a received MAC
+ * in constant time. The MAC length is fixed by the caller, not by the received MAC,
+ * so an empty or truncated MAC never verifies. SP 800-185 asks for L of at least
+ * 32 bits when KMAC is used as a MAC.
+ *
+ * @param msg       [in] Message.
+ * @param mac       [in] Received MAC.
+ * @param macLen    [in] Expected MAC length in bytes, at least KMAC_MIN_MAC_BYTES.
+ *
+ * @return True if the MAC has the expected length and matches.
+ */
+
+bool KMAC::Verify(const vector<uint8_t>& msg, const vector<uint8_t>& mac, const uint64_t macLen)
+{
+    if (macLen < KMAC_MIN_MAC_BYTES)
+        throw invalid_argument("KMAC MAC length is too short to verify.");
+
+    if (mac.size() != macLen)
+        return false;
+
+    vector<uint8_t> expected;
+    uint8_t diff = 0;
+
+    Mac(msg, expected, macLen);
+
+    for (uint64_t i = 0; i < macLen; i++)
+        diff |= expected[i] ^ mac[i];
+
+    return diff == 0;
+}
+
+/**
+ * KeccakMulti::KeccakMulti - Pick the widest Keccak engine the CPU supports and
+ * clear all lanes.
+ */
+
+KeccakMulti::KeccakMulti() : engine(CPUHasFeature(CPU_AVX512) ? KECCAK_AVX512 :
+    CPUHasFeature(CPU_AVX2) ? KECCAK_AVX2 : KECCAK_SCALAR)
+{
+    ClearState();
+}
+
+/**
+ * KeccakMulti::SetEngine - Select the permutation implementation. Changing the
+ * engine changes the interleaving, so all states are cleared.
+ *
+ * @param engineIn  [in] KECCAK_SCALAR for one state at a time, KECCAK_AVX2 for four
+ *                       states or KECCAK_AVX512 for eight.
+ */
+
+void KeccakMulti::SetEngine(const KeccakEngine engineIn)
+{
+    if (engineIn == KECCAK_AVX2 && !CPUHasFeature(CPU_AVX2))
+        throw invalid_argument("AVX2 is not supported on this CPU.");
+
+    if (engineIn == KECCAK_AVX512 && !CPUHasFeature(CPU_AVX512))
+        throw invalid_argument("AVX-512 is not supported on this CPU.");
+
+    engine = engineIn;
+    ClearState();
+}
+
+/**
+ * KeccakMulti::Lanes - Number of states permuted together by the current engine.
+ *
+ * @return 1, 4 or 8.
+ */
+
+uint32_t KeccakMulti::Lanes()
+{
+    switch (engine)
+    {
+        case KECCAK_AVX2:
+
+            return KECCAK_AVX2_LANES;
+
+        case KECCAK_AVX512:
+
+            return KECCAK_AVX512_LANES;
+
+        default:
+            return 1;
+    }
+}
+
+/**
+ * KeccakMulti::ClearState - Zero every state.
+ */
+
+void KeccakMulti::ClearState()
+{
+    memset(a, 0, sizeof(a));
+}
+
+/**
+ * KeccakMulti::Load - Copy a SHA3 style state into one lane of the interleaved
+ * states. Lane i of state s is stored at a[Lanes() * i + s].
+ *
+ * @param lane  [in] Which state to overwrite, less than Lanes().
+ * @param state [in] 25 lanes indexed by LANE(x, y), e.g. SHA3::state.
+ */
+
+void KeccakMulti::Load(const uint32_t lane, const uint64_t state[STATE_W * STATE_H])
+{
+    const uint32_t L = Lanes();
+
+    assert(lane < L);
+
+    for (uint32_t i = 0; i < STATE_W * STATE_H; i++)
+        a[L * i + lane] = state[i];
+}
+
+/**
+ * KeccakMulti::Store - Copy one lane of the interleaved states out to a SHA3
+ * style state.
+ *
+ * @param lane  [in]    Which state to read, less than Lanes().
+ * @param state [out]   25 lanes indexed by LANE(x, y).
+ */
+
+void KeccakMulti::Store(const uint32_t lane, uint64_t state[STATE_W * STATE_H])
+{
+    const uint32_t L = Lanes();
+
+    assert(lane < L);
+
+    for (uint32_t i = 0; i < STATE_W * STATE_H; i++)
+        state[i] = a[L * i + lane];
+}
+
+/**
+ * KeccakMulti::Permute - Apply Keccak-f[1600] to every state.
+ */
+
+void KeccakMulti::Permute()
+{
+    switch (engine)
+    {
+        case KECCAK_AVX2:
+
+            KeccakF1600x4AVX2(rcs, a);
+            break;
+
+        case KECCAK_AVX512:
+
+            KeccakF1600x8AVX512(rcs, a);
+            break;
+
+        default:
+
+            KeccakF1600(a);
+            break;
+    }
+}
+
+/**
+ * KeccakMulti::Sponge - Run many independent sponges, one message per lane. Each
+ * lane absorbs its message a rate block at a time, pads the tail with the domain
+ * suffix and pad10*1, then squeezes outBytes. A lane that finishes has its output
+ * written and restarts on the next waiting message, so messages of different
+ * lengths keep the lanes full; once none are left, idle lanes are permuted along
+ * with the rest and ignored.
+ *
+ * @param rateBytes [in]    Sponge rate in bytes.
+ * @param suffix    [in]    Domain separation bits plus the first padding bit, e.g.
+ *                          0x06 for SHA3 or 0x1F for SHAKE.
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param outs      [out]   Outputs, outBytes per message, back to back.
+ * @param outBytes  [in]    Output length per message.
+ * @param numMsgs   [in]    Number of messages.
+ */
+
+void KeccakMulti::Sponge(const uint64_t rateBytes, const uint8_t suffix, const uint8_t* const* msgs,
+    const uint64_t* lens, uint8_t* outs, const uint64_t outBytes, const uint64_t numMsgs)
+{
+    assert(rateBytes % 8 == 0 && rateBytes < STATE_BYTES);
+
+    const uint32_t L            = Lanes();
+    const uint64_t rateWords    = rateBytes / 8;
+
+    uint64_t laneMsg[KECCAK_MAX_LANES];
+    uint64_t laneBlock[KECCAK_MAX_LANES];
+    uint64_t laneBlocks[KECCAK_MAX_LANES];
+    uint64_t laneOut[KECCAK_MAX_LANES];
+    bool laneActive[KECCAK_MAX_LANES];
+    uint64_t nextMsg    = 0;
+    uint32_t numActive  = 0;
+    uint8_t pad[STATE_BYTES];
+
+    auto StartLane = [&](const uint32_t l)
+    {
+        for (uint32_t i = 0; i < STATE_W * STATE_H; i++)
+            a[L * i + l] = 0;
+
+        laneActive[l] = nextMsg < numMsgs;
+
+        if (!laneActive[l])
+            return;
+
+        laneMsg[l]      = nextMsg++;
+        laneBlock[l]    = 0;
+        laneBlocks[l]   = lens[laneMsg[l]] / rateBytes + 1;
+        laneOut[l]      = 0;
+        numActive++;
+    };
+
+    for (uint32_t l = 0; l < L; l++)
+        StartLane(l);
+
+    while (numActive)
+    {
+        for (uint32_t l = 0; l < L; l++)
+        {
+            if (!laneActive[l] || laneBlock[l] == laneBlocks[l])
+                continue;
+
+            const uint64_t len  = lens[laneMsg[l]];
+            const uint64_t off  = rateBytes * laneBlock[l];
+            const uint8_t* blk  = &msgs[laneMsg[l]][off];
+
+            if (++laneBlock[l] == laneBlocks[l])
+            {
+                memset(pad, 0, rateBytes);
+
+                if (len > off)
+                    memcpy(pad, blk, len - off);
+
+                pad[len - off]      |= suffix;
+                pad[rateBytes - 1]  |= 0x80;
+                blk                 = pad;
+            }
+
+            for (uint64_t i = 0; i < rateWords; i++)
+            {
+                uint64_t w;
+                memcpy(&w, &blk[8 * i], 8);
+                a[L * i + l] ^= w;
+            }
+        }
+
+        Permute();
+
+        for (uint32_t l = 0; l < L; l++)
+        {
+            if (!laneActive[l] || laneBlock[l] < laneBlocks[l])
+                continue;
+
+            uint8_t* out        = &outs[outBytes * laneMsg[l]];
+            const uint64_t n    = min(rateBytes, outBytes - laneOut[l]);
+
+            for (uint64_t i = 0; i < n; i++)
+                out[laneOut[l] + i] = (uint8_t)(a[L * (i / 8) + l] >> (8 * (i % 8)));
+
+            laneOut[l] += n;
+
+            if (laneOut[l] == outBytes)
+            {
+                numActive--;
+                StartLane(l);
+            }
+        }
+    }
+}
+
+/**
+ * SHA3Multi::SetEngine - Select the Keccak permutation used for batches.
+ *
+ * @param engineIn  [in] KECCAK_SCALAR, KECCAK_AVX2 or KECCAK_AVX512.
+ */
+
+void SHA3Multi::SetEngine(const KeccakEngine engineIn)
+{
+    keccak.SetEngine(engineIn);
+}
+
+/**
+ * SHA3Multi::Hash - SHA3 of a batch of independent messages of any lengths.
+ *
+ * @param sz        [in]    SHA3 variant.
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param mds       [out]   Digests, numMsgs * digest bytes, back to back in message order.
+ * @param numMsgs   [in]    Number of messages.
+ */
+
+void SHA3Multi::Hash(const SHASize sz, const uint8_t* const* msgs, const uint64_t* lens,
+    uint8_t* mds, const uint64_t numMsgs)
+{
+    SHA3 sha(sz);
+    keccak.Sponge(sha.params.r / 8, 0x06, msgs, lens, mds, sha.params.d / 8, numMsgs);
+}
+
+/**
+ * SHA3Multi::Hash - SHA3 of a batch of independent messages.
+ *
+ * @param sz    [in]    SHA3 variant.
+ * @param msgs  [in]    Messages.
+ * @param mds   [out]   One digest per message.
+ */
+
+void SHA3Multi::Hash(const SHASize sz, const vector<vector<uint8_t>>& msgs, vector<vector<uint8_t>>& mds)
+{
+    const uint64_t numMsgs = msgs.size();
+    const uint64_t mdBytes = SHA3(sz).params.d / 8;
+
+    vector<const uint8_t*> ptrs(numMsgs);
+    vector<uint64_t> lens(numMsgs);
+    vector<uint8_t> out(numMsgs * mdBytes);
+
+    for (uint64_t i = 0; i < numMsgs; i++)
+    {
+        ptrs[i] = msgs[i].data();
+        lens[i] = msgs[i].size();
+    }
+
+    Hash(sz, ptrs.data(), lens.data(), out.data(), numMsgs);
+
+    mds.resize(numMsgs);
+
+    for (uint64_t i = 0; i < numMsgs; i++)
+        mds[i].assign(&out[mdBytes * i], &out[mdBytes * (i + 1)]);
+}
+
+/**
+ * ParallelHash::ParallelHash - Constructor.
+ *
+ * @param szIn          [in] ParallelHash128 (SHAKE128) or ParallelHash256 (SHAKE256).
+ * @param blockBytesIn  [in] Chunk size B in bytes; each chunk is hashed independently.
+ * @param SIn           [in] Customization string.
+ */
+
+ParallelHash::ParallelHash(SHAKESize szIn, const uint64_t blockBytesIn, const vector<uint8_t>& SIn) :
+    sz(szIn), blockBytes(blockBytesIn), S(SIn), engine(KeccakMulti().engine),
+    numThreads(max(1u, thread::hardware_concurrency())), parallelThreshold(PARALLELHASH_DEFAULT_THRESHOLD)
+{
+    if (blockBytes == 0)
+        throw invalid_argument("ParallelHash block size must be at least one byte.");
+}
+
+/**
+ * ParallelHash::SetEngine - Select the Keccak permutation used for chunk hashes.
+ *
+ * @param engineIn  [in] KECCAK_SCALAR, KECCAK_AVX2 or KECCAK_AVX512.
+ */
+
+void ParallelHash::SetEngine(const KeccakEngine engineIn)
+{
+    KeccakMulti keccak;
+    keccak.SetEngine(engineIn);
+
+    engine = engineIn;
+}
+
+/**
+ * ParallelHash::SetThreading - Configure multi-threaded chunk hashing.
+ *
+ * @param numThreadsIn          [in] Maximum number of worker threads. 1 disables threading.
+ * @param parallelThresholdIn   [in] Minimum message length in bytes before chunks are split
+ *                                   across threads.
+ */
+
+void ParallelHash::SetThreading(const uint32_t numThreadsIn, const uint64_t parallelThresholdIn)
+{
+    if (numThreadsIn == 0)
+        throw invalid_argument("ParallelHash thread count must be at least 1.");
+
+    numThreads          = numThreadsIn;
+    parallelThreshold   = parallelThresholdIn;
+}
+
+/**
+ * ParallelHash::Compute - Hash every B byte chunk with SHAKE at twice the security
+ * strength, spreading runs of consecutive chunks over worker threads and, inside a
+ * thread, over the SIMD lanes of the Keccak engine. The chunk hashes land in place
+ * in z = left_encode(B) || h_0 || ... || h_(n-1) || right_encode(n) || right_encode(L),
+ * which is then fed to cSHAKE with N = "ParallelHash".
+ *
+ * @param msg       [in]    Message.
+ * @param len       [in]    Message length in bytes.
+ * @param out       [out]   Output buffer of outLen bytes.
+ * @param outLen    [in]    Output length in bytes.
+ * @param bXOF      [in]    Encode L as 0 for ParallelHashXOF.
+ */
+
+void ParallelHash::Compute(const uint8_t* msg, const uint64_t len, uint8_t* out,
+    const uint64_t outLen, const bool bXOF)
+{
+    static const vector<uint8_t> N = { 'P', 'a', 'r', 'a', 'l', 'l', 'e', 'l', 'H', 'a', 's', 'h' };
+
+    const uint64_t nChunks          = (len + blockBytes - 1) / blockBytes;
+    const uint64_t chunkOutBytes    = (sz == SHAKE128) ? 32 : 64;
+    const uint64_t rateBytes        = (sz == SHAKE128) ? 168 : 136;
+
+    vector<uint8_t> z;
+    LeftEncode(blockBytes, z);
+
+    const uint64_t hashOffset = z.size();
+
+    z.resize(hashOffset + nChunks * chunkOutBytes);
+    RightEncode(nChunks, z);
+    RightEncode(bXOF ? 0 : 8 * outLen, z);
+
+    const uint64_t nWorkers         = (len >= parallelThreshold) ? min((uint64_t)numThreads, nChunks) : 1;
+    const uint64_t chunksPerWorker  = nWorkers ? (nChunks + nWorkers - 1) / nWorkers : 0;
+
+    auto HashChunks = [&](uint64_t w)
+    {
+        const uint64_t start    = w * chunksPerWorker;
+        const uint64_t end      = min(nChunks, start + chunksPerWorker);
+
+        if (start >= end)
+            return;
+
+        vector<const uint8_t*> ptrs(end - start);
+        vector<uint64_t> lens(end - start);
+
+        for (uint64_t i = start; i < end; i++)
+        {
+            ptrs[i - start] = &msg[i * blockBytes];
+            lens[i - start] = min(blockBytes, len - i * blockBytes);
+        }
+
+        KeccakMulti keccak;
+        keccak.SetEngine(engine);
+        keccak.Sponge(rateBytes, 0x1F, ptrs.data(), lens.data(), &z[hashOffset + start * chunkOutBytes],
+            chunkOutBytes, end - start);
+    };
+
+    if (nWorkers > 1)
+        ThreadPool::Global().ParallelFor(nWorkers, HashChunks);
+    else if (nWorkers == 1)
+        HashChunks(0);
+
+    CSHAKE cshake(sz, N, S);
+    cshake.Init();
+    cshake.Update(z);
+    cshake.Squeeze(out, outLen);
+}
+
+/**
+ * ParallelHash::Hash - ParallelHash of a message with a fixed output length.
+ *
+ * @param msg       [in]    Message.
+ * @param len       [in]    Message length in bytes.
+ * @param out       [out]   Output buffer of outLen bytes.
+ * @param outLen    [in]    Output length in bytes.
+ */
+
+void ParallelHash::Hash(const uint8_t* msg, const uint64_t len, uint8_t* out, const uint64_t outLen)
+{
+    Compute(msg, len, out, outLen, false);
+}
+
+/**
+ * ParallelHash::Hash - ParallelHash of a message with a fixed output length.
+ *
+ * @param msg       [in]    Message.
+ * @param out       [out]   Output, replaced with outLen bytes.
+ * @param outLen    [in]    Output length in bytes.
+ */
+
+void ParallelHash::Hash(const vector<uint8_t>& msg, vector<uint8_t>& out, const uint64_t outLen)
+{
+    out.resize(outLen);
+    Compute(msg.data(), msg.size(), out.data(), outLen, false);
+}
+
+/**
+ * ParallelHash::HashXOF - ParallelHashXOF, which encodes the output length as 0 so
+ * any prefix of a longer output is a valid shorter output.
+ *
+ * @param msg       [in]    Message.
+ * @param out       [out]   Output, replaced with outLen bytes.
+ * @param outLen    [in]    Output length in bytes.
+ */
+
+void ParallelHash::HashXOF(const vector<uint8_t>& msg, vector<uint8_t>& out, const uint64_t outLen)
+{
+    out.resize(outLen);
+    Compute(msg.data(), msg.size(), out.data(), outLen, true);
 }
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include "sha2multi.h"
+
+#ifdef NISTCRYPTO_X86
+
+#define SHA2_INLINE inline __attribute__((always_inline))
+
+typedef uint32_t V32x8 __attribute__((vector_size(32)));
+typedef uint32_t V32x16 __attribute__((vector_size(64)));
+typedef uint64_t V64x4 __attribute__((vector_size(32)));
+typedef uint64_t V64x8 __attribute__((vector_size(64)));
+
+/**
+ * SHA256Ops - Word size, round count and sigma rotation amounts of SHA224/256.
+ * The last entry of the small sigmas is a shift rather than a rotation.
+ */
+
+struct SHA256Ops
+{
+    typedef uint32_t Word;
+
+    static constexpr uint32_t rounds    = 64;
+    static constexpr uint32_t S0[3]     = { 2, 13, 22 };
+    static constexpr uint32_t S1[3]     = { 6, 11, 25 };
+    static constexpr uint32_t s0[3]     = { 7, 18, 3 };
+    static constexpr uint32_t s1[3]     = { 17, 19, 10 };
+};
+
+/**
+ * SHA512Ops - Word size, round count and sigma rotation amounts of SHA384/512.
+ */
+
+struct SHA512Ops
+{
+    typedef uint64_t Word;
+
+    static constexpr uint32_t rounds    = 80;
+    static constexpr uint32_t S0[3]     = { 28, 34, 39 };
+    static constexpr uint32_t S1[3]     = { 14, 18, 41 };
+    static constexpr uint32_t s0[3]     = { 1, 8, 7 };
+    static constexpr uint32_t s1[3]     = { 19, 61, 6 };
+};
+
+#define VROTR(x, n) (((x) >> (n)) | ((x) << (8 * sizeof(Word) - (n))))
+#define VSIG(x, r) (VROTR(x, r[0]) ^ VROTR(x, r[1]) ^ VROTR(x, r[2]))
+#define VSMALLSIG(x, r) (VROTR(x, r[0]) ^ VROTR(x, r[1]) ^ ((x) >> r[2]))
+
+#define VROUND(a, b, c, d, e, f, g, h, t)                                               \
+{                                                                                       \
+    V T1 = h + VSIG(e, Ops::S1) + ((e & f) ^ (~e & g)) + k[t] + w[(t) % 16];            \
+    d += T1;                                                                            \
+    h = T1 + VSIG(a, Ops::S0) + ((a & b) ^ (a & c) ^ (b & c));                          \
+}
+
+/**
+ * LoadBE - Load a big-endian message word.
+ *
+ * @param p [in] Word bytes.
+ *
+ * @return Word in host order.
+ */
+
+template <typename Word>
+static SHA2_INLINE Word LoadBE(const uint8_t* p)
+{
+    Word w;
+    memcpy(&w, p, sizeof(Word));
+    return (sizeof(Word) == 4) ? (Word)__builtin_bswap32((uint32_t)w) : (Word)__builtin_bswap64(w);
+}
+
+/**
+ * LaneBlock - Fetch block b of a message as big-endian words into one lane of the
+ * transposed block, applying FIPS 180-4 padding to the blocks that run past the
+ * end of the message.
+ *
+ * @param msg       [in]    Message.
+ * @param len       [in]    Message length in bytes.
+ * @param b         [in]    Block index.
+ * @param nBlocks   [in]    Number of padded blocks in the message.
+ * @param words     [out]   Sixteen message words, stride words apart.
+ * @param stride    [in]    Distance between consecutive words (the lane count).
+ */
+
+template <typename Word>
+static SHA2_INLINE void LaneBlock(const uint8_t* msg, const uint64_t len, const uint64_t b,
+    const uint64_t nBlocks, Word* words, const uint32_t stride)
+{
+    const uint64_t blockBytes   = 16 * sizeof(Word);
+    const uint64_t offset       = b * blockBytes;
+    uint8_t pad[16 * sizeof(Word)];
+    const uint8_t* block        = &msg[offset];
+
+    if (offset + blockBytes > len)
+    {
+        const uint64_t n = (offset < len) ? len - offset : 0;
+
+        memset(pad, 0, blockBytes);
+
+        if (n)
+            memcpy(pad, &msg[offset], n);
+
+        if (offset <= len)
+            pad[len - offset] = 0x80;
+
+        if (b == nBlocks - 1)
+        {
+            for (uint64_t i = 0; i < 8; i++)
+                pad[blockBytes - 1 - i] = (uint8_t)((8 * len) >> (8 * i));
+
+            if (sizeof(Word) == 8)
+                pad[blockBytes - 9] = (uint8_t)(len >> 61);
+        }
+
+        block = pad;
+    }
+
+    for (uint32_t t = 0; t < 16; t++)
+        words[t * stride] = LoadBE<Word>(&block[sizeof(Word) * t]);
+}
+
+/**
+ * HashManyLanes - Hash many independent messages with one message per SIMD lane.
+ * Each lane runs its own message block by block; when a lane's message ends its
+ * digest is written out and the lane restarts on the next waiting message, so
+ * messages of different lengths keep every lane busy. Once no messages are left,
+ * finished lanes are masked: they hash a zero block whose result is never read.
+ *
+ * @param k         [in]    Round constants.
+ * @param iv        [in]    Initial hash value.
+ * @param mdBytes   [in]    Digest length in bytes (truncation for SHA224/384).
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param mds       [out]   Digests, mdBytes per message, back to back.
+ * @param numMsgs   [in]    Number of messages.
+ */
+
+template <typename Ops, typename V, uint32_t L>
+static SHA2_INLINE void HashManyLanes(const typename Ops::Word* k, const typename Ops::Word iv[8],
+    const uint32_t mdBytes, const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds,
+    const uint64_t numMsgs)
+{
+    typedef typename Ops::Word Word;
+
+    const uint64_t blockBytes   = 16 * sizeof(Word);
+    const uint64_t lenBytes     = 2 * sizeof(Word);
+
+    uint64_t laneMsg[L];
+    uint64_t laneBlock[L];
+    uint64_t laneBlocks[L];
+    bool laneActive[L];
+    uint64_t nextMsg    = 0;
+    uint32_t numActive  = 0;
+    V st[8];
+
+    auto StartLane = [&](const uint32_t l)
+    {
+        laneActive[l] = nextMsg < numMsgs;
+
+        if (!laneActive[l])
+            return;
+
+        laneMsg[l]      = nextMsg++;
+        laneBlock[l]    = 0;
+        laneBlocks[l]   = (lens[laneMsg[l]] + 1 + lenBytes + blockBytes - 1) / blockBytes;
+        numActive++;
+
+        for (uint32_t j = 0; j < 8; j++)
+            st[j][l] = iv[j];
+    };
+
+    for (uint32_t j = 0; j < 8; j++)
+        st[j] = V{} + iv[j];
+
+    for (uint32_t l = 0; l < L; l++)
+        StartLane(l);
+
+    while (numActive)
+    {
+        Word wT[16][L] __attribute__((aligned(64))) = {};
+        V w[16];
+
+        for (uint32_t l = 0; l < L; l++)
+        {
+            if (laneActive[l])
+                LaneBlock(msgs[laneMsg[l]], lens[laneMsg[l]], laneBlock[l], laneBlocks[l], &wT[0][l], L);
+        }
+
+        for (uint32_t t = 0; t < 16; t++)
+            memcpy(&w[t], wT[t], sizeof(V));
+
+        V a = st[0];
+        V b = st[1];
+        V c = st[2];
+        V d = st[3];
+        V e = st[4];
+        V f = st[5];
+        V g = st[6];
+        V h = st[7];
+
+        for (uint32_t t = 0; t < Ops::rounds; t += 16)
+        {
+            if (t)
+            {
+#pragma GCC unroll 16
+                for (uint32_t j = 0; j < 16; j++)
+                {
+                    w[j] += VSMALLSIG(w[(j + 14) % 16], Ops::s1) + w[(j + 9) % 16] +
+                        VSMALLSIG(w[(j + 1) % 16], Ops::s0);
+                }
+            }
+
+            VROUND(a, b, c, d, e, f, g, h, t + 0);
+            VROUND(h, a, b, c, d, e, f, g, t + 1);
+            VROUND(g, h, a, b, c, d, e, f, t + 2);
+            VROUND(f, g, h, a, b, c, d, e, t + 3);
+            VROUND(e, f, g, h, a, b, c, d, t + 4);
+            VROUND(d, e, f, g, h, a, b, c, t + 5);
+            VROUND(c, d, e, f, g, h, a, b, t + 6);
+            VROUND(b, c, d, e, f, g, h, a, t + 7);
+            VROUND(a, b, c, d, e, f, g, h, t + 8);
+            VROUND(h, a, b, c, d, e, f, g, t + 9);
+            VROUND(g, h, a, b, c, d, e, f, t + 10);
+            VROUND(f, g, h, a, b, c, d, e, t + 11);
+            VROUND(e, f, g, h, a, b, c, d, t + 12);
+            VROUND(d, e, f, g, h, a, b, c, t + 13);
+            VROUND(c, d, e, f, g, h, a, b, t + 14);
+            VROUND(b, c, d, e, f, g, h, a, t + 15);
+        }
+
+        st[0] += a;
+        st[1] += b;
+        st[2] += c;
+        st[3] += d;
+        st[4] += e;
+        st[5] += f;
+        st[6] += g;
+        st[7] += h;
+
+        for (uint32_t l = 0; l < L; l++)
+        {
+            if (!laneActive[l] || ++laneBlock[l] < laneBlocks[l])
+                continue;
+
+            uint8_t* md = &mds[mdBytes * laneMsg[l]];
+
+            for (uint32_t i = 0; i < mdBytes; i++)
+                md[i] = (uint8_t)(st[i / sizeof(Word)][l] >> (8 * (sizeof(Word) - 1 - i % sizeof(Word))));
+
+            numActive--;
+            StartLane(l);
+        }
+    }
+}
+
+/**
+ * SHA256HashManyAVX2 - SHA224/256 of many messages, eight lanes of 32-bit words.
+ *
+ * @param k         [in]    Round constants.
+ * @param iv        [in]    Initial hash value.
+ * @param mdBytes   [in]    Digest length in bytes.
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param mds       [out]   Digests, back to back.
+ * @param numMsgs   [in]    Number of messages.
+ */
+
+__attribute__((target("avx2"))) void SHA256HashManyAVX2(const uint32_t k[64], const uint32_t iv[8],
+    const uint32_t mdBytes, const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds,
+    const uint64_t numMsgs)
+{
+    HashManyLanes<SHA256Ops, V32x8, SHA256_AVX2_LANES>(k, iv, mdBytes, msgs, lens, mds, numMsgs);
+}
+
+/**
+ * SHA256HashManyAVX512 - SHA224/256 of many messages, sixteen lanes of 32-bit words.
+ *
+ * @param k         [in]    Round constants.
+ * @param iv        [in]    Initial hash value.
+ * @param mdBytes   [in]    Digest length in bytes.
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param mds       [out]   Digests, back to back.
+ * @param numMsgs   [in]    Number of messages.
+ */
+
+__attribute__((target("avx512f"))) void SHA256HashManyAVX512(const uint32_t k[64], const uint32_t iv[8],
+    const uint32_t mdBytes, const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds,
+    const uint64_t numMsgs)
+{
+    HashManyLanes<SHA256Ops, V32x16, SHA256_AVX512_LANES>(k, iv, mdBytes, msgs, lens, mds, numMsgs);
+}
+
+/**
+ * SHA512HashManyAVX2 - SHA384/512 of many messages, four lanes of 64-bit words.
+ *
+ * @param k         [in]    Round constants.
+ * @param iv        [in]    Initial hash value.
+ * @param mdBytes   [in]    Digest length in bytes.
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param mds       [out]   Digests, back to back.
+ * @param numMsgs   [in]    Number of messages.
+ */
+
+__attribute__((target("avx2"))) void SHA512HashManyAVX2(const uint64_t k[80], const uint64_t iv[8],
+    const uint32_t mdBytes, const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds,
+    const uint64_t numMsgs)
+{
+    HashManyLanes<SHA512Ops, V64x4, SHA512_AVX2_LANES>(k, iv, mdBytes, msgs, lens, mds, numMsgs);
+}
+
+/**
+ * SHA512HashManyAVX512 - SHA384/512 of many messages, eight lanes of 64-bit words.
+ *
+ * @param k         [in]    Round constants.
+ * @param iv        [in]    Initial hash value.
+ * @param mdBytes   [in]    Digest length in bytes.
+ * @param msgs      [in]    Message pointers.
+ * @param lens      [in]    Message lengths in bytes.
+ * @param mds       [out]   Digests, back to back.
+ * @param numMsgs   [in]    Number of messages.
+ */
+
+__attribute__((target("avx512f"))) void SHA512HashManyAVX512(const uint64_t k[80], const uint64_t iv[8],
+    const uint32_t mdBytes, const uint8_t* const* msgs, const uint64_t* lens, uint8_t* mds,
+    const uint64_t numMsgs)
+{
+    HashManyLanes<SHA512Ops, V64x8, SHA512_AVX512_LANES>(k, iv, mdBytes, msgs, lens, mds, numMsgs);
+}
+
+#else
+
+void SHA256HashManyAVX2(const uint32_t*, const uint32_t*, const uint32_t, const uint8_t* const*,
+    const uint64_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AVX2 is not available on this platform.");
+}
+
+void SHA256HashManyAVX512(const uint32_t*, const uint32_t*, const uint32_t, const uint8_t* const*,
+    const uint64_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AVX-512 is not available on this platform.");
+}
+
+void SHA512HashManyAVX2(const uint64_t*, const uint64_t*, const uint32_t, const uint8_t* const*,
+    const uint64_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AVX2 is not available on this platform.");
+}
+
+void SHA512HashManyAVX512(const uint64_t*, const uint64_t*, const uint32_t, const uint8_t* const*,
+    const uint64_t*, uint8_t*, const uint64_t)
+{
+    throw runtime_error("AVX-512 is not available on this platform.");
+}
+
+#endif
\ No newline at end of file
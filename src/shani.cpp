@@ -0,0 +1,94 @@
+#include "shani.h"
+
+#ifdef NISTCRYPTO_X86
+
+#include <immintrin.h>
+
+#define SHANI_TARGET __attribute__((target("sha,sse4.1")))
+
+/**
+ * SHANISupported - Check if the CPU has the SHA extensions this backend needs.
+ *
+ * @return True if SHA256RNDS2/SHA256MSG1/SHA256MSG2, SSSE3 and SSE4.1 are available.
+ */
+
+bool SHANISupported()
+{
+    return CPUHasFeature(CPU_SHA);
+}
+
+/**
+ * SHANICompress256 - Run the SHA224/256 compression function over consecutive
+ * 64-byte blocks with the SHA extensions. SHA256RNDS2 keeps the working variables
+ * as ABEF/CDGH register pairs and does two rounds per instruction; SHA256MSG1 and
+ * SHA256MSG2 extend the message schedule four words at a time.
+ *
+ * @param k         [in]        SHA-256 round constants.
+ * @param H         [in/out]    Intermediate hash value.
+ * @param blocks    [in]        Pointer to the first message block.
+ * @param nBlocks   [in]        Number of 64-byte blocks to compress.
+ */
+
+SHANI_TARGET void SHANICompress256(const uint32_t k[64], uint32_t H[8], const uint8_t* blocks,
+    const uint64_t nBlocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp     = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&H[0]), 0xB1);
+    __m128i state1  = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&H[4]), 0x1B);
+    __m128i state0  = _mm_alignr_epi8(tmp, state1, 8);
+
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for (uint64_t i = 0; i < nBlocks; i++)
+    {
+        const uint8_t* block    = blocks + 64 * i;
+        const __m128i abef      = state0;
+        const __m128i cdgh      = state1;
+        __m128i w[4];
+
+        for (uint32_t j = 0; j < 4; j++)
+            w[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&block[16 * j]), byteSwap);
+
+#pragma GCC unroll 16
+        for (uint32_t r = 0; r < 16; r++)
+        {
+            if (r >= 4)
+            {
+                __m128i sched = _mm_sha256msg1_epu32(w[r % 4], w[(r + 1) % 4]);
+                sched = _mm_add_epi32(sched, _mm_alignr_epi8(w[(r + 3) % 4], w[(r + 2) % 4], 4));
+                w[r % 4] = _mm_sha256msg2_epu32(sched, w[(r + 3) % 4]);
+            }
+
+            const __m128i wk = _mm_add_epi32(w[r % 4], _mm_loadu_si128((const __m128i*)&k[4 * r]));
+
+            state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp     = _mm_shuffle_epi32(state0, 0x1B);
+    state1  = _mm_shuffle_epi32(state1, 0xB1);
+    state0  = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1  = _mm_alignr_epi8(state1, tmp, 8);
+
+    _mm_storeu_si128((__m128i*)&H[0], state0);
+    _mm_storeu_si128((__m128i*)&H[4], state1);
+}
+
+#else
+
+bool SHANISupported()
+{
+    return false;
+}
+
+void SHANICompress256(const uint32_t*, uint32_t*, const uint8_t*, const uint64_t)
+{
+    throw runtime_error("SHA extensions are not available on this platform.");
+}
+
+#endif
\ No newline at end of file
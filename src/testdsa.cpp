@@ -73,11 +73,15 @@ static void LoadTestVecsFromFile(const string file, vector<DSATestVec> &vecs)
     DSATestVec curVec;
     NISTCurve curCurve  = P256;
     SHASize curSHA      = SHA256;
+    bool bKnownCurve    = true;
 
     while (fgets(buf, sizeof(buf), pFile) != NULL)
     {
         string line = string(buf);
 
+        while (line.length() && (line.back() == '\n' || line.back() == '\r'))
+            line.pop_back();
+
         if (regex_search(line, match, reMsg))
         {
             vector<uint8_t> msg;
@@ -135,13 +139,18 @@ static void LoadTestVecsFromFile(const string file, vector<DSATestVec> &vecs)
             curVec.shaSz    = curSHA;
             curVec.curve    = curCurve;
 
-            vecs.push_back(curVec);
+            if (bKnownCurve)
+                vecs.push_back(curVec);
             continue;
         }
 
         if (regex_search(line, match, reCurveSHA))
         {
-            curCurve    = curveStrings[match[1]];
+            bKnownCurve = curveStrings.count(match[1]) != 0;
+
+            if (bKnownCurve)
+                curCurve = curveStrings[match[1]];
+
             curSHA      = shaStrings[match[2]];
 
             continue;
@@ -175,5 +184,69 @@ TestResult TestSigGen()
     }
 
     TestResult res;
+    return res;
+}
+
+/**
+ * ToBigInt - Convert a big endian byte string from the test vector files to a
+ * BigInt, which takes little endian bytes.
+ *
+ * @param bytes     [in] Big endian integer bytes.
+ *
+ * @return Integer value.
+ */
+
+static BigInt ToBigInt(const vector<uint8_t>& bytes)
+{
+    vector<uint8_t> le(bytes.rbegin(), bytes.rend());
+    return BigInt(le);
+}
+
+/**
+ * TestECMultiplyBase - Load the P-224 vectors from SigGen.txt and check the base
+ * point multiplication against them: dG must equal the public key Q, and the x
+ * coordinate of kG reduced mod n must equal the signature value r.
+ *
+ * @return  Pass if every scalar multiple matches, fail otherwise.
+ */
+
+TestResult TestECMultiplyBase()
+{
+    TestResult res;
+
+    vector<DSATestVec> testVecs;
+    LoadTestVecsFromFile("test/ecdsatestvectors/SigGen.txt", testVecs);
+
+    DPStrings paramStrings = curveDomainParams[P224];
+    DomainParams params(paramStrings);
+    EllipticCurve ec(params);
+
+    for (uint32_t i = 0; i < testVecs.size(); i++)
+    {
+        if (testVecs[i].curve != P224)
+            continue;
+
+        ECPoint Q   = ec.MultiplyBase(ToBigInt(testVecs[i].d));
+        ECPoint R   = ec.MultiplyBase(ToBigInt(testVecs[i].k));
+        BigInt r    = R.x % params.n;
+
+        if (Q.x != ToBigInt(testVecs[i].Qx) || Q.y != ToBigInt(testVecs[i].Qy) || r != ToBigInt(testVecs[i].r))
+        {
+            char msg[256];
+
+            sprintf(
+                msg,
+                "EC base point multiply failed for P-224 vector %u.",
+                i
+            );
+
+            res.caseResults.push_back({ FAIL, string(msg) });
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+    }
+
     return res;
 }
\ No newline at end of file
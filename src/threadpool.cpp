@@ -0,0 +1,186 @@
+#include "threadpool.h"
+
+static thread_local bool bInPoolTask = false;
+
+/**
+ * ThreadPool - Constructor. Start a fixed set of worker threads that sleep until
+ * ParallelFor hands them work.
+ *
+ * @param numWorkers    [in] Number of worker threads. The thread calling ParallelFor
+ *                           also runs tasks, so 0 gives serial execution.
+ */
+
+ThreadPool::ThreadPool(const uint32_t numWorkers) : generation(0), bStop(false)
+{
+    for (uint32_t i = 0; i < numWorkers; i++)
+        workers.push_back(thread(&ThreadPool::WorkerLoop, this));
+}
+
+/**
+ * ~ThreadPool - Destructor. Wake and join all workers.
+ */
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        bStop = true;
+    }
+
+    wakeCv.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+/**
+ * ThreadPool::Size - Number of threads that run tasks, counting the caller.
+ *
+ * @return Worker count plus one.
+ */
+
+uint32_t ThreadPool::Size() const
+{
+    return workers.size() + 1;
+}
+
+/**
+ * ThreadPool::Global - Process-wide pool with one thread per hardware thread
+ * (including the caller), created on first use.
+ *
+ * @return Shared thread pool.
+ */
+
+ThreadPool& ThreadPool::Global()
+{
+    static ThreadPool pool(max(1u, thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+/**
+ * ThreadPool::RunTasks - Claim and run task indices of a job until none are left,
+ * then record how many this thread completed. Indices are claimed from the job
+ * itself, so a worker that picks up a job late can never claim from the next one.
+ *
+ * @param jobIn [in/out] Job to run tasks from.
+ */
+
+void ThreadPool::RunTasks(ThreadPoolJob& jobIn)
+{
+    uint64_t done = 0;
+    exception_ptr error;
+
+    bInPoolTask = true;
+
+    for (uint64_t i = jobIn.nextTask++; i < jobIn.numTasks; i = jobIn.nextTask++)
+    {
+        try
+        {
+            (*jobIn.task)(i);
+        }
+        catch (...)
+        {
+            if (!error)
+                error = current_exception();
+        }
+
+        done++;
+    }
+
+    bInPoolTask = false;
+
+    if (done == 0)
+        return;
+
+    {
+        lock_guard<mutex> lock(mtx);
+
+        jobIn.tasksDone += done;
+
+        if (error && !jobIn.taskError)
+            jobIn.taskError = error;
+    }
+
+    doneCv.notify_all();
+}
+
+/**
+ * ThreadPool::WorkerLoop - Worker body. Sleep until a new job is posted, help run
+ * it, and report back. The worker holds its own reference to the job, so the job
+ * state stays valid even if ParallelFor has already returned.
+ */
+
+void ThreadPool::WorkerLoop()
+{
+    uint64_t seenGeneration = 0;
+
+    while (true)
+    {
+        shared_ptr<ThreadPoolJob> curJob;
+
+        {
+            unique_lock<mutex> lock(mtx);
+            wakeCv.wait(lock, [&]() { return bStop || (job && generation != seenGeneration); });
+
+            if (bStop)
+                return;
+
+            seenGeneration  = generation;
+            curJob          = job;
+        }
+
+        RunTasks(*curJob);
+    }
+}
+
+/**
+ * ThreadPool::ParallelFor - Run task(0) .. task(numTasksIn - 1) across the pool and
+ * the calling thread, returning once all have finished. Tasks are claimed one index
+ * at a time, so uneven task costs balance out. Calls from inside a pool task run
+ * serially instead of waiting on the pool. The first exception a task throws is
+ * rethrown here after the job completes.
+ *
+ * @param numTasksIn    [in] Number of tasks.
+ * @param taskIn        [in] Task body, called with the task index.
+ */
+
+void ThreadPool::ParallelFor(const uint64_t numTasksIn, const function<void(uint64_t)>& taskIn)
+{
+    if (numTasksIn == 0)
+        return;
+
+    if (bInPoolTask || workers.size() == 0 || numTasksIn == 1)
+    {
+        for (uint64_t i = 0; i < numTasksIn; i++)
+            taskIn(i);
+
+        return;
+    }
+
+    lock_guard<mutex> callLock(callMtx);
+
+    shared_ptr<ThreadPoolJob> curJob = make_shared<ThreadPoolJob>(&taskIn, numTasksIn);
+
+    {
+        lock_guard<mutex> lock(mtx);
+
+        job = curJob;
+        generation++;
+    }
+
+    wakeCv.notify_all();
+    RunTasks(*curJob);
+
+    exception_ptr error;
+
+    {
+        unique_lock<mutex> lock(mtx);
+        doneCv.wait(lock, [&]() { return curJob->tasksDone == curJob->numTasks; });
+
+        job     = nullptr;
+        error   = curJob->taskError;
+    }
+
+    if (error)
+        rethrow_exception(error);
+}
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "utils.h"
 
+#ifdef NISTCRYPTO_X86
+#include <cpuid.h>
+#endif
+
 static map<char, uint8_t> char2Hex =
 {
     { '0', 0x0 },
@@ -276,4 +280,130 @@ uint64_t InvModN(const uint64_t k, const uint64_t n)
         coeffsT[coeffsT.size() - 1] += n;
 
     return coeffsT[coeffsT.size() - 1];
+}
+
+#ifdef NISTCRYPTO_X86
+
+/**
+ * XGetBV - Read XCR0, the register state components the OS saves on context switch.
+ * Only valid when CPUID reports OSXSAVE.
+ *
+ * @return XCR0.
+ */
+
+static uint64_t XGetBV()
+{
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+#endif
+
+/**
+ * CPUSupports - Check whether the host CPU implements an instruction set extension.
+ * Queries CPUID on every call; runtime dispatch goes through CPUHasFeature, which
+ * caches the answers. Always false on non-x86 builds.
+ *
+ * @param feature   [in] Extension to check for.
+ *
+ * @return True if the extension is available.
+ */
+
+bool CPUSupports(const CPUFeature feature)
+{
+#ifdef NISTCRYPTO_X86
+
+    uint32_t eax = 0;
+    uint32_t ebx = 0;
+    uint32_t ecx = 0;
+    uint32_t edx = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    switch (feature)
+    {
+        case CPU_SSSE3:
+
+            return (ecx & (1U << 9)) != 0;
+
+        case CPU_SSE41:
+
+            return (ecx & (1U << 19)) != 0;
+
+        case CPU_AESNI:
+
+            return (ecx & (1U << 25)) != 0 && (ecx & (1U << 19)) != 0;
+
+        case CPU_PCLMUL:
+
+            return (ecx & (1U << 1)) != 0 && (ecx & (1U << 19)) != 0;
+
+        case CPU_SHA:
+        {
+            const bool bSSE = (ecx & (1U << 9)) != 0 && (ecx & (1U << 19)) != 0;
+
+            if (!bSSE || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return false;
+
+            return (ebx & (1U << 29)) != 0;
+        }
+
+        case CPU_AVX2:
+        case CPU_AVX512:
+        {
+            // The OS must also save the YMM (and for AVX-512, opmask and ZMM) state.
+
+            const uint64_t xcr0Mask = (feature == CPU_AVX2) ? 0x06 : 0xE6;
+            const uint32_t ebxMask  = (feature == CPU_AVX2) ? (1U << 5) : (1U << 16);
+
+            if ((ecx & (1U << 27)) == 0 || (XGetBV() & xcr0Mask) != xcr0Mask)
+                return false;
+
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return false;
+
+            return (ebx & ebxMask) != 0;
+        }
+
+        default:
+
+            return false;
+    }
+
+#else
+
+    (void)feature;
+    return false;
+
+#endif
+}
+
+/**
+ * CPUHasFeature - Cached CPUSupports for runtime dispatch. CPUID is queried once
+ * for every feature on first use, so engine selection in hot paths costs a table
+ * lookup.
+ *
+ * @param feature   [in] Extension to check for.
+ *
+ * @return True if the extension is available.
+ */
+
+bool CPUHasFeature(const CPUFeature feature)
+{
+    static const vector<bool> bSupported = []()
+    {
+        vector<bool> flags(CPU_NUM_FEATURES);
+
+        for (uint32_t i = 0; i < CPU_NUM_FEATURES; i++)
+            flags[i] = CPUSupports((CPUFeature)i);
+
+        return flags;
+    }();
+
+    return bSupported[feature];
 }
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include "xts.h"
+#include "threadpool.h"
+
+/**
+ * MulAlpha - Multiply a tweak by the primitive element alpha of GF(2^128), with the
+ * little-endian byte order of IEEE 1619: shift the 128-bit value left one bit and
+ * reduce the carry with x^7 + x^2 + x + 1.
+ *
+ * @param T     [in/out]    Tweak block.
+ */
+
+static inline void MulAlpha(uint8_t T[XTS_BLOCK_BYTES])
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    memcpy(&lo, &T[0], 8);
+    memcpy(&hi, &T[8], 8);
+
+    const uint64_t carry = hi >> 63;
+
+    hi = (hi << 1) | (lo >> 63);
+    lo = (lo << 1) ^ (0x87 & (0 - carry));
+
+    memcpy(&T[0], &lo, 8);
+    memcpy(&T[8], &hi, 8);
+}
+
+/**
+ * CryptBlock - XEX one block: XOR with the tweak, encrypt or decrypt, and XOR with
+ * the tweak again.
+ *
+ * @param dataAES   [in]    Data unit cipher, in ECB mode.
+ * @param T         [in]    Tweak for this block.
+ * @param in        [in]    Input block.
+ * @param out       [out]   Output block. May be the same as in.
+ * @param bEncrypt  [in]    True to encrypt, false to decrypt.
+ */
+
+static void CryptBlock(AES& dataAES, const uint8_t T[XTS_BLOCK_BYTES],
+    const uint8_t in[XTS_BLOCK_BYTES], uint8_t out[XTS_BLOCK_BYTES], const bool bEncrypt)
+{
+    uint8_t block[XTS_BLOCK_BYTES];
+
+    for (uint32_t i = 0; i < XTS_BLOCK_BYTES; i++)
+        block[i] = in[i] ^ T[i];
+
+    if (bEncrypt)
+        dataAES.Encrypt(block, block, XTS_BLOCK_BYTES);
+    else
+        dataAES.Decrypt(block, block, XTS_BLOCK_BYTES);
+
+    for (uint32_t i = 0; i < XTS_BLOCK_BYTES; i++)
+        out[i] = block[i] ^ T[i];
+}
+
+/**
+ * CryptSector - XTS-AES over one data unit (IEEE 1619 section 5, SP 800-38E).
+ * Whole blocks are masked with their tweaks a batch at a time and run through the
+ * data cipher's bulk ECB path. A trailing partial block uses ciphertext stealing:
+ * the last whole block is processed with the final tweak order swapped on
+ * decryption, and borrows the tail of its output to pad the partial block.
+ *
+ * @param dataAES   [in]    Data unit cipher (Key1), in ECB mode.
+ * @param tweakAES  [in]    Tweak cipher (Key2), in ECB mode.
+ * @param tweak     [in]    Tweak value i for the data unit.
+ * @param in        [in]    Input data unit.
+ * @param out       [out]   Output data unit. May be the same buffer as in.
+ * @param len       [in]    Data unit length in bytes, at least one block.
+ * @param bEncrypt  [in]    True to encrypt, false to decrypt.
+ */
+
+static void CryptSector(AES& dataAES, AES& tweakAES, const uint8_t tweak[XTS_BLOCK_BYTES],
+    const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt)
+{
+    const uint64_t nFull    = len / XTS_BLOCK_BYTES;
+    const uint64_t tail     = len % XTS_BLOCK_BYTES;
+    const uint64_t nBulk    = tail ? nFull - 1 : nFull;
+    uint8_t T[XTS_BLOCK_BYTES];
+
+    assert(nFull > 0);
+
+    tweakAES.Encrypt(tweak, T, XTS_BLOCK_BYTES);
+
+    for (uint64_t i = 0; i < nBulk; i += XTS_BATCH_BLOCKS)
+    {
+        const uint64_t batch    = min((uint64_t)XTS_BATCH_BLOCKS, nBulk - i);
+        const uint64_t offset   = XTS_BLOCK_BYTES * i;
+        uint8_t tweaks[XTS_BATCH_BLOCKS * XTS_BLOCK_BYTES];
+
+        for (uint64_t j = 0; j < batch; j++)
+        {
+            memcpy(&tweaks[XTS_BLOCK_BYTES * j], T, XTS_BLOCK_BYTES);
+            MulAlpha(T);
+        }
+
+        for (uint64_t k = 0; k < XTS_BLOCK_BYTES * batch; k++)
+            out[offset + k] = in[offset + k] ^ tweaks[k];
+
+        if (bEncrypt)
+            dataAES.Encrypt(&out[offset], &out[offset], XTS_BLOCK_BYTES * batch);
+        else
+            dataAES.Decrypt(&out[offset], &out[offset], XTS_BLOCK_BYTES * batch);
+
+        for (uint64_t k = 0; k < XTS_BLOCK_BYTES * batch; k++)
+            out[offset + k] ^= tweaks[k];
+    }
+
+    if (tail == 0)
+        return;
+
+    const uint64_t lastOffset = XTS_BLOCK_BYTES * nBulk;
+    uint8_t lastT[XTS_BLOCK_BYTES];
+    uint8_t stolen[XTS_BLOCK_BYTES];
+    uint8_t partial[XTS_BLOCK_BYTES];
+
+    memcpy(lastT, T, XTS_BLOCK_BYTES);
+    MulAlpha(lastT);
+
+    memcpy(partial, &in[lastOffset + XTS_BLOCK_BYTES], tail);
+
+    CryptBlock(dataAES, bEncrypt ? T : lastT, &in[lastOffset], stolen, bEncrypt);
+    memcpy(&partial[tail], &stolen[tail], XTS_BLOCK_BYTES - tail);
+
+    memcpy(&out[lastOffset + XTS_BLOCK_BYTES], stolen, tail);
+    CryptBlock(dataAES, bEncrypt ? lastT : T, partial, &out[lastOffset], bEncrypt);
+}
+
+/**
+ * XTS - Constructor. XTS-AES is defined for 128 and 256-bit keys only.
+ *
+ * @param sz    [in] AES key size of each of the two keys.
+ */
+
+XTS::XTS(AESSize sz) : size(sz), dataCipher(sz, ECB), tweakCipher(sz, ECB),
+    numThreads(max(1u, thread::hardware_concurrency())), parallelThreshold(AES_DEFAULT_PARALLEL_THRESHOLD)
+{
+    if (sz == AES192)
+        throw invalid_argument("XTS-AES supports AES-128 and AES-256 keys only.");
+}
+
+/**
+ * XTS::SetKey - Split an XTS key into the data unit key (Key1, first half) and
+ * tweak key (Key2, second half) and expand both. Identical halves are rejected,
+ * since they void the XTS security bound.
+ *
+ * @param key   [in]    Key1 followed by Key2, as AES key words.
+ */
+
+void XTS::SetKey(const vector<uint32_t>& key)
+{
+    const uint32_t nk = (size == AES128) ? 4 : 8;
+
+    if (key.size() != 2 * nk)
+        throw invalid_argument("XTS key must be two AES keys of the configured size.");
+
+    const vector<uint32_t> key1(key.begin(), key.begin() + nk);
+    const vector<uint32_t> key2(key.begin() + nk, key.end());
+
+    if (key1 == key2)
+        throw invalid_argument("XTS data and tweak keys must differ.");
+
+    dataSched.Expand(key1, dataCipher.engine == AES_BITSLICED);
+    tweakSched.Expand(key2, tweakCipher.engine == AES_BITSLICED);
+
+    dataCipher.SetKey(dataSched);
+    tweakCipher.SetKey(tweakSched);
+}
+
+/**
+ * XTS::SetEngine - Select the block cipher implementation for both keys.
+ *
+ * @param engineIn  [in] AES engine. Leaving the bitsliced engine fills in the
+ *                       table-derived round keys of both schedules.
+ */
+
+void XTS::SetEngine(const AESEngine engineIn)
+{
+    if (engineIn != AES_BITSLICED)
+    {
+        dataSched.ExpandTables();
+        tweakSched.ExpandTables();
+    }
+
+    dataCipher.SetEngine(engineIn);
+    tweakCipher.SetEngine(engineIn);
+}
+
+/**
+ * XTS::SetThreading - Configure multi-threaded processing of multi-sector buffers.
+ *
+ * @param numThreadsIn          [in] Maximum number of worker threads. 1 disables threading.
+ * @param parallelThresholdIn   [in] Minimum buffer length in bytes before sectors are split
+ *                                   across threads.
+ */
+
+void XTS::SetThreading(const uint32_t numThreadsIn, const uint64_t parallelThresholdIn)
+{
+    if (numThreadsIn == 0)
+        throw invalid_argument("XTS thread count must be at least 1.");
+
+    numThreads          = numThreadsIn;
+    parallelThreshold   = parallelThresholdIn;
+}
+
+/**
+ * XTS::SectorTweak - Tweak for a data unit sequence number: the number as a 128-bit
+ * little-endian value (IEEE 1619 section 5.1).
+ *
+ * @param sectorNum [in]    Data unit sequence number.
+ * @param tweak     [out]   Tweak block.
+ */
+
+void XTS::SectorTweak(const uint64_t sectorNum, uint8_t tweak[XTS_BLOCK_BYTES])
+{
+    memset(tweak, 0, XTS_BLOCK_BYTES);
+
+    for (uint32_t i = 0; i < 8; i++)
+        tweak[i] = (uint8_t)(sectorNum >> (8 * i));
+}
+
+/**
+ * XTS::EncryptSector - Encrypt one data unit under a caller-supplied tweak.
+ *
+ * @param tweak [in]    Tweak value for the data unit.
+ * @param in    [in]    Plaintext.
+ * @param out   [out]   Ciphertext. May be the same buffer as in.
+ * @param len   [in]    Length in bytes, at least 16.
+ */
+
+void XTS::EncryptSector(const uint8_t tweak[XTS_BLOCK_BYTES], const uint8_t* in,
+    uint8_t* out, const uint64_t len)
+{
+    if (len < XTS_BLOCK_BYTES)
+        throw invalid_argument("XTS data units must be at least one block long.");
+
+    CryptSector(dataCipher, tweakCipher, tweak, in, out, len, true);
+}
+
+/**
+ * XTS::DecryptSector - Decrypt one data unit under a caller-supplied tweak.
+ *
+ * @param tweak [in]    Tweak value for the data unit.
+ * @param in    [in]    Ciphertext.
+ * @param out   [out]   Plaintext. May be the same buffer as in.
+ * @param len   [in]    Length in bytes, at least 16.
+ */
+
+void XTS::DecryptSector(const uint8_t tweak[XTS_BLOCK_BYTES], const uint8_t* in,
+    uint8_t* out, const uint64_t len)
+{
+    if (len < XTS_BLOCK_BYTES)
+        throw invalid_argument("XTS data units must be at least one block long.");
+
+    CryptSector(dataCipher, tweakCipher, tweak, in, out, len, false);
+}
+
+/**
+ * XTS::EncryptSectors - Encrypt consecutive sectors of a buffer, such as a run of
+ * disk blocks or database pages. Sector n of the buffer uses the tweak for
+ * firstSector + n.
+ *
+ * @param firstSector   [in]    Sequence number of the first sector.
+ * @param sectorBytes   [in]    Sector size in bytes, at least 16.
+ * @param in            [in]    Plaintext sectors.
+ * @param out           [out]   Ciphertext sectors. May be the same buffer as in.
+ * @param len           [in]    Buffer length. The last sector may be short, but
+ *                              not shorter than one block.
+ */
+
+void XTS::EncryptSectors(const uint64_t firstSector, const uint64_t sectorBytes,
+    const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    CryptSectors(firstSector, sectorBytes, in, out, len, true);
+}
+
+/**
+ * XTS::DecryptSectors - Decrypt consecutive sectors of a buffer. Sector n of the
+ * buffer uses the tweak for firstSector + n.
+ *
+ * @param firstSector   [in]    Sequence number of the first sector.
+ * @param sectorBytes   [in]    Sector size in bytes, at least 16.
+ * @param in            [in]    Ciphertext sectors.
+ * @param out           [out]   Plaintext sectors. May be the same buffer as in.
+ * @param len           [in]    Buffer length. The last sector may be short, but
+ *                              not shorter than one block.
+ */
+
+void XTS::DecryptSectors(const uint64_t firstSector, const uint64_t sectorBytes,
+    const uint8_t* in, uint8_t* out, const uint64_t len)
+{
+    CryptSectors(firstSector, sectorBytes, in, out, len, false);
+}
+
+/**
+ * XTS::CryptSectors - Process consecutive sectors. Sectors are independent, so
+ * buffers at or above the parallel threshold are split into contiguous sector
+ * ranges run on the shared thread pool, each with its own cipher objects over the
+ * shared key schedules.
+ *
+ * @param firstSector   [in]    Sequence number of the first sector.
+ * @param sectorBytes   [in]    Sector size in bytes.
+ * @param in            [in]    Input sectors.
+ * @param out           [out]   Output sectors. May be the same buffer as in.
+ * @param len           [in]    Buffer length.
+ * @param bEncrypt      [in]    True to encrypt, false to decrypt.
+ */
+
+void XTS::CryptSectors(const uint64_t firstSector, const uint64_t sectorBytes,
+    const uint8_t* in, uint8_t* out, const uint64_t len, const bool bEncrypt)
+{
+    if (sectorBytes < XTS_BLOCK_BYTES)
+        throw invalid_argument("XTS data units must be at least one block long.");
+
+    if (len == 0)
+        return;
+
+    const uint64_t nSectors = (len + sectorBytes - 1) / sectorBytes;
+
+    if (len - (nSectors - 1) * sectorBytes < XTS_BLOCK_BYTES)
+        throw invalid_argument("XTS data units must be at least one block long.");
+
+    uint64_t nWorkers = (len >= parallelThreshold) ? min((uint64_t)numThreads, nSectors) : 1;
+
+    if (nWorkers == 1)
+    {
+        for (uint64_t i = 0; i < nSectors; i++)
+        {
+            const uint64_t offset = i * sectorBytes;
+            uint8_t tweak[XTS_BLOCK_BYTES];
+
+            SectorTweak(firstSector + i, tweak);
+            CryptSector(dataCipher, tweakCipher, tweak, &in[offset], &out[offset],
+                min(sectorBytes, len - offset), bEncrypt);
+        }
+
+        return;
+    }
+
+    const uint64_t sectorsPerWorker = (nSectors + nWorkers - 1) / nWorkers;
+
+    ThreadPool::Global().ParallelFor(nWorkers, [&](uint64_t w)
+    {
+        const uint64_t startSector  = w * sectorsPerWorker;
+        const uint64_t endSector    = min(nSectors, startSector + sectorsPerWorker);
+
+        AES dataAES(dataCipher);
+        AES tweakAES(tweakCipher);
+
+        for (uint64_t i = startSector; i < endSector; i++)
+        {
+            const uint64_t offset = i * sectorBytes;
+            uint8_t tweak[XTS_BLOCK_BYTES];
+
+            SectorTweak(firstSector + i, tweak);
+            CryptSector(dataAES, tweakAES, tweak, &in[offset], &out[offset],
+                min(sectorBytes, len - offset), bEncrypt);
+        }
+    });
+}
\ No newline at end of file
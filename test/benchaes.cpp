@@ -0,0 +1,491 @@
+#include "test.h"
+#include "aes.h"
+#include "gcm.h"
+#include "xts.h"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const uint64_t benchBytesRef    = 1 << 16;
+static const uint64_t benchBytes       = 1 << 22;
+static const uint64_t benchXTSFileBytes = 2ull << 30;
+
+/**
+ * GenAESKey - Build a random key of the right word count for an AES key size.
+ *
+ * @param sz    [in]        AES key size.
+ * @param key   [in/out]    Generated key words.
+ */
+
+static void GenAESKey(const AESSize sz, vector<uint32_t>& key)
+{
+    const uint32_t nk = (sz == AES128) ? 4 : (sz == AES192) ? 6 : 8;
+    vector<uint8_t> keyBytes;
+
+    GenKey(32 * nk, keyBytes);
+    key.resize(nk);
+    memcpy(&key[0], &keyBytes[0], 4 * nk);
+}
+
+/**
+ * BenchAESEngines - Compare ECB encryption and decryption throughput of the
+ * reference FIPS 197 rounds, the table-driven rounds, the constant-time bitsliced
+ * rounds and, when available, the AES-NI instructions for each key size.
+ */
+
+void BenchAESEngines()
+{
+    const AESSize sizes[3]          = { AES128, AES192, AES256 };
+    const char* sizeNames[3]        = { "AES128", "AES192", "AES256" };
+    const AESEngine engines[4]      = { AES_REFERENCE, AES_TTABLE, AES_BITSLICED, AES_AESNI };
+    const char* engineNames[4]      = { "reference", "T-table", "bitsliced", "AES-NI" };
+    const uint32_t numEngines       = AESNISupported() ? 4 : 3;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        vector<uint32_t> key;
+        GenAESKey(sizes[i], key);
+
+        for (uint32_t j = 0; j < numEngines; j++)
+        {
+            const uint64_t bytes = (engines[j] == AES_REFERENCE) ? benchBytesRef : benchBytes;
+
+            vector<uint8_t> plainTxt;
+            GenKey(8 * bytes, plainTxt);
+
+            AES aes(sizes[i], ECB);
+            aes.SetEngine(engines[j]);
+
+            vector<uint8_t> cipherTxt;
+            vector<uint8_t> plainTxtOut;
+
+            double start = GetTimeSeconds();
+            aes.Encrypt(plainTxt, cipherTxt, key);
+            double encSecs = GetTimeSeconds() - start;
+
+            start = GetTimeSeconds();
+            aes.Decrypt(cipherTxt, plainTxtOut, key);
+            double decSecs = GetTimeSeconds() - start;
+
+            assert(plainTxtOut == plainTxt);
+
+            PrintThroughput(string(sizeNames[i]) + " ECB encrypt (" + engineNames[j] + ")", bytes, encSecs);
+            PrintThroughput(string(sizeNames[i]) + " ECB decrypt (" + engineNames[j] + ")", bytes, decSecs);
+        }
+    }
+}
+
+/**
+ * BenchAESKeySchedule - Encrypt many small ECB records under one key, once expanding
+ * the key on every call and once reusing a single expanded AESKeySchedule.
+ */
+
+void BenchAESKeySchedule()
+{
+    const uint64_t recordSizes[3]   = { 16, 64, 256 };
+    const uint64_t totalBytes       = 1 << 20;
+
+    vector<uint32_t> key;
+    GenAESKey(AES128, key);
+
+    const AESKeySchedule sched(key);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const uint64_t numRecords = totalBytes / recordSizes[i];
+
+        vector<uint8_t> plainTxt;
+        GenKey(8 * recordSizes[i], plainTxt);
+
+        AES aes(AES128, ECB);
+        vector<uint8_t> cipherTxt;
+
+        double start = GetTimeSeconds();
+
+        for (uint64_t j = 0; j < numRecords; j++)
+        {
+            cipherTxt.clear();
+            aes.Encrypt(plainTxt, cipherTxt, key);
+        }
+
+        double expandSecs = GetTimeSeconds() - start;
+
+        aes.SetKey(sched);
+        start = GetTimeSeconds();
+
+        for (uint64_t j = 0; j < numRecords; j++)
+        {
+            cipherTxt.clear();
+            aes.Encrypt(plainTxt, cipherTxt);
+        }
+
+        double reuseSecs = GetTimeSeconds() - start;
+
+        const string recordName = "AES128 ECB " + to_string(recordSizes[i]) + " B records";
+
+        PrintThroughput(recordName + " (expand per call)", totalBytes, expandSecs);
+        PrintThroughput(recordName + " (shared schedule)", totalBytes, reuseSecs);
+    }
+}
+
+/**
+ * BenchAESMultiKey - Encrypt one or two blocks under each of many AES-128 and AES-256
+ * keys, once with an AESKeySchedule and AES object per key and once with the batch
+ * API on each engine, next to bulk ECB under a single key for comparison.
+ */
+
+void BenchAESMultiKey()
+{
+    const AESSize sizes[2]      = { AES128, AES256 };
+    const char* sizeNames[2]    = { "AES128", "AES256" };
+    const uint32_t nks[2]       = { 4, 8 };
+    const AESEngine engines[2]  = { AES_TTABLE, AES_AESNI };
+    const char* engineNames[2]  = { "T-table", "AES-NI" };
+    const uint32_t numEngines   = AESNISupported() ? 2 : 1;
+    const uint64_t numKeys      = 1 << 16;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        vector<uint8_t> keyBytes;
+        GenKey(32 * nks[i] * numKeys, keyBytes);
+
+        vector<uint32_t> keys(nks[i] * numKeys);
+        memcpy(&keys[0], &keyBytes[0], 4 * keys.size());
+
+        for (uint64_t blocksPerKey = 1; blocksPerKey <= 2; blocksPerKey++)
+        {
+            const uint64_t bytes = 16 * blocksPerKey * numKeys;
+            const string label = string(sizeNames[i]) + " " + to_string(blocksPerKey) + " block(s) per key";
+
+            vector<uint8_t> plainTxt;
+            vector<uint8_t> cipherTxt(bytes);
+
+            GenKey(8 * bytes, plainTxt);
+
+            AES aes(sizes[i], ECB);
+            AESKeySchedule sched;
+
+            double start = GetTimeSeconds();
+
+            for (uint64_t k = 0; k < numKeys; k++)
+            {
+                sched.Expand(vector<uint32_t>(&keys[nks[i] * k], &keys[nks[i] * (k + 1)]));
+                aes.SetKey(sched);
+                aes.Encrypt(&plainTxt[16 * blocksPerKey * k], &cipherTxt[16 * blocksPerKey * k],
+                    16 * blocksPerKey);
+            }
+
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput(label + " (schedule per key)", bytes, secs);
+
+            for (uint32_t j = 0; j < numEngines; j++)
+            {
+                start = GetTimeSeconds();
+                AESEncryptMultiKey(sizes[i], engines[j], &keys[0], &plainTxt[0], &cipherTxt[0],
+                    numKeys, blocksPerKey);
+                secs = GetTimeSeconds() - start;
+
+                PrintThroughput(label + " (batch, " + engineNames[j] + ")", bytes, secs);
+            }
+
+            aes.SetEngine(engines[numEngines - 1]);
+
+            start = GetTimeSeconds();
+            aes.Encrypt(&plainTxt[0], &cipherTxt[0], bytes);
+            secs = GetTimeSeconds() - start;
+
+            PrintThroughput(label + " (bulk ECB, one key, " + engineNames[numEngines - 1] + ")", bytes, secs);
+        }
+    }
+}
+
+/**
+ * BenchAESCFBSegments - CFB1 and CFB8 encryption and decryption throughput for each
+ * engine. Both modes run one block encryption per segment, so these measure the
+ * per-segment overhead around the cipher as much as the cipher itself.
+ */
+
+void BenchAESCFBSegments()
+{
+    const AESMode modes[2]      = { CFB1, CFB8 };
+    const char* modeNames[2]    = { "CFB1", "CFB8" };
+    const uint64_t modeBytes[2] = { 1 << 14, 1 << 17 };
+    const AESEngine engines[3]  = { AES_BITSLICED, AES_TTABLE, AES_AESNI };
+    const char* engineNames[3]  = { "bitsliced", "T-table", "AES-NI" };
+    const uint32_t numEngines   = AESNISupported() ? 3 : 2;
+
+    vector<uint32_t> key;
+    GenAESKey(AES128, key);
+
+    const AESKeySchedule sched(key);
+    const vector<uint32_t> iv = { 0, 0, 0, 0 };
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        for (uint32_t j = 0; j < numEngines; j++)
+        {
+            const uint64_t bytes = (engines[j] == AES_BITSLICED) ? modeBytes[i] / 8 : modeBytes[i];
+
+            vector<uint8_t> buf;
+            GenKey(8 * bytes, buf);
+
+            AES aes(AES128, modes[i]);
+            aes.SetEngine(engines[j]);
+            aes.SetKey(sched);
+            aes.SetIV(iv);
+
+            double start = GetTimeSeconds();
+            aes.Encrypt(buf.data(), buf.data(), bytes);
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput("AES128 " + string(modeNames[i]) + " encrypt (" + engineNames[j] + ")", bytes, secs);
+
+            aes.SetIV(iv);
+
+            start = GetTimeSeconds();
+            aes.Decrypt(buf.data(), buf.data(), bytes);
+            secs = GetTimeSeconds() - start;
+
+            PrintThroughput("AES128 " + string(modeNames[i]) + " decrypt (" + engineNames[j] + ")", bytes, secs);
+        }
+    }
+}
+
+/**
+ * BenchAESCTR - CTR mode throughput for each engine, single-threaded and split
+ * across all hardware threads.
+ */
+
+void BenchAESCTR()
+{
+    const AESEngine engines[3]  = { AES_TTABLE, AES_BITSLICED, AES_AESNI };
+    const char* engineNames[3]  = { "T-table", "bitsliced", "AES-NI" };
+    const uint32_t numEngines   = AESNISupported() ? 3 : 2;
+    const uint32_t maxThreads   = max(1u, thread::hardware_concurrency());
+    const uint64_t bytes        = 1 << 24;
+
+    vector<uint32_t> key;
+    GenAESKey(AES128, key);
+
+    const AESKeySchedule sched(key);
+    const vector<uint32_t> iv = { 0, 0, 0, 0 };
+
+    vector<uint8_t> plainTxt;
+    GenKey(8 * bytes, plainTxt);
+
+    for (uint32_t i = 0; i < numEngines; i++)
+    {
+        const uint32_t threadCounts[2] = { 1, maxThreads };
+
+        for (uint32_t j = 0; j < 2; j++)
+        {
+            AES aes(AES128, CTR);
+            aes.SetEngine(engines[i]);
+            aes.SetKey(sched);
+            aes.SetThreading(threadCounts[j], AES_DEFAULT_PARALLEL_THRESHOLD);
+            aes.SetIV(iv);
+
+            vector<uint8_t> cipherTxt;
+
+            double start = GetTimeSeconds();
+            aes.Encrypt(plainTxt, cipherTxt);
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput("AES128 CTR (" + string(engineNames[i]) + ", " +
+                to_string(threadCounts[j]) + " threads)", bytes, secs);
+        }
+    }
+}
+
+/**
+ * BenchAESCBCDecrypt - CBC decryption throughput for each engine, single-threaded
+ * and split across all hardware threads, next to serial CBC encryption.
+ */
+
+void BenchAESCBCDecrypt()
+{
+    const AESEngine engines[3]  = { AES_TTABLE, AES_BITSLICED, AES_AESNI };
+    const char* engineNames[3]  = { "T-table", "bitsliced", "AES-NI" };
+    const uint32_t numEngines   = AESNISupported() ? 3 : 2;
+    const uint32_t maxThreads   = max(1u, thread::hardware_concurrency());
+    const uint64_t bytes        = 1 << 24;
+
+    vector<uint32_t> key;
+    GenAESKey(AES128, key);
+
+    const AESKeySchedule sched(key);
+    const vector<uint32_t> iv = { 0, 0, 0, 0 };
+
+    vector<uint8_t> plainTxt;
+    GenKey(8 * bytes, plainTxt);
+
+    for (uint32_t i = 0; i < numEngines; i++)
+    {
+        AES aes(AES128, CBC);
+        aes.SetEngine(engines[i]);
+        aes.SetKey(sched);
+        aes.SetIV(iv);
+
+        vector<uint8_t> cipherTxt;
+
+        double start = GetTimeSeconds();
+        aes.Encrypt(plainTxt, cipherTxt);
+        double secs = GetTimeSeconds() - start;
+
+        PrintThroughput("AES128 CBC encrypt (" + string(engineNames[i]) + ")", bytes, secs);
+
+        const uint32_t threadCounts[2] = { 1, maxThreads };
+
+        for (uint32_t j = 0; j < 2; j++)
+        {
+            aes.SetThreading(threadCounts[j], AES_DEFAULT_PARALLEL_THRESHOLD);
+            aes.SetIV(iv);
+
+            vector<uint8_t> plainTxtOut;
+
+            start = GetTimeSeconds();
+            aes.Decrypt(cipherTxt, plainTxtOut);
+            secs = GetTimeSeconds() - start;
+
+            PrintThroughput("AES128 CBC decrypt (" + string(engineNames[i]) + ", " +
+                to_string(threadCounts[j]) + " threads)", bytes, secs);
+        }
+    }
+}
+
+/**
+ * BenchAESGCM - AES-128-GCM encryption throughput for 64 B, 1 KiB and 1 MiB messages
+ * with the portable table GHASH variants and, when available, the fused AES-NI and
+ * PCLMULQDQ path.
+ */
+
+void BenchAESGCM()
+{
+    const uint64_t msgSizes[3]      = { 64, 1 << 10, 1 << 20 };
+    const char* msgNames[3]         = { "64 B", "1 KiB", "1 MiB" };
+    const AESEngine aesEngines[3]   = { AES_TTABLE, AES_TTABLE, AES_AESNI };
+    const GHASHEngine ghashEngines[3] = { GHASH_4BIT, GHASH_8BIT, GHASH_PCLMUL };
+    const char* engineNames[3]      = { "T-table, 4-bit GHASH", "T-table, 8-bit GHASH", "AES-NI, PCLMULQDQ" };
+    const uint32_t numEngines       = AESNIGCMSupported() ? 3 : 2;
+    const uint64_t totalBytes       = 1 << 22;
+
+    vector<uint32_t> key;
+    GenAESKey(AES128, key);
+
+    vector<uint8_t> iv;
+    vector<uint8_t> aad;
+
+    GenKey(96, iv);
+    GenKey(128, aad);
+
+    for (uint32_t i = 0; i < numEngines; i++)
+    {
+        GCM gcm(AES128);
+        gcm.SetEngine(aesEngines[i]);
+        gcm.SetGHASHEngine(ghashEngines[i]);
+        gcm.SetKey(key);
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            const uint64_t numMsgs = totalBytes / msgSizes[j];
+
+            vector<uint8_t> plainTxt;
+            GenKey(8 * msgSizes[j], plainTxt);
+
+            vector<uint8_t> cipherTxt;
+            vector<uint8_t> tag;
+
+            double start = GetTimeSeconds();
+
+            for (uint64_t k = 0; k < numMsgs; k++)
+            {
+                cipherTxt.clear();
+                gcm.Encrypt(iv, aad, plainTxt, cipherTxt, tag);
+            }
+
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput("AES128-GCM " + string(msgNames[j]) + " (" + engineNames[i] + ")", totalBytes, secs);
+        }
+    }
+}
+
+/**
+ * BenchAESXTS - XTS-AES-128 throughput over a 2 GiB memory-mapped file, encrypted and
+ * decrypted in place as 4 KiB sectors, on one thread and on all hardware threads.
+ * Uses AES-NI when available, otherwise the T-table engine.
+ */
+
+void BenchAESXTS()
+{
+    const AESEngine engine      = AESNISupported() ? AES_AESNI : AES_TTABLE;
+    const char* engineName      = AESNISupported() ? "AES-NI" : "T-table";
+    const uint32_t maxThreads   = max(1u, thread::hardware_concurrency());
+    const uint32_t threadCounts[2] = { 1, maxThreads };
+
+    char path[] = "/tmp/nistcrypto-xts-XXXXXX";
+    int fd = mkstemp(path);
+
+    if (fd < 0)
+    {
+        printf("BenchAESXTS: could not create a temporary file.\n");
+        return;
+    }
+
+    unlink(path);
+
+    if (ftruncate(fd, benchXTSFileBytes) != 0)
+    {
+        printf("BenchAESXTS: could not size the temporary file.\n");
+        close(fd);
+        return;
+    }
+
+    uint8_t* disk = (uint8_t*)mmap(nullptr, benchXTSFileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (disk == MAP_FAILED)
+    {
+        printf("BenchAESXTS: could not map the temporary file.\n");
+        close(fd);
+        return;
+    }
+
+    memset(disk, 0xa5, benchXTSFileBytes);
+
+    vector<uint8_t> keyBytes;
+    vector<uint32_t> key(8);
+
+    GenKey(256, keyBytes);
+    memcpy(&key[0], &keyBytes[0], 32);
+
+    XTS xts(AES128);
+    xts.SetEngine(engine);
+    xts.SetKey(key);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        xts.SetThreading(threadCounts[i], AES_DEFAULT_PARALLEL_THRESHOLD);
+
+        const string label = string(engineName) + ", " + to_string(threadCounts[i]) + " threads";
+
+        double start = GetTimeSeconds();
+        xts.EncryptSectors(0, XTS_SECTOR_BYTES, disk, disk, benchXTSFileBytes);
+        double secs = GetTimeSeconds() - start;
+
+        PrintThroughput("AES128-XTS 4 KiB sectors encrypt (" + label + ")", benchXTSFileBytes, secs);
+
+        start = GetTimeSeconds();
+        xts.DecryptSectors(0, XTS_SECTOR_BYTES, disk, disk, benchXTSFileBytes);
+        secs = GetTimeSeconds() - start;
+
+        PrintThroughput("AES128-XTS 4 KiB sectors decrypt (" + label + ")", benchXTSFileBytes, secs);
+    }
+
+    if (disk[0] != 0xa5 || disk[benchXTSFileBytes - 1] != 0xa5)
+        printf("BenchAESXTS: sectors did not decrypt back to the original data.\n");
+
+    munmap(disk, benchXTSFileBytes);
+    close(fd);
+}
\ No newline at end of file
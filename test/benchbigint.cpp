@@ -0,0 +1,207 @@
+#include "test.h"
+#include "bigint.h"
+#include "modarith.h"
+
+#define BIGINT_BENCH_NO_THRESHOLD   (1ULL << 40)
+
+/**
+ * TimeMul - Average time of one product or square of two random n-limb ints
+ * under the given multiplication thresholds.
+ *
+ * @param nLimbs        [in] Operand size in limbs.
+ * @param karatsuba     [in] Karatsuba threshold to time with.
+ * @param toom3         [in] Toom-3 threshold to time with.
+ * @param bSquare       [in] Time squaring instead of a general multiply.
+ *
+ * @return Seconds per operation.
+ */
+
+static double TimeMul(const uint64_t nLimbs, const uint64_t karatsuba, const uint64_t toom3, const bool bSquare)
+{
+    BigInt a;
+    BigInt b;
+    BigIntRand(64 * nLimbs, a);
+    BigIntRand(64 * nLimbs, b);
+
+    BigIntSetMulThresholds(karatsuba, toom3, karatsuba, toom3);
+
+    const uint64_t numOps = max((uint64_t)4, (uint64_t)(1 << 22) / (nLimbs * nLimbs));
+    double best = 1e30;
+
+    for (uint32_t rep = 0; rep < 5; rep++)
+    {
+        double start = GetTimeSeconds();
+
+        for (uint64_t i = 0; i < numOps; i++)
+        {
+            BigInt c = bSquare ? a.Square() : a * b;
+            (void)c;
+        }
+
+        best = min(best, (GetTimeSeconds() - start) / numOps);
+    }
+
+    BigIntSetMulThresholds(BIGINT_KARATSUBA_THRESHOLD, BIGINT_TOOM3_THRESHOLD,
+        BIGINT_SQR_KARATSUBA_THRESHOLD, BIGINT_SQR_TOOM3_THRESHOLD);
+
+    return best;
+}
+
+/**
+ * BenchBigIntMul - Multiply and square time for 1024 to 65536-bit operands with
+ * schoolbook only, schoolbook + Karatsuba, and the default thresholds, which add
+ * Toom-3.
+ */
+
+void BenchBigIntMul()
+{
+    const uint64_t bitSizes[7] = { 1024, 2048, 4096, 8192, 16384, 32768, 65536 };
+
+    for (uint32_t i = 0; i < 7; i++)
+    {
+        const uint64_t nLimbs   = bitSizes[i] / 64;
+        const string size       = to_string(bitSizes[i]) + "-bit";
+
+        for (uint32_t sq = 0; sq < 2; sq++)
+        {
+            const string op             = sq ? "square " : "multiply ";
+            const uint64_t karatsuba    = sq ? BIGINT_SQR_KARATSUBA_THRESHOLD : BIGINT_KARATSUBA_THRESHOLD;
+            const uint64_t toom3        = sq ? BIGINT_SQR_TOOM3_THRESHOLD : BIGINT_TOOM3_THRESHOLD;
+
+            PrintOpTime(op + size + " (schoolbook)", 1,
+                TimeMul(nLimbs, BIGINT_BENCH_NO_THRESHOLD, BIGINT_BENCH_NO_THRESHOLD, sq));
+            PrintOpTime(op + size + " (Karatsuba)", 1,
+                TimeMul(nLimbs, karatsuba, BIGINT_BENCH_NO_THRESHOLD, sq));
+            PrintOpTime(op + size + " (Karatsuba + Toom-3)", 1,
+                TimeMul(nLimbs, karatsuba, toom3, sq));
+        }
+    }
+}
+
+/**
+ * FindCrossover - Find the smallest operand size at which one top-level step of
+ * the faster algorithm beats the slower one for two sizes in a row. Setting the
+ * threshold to exactly n forces the faster algorithm at the top level only, with
+ * the recursive pieces falling back to the lower thresholds.
+ *
+ * @param lo            [in] Smallest size to try, in limbs.
+ * @param hi            [in] Largest size to try, in limbs.
+ * @param step          [in] Size increment in limbs.
+ * @param bToom3        [in] Tune the Toom-3 threshold instead of Karatsuba.
+ * @param karatsuba     [in] Karatsuba threshold to hold fixed when tuning Toom-3.
+ * @param bSquare       [in] Tune squaring instead of a general multiply.
+ *
+ * @return Crossover size in limbs, or hi if none was found.
+ */
+
+static uint64_t FindCrossover(const uint64_t lo, const uint64_t hi, const uint64_t step,
+    const bool bToom3, const uint64_t karatsuba, const bool bSquare)
+{
+    uint64_t wins = 0;
+
+    for (uint64_t n = lo; n <= hi; n += step)
+    {
+        double tOff = bToom3 ? TimeMul(n, karatsuba, BIGINT_BENCH_NO_THRESHOLD, bSquare) :
+            TimeMul(n, BIGINT_BENCH_NO_THRESHOLD, BIGINT_BENCH_NO_THRESHOLD, bSquare);
+        double tOn  = bToom3 ? TimeMul(n, karatsuba, n, bSquare) :
+            TimeMul(n, n, BIGINT_BENCH_NO_THRESHOLD, bSquare);
+
+        wins = (tOn < tOff) ? wins + 1 : 0;
+
+        if (wins == 2)
+            return n - step;
+    }
+
+    return hi;
+}
+
+/**
+ * BenchBigIntMulThresholds - Tune the Karatsuba and Toom-3 crossover points for
+ * this machine, for general multiplies and for squares, and print them next to
+ * the compiled-in defaults in bigint.h.
+ */
+
+void BenchBigIntMulThresholds()
+{
+    for (uint32_t sq = 0; sq < 2; sq++)
+    {
+        const string op     = sq ? "square" : "multiply";
+        uint64_t karatsuba  = FindCrossover(4, 128, 2, false, 0, sq);
+        uint64_t toom3      = FindCrossover(karatsuba, 768, 16, true, karatsuba, sq);
+
+        printf("    %-48s %10llu limbs (default %d)\n", (op + " Karatsuba threshold").c_str(),
+            (unsigned long long)karatsuba, sq ? BIGINT_SQR_KARATSUBA_THRESHOLD : BIGINT_KARATSUBA_THRESHOLD);
+        printf("    %-48s %10llu limbs (default %d)\n", (op + " Toom-3 threshold").c_str(),
+            (unsigned long long)toom3, sq ? BIGINT_SQR_TOOM3_THRESHOLD : BIGINT_TOOM3_THRESHOLD);
+    }
+}
+
+/**
+ * BenchBarrettReduce - Time to reduce a double width product mod m with
+ * operator%= and with a Barrett reducer built once for m, for moduli the size of
+ * the NIST P-224, P-256, P-384 and P-521 primes.
+ */
+
+void BenchBarrettReduce()
+{
+    const uint64_t bitSizes[4]  = { 224, 256, 384, 521 };
+    const uint64_t numProducts  = 256;
+    const uint64_t numRounds    = 256;
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const string size = to_string(bitSizes[i]) + "-bit";
+
+        BigInt m;
+        BigIntRand(bitSizes[i], m);
+
+        BarrettCtx ctx(m);
+        vector<BigInt> products(numProducts);
+
+        for (uint64_t j = 0; j < numProducts; j++)
+        {
+            BigInt a;
+            BigInt b;
+            BigIntRand(bitSizes[i], a);
+            BigIntRand(bitSizes[i], b);
+
+            products[j] = (a % m) * (b % m);
+        }
+
+        double best = 1e30;
+
+        for (uint32_t rep = 0; rep < 5; rep++)
+        {
+            double start = GetTimeSeconds();
+
+            for (uint64_t r = 0; r < numRounds; r++)
+                for (uint64_t j = 0; j < numProducts; j++)
+                {
+                    BigInt x = products[j];
+                    x %= m;
+                }
+
+            best = min(best, GetTimeSeconds() - start);
+        }
+
+        PrintOpTime("reduce " + size + " (operator%=)", numRounds * numProducts, best);
+
+        best = 1e30;
+
+        for (uint32_t rep = 0; rep < 5; rep++)
+        {
+            double start = GetTimeSeconds();
+
+            for (uint64_t r = 0; r < numRounds; r++)
+                for (uint64_t j = 0; j < numProducts; j++)
+                {
+                    BigInt x = ctx.Reduce(products[j]);
+                    (void)x;
+                }
+
+            best = min(best, GetTimeSeconds() - start);
+        }
+
+        PrintOpTime("reduce " + size + " (Barrett)", numRounds * numProducts, best);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "test.h"
+#include "sha.h"
+#include "shani.h"
+#include "sha2multi.h"
+#include "keccakmulti.h"
+
+/**
+ * BenchSHA2 - SHA-256 throughput for 64 B, 1 KiB and 1 MiB messages with the scalar
+ * rounds and, when available, the SHA extensions, plus SHA-512 for comparison.
+ */
+
+void BenchSHA2()
+{
+    const uint64_t msgSizes[3]      = { 64, 1 << 10, 1 << 20 };
+    const char* msgNames[3]         = { "64 B", "1 KiB", "1 MiB" };
+    const SHA2Engine engines[2]     = { SHA2_SCALAR, SHA2_SHANI };
+    const char* engineNames[2]      = { "scalar", "SHA-NI" };
+    const uint32_t numEngines       = SHANISupported() ? 2 : 1;
+    const uint64_t totalBytes       = 1 << 24;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const uint64_t numMsgs = totalBytes / msgSizes[i];
+
+        vector<uint8_t> msg;
+        GenKey(8 * msgSizes[i], msg);
+
+        for (uint32_t j = 0; j < numEngines; j++)
+        {
+            SHA2 sha;
+            sha.SetEngine(engines[j]);
+
+            double start = GetTimeSeconds();
+
+            for (uint64_t k = 0; k < numMsgs; k++)
+            {
+                vector<uint8_t> md;
+                sha.Hash(SHA256, msg, md);
+            }
+
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput("SHA256 " + string(msgNames[i]) + " (" + engineNames[j] + ")", totalBytes, secs);
+        }
+
+        SHA2 sha;
+        double start = GetTimeSeconds();
+
+        for (uint64_t k = 0; k < numMsgs; k++)
+        {
+            vector<uint8_t> md;
+            sha.Hash(SHA512, msg, md);
+        }
+
+        double secs = GetTimeSeconds() - start;
+
+        PrintThroughput("SHA512 " + string(msgNames[i]) + " (scalar)", totalBytes, secs);
+    }
+}
+
+/**
+ * BenchSHA2Multi - Hash many independent 64 B, 256 B and 4 KiB messages with a loop
+ * over SHA2::Hash and with each multi-buffer engine, for SHA-256 and SHA-512.
+ */
+
+void BenchSHA2Multi()
+{
+    const uint64_t msgSizes[3]              = { 64, 256, 4096 };
+    const char* msgNames[3]                 = { "64 B", "256 B", "4 KiB" };
+    const SHASize sizes[2]                  = { SHA256, SHA512 };
+    const char* sizeNames[2]                = { "SHA256", "SHA512" };
+    const SHA2MultiEngine engines[3]        = { SHA2_MULTI_SERIAL, SHA2_MULTI_AVX2, SHA2_MULTI_AVX512 };
+    const char* engineNames[3]              = { "multi serial", "multi AVX2", "multi AVX-512" };
+    const bool bSupported[3]                = { true, CPUHasFeature(CPU_AVX2), CPUHasFeature(CPU_AVX512) };
+    const uint64_t totalBytes               = 1 << 24;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const uint64_t numMsgs = totalBytes / msgSizes[i];
+
+        vector<uint8_t> data;
+        GenKey(8 * totalBytes, data);
+
+        vector<const uint8_t*> msgs(numMsgs);
+        vector<uint64_t> lens(numMsgs, msgSizes[i]);
+        vector<uint8_t> mds(64 * numMsgs);
+
+        for (uint64_t k = 0; k < numMsgs; k++)
+            msgs[k] = &data[k * msgSizes[i]];
+
+        for (uint32_t s = 0; s < 2; s++)
+        {
+            SHA2 sha;
+            double start = GetTimeSeconds();
+
+            for (uint64_t k = 0; k < numMsgs; k++)
+            {
+                vector<uint8_t> msg(msgs[k], msgs[k] + msgSizes[i]);
+                vector<uint8_t> md;
+                sha.Hash(sizes[s], msg, md);
+            }
+
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput(string(sizeNames[s]) + " " + msgNames[i] + " (SHA2::Hash loop)", totalBytes, secs);
+
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                if (!bSupported[j])
+                    continue;
+
+                SHA2Multi multi;
+                multi.SetEngine(engines[j]);
+
+                start = GetTimeSeconds();
+                multi.Hash(sizes[s], msgs.data(), lens.data(), mds.data(), numMsgs);
+                secs = GetTimeSeconds() - start;
+
+                PrintThroughput(string(sizeNames[s]) + " " + msgNames[i] + " (" + engineNames[j] + ")", totalBytes, secs);
+            }
+        }
+    }
+}
+
+/**
+ * BenchSHA3Multi - SHA3-256 of many independent 64 B, 256 B and 4 KiB messages with
+ * a loop over SHA3::Hash and with batches on the scalar, 4-way AVX2 and 8-way
+ * AVX-512 Keccak engines.
+ */
+
+void BenchSHA3Multi()
+{
+    const uint64_t msgSizes[3]          = { 64, 256, 4096 };
+    const char* msgNames[3]             = { "64 B", "256 B", "4 KiB" };
+    const KeccakEngine engines[3]       = { KECCAK_SCALAR, KECCAK_AVX2, KECCAK_AVX512 };
+    const char* engineNames[3]          = { "batch scalar", "batch AVX2 x4", "batch AVX-512 x8" };
+    const bool bSupported[3]            = { true, CPUHasFeature(CPU_AVX2), CPUHasFeature(CPU_AVX512) };
+    const uint64_t totalBytes           = 1 << 24;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const uint64_t numMsgs = totalBytes / msgSizes[i];
+
+        vector<uint8_t> data;
+        GenKey(8 * totalBytes, data);
+
+        vector<const uint8_t*> msgs(numMsgs);
+        vector<uint64_t> lens(numMsgs, msgSizes[i]);
+        vector<uint8_t> mds(32 * numMsgs);
+
+        for (uint64_t k = 0; k < numMsgs; k++)
+            msgs[k] = &data[k * msgSizes[i]];
+
+        SHA3 sha(SHA256);
+        double start = GetTimeSeconds();
+
+        for (uint64_t k = 0; k < numMsgs; k++)
+        {
+            vector<uint8_t> msg(msgs[k], msgs[k] + msgSizes[i]);
+            vector<uint8_t> md;
+            sha.Hash(msg, md);
+        }
+
+        double secs = GetTimeSeconds() - start;
+
+        PrintThroughput("SHA3-256 " + string(msgNames[i]) + " (SHA3::Hash loop)", totalBytes, secs);
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            if (!bSupported[j])
+                continue;
+
+            SHA3Multi multi;
+            multi.SetEngine(engines[j]);
+
+            start = GetTimeSeconds();
+            multi.Hash(SHA256, msgs.data(), lens.data(), mds.data(), numMsgs);
+            secs = GetTimeSeconds() - start;
+
+            PrintThroughput("SHA3-256 " + string(msgNames[i]) + " (" + engineNames[j] + ")", totalBytes, secs);
+        }
+    }
+}
+
+/**
+ * BenchSHAKE - SHAKE128/256 output rate when squeezing 64 MiB from one seed, in
+ * 32 B pieces as a DRBG or mask generator would, and in 1 MiB pieces.
+ */
+
+void BenchSHAKE()
+{
+    const SHAKESize sizes[2]        = { SHAKE128, SHAKE256 };
+    const char* sizeNames[2]        = { "SHAKE128", "SHAKE256" };
+    const uint64_t chunkSizes[2]    = { 32, 1 << 20 };
+    const char* chunkNames[2]       = { "32 B", "1 MiB" };
+    const uint64_t totalBytes       = 1 << 26;
+
+    vector<uint8_t> seed;
+    vector<uint8_t> out(1 << 20);
+
+    GenKey(256, seed);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        for (uint32_t j = 0; j < 2; j++)
+        {
+            SHAKE shake(sizes[i]);
+            shake.Init();
+            shake.Update(seed);
+
+            double start = GetTimeSeconds();
+
+            for (uint64_t k = 0; k < totalBytes / chunkSizes[j]; k++)
+                shake.Squeeze(&out[0], chunkSizes[j]);
+
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput(string(sizeNames[i]) + " squeeze " + chunkNames[j] + " pieces", totalBytes, secs);
+        }
+    }
+}
+
+/**
+ * BenchParallelHash - ParallelHash128/256 of a 64 MiB message in 8 KiB chunks with
+ * the scalar and widest SIMD Keccak engines on 1, 2, 4, ... up to all hardware
+ * threads, next to a single cSHAKE sponge over the same message.
+ */
+
+void BenchParallelHash()
+{
+    const SHAKESize sizes[2]    = { SHAKE128, SHAKE256 };
+    const char* sizeNames[2]    = { "ParallelHash128", "ParallelHash256" };
+    const uint32_t maxThreads   = max(1u, thread::hardware_concurrency());
+    const uint64_t bytes        = 1 << 26;
+    const uint64_t chunkBytes   = 1 << 13;
+
+    const KeccakEngine simdEngine = CPUHasFeature(CPU_AVX512) ? KECCAK_AVX512 :
+        CPUHasFeature(CPU_AVX2) ? KECCAK_AVX2 : KECCAK_SCALAR;
+
+    const KeccakEngine engines[2]   = { KECCAK_SCALAR, simdEngine };
+    const char* engineNames[2]      = { "scalar", (simdEngine == KECCAK_AVX512) ? "AVX-512 x8" :
+        (simdEngine == KECCAK_AVX2) ? "AVX2 x4" : "scalar" };
+    const uint32_t numEngines       = (simdEngine == KECCAK_SCALAR) ? 1 : 2;
+
+    vector<uint8_t> msg;
+    GenKey(8 * bytes, msg);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        vector<uint8_t> out;
+
+        CSHAKE cshake(sizes[i]);
+
+        double start = GetTimeSeconds();
+        cshake.Hash(msg, out, 64);
+        double secs = GetTimeSeconds() - start;
+
+        PrintThroughput(string(sizeNames[i]) + " baseline (one cSHAKE sponge)", bytes, secs);
+
+        for (uint32_t j = 0; j < numEngines; j++)
+        {
+            for (uint32_t threads = 1; ; threads = min(2 * threads, maxThreads))
+            {
+                ParallelHash ph(sizes[i], chunkBytes);
+                ph.SetEngine(engines[j]);
+                ph.SetThreading(threads, PARALLELHASH_DEFAULT_THRESHOLD);
+
+                start = GetTimeSeconds();
+                ph.Hash(msg, out, 64);
+                secs = GetTimeSeconds() - start;
+
+                PrintThroughput(string(sizeNames[i]) + " (" + engineNames[j] + ", " +
+                    to_string(threads) + " threads)", bytes, secs);
+
+                if (threads == maxThreads)
+                    break;
+            }
+        }
+    }
+}
+
+/**
+ * BenchKMAC - KMAC128/256 of 64 B and 1 KiB messages, re-absorbing the key for
+ * every message and reusing the precomputed key state.
+ */
+
+void BenchKMAC()
+{
+    const SHAKESize sizes[2]    = { SHAKE128, SHAKE256 };
+    const char* sizeNames[2]    = { "KMAC128", "KMAC256" };
+    const uint64_t msgSizes[2]  = { 64, 1 << 10 };
+    const char* msgNames[2]     = { "64 B", "1 KiB" };
+    const uint64_t totalBytes   = 1 << 24;
+
+    vector<uint8_t> key;
+    GenKey(256, key);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        for (uint32_t j = 0; j < 2; j++)
+        {
+            const uint64_t numMsgs = totalBytes / msgSizes[j];
+
+            vector<uint8_t> msg;
+            vector<uint8_t> mac;
+            GenKey(8 * msgSizes[j], msg);
+
+            KMAC kmac(sizes[i]);
+
+            double start = GetTimeSeconds();
+
+            for (uint64_t k = 0; k < numMsgs; k++)
+            {
+                kmac.SetKey(key);
+                kmac.Mac(msg, mac, 32);
+            }
+
+            double secs = GetTimeSeconds() - start;
+
+            PrintThroughput(string(sizeNames[i]) + " " + msgNames[j] + " (key per message)", totalBytes, secs);
+
+            kmac.SetKey(key);
+
+            start = GetTimeSeconds();
+
+            for (uint64_t k = 0; k < numMsgs; k++)
+                kmac.Mac(msg, mac, 32);
+
+            secs = GetTimeSeconds() - start;
+
+            PrintThroughput(string(sizeNames[i]) + " " + msgNames[j] + " (key state reused)", totalBytes, secs);
+        }
+    }
+}
\ No newline at end of file
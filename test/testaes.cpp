@@ -1968,5 +1968,943 @@ TestResult TestAESDecrypt256OFB()
         res.caseResults.push_back({ PASS, "" });
     }
 
+    return res;
+}
+
+/**
+ * TestAESEncrypt128CTR - Encrypt plaintext with specified 128-bit key in
+ * counter (CTR) mode and compare against expected ciphertext (SP 800-38A F.5).
+ *
+ * @return Pass if generated cipher text matches expected value.
+ */
+
+TestResult TestAESEncrypt128CTR()
+{
+    TestResult res;
+
+    const vector<uint8_t> plainTxt =
+    {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+
+    const vector<uint32_t> key =
+    {
+        0x2b7e1516, 0x28aed2a6, 0xabf71588, 0x09cf4f3c
+    };
+
+    const vector<uint32_t> iv =
+    {
+        0xf0f1f2f3, 0xf4f5f6f7, 0xf8f9fafb, 0xfcfdfeff
+    };
+
+    const vector<uint8_t> cipherTxtExp =
+    {
+        0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+        0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+        0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+        0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+    };
+
+    vector<uint8_t> cipherTxtAct;
+
+    AES aes(AES128, CTR);
+    aes.SetIV(iv);
+    aes.Encrypt(plainTxt, cipherTxtAct, key);
+
+    if (cipherTxtAct.size() != cipherTxtExp.size() ||
+        (memcmp(&cipherTxtAct[0], &cipherTxtExp[0], cipherTxtAct.size()) != 0))
+    {
+        res.caseResults.push_back({ FAIL, "Unexpected cipher text generated in AES128 CTR encryption." });
+        assert(false);
+    }
+    else
+    {
+        res.caseResults.push_back({ PASS, "" });
+    }
+
+    return res;
+}
+
+/**
+ * TestAESEncrypt192CTR - Encrypt plaintext with specified 192-bit key in
+ * counter (CTR) mode and compare against expected ciphertext (SP 800-38A F.5).
+ *
+ * @return Pass if generated cipher text matches expected value.
+ */
+
+TestResult TestAESEncrypt192CTR()
+{
+    TestResult res;
+
+    const vector<uint8_t> plainTxt =
+    {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+
+    const vector<uint32_t> key =
+    {
+        0x8e73b0f7, 0xda0e6452, 0xc810f32b, 0x809079e5, 0x62f8ead2, 0x522c6b7b
+    };
+
+    const vector<uint32_t> iv =
+    {
+        0xf0f1f2f3, 0xf4f5f6f7, 0xf8f9fafb, 0xfcfdfeff
+    };
+
+    const vector<uint8_t> cipherTxtExp =
+    {
+        0x1a, 0xbc, 0x93, 0x24, 0x17, 0x52, 0x1c, 0xa2, 0x4f, 0x2b, 0x04, 0x59, 0xfe, 0x7e, 0x6e, 0x0b,
+        0x09, 0x03, 0x39, 0xec, 0x0a, 0xa6, 0xfa, 0xef, 0xd5, 0xcc, 0xc2, 0xc6, 0xf4, 0xce, 0x8e, 0x94,
+        0x1e, 0x36, 0xb2, 0x6b, 0xd1, 0xeb, 0xc6, 0x70, 0xd1, 0xbd, 0x1d, 0x66, 0x56, 0x20, 0xab, 0xf7,
+        0x4f, 0x78, 0xa7, 0xf6, 0xd2, 0x98, 0x09, 0x58, 0x5a, 0x97, 0xda, 0xec, 0x58, 0xc6, 0xb0, 0x50
+    };
+
+    vector<uint8_t> cipherTxtAct;
+
+    AES aes(AES192, CTR);
+    aes.SetIV(iv);
+    aes.Encrypt(plainTxt, cipherTxtAct, key);
+
+    if (cipherTxtAct.size() != cipherTxtExp.size() ||
+        (memcmp(&cipherTxtAct[0], &cipherTxtExp[0], cipherTxtAct.size()) != 0))
+    {
+        res.caseResults.push_back({ FAIL, "Unexpected cipher text generated in AES192 CTR encryption." });
+        assert(false);
+    }
+    else
+    {
+        res.caseResults.push_back({ PASS, "" });
+    }
+
+    return res;
+}
+
+/**
+ * TestAESEncrypt256CTR - Encrypt plaintext with specified 256-bit key in
+ * counter (CTR) mode and compare against expected ciphertext (SP 800-38A F.5).
+ *
+ * @return Pass if generated cipher text matches expected value.
+ */
+
+TestResult TestAESEncrypt256CTR()
+{
+    TestResult res;
+
+    const vector<uint8_t> plainTxt =
+    {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+
+    const vector<uint32_t> key =
+    {
+        0x603deb10, 0x15ca71be, 0x2b73aef0, 0x857d7781, 0x1f352c07, 0x3b6108d7, 0x2d9810a3, 0x0914dff4
+    };
+
+    const vector<uint32_t> iv =
+    {
+        0xf0f1f2f3, 0xf4f5f6f7, 0xf8f9fafb, 0xfcfdfeff
+    };
+
+    const vector<uint8_t> cipherTxtExp =
+    {
+        0x60, 0x1e, 0xc3, 0x13, 0x77, 0x57, 0x89, 0xa5, 0xb7, 0xa7, 0xf5, 0x04, 0xbb, 0xf3, 0xd2, 0x28,
+        0xf4, 0x43, 0xe3, 0xca, 0x4d, 0x62, 0xb5, 0x9a, 0xca, 0x84, 0xe9, 0x90, 0xca, 0xca, 0xf5, 0xc5,
+        0x2b, 0x09, 0x30, 0xda, 0xa2, 0x3d, 0xe9, 0x4c, 0xe8, 0x70, 0x17, 0xba, 0x2d, 0x84, 0x98, 0x8d,
+        0xdf, 0xc9, 0xc5, 0x8d, 0xb6, 0x7a, 0xad, 0xa6, 0x13, 0xc2, 0xdd, 0x08, 0x45, 0x79, 0x41, 0xa6
+    };
+
+    vector<uint8_t> cipherTxtAct;
+
+    AES aes(AES256, CTR);
+    aes.SetIV(iv);
+    aes.Encrypt(plainTxt, cipherTxtAct, key);
+
+    if (cipherTxtAct.size() != cipherTxtExp.size() ||
+        (memcmp(&cipherTxtAct[0], &cipherTxtExp[0], cipherTxtAct.size()) != 0))
+    {
+        res.caseResults.push_back({ FAIL, "Unexpected cipher text generated in AES256 CTR encryption." });
+        assert(false);
+    }
+    else
+    {
+        res.caseResults.push_back({ PASS, "" });
+    }
+
+    return res;
+}
+
+/**
+ * TestAESDecrypt128CTR - Decrypt ciphertext with specified 128-bit key in
+ * counter (CTR) mode and compare against expected plaintext (SP 800-38A F.5).
+ *
+ * @return Pass if generated plain text matches expected value.
+ */
+
+TestResult TestAESDecrypt128CTR()
+{
+    TestResult res;
+
+    const vector<uint8_t> cipherTxt =
+    {
+        0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+        0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+        0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+        0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+    };
+
+    const vector<uint32_t> key =
+    {
+        0x2b7e1516, 0x28aed2a6, 0xabf71588, 0x09cf4f3c
+    };
+
+    const vector<uint32_t> iv =
+    {
+        0xf0f1f2f3, 0xf4f5f6f7, 0xf8f9fafb, 0xfcfdfeff
+    };
+
+    const vector<uint8_t> plainTxtExp =
+    {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+
+    vector<uint8_t> plainTxtAct;
+
+    AES aes(AES128, CTR);
+    aes.SetIV(iv);
+    aes.Decrypt(cipherTxt, plainTxtAct, key);
+
+    if (plainTxtAct.size() != plainTxtExp.size() ||
+        (memcmp(&plainTxtAct[0], &plainTxtExp[0], plainTxtAct.size()) != 0))
+    {
+        res.caseResults.push_back({ FAIL, "Unexpected plain text generated in AES128 CTR decryption." });
+        assert(false);
+    }
+    else
+    {
+        res.caseResults.push_back({ PASS, "" });
+    }
+
+    return res;
+}
+
+/**
+ * TestAESDecrypt192CTR - Decrypt ciphertext with specified 192-bit key in
+ * counter (CTR) mode and compare against expected plaintext (SP 800-38A F.5).
+ *
+ * @return Pass if generated plain text matches expected value.
+ */
+
+TestResult TestAESDecrypt192CTR()
+{
+    TestResult res;
+
+    const vector<uint8_t> cipherTxt =
+    {
+        0x1a, 0xbc, 0x93, 0x24, 0x17, 0x52, 0x1c, 0xa2, 0x4f, 0x2b, 0x04, 0x59, 0xfe, 0x7e, 0x6e, 0x0b,
+        0x09, 0x03, 0x39, 0xec, 0x0a, 0xa6, 0xfa, 0xef, 0xd5, 0xcc, 0xc2, 0xc6, 0xf4, 0xce, 0x8e, 0x94,
+        0x1e, 0x36, 0xb2, 0x6b, 0xd1, 0xeb, 0xc6, 0x70, 0xd1, 0xbd, 0x1d, 0x66, 0x56, 0x20, 0xab, 0xf7,
+        0x4f, 0x78, 0xa7, 0xf6, 0xd2, 0x98, 0x09, 0x58, 0x5a, 0x97, 0xda, 0xec, 0x58, 0xc6, 0xb0, 0x50
+    };
+
+    const vector<uint32_t> key =
+    {
+        0x8e73b0f7, 0xda0e6452, 0xc810f32b, 0x809079e5, 0x62f8ead2, 0x522c6b7b
+    };
+
+    const vector<uint32_t> iv =
+    {
+        0xf0f1f2f3, 0xf4f5f6f7, 0xf8f9fafb, 0xfcfdfeff
+    };
+
+    const vector<uint8_t> plainTxtExp =
+    {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+
+    vector<uint8_t> plainTxtAct;
+
+    AES aes(AES192, CTR);
+    aes.SetIV(iv);
+    aes.Decrypt(cipherTxt, plainTxtAct, key);
+
+    if (plainTxtAct.size() != plainTxtExp.size() ||
+        (memcmp(&plainTxtAct[0], &plainTxtExp[0], plainTxtAct.size()) != 0))
+    {
+        res.caseResults.push_back({ FAIL, "Unexpected plain text generated in AES192 CTR decryption." });
+        assert(false);
+    }
+    else
+    {
+        res.caseResults.push_back({ PASS, "" });
+    }
+
+    return res;
+}
+
+/**
+ * TestAESDecrypt256CTR - Decrypt ciphertext with specified 256-bit key in
+ * counter (CTR) mode and compare against expected plaintext (SP 800-38A F.5).
+ *
+ * @return Pass if generated plain text matches expected value.
+ */
+
+TestResult TestAESDecrypt256CTR()
+{
+    TestResult res;
+
+    const vector<uint8_t> cipherTxt =
+    {
+        0x60, 0x1e, 0xc3, 0x13, 0x77, 0x57, 0x89, 0xa5, 0xb7, 0xa7, 0xf5, 0x04, 0xbb, 0xf3, 0xd2, 0x28,
+        0xf4, 0x43, 0xe3, 0xca, 0x4d, 0x62, 0xb5, 0x9a, 0xca, 0x84, 0xe9, 0x90, 0xca, 0xca, 0xf5, 0xc5,
+        0x2b, 0x09, 0x30, 0xda, 0xa2, 0x3d, 0xe9, 0x4c, 0xe8, 0x70, 0x17, 0xba, 0x2d, 0x84, 0x98, 0x8d,
+        0xdf, 0xc9, 0xc5, 0x8d, 0xb6, 0x7a, 0xad, 0xa6, 0x13, 0xc2, 0xdd, 0x08, 0x45, 0x79, 0x41, 0xa6
+    };
+
+    const vector<uint32_t> key =
+    {
+        0x603deb10, 0x15ca71be, 0x2b73aef0, 0x857d7781, 0x1f352c07, 0x3b6108d7, 0x2d9810a3, 0x0914dff4
+    };
+
+    const vector<uint32_t> iv =
+    {
+        0xf0f1f2f3, 0xf4f5f6f7, 0xf8f9fafb, 0xfcfdfeff
+    };
+
+    const vector<uint8_t> plainTxtExp =
+    {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+
+    vector<uint8_t> plainTxtAct;
+
+    AES aes(AES256, CTR);
+    aes.SetIV(iv);
+    aes.Decrypt(cipherTxt, plainTxtAct, key);
+
+    if (plainTxtAct.size() != plainTxtExp.size() ||
+        (memcmp(&plainTxtAct[0], &plainTxtExp[0], plainTxtAct.size()) != 0))
+    {
+        res.caseResults.push_back({ FAIL, "Unexpected plain text generated in AES256 CTR decryption." });
+        assert(false);
+    }
+    else
+    {
+        res.caseResults.push_back({ PASS, "" });
+    }
+
+    return res;
+}
+
+/**
+ * TestAESEngines - Encrypt and decrypt random messages in every mode with the
+ * reference, T-table, bitsliced and (when the CPU supports it) AES-NI engines and check that
+ * all produce the same output and leave the IV chained the same way.
+ *
+ * @return Pass if the engines agree and decryption recovers the plaintext.
+ */
+
+TestResult TestAESEngines()
+{
+    TestResult res;
+
+    const AESSize sizes[3]  = { AES128, AES192, AES256 };
+    const uint32_t nks[3]   = { 4, 6, 8 };
+    const AESMode modes[7]  = { ECB, CBC, CFB1, CFB8, CFB128, OFB, CTR };
+
+    vector<AESEngine> engines = { AES_TTABLE, AES_BITSLICED };
+
+    if (AESNISupported())
+        engines.push_back(AES_AESNI);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        for (uint32_t j = 0; j < 7; j++)
+        {
+            vector<uint8_t> keyBytes;
+            vector<uint8_t> ivBytes;
+            vector<uint8_t> plainTxt;
+
+            GenKey(32 * nks[i], keyBytes);
+            GenKey(128, ivBytes);
+            GenKey(8 * 16 * (rand() % 8 + 1), plainTxt);
+
+            vector<uint32_t> key(nks[i]);
+            vector<uint32_t> iv(4);
+
+            memcpy(&key[0], &keyBytes[0], 4 * nks[i]);
+            memcpy(&iv[0], &ivBytes[0], 16);
+
+            vector<uint8_t> cipherTxtRef;
+
+            AES aesRef(sizes[i], modes[j]);
+            aesRef.SetEngine(AES_REFERENCE);
+            aesRef.SetIV(iv);
+            aesRef.Encrypt(plainTxt, cipherTxtRef, key);
+
+            for (auto& engine : engines)
+            {
+                vector<uint8_t> cipherTxt;
+                vector<uint8_t> plainTxtOut;
+
+                AES aes(sizes[i], modes[j]);
+                aes.SetEngine(engine);
+                aes.SetIV(iv);
+                aes.Encrypt(plainTxt, cipherTxt, key);
+
+                bool ivMatch = (aes.iv == aesRef.iv);
+
+                aes.SetIV(iv);
+                aes.Decrypt(cipherTxt, plainTxtOut, key);
+
+                if (cipherTxtRef != cipherTxt || plainTxtOut != plainTxt || !ivMatch)
+                {
+                    res.caseResults.push_back({ FAIL, "AES engines disagree with the reference engine." });
+                    assert(false);
+                }
+                else
+                {
+                    res.caseResults.push_back({ PASS, "" });
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestAESKeySchedule - Expand each key once into a shared schedule and check that
+ * AES objects using it with SetKey match the expand-per-call API, including when
+ * several threads encrypt with the same schedule at once. Half of the threads
+ * switch to the bitsliced engine after the key is set, so its round keys have
+ * to be built then. A constant-time schedule must match the table-driven one, be
+ * refused by the table engines, and be completed when an object that expanded
+ * its key under the bitsliced engine switches to the T-table engine.
+ *
+ * @return Pass if all shared-schedule outputs match the per-call outputs.
+ */
+
+TestResult TestAESKeySchedule()
+{
+    TestResult res;
+
+    const AESSize sizes[3]      = { AES128, AES192, AES256 };
+    const uint32_t nks[3]       = { 4, 6, 8 };
+    const AESMode modes[7]      = { ECB, CBC, CFB1, CFB8, CFB128, OFB, CTR };
+    const uint32_t numThreads   = 4;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        vector<uint8_t> keyBytes;
+        GenKey(32 * nks[i], keyBytes);
+
+        vector<uint32_t> key(nks[i]);
+        memcpy(&key[0], &keyBytes[0], 4 * nks[i]);
+
+        const AESKeySchedule sched(key);
+
+        for (uint32_t j = 0; j < 7; j++)
+        {
+            vector<uint8_t> ivBytes;
+            GenKey(128, ivBytes);
+
+            vector<uint32_t> iv(4);
+            memcpy(&iv[0], &ivBytes[0], 16);
+
+            vector<vector<uint8_t>> plainTxts(numThreads);
+            vector<vector<uint8_t>> cipherTxtsRef(numThreads);
+            vector<vector<uint8_t>> cipherTxts(numThreads);
+            vector<vector<uint8_t>> plainTxtsOut(numThreads);
+
+            for (uint32_t t = 0; t < numThreads; t++)
+            {
+                GenKey(8 * 16 * (rand() % 8 + 1), plainTxts[t]);
+
+                AES aes(sizes[i], modes[j]);
+                aes.SetIV(iv);
+                aes.Encrypt(plainTxts[t], cipherTxtsRef[t], key);
+            }
+
+            vector<thread> workers;
+
+            for (uint32_t t = 0; t < numThreads; t++)
+            {
+                workers.push_back(thread([&, t]()
+                {
+                    AES aes(sizes[i], modes[j]);
+                    aes.SetKey(sched);
+
+                    if (t % 2)
+                        aes.SetEngine(AES_BITSLICED);
+
+                    aes.SetIV(iv);
+                    aes.Encrypt(plainTxts[t], cipherTxts[t]);
+
+                    aes.SetIV(iv);
+                    aes.Decrypt(cipherTxts[t], plainTxtsOut[t]);
+                }));
+            }
+
+            for (auto& worker : workers)
+                worker.join();
+
+            if (cipherTxts != cipherTxtsRef || plainTxtsOut != plainTxts)
+            {
+                res.caseResults.push_back({ FAIL, "AES shared key schedule output does not match per-call key expansion." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+
+        AES aesWrongSize((sizes[i] == AES128) ? AES256 : AES128, ECB);
+        bool bThrew = false;
+
+        try
+        {
+            aesWrongSize.SetKey(sched);
+        }
+        catch (const invalid_argument&)
+        {
+            bThrew = true;
+        }
+
+        res.caseResults.push_back({ bThrew ? PASS : FAIL, bThrew ? "" : "SetKey accepted a schedule of the wrong size." });
+
+        const AESKeySchedule schedCT(key, true);
+
+        AES aesTable(sizes[i], ECB);
+        aesTable.SetEngine(AES_TTABLE);
+        bThrew = false;
+
+        try
+        {
+            aesTable.SetKey(schedCT);
+        }
+        catch (const invalid_argument&)
+        {
+            bThrew = true;
+        }
+
+        vector<uint8_t> plainTxt;
+        vector<uint8_t> cipherTxtRef;
+        vector<uint8_t> cipherTxt;
+        vector<uint8_t> plainTxtOut;
+
+        GenKey(8 * 16 * 16, plainTxt);
+
+        AES aesRef(sizes[i], ECB);
+        aesRef.SetEngine(AES_REFERENCE);
+        aesRef.Encrypt(plainTxt, cipherTxtRef, key);
+
+        AES aesCT(sizes[i], ECB);
+        aesCT.SetEngine(AES_BITSLICED);
+        aesCT.ExpandKey(key);
+        aesCT.Encrypt(plainTxt, cipherTxt);
+        aesCT.SetEngine(AES_TTABLE);
+        aesCT.Decrypt(cipherTxt, plainTxtOut);
+
+        if (memcmp(schedCT.w, sched.w, sizeof(sched.w)) != 0 || !bThrew || cipherTxt != cipherTxtRef ||
+            plainTxtOut != plainTxt)
+        {
+            res.caseResults.push_back({ FAIL, "AES constant-time key schedule does not match or was misused." });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestAESCTRParallel - Encrypt random messages of uneven length in CTR mode with a
+ * counter that carries across 64-bit boundaries. Compare the multi-threaded path and
+ * each engine against serial reference-engine output, and check that the IV ends on
+ * the next unused counter so a message split into two calls gives the same result.
+ *
+ * @return Pass if all CTR paths agree.
+ */
+
+TestResult TestAESCTRParallel()
+{
+    TestResult res;
+
+    const AESSize sizes[3]  = { AES128, AES192, AES256 };
+    const uint32_t nks[3]   = { 4, 6, 8 };
+
+    vector<AESEngine> engines = { AES_TTABLE, AES_BITSLICED };
+
+    if (AESNISupported())
+        engines.push_back(AES_AESNI);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        vector<uint8_t> keyBytes;
+        vector<uint8_t> ivBytes;
+        vector<uint8_t> plainTxt;
+
+        GenKey(32 * nks[i], keyBytes);
+        GenKey(64, ivBytes);
+        GenKey(8 * (16 * (rand() % 512 + 64) + rand() % 16), plainTxt);
+
+        vector<uint32_t> key(nks[i]);
+        vector<uint32_t> iv(4);
+
+        memcpy(&key[0], &keyBytes[0], 4 * nks[i]);
+        memcpy(&iv[0], &ivBytes[0], 8);
+        iv[2] = 0xffffffff;
+        iv[3] = 0xfffffff0;
+
+        vector<uint8_t> cipherTxtRef;
+
+        AES aesRef(sizes[i], CTR);
+        aesRef.SetEngine(AES_REFERENCE);
+        aesRef.SetIV(iv);
+        aesRef.Encrypt(plainTxt, cipherTxtRef, key);
+
+        for (auto& engine : engines)
+        {
+            vector<uint8_t> cipherTxtSerial;
+            vector<uint8_t> cipherTxtThreaded;
+            vector<uint8_t> plainTxtOut;
+
+            AES aes(sizes[i], CTR);
+            aes.SetEngine(engine);
+
+            aes.SetThreading(1, 0);
+            aes.SetIV(iv);
+            aes.Encrypt(plainTxt, cipherTxtSerial, key);
+
+            bool ivMatch = (aes.iv == aesRef.iv);
+
+            aes.SetThreading(4, 0);
+            aes.SetIV(iv);
+            aes.Encrypt(plainTxt, cipherTxtThreaded, key);
+
+            ivMatch = ivMatch && (aes.iv == aesRef.iv);
+
+            aes.SetIV(iv);
+            aes.Decrypt(cipherTxtThreaded, plainTxtOut, key);
+
+            const uint64_t split = 16 * (plainTxt.size() / 32);
+            vector<uint8_t> head(plainTxt.begin(), plainTxt.begin() + split);
+            vector<uint8_t> tail(plainTxt.begin() + split, plainTxt.end());
+            vector<uint8_t> cipherTxtHead;
+            vector<uint8_t> cipherTxtTail;
+
+            aes.SetIV(iv);
+            aes.Encrypt(head, cipherTxtHead, key);
+            aes.Encrypt(tail, cipherTxtTail, key);
+            cipherTxtHead.insert(cipherTxtHead.end(), cipherTxtTail.begin(), cipherTxtTail.end());
+
+            if (cipherTxtSerial != cipherTxtRef || cipherTxtThreaded != cipherTxtRef ||
+                plainTxtOut != plainTxt || cipherTxtHead != cipherTxtRef || !ivMatch)
+            {
+                res.caseResults.push_back({ FAIL, "AES CTR output differs between engines or thread counts." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestAESChainedDecrypt - Encrypt random whole-block messages in CBC and CFB128 mode
+ * with the reference engine, then decrypt with each fast engine serially, split
+ * across threads, and in two calls. All must recover the plaintext and leave the IV
+ * on the last ciphertext block, matching the reference engine.
+ *
+ * @return Pass if all CBC and CFB128 decryption paths agree.
+ */
+
+TestResult TestAESChainedDecrypt()
+{
+    TestResult res;
+
+    const AESSize sizes[3]  = { AES128, AES192, AES256 };
+    const uint32_t nks[3]   = { 4, 6, 8 };
+    const AESMode modes[2]  = { CBC, CFB128 };
+
+    vector<AESEngine> engines = { AES_TTABLE, AES_BITSLICED };
+
+    if (AESNISupported())
+        engines.push_back(AES_AESNI);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        for (auto& mode : modes)
+        {
+            vector<uint8_t> keyBytes;
+            vector<uint8_t> ivBytes;
+            vector<uint8_t> plainTxt;
+
+            GenKey(32 * nks[i], keyBytes);
+            GenKey(128, ivBytes);
+            GenKey(8 * 16 * (rand() % 512 + 64), plainTxt);
+
+            vector<uint32_t> key(nks[i]);
+            vector<uint32_t> iv(4);
+
+            memcpy(&key[0], &keyBytes[0], 4 * nks[i]);
+            memcpy(&iv[0], &ivBytes[0], 16);
+
+            vector<uint8_t> cipherTxt;
+            vector<uint8_t> plainTxtRef;
+
+            AES aesRef(sizes[i], mode);
+            aesRef.SetEngine(AES_REFERENCE);
+            aesRef.SetIV(iv);
+            aesRef.Encrypt(plainTxt, cipherTxt, key);
+
+            aesRef.SetIV(iv);
+            aesRef.Decrypt(cipherTxt, plainTxtRef, key);
+
+            for (auto& engine : engines)
+            {
+                vector<uint8_t> plainTxtSerial;
+                vector<uint8_t> plainTxtThreaded;
+
+                AES aes(sizes[i], mode);
+                aes.SetEngine(engine);
+
+                aes.SetThreading(1, 0);
+                aes.SetIV(iv);
+                aes.Decrypt(cipherTxt, plainTxtSerial, key);
+
+                bool ivMatch = (aes.iv == aesRef.iv);
+
+                aes.SetThreading(4, 0);
+                aes.SetIV(iv);
+                aes.Decrypt(cipherTxt, plainTxtThreaded, key);
+
+                ivMatch = ivMatch && (aes.iv == aesRef.iv);
+
+                const uint64_t split = 16 * (cipherTxt.size() / 48);
+                vector<uint8_t> head(cipherTxt.begin(), cipherTxt.begin() + split);
+                vector<uint8_t> tail(cipherTxt.begin() + split, cipherTxt.end());
+                vector<uint8_t> plainTxtHead;
+                vector<uint8_t> plainTxtTail;
+
+                aes.SetIV(iv);
+                aes.Decrypt(head, plainTxtHead, key);
+                aes.Decrypt(tail, plainTxtTail, key);
+                plainTxtHead.insert(plainTxtHead.end(), plainTxtTail.begin(), plainTxtTail.end());
+
+                ivMatch = ivMatch && (aes.iv == aesRef.iv);
+
+                if (plainTxtRef != plainTxt || plainTxtSerial != plainTxt ||
+                    plainTxtThreaded != plainTxt || plainTxtHead != plainTxt || !ivMatch)
+                {
+                    res.caseResults.push_back({ FAIL, "AES CBC/CFB128 decryption differs between engines or thread counts." });
+                    assert(false);
+                }
+                else
+                {
+                    res.caseResults.push_back({ PASS, "" });
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestAESInPlace - Encrypt and decrypt random messages in every mode through the
+ * buffer API, in place, with each engine and thread count. Compare against the
+ * vector API on the reference engine, including the IV left for the next call, and
+ * check that partial ECB/CBC blocks are rejected.
+ *
+ * @return Pass if the in-place buffer API matches the vector API.
+ */
+
+TestResult TestAESInPlace()
+{
+    TestResult res;
+
+    const AESMode modes[7]  = { ECB, CBC, CFB1, CFB8, CFB128, OFB, CTR };
+    const uint32_t nk       = 4;
+
+    vector<AESEngine> engines = { AES_REFERENCE, AES_TTABLE, AES_BITSLICED };
+
+    if (AESNISupported())
+        engines.push_back(AES_AESNI);
+
+    for (auto& mode : modes)
+    {
+        const bool bWholeBlocks = (mode == ECB || mode == CBC);
+        const uint64_t len      = (mode == CFB1) ? (rand() % 64 + 1) :
+            16 * (rand() % 256 + 1) + (bWholeBlocks ? 0 : rand() % 16);
+
+        vector<uint8_t> keyBytes;
+        vector<uint8_t> ivBytes;
+        vector<uint8_t> plainTxt;
+
+        GenKey(32 * nk, keyBytes);
+        GenKey(128, ivBytes);
+        GenKey(8 * len, plainTxt);
+
+        vector<uint32_t> key(nk);
+        vector<uint32_t> iv(4);
+
+        memcpy(&key[0], &keyBytes[0], 4 * nk);
+        memcpy(&iv[0], &ivBytes[0], 16);
+
+        vector<uint8_t> cipherTxtRef;
+
+        AES aesRef(AES128, mode);
+        aesRef.SetEngine(AES_REFERENCE);
+        aesRef.SetIV(iv);
+        aesRef.Encrypt(plainTxt, cipherTxtRef, key);
+
+        for (auto& engine : engines)
+        {
+            for (uint32_t numThreads = 1; numThreads <= 4; numThreads += 3)
+            {
+                AES aes(AES128, mode);
+                aes.SetEngine(engine);
+                aes.SetThreading(numThreads, 0);
+                aes.ExpandKey(key);
+
+                vector<uint8_t> buf = plainTxt;
+
+                aes.SetIV(iv);
+                aes.Encrypt(buf.data(), buf.data(), buf.size());
+
+                bool bPass = (buf == cipherTxtRef) && (aes.iv == aesRef.iv);
+
+                aes.SetIV(iv);
+                aes.Decrypt(buf.data(), buf.data(), buf.size());
+
+                bPass = bPass && (buf == plainTxt) && (aes.iv == aesRef.iv);
+
+                if (bWholeBlocks)
+                {
+                    bool bThrew = false;
+
+                    try
+                    {
+                        aes.Encrypt(buf.data(), buf.data(), buf.size() - 1);
+                    }
+                    catch (const invalid_argument&)
+                    {
+                        bThrew = true;
+                    }
+
+                    bPass = bPass && bThrew;
+                }
+
+                if (!bPass)
+                {
+                    res.caseResults.push_back({ FAIL, "AES in-place buffer output differs from the vector API." });
+                    assert(false);
+                }
+                else
+                {
+                    res.caseResults.push_back({ PASS, "" });
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestAESMultiKey - Encrypt one to three blocks under each of a batch of random keys
+ * with every engine and key size, with key counts that leave partial AES-NI lane
+ * groups, and compare against encrypting each key's blocks separately in ECB mode.
+ *
+ * @return Pass if the batch output matches per-key encryption.
+ */
+
+TestResult TestAESMultiKey()
+{
+    TestResult res;
+
+    const AESSize sizes[3]  = { AES128, AES192, AES256 };
+    const uint32_t nks[3]   = { 4, 6, 8 };
+
+    vector<AESEngine> engines = { AES_REFERENCE, AES_TTABLE, AES_BITSLICED };
+
+    if (AESNISupported())
+        engines.push_back(AES_AESNI);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        for (uint64_t blocksPerKey = 1; blocksPerKey <= 3; blocksPerKey++)
+        {
+            const uint64_t numKeys  = rand() % 100 + 1;
+            const uint64_t len      = 16 * blocksPerKey * numKeys;
+
+            vector<uint8_t> keyBytes;
+            vector<uint8_t> plainTxt;
+
+            GenKey(32 * nks[i] * numKeys, keyBytes);
+            GenKey(8 * len, plainTxt);
+
+            vector<uint32_t> keys(nks[i] * numKeys);
+            memcpy(&keys[0], &keyBytes[0], 4 * keys.size());
+
+            vector<uint8_t> cipherTxtRef(len);
+
+            for (uint64_t k = 0; k < numKeys; k++)
+            {
+                AES aes(sizes[i], ECB);
+                aes.SetEngine(AES_REFERENCE);
+                aes.ExpandKey(vector<uint32_t>(&keys[nks[i] * k], &keys[nks[i] * (k + 1)]));
+                aes.Encrypt(&plainTxt[16 * blocksPerKey * k], &cipherTxtRef[16 * blocksPerKey * k],
+                    16 * blocksPerKey);
+            }
+
+            for (auto& engine : engines)
+            {
+                vector<uint8_t> cipherTxt(len);
+                vector<uint8_t> buf = plainTxt;
+
+                AESEncryptMultiKey(sizes[i], engine, &keys[0], &plainTxt[0], &cipherTxt[0], numKeys, blocksPerKey);
+                AESEncryptMultiKey(sizes[i], engine, &keys[0], &buf[0], &buf[0], numKeys, blocksPerKey);
+
+                if (cipherTxt != cipherTxtRef || buf != cipherTxtRef)
+                {
+                    res.caseResults.push_back({ FAIL, "AES multi-key batch output differs from per-key encryption." });
+                    assert(false);
+                }
+                else
+                {
+                    res.caseResults.push_back({ PASS, "" });
+                }
+            }
+        }
+    }
+
     return res;
 }
\ No newline at end of file
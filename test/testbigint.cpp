@@ -1,4 +1,5 @@
 #include "test.h"
+#include "modarith.h"
 
 static const uint64_t nSizes = 10;
 static const uint64_t maxShift = 16;
@@ -536,6 +537,70 @@ TestResult TestCmpMulBigIntCorrect()
     return res;
 }
 
+/**
+ * TestFastMulBigIntCorrect - Test Karatsuba and Toom-3 multiplication and
+ * squaring. Lower the thresholds so a few thousand bit operands recurse through
+ * both algorithms, including unbalanced operands, and compare against schoolbook
+ * products computed with the fast paths disabled.
+ *
+ * @return  Pass if fast products match schoolbook products, fail otherwise.
+ */
+
+TestResult TestFastMulBigIntCorrect()
+{
+    TestResult res;
+
+    const uint64_t nFastSizes               = 5;
+    const uint64_t fastBitSizes[nFastSizes] = { 1000, 2048, 3001, 4096, 6000 };
+    const uint64_t off                      = 1ULL << 40;
+
+    for (uint64_t i = 0; i < nFastSizes; i++)
+    {
+        for (uint64_t j = 0; j < numCasesPerSize; j++)
+        {
+            BigInt a;
+            BigIntRand(fastBitSizes[i], a);
+
+            BigInt b;
+            BigIntRand(fastBitSizes[i] / (1 + j % 3), b);
+
+            BigIntSetMulThresholds(off, off, off, off);
+
+            BigInt prodRef     = a * b;
+            BigInt sqrRef      = a * BigInt(a);
+
+            BigIntSetMulThresholds(4, 9, 4, 9);
+
+            BigInt prod        = a * b;
+            BigInt sqr         = a.Square();
+
+            BigIntSetMulThresholds(BIGINT_KARATSUBA_THRESHOLD, BIGINT_TOOM3_THRESHOLD,
+                BIGINT_SQR_KARATSUBA_THRESHOLD, BIGINT_SQR_TOOM3_THRESHOLD);
+
+            if (prod != prodRef || sqr != sqrRef)
+            {
+                char msg[256];
+
+                sprintf(
+                    msg,
+                    "BigInt fast multiply failed for %llu-bit operands (product %s, square %s).",
+                    (unsigned long long)fastBitSizes[i],
+                    prod != prodRef ? "wrong" : "ok",
+                    sqr != sqrRef ? "wrong" : "ok"
+                );
+
+                res.caseResults.push_back({ FAIL, string(msg) });
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
 /**
  * TestCmpDivBigIntCorrect - Test big integer division. Generate
  * two random big ints, multiply, then divide again. Check result matches
@@ -558,6 +623,9 @@ TestResult TestCmpDivBigIntCorrect()
             BigInt b;
             BigIntRand(testIntBitSizes[i - 1], b);
 
+            if (b == 0)
+                b = 1;
+
             BigInt tmp  = a;
             tmp         *= b;
             tmp         /= b;
@@ -616,6 +684,9 @@ TestResult TestCmpModBigIntCorrect()
             BigInt b;
             BigIntRand(testIntBitSizes[i - 1], b);
 
+            if (b == 0)
+                b = 1;
+
             BigInt q = a;
             BigInt r = a;
             q       /= b;
@@ -654,6 +725,200 @@ TestResult TestCmpModBigIntCorrect()
     return res;
 }
 
+/**
+ * TestDivModBigIntCorrect - Test combined big integer division. Generate values
+ * a and b, compute (q, r) = DivMod(a, b), and check a = b * q + r with r < b.
+ * Divisors are shifted up so multi-limb divisors with both small and large top
+ * limbs are covered.
+ *
+ * @return  Pass if quotients and remainders are consistent, fail otherwise.
+ */
+
+TestResult TestDivModBigIntCorrect()
+{
+    TestResult res;
+
+    for (uint64_t i = 1; i < nSizes; i++)
+    {
+        for (uint64_t j = 0; j < numCasesPerSize; j++)
+        {
+            BigInt a;
+            BigIntRand(testIntBitSizes[i], a);
+
+            BigInt b;
+            BigIntRand(testIntBitSizes[i - 1], b);
+
+            b++;
+            b <<= (j * 13) % testIntBitSizes[i - 1];
+
+            BigInt q;
+            BigInt r;
+            DivMod(a, b, q, r);
+
+            if (a != ((q * b) + r) || !(r < b))
+            {
+                char msg[256];
+
+                sprintf(
+                    msg,
+                    "BigInt DivMod failed with a = %s, b = %s, r = %s",
+                    a.GetHexString().c_str(),
+                    b.GetHexString().c_str(),
+                    r.GetHexString().c_str()
+                );
+
+                res.caseResults.push_back({ FAIL, string(msg) });
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestMontgomeryBigIntCorrect - Test Montgomery arithmetic. For random odd moduli,
+ * check multiply, square, add and subtract through Montgomery form against the
+ * generic operators, and ModExp against square and multiply with operator%=.
+ *
+ * @return  Pass if Montgomery results match generic results, fail otherwise.
+ */
+
+TestResult TestMontgomeryBigIntCorrect()
+{
+    TestResult res;
+
+    for (uint64_t i = 1; i < nSizes; i++)
+    {
+        for (uint64_t j = 0; j < numCasesPerSize; j++)
+        {
+            BigInt m;
+            BigIntRand(testIntBitSizes[i], m);
+            m.data[0] |= 0x3;
+
+            BigInt a;
+            BigIntRand(testIntBitSizes[i], a);
+            a %= m;
+
+            BigInt b;
+            BigIntRand(testIntBitSizes[i - 1], b);
+
+            BigInt e;
+            BigIntRand(testIntBitSizes[i - 1], e);
+
+            MontgomeryCtx ctx(m);
+            BigInt am = ctx.ToMont(a);
+            BigInt bm = ctx.ToMont(b);
+            b %= m;
+
+            BigInt expRef = 1;
+
+            for (uint64_t k = e.nBits; k-- > 0;)
+            {
+                expRef *= expRef;
+                expRef %= m;
+
+                if ((e.data[k / BIGINT_LIMB_BITS] >> (k % BIGINT_LIMB_BITS)) & 0x1)
+                {
+                    expRef *= a;
+                    expRef %= m;
+                }
+            }
+
+            bool bPass = true;
+
+            bPass &= ctx.FromMont(ctx.Mul(am, bm)) == (a * b) % m;
+            bPass &= ctx.FromMont(ctx.Sqr(am)) == (a * a) % m;
+            bPass &= ctx.FromMont(ctx.Add(am, bm)) == (a + b) % m;
+            bPass &= ctx.FromMont(ctx.Sub(am, bm)) == (a + m - b) % m;
+            bPass &= ModExp(a, e, m) == expRef;
+
+            if (!bPass)
+            {
+                char msg[256];
+
+                sprintf(
+                    msg,
+                    "BigInt Montgomery arithmetic failed with m = %s, a = %s",
+                    m.GetHexString().c_str(),
+                    a.GetHexString().c_str()
+                );
+
+                res.caseResults.push_back({ FAIL, string(msg) });
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestBarrettBigIntCorrect - Test Barrett reduction. For random moduli, check
+ * reduction of values below m and of double width products, and the modular
+ * multiply and square, against operator%=.
+ *
+ * @return  Pass if Barrett results match generic results, fail otherwise.
+ */
+
+TestResult TestBarrettBigIntCorrect()
+{
+    TestResult res;
+
+    for (uint64_t i = 1; i < nSizes; i++)
+    {
+        for (uint64_t j = 0; j < numCasesPerSize; j++)
+        {
+            BigInt m;
+            BigIntRand(testIntBitSizes[i], m);
+            m.data[0] |= 0x2;
+
+            BigInt a;
+            BigIntRand(testIntBitSizes[i], a);
+            a %= m;
+
+            BigInt b;
+            BigIntRand(testIntBitSizes[i - 1], b);
+            b %= m;
+
+            BarrettCtx ctx(m);
+            bool bPass = true;
+
+            bPass &= ctx.Reduce(b) == b;
+            bPass &= ctx.Reduce(a * b) == (a * b) % m;
+            bPass &= ctx.Mul(a, b) == (a * b) % m;
+            bPass &= ctx.Sqr(a) == (a * a) % m;
+            bPass &= ctx.Reduce((m - 1) * (m - 1)) == ((m - 1) * (m - 1)) % m;
+
+            if (!bPass)
+            {
+                char msg[256];
+
+                sprintf(
+                    msg,
+                    "BigInt Barrett reduction failed with m = %s, a = %s",
+                    m.GetHexString().c_str(),
+                    a.GetHexString().c_str()
+                );
+
+                res.caseResults.push_back({ FAIL, string(msg) });
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
 /**
  * TestSqrtBigIntCorrect - Test big integer square root function. Generate random large ints, square them,
  * then check Sqrt returns the original int.
@@ -0,0 +1,348 @@
+#include "test.h"
+#include "gcm.h"
+
+struct GCMTestVector
+{
+    string key;
+    string iv;
+    string aad;
+    string plainTxt;
+    string cipherTxt;
+    string tag;
+};
+
+static const string gcmPlainTxt64 =
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+    "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255";
+
+static const string gcmPlainTxt60 =
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+    "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39";
+
+static const string gcmAAD = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+
+static const string gcmLongIV =
+    "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728"
+    "c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b";
+
+/**
+ * GCMEngines - AES and GHASH engine pairs available on this CPU.
+ *
+ * @param aesEngines    [out] AES engine of each pair.
+ * @param ghashEngines  [out] GHASH engine of each pair.
+ */
+
+static void GCMEngines(vector<AESEngine>& aesEngines, vector<GHASHEngine>& ghashEngines)
+{
+    aesEngines      = { AES_REFERENCE, AES_TTABLE, AES_TTABLE };
+    ghashEngines    = { GHASH_4BIT, GHASH_4BIT, GHASH_8BIT };
+
+    if (AESNIGCMSupported())
+    {
+        aesEngines.push_back(AES_TTABLE);
+        ghashEngines.push_back(GHASH_PCLMUL);
+
+        aesEngines.push_back(AES_AESNI);
+        ghashEngines.push_back(GHASH_8BIT);
+
+        aesEngines.push_back(AES_AESNI);
+        ghashEngines.push_back(GHASH_PCLMUL);
+    }
+}
+
+/**
+ * KeyWords - Convert key bytes to the big-endian words AES takes.
+ *
+ * @param keyBytes  [in]    Key bytes.
+ * @param key       [out]   Key words.
+ */
+
+static void KeyWords(const vector<uint8_t>& keyBytes, vector<uint32_t>& key)
+{
+    key.resize(keyBytes.size() / 4);
+
+    for (uint32_t i = 0; i < key.size(); i++)
+    {
+        key[i] = (uint32_t)keyBytes[4 * i] << 24 | (uint32_t)keyBytes[4 * i + 1] << 16 |
+            (uint32_t)keyBytes[4 * i + 2] << 8 | keyBytes[4 * i + 3];
+    }
+}
+
+/**
+ * RunGCMVectors - Encrypt and decrypt known-answer vectors with every available
+ * engine pair. Also check that a corrupted tag is rejected.
+ *
+ * @param sz        [in]        AES key size.
+ * @param vectors   [in]        Test vectors.
+ * @param res       [in/out]    Test results.
+ */
+
+static void RunGCMVectors(const AESSize sz, const vector<GCMTestVector>& vectors, TestResult& res)
+{
+    vector<AESEngine> aesEngines;
+    vector<GHASHEngine> ghashEngines;
+
+    GCMEngines(aesEngines, ghashEngines);
+
+    for (auto& tv : vectors)
+    {
+        vector<uint8_t> keyBytes;
+        vector<uint8_t> iv;
+        vector<uint8_t> aad;
+        vector<uint8_t> plainTxt;
+        vector<uint8_t> cipherTxtExp;
+        vector<uint8_t> tagExp;
+        vector<uint32_t> key;
+
+        StringToHexArray(tv.key, keyBytes, false);
+        StringToHexArray(tv.iv, iv, false);
+        StringToHexArray(tv.aad, aad, false);
+        StringToHexArray(tv.plainTxt, plainTxt, false);
+        StringToHexArray(tv.cipherTxt, cipherTxtExp, false);
+        StringToHexArray(tv.tag, tagExp, false);
+        KeyWords(keyBytes, key);
+
+        for (uint32_t i = 0; i < aesEngines.size(); i++)
+        {
+            GCM gcm(sz);
+            gcm.SetEngine(aesEngines[i]);
+            gcm.SetGHASHEngine(ghashEngines[i]);
+            gcm.SetKey(key);
+
+            vector<uint8_t> cipherTxtAct;
+            vector<uint8_t> tagAct;
+            vector<uint8_t> plainTxtAct;
+            vector<uint8_t> plainTxtBad;
+
+            gcm.Encrypt(iv, aad, plainTxt, cipherTxtAct, tagAct);
+
+            bool bAuth      = gcm.Decrypt(iv, aad, cipherTxtExp, tagExp, plainTxtAct);
+            vector<uint8_t> tagBad = tagExp;
+            tagBad[0]       ^= 1;
+            bool bRejected  = !gcm.Decrypt(iv, aad, cipherTxtExp, tagBad, plainTxtBad) && plainTxtBad.size() == 0;
+
+            if (cipherTxtAct != cipherTxtExp || tagAct != tagExp || !bAuth ||
+                plainTxtAct != plainTxt || !bRejected)
+            {
+                res.caseResults.push_back({ FAIL, "Unexpected AES-GCM output for known-answer vector." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+}
+
+/**
+ * TestAESGCM128 - AES-128 GCM known-answer tests (GCM specification test cases 1-6),
+ * covering empty and partial-block text, AAD, and non-96-bit IVs.
+ *
+ * @return Pass if all vectors match with every engine.
+ */
+
+TestResult TestAESGCM128()
+{
+    TestResult res;
+
+    const string key = "feffe9928665731c6d6a8f9467308308";
+
+    const vector<GCMTestVector> vectors =
+    {
+        {
+            "00000000000000000000000000000000", "000000000000000000000000", "", "", "",
+            "58e2fccefa7e3061367f1d57a4e7455a"
+        },
+        {
+            "00000000000000000000000000000000", "000000000000000000000000", "",
+            "00000000000000000000000000000000",
+            "0388dace60b6a392f328c2b971b2fe78",
+            "ab6e47d42cec13bdf53a67b21257bddf"
+        },
+        {
+            key, "cafebabefacedbaddecaf888", "", gcmPlainTxt64,
+            "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+            "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985",
+            "4d5c2af327cd64a62cf35abd2ba6fab4"
+        },
+        {
+            key, "cafebabefacedbaddecaf888", gcmAAD, gcmPlainTxt60,
+            "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+            "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+            "5bc94fbc3221a5db94fae95ae7121a47"
+        },
+        {
+            key, "cafebabefacedbad", gcmAAD, gcmPlainTxt60,
+            "61353b4c2806934a777ff51fa22a4755699b2a714fcdc6f83766e5f97b6c7423"
+            "73806900e49f24b22b097544d4896b424989b5e1ebac0f07c23f4598",
+            "3612d2e79e3b0785561be14aaca2fccb"
+        },
+        {
+            key, gcmLongIV, gcmAAD, gcmPlainTxt60,
+            "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca7"
+            "01e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5",
+            "619cc5aefffe0bfa462af43c1699d050"
+        }
+    };
+
+    RunGCMVectors(AES128, vectors, res);
+    return res;
+}
+
+/**
+ * TestAESGCM192 - AES-192 GCM known-answer tests (GCM specification test cases 7-8).
+ *
+ * @return Pass if all vectors match with every engine.
+ */
+
+TestResult TestAESGCM192()
+{
+    TestResult res;
+
+    const string zeroKey = "000000000000000000000000000000000000000000000000";
+
+    const vector<GCMTestVector> vectors =
+    {
+        {
+            zeroKey, "000000000000000000000000", "", "", "",
+            "cd33b28ac773f74ba00ed1f312572435"
+        },
+        {
+            zeroKey, "000000000000000000000000", "",
+            "00000000000000000000000000000000",
+            "98e7247c07f0fe411c267e4384b0f600",
+            "2ff58d80033927ab8ef4d4587514f0fb"
+        }
+    };
+
+    RunGCMVectors(AES192, vectors, res);
+    return res;
+}
+
+/**
+ * TestAESGCM256 - AES-256 GCM known-answer tests (GCM specification test cases 13-16).
+ *
+ * @return Pass if all vectors match with every engine.
+ */
+
+TestResult TestAESGCM256()
+{
+    TestResult res;
+
+    const string zeroKey    = "0000000000000000000000000000000000000000000000000000000000000000";
+    const string key        = "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308";
+
+    const vector<GCMTestVector> vectors =
+    {
+        {
+            zeroKey, "000000000000000000000000", "", "", "",
+            "530f8afbc74536b9a963b4f1c4cb738b"
+        },
+        {
+            zeroKey, "000000000000000000000000", "",
+            "00000000000000000000000000000000",
+            "cea7403d4d606b6e074ec5d3baf39d18",
+            "d0d1c8a799996bf0265b98b5d48ab919"
+        },
+        {
+            key, "cafebabefacedbaddecaf888", "", gcmPlainTxt64,
+            "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+            "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662898015ad",
+            "b094dac5d93471bdec1a502270e3cc6c"
+        },
+        {
+            key, "cafebabefacedbaddecaf888", gcmAAD, gcmPlainTxt60,
+            "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+            "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+            "76fc6ece0f4e1768cddf8853bb2d551b"
+        }
+    };
+
+    RunGCMVectors(AES256, vectors, res);
+    return res;
+}
+
+/**
+ * TestAESGCMEngines - Encrypt random messages with random AAD and IV lengths using
+ * every available AES/GHASH engine pair and check that all agree with the reference
+ * AES engine and 4-bit GHASH, and that each decrypts its own output.
+ *
+ * @return Pass if all engine pairs agree.
+ */
+
+TestResult TestAESGCMEngines()
+{
+    TestResult res;
+
+    const AESSize sizes[3]  = { AES128, AES192, AES256 };
+    const uint32_t nks[3]   = { 4, 6, 8 };
+
+    vector<AESEngine> aesEngines;
+    vector<GHASHEngine> ghashEngines;
+
+    GCMEngines(aesEngines, ghashEngines);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        for (uint32_t trial = 0; trial < 8; trial++)
+        {
+            vector<uint8_t> keyBytes;
+            vector<uint8_t> iv;
+            vector<uint8_t> aad;
+            vector<uint8_t> plainTxt;
+            vector<uint32_t> key;
+
+            const uint32_t aadBytes = rand() % 48;
+            const uint32_t txtBytes = rand() % 600;
+
+            GenKey(32 * nks[i], keyBytes);
+            GenKey(8 * ((trial % 2) ? 12 : (rand() % 32 + 1)), iv);
+
+            if (aadBytes > 0)
+                GenKey(8 * aadBytes, aad);
+
+            if (txtBytes > 0)
+                GenKey(8 * txtBytes, plainTxt);
+
+            KeyWords(keyBytes, key);
+
+            vector<uint8_t> cipherTxtRef;
+            vector<uint8_t> tagRef;
+
+            for (uint32_t j = 0; j < aesEngines.size(); j++)
+            {
+                GCM gcm(sizes[i]);
+                gcm.SetEngine(aesEngines[j]);
+                gcm.SetGHASHEngine(ghashEngines[j]);
+                gcm.SetKey(key);
+
+                vector<uint8_t> cipherTxt;
+                vector<uint8_t> tag;
+                vector<uint8_t> plainTxtOut;
+
+                gcm.Encrypt(iv, aad, plainTxt, cipherTxt, tag);
+
+                if (j == 0)
+                {
+                    cipherTxtRef    = cipherTxt;
+                    tagRef          = tag;
+                }
+
+                bool bAuth = gcm.Decrypt(iv, aad, cipherTxt, tag, plainTxtOut);
+
+                if (cipherTxt != cipherTxtRef || tag != tagRef || !bAuth || plainTxtOut != plainTxt)
+                {
+                    res.caseResults.push_back({ FAIL, "AES-GCM engines disagree." });
+                    assert(false);
+                }
+                else
+                {
+                    res.caseResults.push_back({ PASS, "" });
+                }
+            }
+        }
+    }
+
+    return res;
+}
\ No newline at end of file
@@ -10,6 +10,11 @@ typedef vector<TestCase> TestGroupCases;
 typedef pair<TestGroupDesc, TestGroupCases> TestGroup;
 typedef vector<TestGroup> TestGroupList;
 
+typedef pair<string, pfnBenchFunc> BenchCase;
+typedef vector<BenchCase> BenchGroupCases;
+typedef pair<TestGroupDesc, BenchGroupCases> BenchGroup;
+typedef vector<BenchGroup> BenchGroupList;
+
 static bool gbLogToFile         = false;
 static string gLogFilePath      = "";
 static FILE *gpLogFile          = nullptr;
@@ -17,6 +22,7 @@ static FILE *gpLogFile          = nullptr;
 struct TestArgs
 {
     vector<uint64_t> testGroupIDs;
+    vector<uint64_t> benchGroupIDs;
 };
 
 map<ResultCode, string> ResultCodeStrings =
@@ -40,10 +46,14 @@ TestGroupList testGroups =
             { "TestCmpAddBigIntCorrect",    TestCmpAddBigIntCorrect },
             { "TestCmpSubBigIntCorrect",    TestCmpSubBigIntCorrect },
             { "TestCmpMulBigIntCorrect",    TestCmpMulBigIntCorrect },
+            { "TestFastMulBigIntCorrect",   TestFastMulBigIntCorrect },
             { "TestCmpDivBigIntCorrect",    TestCmpDivBigIntCorrect },
             { "TestCmpModBigIntCorrect",    TestCmpModBigIntCorrect },
-            { "TestSqrtBigIntCorrect",      TestSqrtBigIntCorrect }
-            //{ "TestGetModInverseBigInt",    TestGetModInverseBigInt }
+            { "TestDivModBigIntCorrect",    TestDivModBigIntCorrect },
+            { "TestMontgomeryBigIntCorrect", TestMontgomeryBigIntCorrect },
+            { "TestBarrettBigIntCorrect",   TestBarrettBigIntCorrect },
+            { "TestSqrtBigIntCorrect",      TestSqrtBigIntCorrect },
+            { "TestGetModInverseBigInt",    TestGetModInverseBigInt }
         }
     },
 
@@ -71,13 +81,16 @@ TestGroupList testGroups =
     {
         { 
             "Hash",
-            "SHA224/256/384/512 and SHA3 tests."
+            "SHA224/256/384/512, SHA3, SHAKE, cSHAKE, KMAC and ParallelHash tests."
         },
         {
             { "TestSHA224Short",            TestSHA224Short },
             { "TestSHA256Short",            TestSHA256Short },
             { "TestSHA384Short",            TestSHA384Short },
             { "TestSHA512Short",            TestSHA512Short },
+            { "TestSHA2Streaming",          TestSHA2Streaming },
+            { "TestSHA2Engines",            TestSHA2Engines },
+            { "TestSHA2Multi",              TestSHA2Multi },
             { "TestSHA3224Short",           TestSHA3224Short },
             { "TestSHA3224Long",            TestSHA3224Long },
             { "TestSHA3224Monte",           TestSHA3224Monte },
@@ -89,7 +102,14 @@ TestGroupList testGroups =
             { "TestSHA3384Monte",           TestSHA3384Monte },
             { "TestSHA3512Short",           TestSHA3512Short },
             { "TestSHA3512Long",            TestSHA3512Long },
-            { "TestSHA3512Monte",           TestSHA3512Monte }
+            { "TestSHA3512Monte",           TestSHA3512Monte },
+            { "TestSHA3Streaming",          TestSHA3Streaming },
+            { "TestKeccakMulti",            TestKeccakMulti },
+            { "TestSHA3Multi",              TestSHA3Multi },
+            { "TestSHAKE",                  TestSHAKE },
+            { "TestCSHAKE",                 TestCSHAKE },
+            { "TestParallelHash",           TestParallelHash },
+            { "TestKMAC",                   TestKMAC }
         }
     },
 
@@ -143,19 +163,87 @@ TestGroupList testGroups =
             { "TestAESEncrypt256OFB",       TestAESEncrypt256OFB },
             { "TestAESDecrypt128OFB",       TestAESDecrypt128OFB },
             { "TestAESDecrypt192OFB",       TestAESDecrypt192OFB },
-            { "TestAESDecrypt256OFB",       TestAESDecrypt256OFB }
+            { "TestAESDecrypt256OFB",       TestAESDecrypt256OFB },
+            { "TestAESEncrypt128CTR",       TestAESEncrypt128CTR },
+            { "TestAESEncrypt192CTR",       TestAESEncrypt192CTR },
+            { "TestAESEncrypt256CTR",       TestAESEncrypt256CTR },
+            { "TestAESDecrypt128CTR",       TestAESDecrypt128CTR },
+            { "TestAESDecrypt192CTR",       TestAESDecrypt192CTR },
+            { "TestAESDecrypt256CTR",       TestAESDecrypt256CTR },
+            { "TestAESEngines",             TestAESEngines },
+            { "TestAESKeySchedule",         TestAESKeySchedule },
+            { "TestThreadPoolStress",       TestThreadPoolStress },
+            { "TestAESCTRParallel",         TestAESCTRParallel },
+            { "TestAESChainedDecrypt",      TestAESChainedDecrypt },
+            { "TestAESInPlace",             TestAESInPlace },
+            { "TestAESMultiKey",            TestAESMultiKey },
+            { "TestAESGCM128",              TestAESGCM128 },
+            { "TestAESGCM192",              TestAESGCM192 },
+            { "TestAESGCM256",              TestAESGCM256 },
+            { "TestAESGCMEngines",          TestAESGCMEngines },
+            { "TestAESXTS128",              TestAESXTS128 },
+            { "TestAESXTS256",              TestAESXTS256 },
+            { "TestAESXTSSectors",          TestAESXTSSectors }
         }
     },
 
-    // {
-    //     {
-    //         "DSA",
-    //             "Digital signature tests."
-    //     },
-    //     {
-    //         { "TestSigGen", TestSigGen }
-    //     }
-    // },
+    {
+        {
+            "DSA",
+            "Digital signature tests."
+        },
+        {
+            { "TestECMultiplyBase",         TestECMultiplyBase }
+            //{ "TestSigGen", TestSigGen }
+        }
+    },
+};
+
+BenchGroupList benchGroups =
+{
+    {
+        {
+            "AES",
+            "AES engine throughput."
+        },
+        {
+            { "BenchAESEngines",            BenchAESEngines },
+            { "BenchAESKeySchedule",        BenchAESKeySchedule },
+            { "BenchAESMultiKey",           BenchAESMultiKey },
+            { "BenchAESCFBSegments",        BenchAESCFBSegments },
+            { "BenchAESCTR",                BenchAESCTR },
+            { "BenchAESCBCDecrypt",         BenchAESCBCDecrypt },
+            { "BenchAESGCM",                BenchAESGCM },
+            { "BenchAESXTS",                BenchAESXTS }
+        }
+    },
+
+    {
+        {
+            "Hash",
+            "Hash throughput."
+        },
+        {
+            { "BenchSHA2",                  BenchSHA2 },
+            { "BenchSHA2Multi",             BenchSHA2Multi },
+            { "BenchSHA3Multi",             BenchSHA3Multi },
+            { "BenchSHAKE",                 BenchSHAKE },
+            { "BenchParallelHash",          BenchParallelHash },
+            { "BenchKMAC",                  BenchKMAC }
+        }
+    },
+
+    {
+        {
+            "BigInt",
+            "Arbitrary size integer arithmetic."
+        },
+        {
+            { "BenchBigIntMul",             BenchBigIntMul },
+            { "BenchBigIntMulThresholds",   BenchBigIntMulThresholds },
+            { "BenchBarrettReduce",         BenchBarrettReduce }
+        }
+    },
 };
 
 /**
@@ -166,8 +254,9 @@ void PrintHelp()
 {
     printf("NISTCrypto Version %d.%d\n\n", VERSION_MAJOR, VERSION_MINOR);
 
-    printf("Usage: ./NISTCrypto [-r <x,y,z...>] [-o <path>]\n\n");
+    printf("Usage: ./NISTCrypto [-r <x,y,z...>] [-b <x,y,z...>] [-o <path>]\n\n");
     printf("    -r    Run a comma-separated list of numbered test groups, e.g., '-r 1, 3, 4'. See test groups below.\n");
+    printf("    -b    Run a comma-separated list of numbered benchmark groups. See benchmark groups below.\n");
     printf("    -o    Output test log file.\n\n");
 
     printf("Available Test Groups:\n\n");
@@ -176,6 +265,13 @@ void PrintHelp()
         printf("    %lu - %s: %s\n", i + 1, testGroups[i].first.first.c_str(), testGroups[i].first.second.c_str());
 
     printf("\n");
+
+    printf("Available Benchmark Groups:\n\n");
+
+    for (uint64_t i = 0; i < benchGroups.size(); i++)
+        printf("    %lu - %s: %s\n", i + 1, benchGroups[i].first.first.c_str(), benchGroups[i].first.second.c_str());
+
+    printf("\n");
 }
 
 /**
@@ -264,6 +360,39 @@ void ParseCommandLine(vector<string> &args, TestArgs &argsOut)
             continue;
         }
 
+        if (args[i] == "-b")
+        {
+            i++;
+
+            if (i >= args.size())
+            {
+                printf("Error: Expected benchmark group IDs after -b flag.\n");
+                exit(1);
+            }
+
+            string benchString = args[i];
+
+            for (uint64_t j = 0; j < benchString.length(); j++)
+            {
+                if (IsNumeric(benchString[j]))
+                {
+                    argsOut.benchGroupIDs.push_back(benchString[j] - '0');
+                    continue;
+                }
+                else if (benchString[j] == ',')
+                {
+                    continue;
+                }
+                else
+                {
+                    printf("Error: Unexpected character '%c' processing -b flag.\n", benchString[j]);
+                    exit(1);
+                }
+            }
+
+            continue;
+        }
+
         if (args[i] == "-o")
         {
             i++;
@@ -461,6 +590,76 @@ void RunTests(TestArgs& args)
         PrintStats(runStats);
 }
 
+/**
+ * GetTimeSeconds - Read a monotonic clock for benchmark timing.
+ *
+ * @return Current time in seconds.
+ */
+
+double GetTimeSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+/**
+ * PrintThroughput - Print one benchmark result line.
+ *
+ * @param name      [in] Description of what was measured.
+ * @param bytes     [in] Total number of bytes processed.
+ * @param seconds   [in] Elapsed time.
+ */
+
+void PrintThroughput(const string& name, const uint64_t bytes, const double seconds)
+{
+    printf("    %-48s %10.2f MB/s\n", name.c_str(), (double)bytes / (seconds * 1e6));
+}
+
+/**
+ * PrintOpTime - Print the average time of an operation for a benchmark.
+ *
+ * @param name      [in] Description of what was measured.
+ * @param ops       [in] Number of operations performed.
+ * @param seconds   [in] Elapsed time.
+ */
+
+void PrintOpTime(const string& name, const uint64_t ops, const double seconds)
+{
+    printf("    %-48s %10.2f us/op\n", name.c_str(), seconds * 1e6 / (double)ops);
+}
+
+/**
+ * RunBenchmarks - Run a set of benchmark groups based on the command line arguments.
+ *
+ * @param args [in] List of benchmark groups to run.
+ */
+
+void RunBenchmarks(TestArgs& args)
+{
+    for (uint64_t i = 0; i < args.benchGroupIDs.size(); i++)
+    {
+        uint64_t groupID = args.benchGroupIDs[i] - 1;
+
+        if (groupID >= benchGroups.size())
+            throw invalid_argument("Invalid benchmark group ID encountered running benchmarks.");
+
+        BenchGroupCases& groupCases = benchGroups[groupID].second;
+
+        for (uint64_t j = 0; j < groupCases.size(); j++)
+        {
+            printf("Benchmark group '%s' - Case '%s'\n\n",
+                benchGroups[groupID].first.first.c_str(),
+                groupCases[j].first.c_str()
+            );
+
+            groupCases[j].second();
+            printf("\n");
+        }
+    }
+}
+
 /**
  * GFMult - Multiply two 8-bit numbers as elements of GF(2^8) (see FIPS 197). Multiply
  * the two 8-bit values as polynomials mod 2, then reduce by the irreducible/prime polynomial
@@ -520,7 +719,12 @@ int main(int argc, char** argv)
     TestArgs argsOut;
 
     ParseCommandLine(args, argsOut);
-    RunTests(argsOut);
+
+    if (argsOut.testGroupIDs.size())
+        RunTests(argsOut);
+
+    if (argsOut.benchGroupIDs.size())
+        RunBenchmarks(argsOut);
 
     return 0;
 }
\ No newline at end of file
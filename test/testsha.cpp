@@ -1,5 +1,8 @@
 #include "test.h"
 #include "sha.h"
+#include "shani.h"
+#include "sha2multi.h"
+#include "keccakmulti.h"
 
 const uint64_t numCases = 100;
 
@@ -720,4 +723,921 @@ TestResult TestSHA3512Monte()
         SHA512);
 
     return res;
-}
\ No newline at end of file
+}
+
+/**
+ * TestSHA2Streaming - Hash random messages through Init/Update/Final in
+ * randomly sized pieces and compare against the one-shot Hash. Also check
+ * the FIPS 180-4 "abc" example for each digest size.
+ *
+ * @return  Pass if streamed MDs match, fail otherwise.
+ */
+
+TestResult TestSHA2Streaming()
+{
+    TestResult res;
+
+    const SHASize sizes[4] = { SHA224, SHA256, SHA384, SHA512 };
+
+    const string abcMDs[4] =
+    {
+        "23097D223405D8228642A477BDA255B32AADBCE4BDA0B3F7E36C9DA7",
+        "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD",
+        "CB00753F45A35E8BB5A03D699AC65007272C32AB0EDED1631A8B605A43FF5BED"
+        "8086072BA1E7CC2358BAECA134C825A7",
+        "DDAF35A193617ABACC417349AE20413112E6FA4E89A97EA20A9EEEE64B55D39A"
+        "2192992A274FC1A836BA3C23A3FEEBBD454D4423643CE80E2A9AC94FA54CA49F"
+    };
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        vector<uint8_t> abc = { 'a', 'b', 'c' };
+        vector<uint8_t> mdOut;
+        vector<uint8_t> mdExp;
+
+        SHA2 sha;
+        sha.Init(sizes[i]);
+        sha.Update(abc);
+        sha.Final(mdOut);
+
+        StringToHexArray(abcMDs[i], mdExp, false);
+
+        if (mdOut != mdExp)
+        {
+            res.caseResults.push_back({ FAIL, "SHA2 streaming 'abc' test failed." });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+
+        for (uint64_t j = 0; j < numCases; j++)
+        {
+            vector<uint8_t> msg;
+            vector<uint8_t> mdRef;
+            vector<uint8_t> mdStream;
+
+            GenKey(8 * (rand() % 1024 + 1), msg);
+
+            SHA2 shaRef;
+            shaRef.Hash(sizes[i], msg, mdRef);
+
+            SHA2 shaStream;
+            shaStream.Init(sizes[i]);
+
+            uint64_t offset = 0;
+
+            while (offset < msg.size())
+            {
+                uint64_t len = min((uint64_t)(rand() % 300), msg.size() - offset);
+                shaStream.Update(&msg[offset], len);
+                offset += len;
+            }
+
+            shaStream.Final(mdStream);
+
+            if (mdStream != mdRef)
+            {
+                res.caseResults.push_back({ FAIL, "SHA2 streaming MD does not match one-shot MD." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestSHA3Streaming - Absorb random messages through Init/Update/Final in
+ * randomly sized pieces and compare against the padded SHAStreamer path.
+ * Also check the FIPS 202 "abc" example for each digest size.
+ *
+ * @return  Pass if streamed MDs match, fail otherwise.
+ */
+
+TestResult TestSHA3Streaming()
+{
+    TestResult res;
+
+    const SHASize sizes[4] = { SHA224, SHA256, SHA384, SHA512 };
+
+    const string abcMDs[4] =
+    {
+        "E642824C3F8CF24AD09234EE7D3C766FC9A3A5168D0C94AD73B46FDF",
+        "3A985DA74FE225B2045C172D6BD390BD855F086E3E9D525B46BFE24511431532",
+        "EC01498288516FC926459F58E2C6AD8DF9B473CB0FC08C2596DA7CF0E49BE4B2"
+        "98D88CEA927AC7F539F1EDF228376D25",
+        "B751850B1A57168A5693CD924B6B096E08F621827444F70D884F5D0240D2712E"
+        "10E116E9192AF3C91A7EC57647E3934057340B4CF408D5A56592F8274EEC53F0"
+    };
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        vector<uint8_t> abc = { 'a', 'b', 'c' };
+        vector<uint8_t> mdOut;
+        vector<uint8_t> mdExp;
+
+        SHA3 sha3(sizes[i]);
+        sha3.Init();
+        sha3.Update(abc);
+        sha3.Final(mdOut);
+
+        StringToHexArray(abcMDs[i], mdExp, false);
+
+        if (mdOut != mdExp)
+        {
+            res.caseResults.push_back({ FAIL, "SHA3 streaming 'abc' test failed." });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+
+        for (uint64_t j = 0; j < numCases; j++)
+        {
+            vector<uint8_t> msg;
+            vector<uint8_t> mdRef;
+            vector<uint8_t> mdStream;
+
+            GenKey(8 * (rand() % 1024 + 1), msg);
+
+            SHA3 shaRef(sizes[i]);
+            vector<uint64_t> block(shaRef.params.r / 64);
+
+            shaRef.ClearState();
+            shaRef.stream.SetData(msg);
+
+            while (!shaRef.stream.End())
+            {
+                memset(&block[0], 0, 8 * block.size());
+                shaRef.stream.Next(block);
+                shaRef.SpongeAbsorbBlock(block);
+            }
+
+            shaRef.SpongeSqueezeBlock(mdRef);
+
+            SHA3 shaStream(sizes[i]);
+            shaStream.Init();
+
+            uint64_t offset = 0;
+
+            while (offset < msg.size())
+            {
+                uint64_t len = min((uint64_t)(rand() % 400), msg.size() - offset);
+                shaStream.Update(&msg[offset], len);
+                offset += len;
+            }
+
+            shaStream.Final(mdStream);
+
+            if (mdStream != mdRef)
+            {
+                res.caseResults.push_back({ FAIL, "SHA3 streaming MD does not match SHAStreamer MD." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestSHA2Engines - Hash random messages with the scalar SHA224/256 rounds and, when
+ * the CPU has them, the SHA extensions, one-shot and streamed in random pieces, and
+ * check that the MDs agree. Also check the FIPS 180-4 two-block example.
+ *
+ * @return  Pass if every engine produces the same MDs, fail otherwise.
+ */
+
+TestResult TestSHA2Engines()
+{
+    TestResult res;
+
+    const SHASize sizes[2] = { SHA224, SHA256 };
+
+    const string twoBlockMDs[2] =
+    {
+        "75388B16512776CC5DBA5DA1FD890150B0C6455CB4F58B1952522525",
+        "248D6A61D20638B8E5C026930C3E6039A33CE45964FF2167F6ECEDD419DB06C1"
+    };
+
+    const string twoBlockMsg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    vector<SHA2Engine> engines = { SHA2_SCALAR };
+
+    if (SHANISupported())
+        engines.push_back(SHA2_SHANI);
+
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        vector<uint8_t> mdExp;
+        StringToHexArray(twoBlockMDs[i], mdExp, false);
+
+        for (auto engine : engines)
+        {
+            vector<uint8_t> msg(twoBlockMsg.begin(), twoBlockMsg.end());
+            vector<uint8_t> md;
+
+            SHA2 sha;
+            sha.SetEngine(engine);
+            sha.Hash(sizes[i], msg, md);
+
+            if (md != mdExp)
+            {
+                res.caseResults.push_back({ FAIL, "SHA2 two-block example failed." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+
+        for (uint64_t j = 0; j < numCases; j++)
+        {
+            vector<uint8_t> msg;
+            vector<uint8_t> mdRef;
+
+            GenKey(8 * (rand() % 1024 + 1), msg);
+
+            SHA2 shaRef;
+            shaRef.SetEngine(SHA2_SCALAR);
+            shaRef.Hash(sizes[i], msg, mdRef);
+
+            bool bMatch = true;
+
+            for (auto engine : engines)
+            {
+                vector<uint8_t> md;
+                vector<uint8_t> mdStream;
+
+                SHA2 sha;
+                sha.SetEngine(engine);
+                sha.Hash(sizes[i], msg, md);
+
+                sha.Init(sizes[i]);
+
+                for (uint64_t offset = 0; offset < msg.size();)
+                {
+                    uint64_t len = min((uint64_t)(rand() % 200), msg.size() - offset);
+                    sha.Update(&msg[offset], len);
+                    offset += len;
+                }
+
+                sha.Final(mdStream);
+
+                bMatch = bMatch && md == mdRef && mdStream == mdRef;
+            }
+
+            if (!bMatch)
+            {
+                res.caseResults.push_back({ FAIL, "SHA2 engines produce different MDs." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestSHA2Multi - Hash batches of random messages with every multi-buffer engine
+ * the CPU supports and compare each digest against SHA2::Hash. Batches mix empty,
+ * single block, padding boundary and multi-block messages, and are not a multiple
+ * of the lane count, so lanes finish, refill and idle at different times.
+ *
+ * @return  Pass if all multi-buffer MDs match, fail otherwise.
+ */
+
+TestResult TestSHA2Multi()
+{
+    TestResult res;
+
+    const SHASize sizes[4]              = { SHA224, SHA256, SHA384, SHA512 };
+    const SHA2MultiEngine engines[3]    = { SHA2_MULTI_SERIAL, SHA2_MULTI_AVX2, SHA2_MULTI_AVX512 };
+    const bool bSupported[3]            = { true, CPUHasFeature(CPU_AVX2), CPUHasFeature(CPU_AVX512) };
+    const uint64_t fixedLens[10]        = { 0, 1, 55, 56, 63, 64, 111, 112, 127, 128 };
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        for (uint64_t j = 0; j < 3; j++)
+        {
+            if (!bSupported[j])
+                continue;
+
+            for (uint64_t k = 0; k < numCases; k++)
+            {
+                const uint64_t numMsgs = rand() % 40 + 1;
+
+                vector<vector<uint8_t>> msgs(numMsgs);
+                vector<vector<uint8_t>> mds;
+
+                for (uint64_t m = 0; m < numMsgs; m++)
+                {
+                    const uint64_t len = (m < 10) ? fixedLens[m] : rand() % 1024;
+
+                    if (len)
+                        GenKey(8 * len, msgs[m]);
+                }
+
+                SHA2Multi multi;
+                multi.SetEngine(engines[j]);
+                multi.Hash(sizes[i], msgs, mds);
+
+                bool bMatch = (mds.size() == numMsgs);
+
+                for (uint64_t m = 0; bMatch && m < numMsgs; m++)
+                {
+                    vector<uint8_t> mdRef;
+
+                    SHA2 sha;
+                    sha.Hash(sizes[i], msgs[m], mdRef);
+
+                    bMatch = (mds[m] == mdRef);
+                }
+
+                if (!bMatch)
+                {
+                    res.caseResults.push_back({ FAIL, "SHA2 multi-buffer MD does not match SHA2::Hash." });
+                    assert(false);
+                }
+                else
+                {
+                    res.caseResults.push_back({ PASS, "" });
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestKeccakMulti - Load random states into every lane of each supported Keccak
+ * engine, permute them together and check each lane against KeccakF1600 applied
+ * to the same state on its own. One lane is taken from a SHA3 object mid-message
+ * to check the interleaved layout agrees with SHA3::state.
+ *
+ * @return  Pass if every lane matches, fail otherwise.
+ */
+
+TestResult TestKeccakMulti()
+{
+    TestResult res;
+
+    const KeccakEngine engines[3]   = { KECCAK_SCALAR, KECCAK_AVX2, KECCAK_AVX512 };
+    const bool bSupported[3]        = { true, CPUHasFeature(CPU_AVX2), CPUHasFeature(CPU_AVX512) };
+
+    for (uint64_t i = 0; i < 3; i++)
+    {
+        if (!bSupported[i])
+            continue;
+
+        for (uint64_t j = 0; j < numCases; j++)
+        {
+            KeccakMulti keccak;
+            keccak.SetEngine(engines[i]);
+
+            const uint32_t lanes = keccak.Lanes();
+
+            vector<vector<uint64_t>> states(lanes, vector<uint64_t>(STATE_W * STATE_H));
+
+            for (uint32_t l = 0; l < lanes; l++)
+            {
+                vector<uint8_t> bytes;
+                GenKey(8 * STATE_BYTES, bytes);
+                memcpy(&states[l][0], &bytes[0], STATE_BYTES);
+            }
+
+            vector<uint8_t> msg;
+            GenKey(8 * (rand() % 512 + 1), msg);
+
+            SHA3 sha(SHA256);
+            sha.Init();
+            sha.Update(msg);
+            memcpy(&states[0][0], sha.state, STATE_BYTES);
+
+            for (uint32_t l = 0; l < lanes; l++)
+                keccak.Load(l, &states[l][0]);
+
+            keccak.Permute();
+
+            bool bMatch = true;
+
+            for (uint32_t l = 0; l < lanes; l++)
+            {
+                uint64_t out[STATE_W * STATE_H];
+
+                keccak.Store(l, out);
+                KeccakF1600(&states[l][0]);
+
+                if (memcmp(out, &states[l][0], STATE_BYTES))
+                    bMatch = false;
+            }
+
+            if (!bMatch)
+            {
+                res.caseResults.push_back({ FAIL, "Interleaved Keccak lane does not match KeccakF1600." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestSHA3Multi - Hash batches of random messages with every supported Keccak
+ * engine and compare each digest against SHA3::Hash. Batches mix empty, rate
+ * boundary and multi-block messages so lanes finish, refill and idle at
+ * different times.
+ *
+ * @return  Pass if all batch MDs match, fail otherwise.
+ */
+
+TestResult TestSHA3Multi()
+{
+    TestResult res;
+
+    const SHASize sizes[4]          = { SHA224, SHA256, SHA384, SHA512 };
+    const KeccakEngine engines[3]   = { KECCAK_SCALAR, KECCAK_AVX2, KECCAK_AVX512 };
+    const bool bSupported[3]        = { true, CPUHasFeature(CPU_AVX2), CPUHasFeature(CPU_AVX512) };
+    const uint64_t fixedLens[8]     = { 0, 1, 71, 72, 103, 104, 135, 136 };
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        for (uint64_t j = 0; j < 3; j++)
+        {
+            if (!bSupported[j])
+                continue;
+
+            for (uint64_t k = 0; k < numCases; k++)
+            {
+                const uint64_t numMsgs = rand() % 30 + 1;
+
+                vector<vector<uint8_t>> msgs(numMsgs);
+                vector<vector<uint8_t>> mds;
+
+                for (uint64_t m = 0; m < numMsgs; m++)
+                {
+                    const uint64_t len = (m < 8) ? fixedLens[m] : rand() % 1024;
+
+                    if (len)
+                        GenKey(8 * len, msgs[m]);
+                }
+
+                SHA3Multi multi;
+                multi.SetEngine(engines[j]);
+                multi.Hash(sizes[i], msgs, mds);
+
+                bool bMatch = (mds.size() == numMsgs);
+
+                for (uint64_t m = 0; bMatch && m < numMsgs; m++)
+                {
+                    vector<uint8_t> mdRef;
+
+                    SHA3 sha(sizes[i]);
+                    sha.Hash(msgs[m], mdRef);
+
+                    bMatch = (mds[m] == mdRef);
+                }
+
+                if (!bMatch)
+                {
+                    res.caseResults.push_back({ FAIL, "SHA3 batch MD does not match SHA3::Hash." });
+                    assert(false);
+                }
+                else
+                {
+                    res.caseResults.push_back({ PASS, "" });
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestSHAKE - Check SHAKE128/256 against known outputs for the empty string and
+ * "abc", then squeeze long outputs in randomly sized pieces and compare them with
+ * a single one-shot squeeze of the same total length.
+ *
+ * @return  Pass if all outputs match, fail otherwise.
+ */
+
+TestResult TestSHAKE()
+{
+    TestResult res;
+
+    const SHAKESize sizes[2] = { SHAKE128, SHAKE256 };
+
+    const string emptyOuts[2] =
+    {
+        "7F9C2BA4E88F827D616045507605853ED73B8093F6EFBC88EB1A6EACFA66EF26",
+        "46B9DD2B0BA88D13233B3FEB743EEB243FCD52EA62B81B82B50C27646ED5762F"
+        "D75DC4DDD8C0F200CB05019D67B592F6FC821C49479AB48640292EACB3B7C4BE"
+    };
+
+    const string abcOuts[2] =
+    {
+        "5881092DD818BF5CF8A3DDB793FBCBA74097D5C526A6D35F97B83351940F2CC8",
+        "483366601360A8771C6863080CC4114D8DB44530F8F1E1EE4F94EA37E78B5739"
+        "D5A15BEF186A5386C75744C0527E1FAA9F8726E462A12A4FEB06BD8801E751E4"
+    };
+
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        vector<uint8_t> empty;
+        vector<uint8_t> abc = { 'a', 'b', 'c' };
+        vector<uint8_t> outExp;
+        vector<uint8_t> out;
+
+        SHAKE shake(sizes[i]);
+
+        StringToHexArray(emptyOuts[i], outExp, false);
+        shake.Hash(empty, out, outExp.size());
+
+        bool bMatch = (out == outExp);
+
+        outExp.clear();
+        StringToHexArray(abcOuts[i], outExp, false);
+        shake.Hash(abc, out, outExp.size());
+
+        bMatch = bMatch && (out == outExp);
+
+        if (!bMatch)
+        {
+            res.caseResults.push_back({ FAIL, "SHAKE known answer test failed." });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+
+        for (uint64_t j = 0; j < numCases; j++)
+        {
+            vector<uint8_t> msg;
+            vector<uint8_t> outRef;
+            vector<uint8_t> outStream;
+
+            GenKey(8 * (rand() % 512 + 1), msg);
+
+            const uint64_t outLen = rand() % 4096 + 1;
+
+            SHAKE shakeRef(sizes[i]);
+            shakeRef.Hash(msg, outRef, outLen);
+
+            SHAKE shakeStream(sizes[i]);
+            shakeStream.Init();
+            shakeStream.Update(msg);
+
+            while (outStream.size() < outLen)
+            {
+                uint64_t len = min((uint64_t)(rand() % 300), outLen - outStream.size());
+                shakeStream.Squeeze(outStream, len);
+            }
+
+            if (outStream != outRef)
+            {
+                res.caseResults.push_back({ FAIL, "SHAKE streamed output does not match one-shot output." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestCSHAKE - NIST SP 800-185 cSHAKE128/256 samples with customization string
+ * "Email Signature".
+ *
+ * @return  Pass if all outputs match, fail otherwise.
+ */
+
+TestResult TestCSHAKE()
+{
+    TestResult res;
+
+    const string S = "Email Signature";
+
+    const SHAKESize sizes[4]    = { SHAKE128, SHAKE128, SHAKE256, SHAKE256 };
+    const uint64_t msgLens[4]   = { 4, 200, 4, 200 };
+
+    const string outs[4] =
+    {
+        "C1C36925B6409A04F1B504FCBCA9D82B4017277CB5ED2B2065FC1D3814D5AAF5",
+        "C5221D50E4F822D96A2E8881A961420F294B7B24FE3D2094BAED2C6524CC166B",
+        "D008828E2B80AC9D2218FFEE1D070C48B8E4C87BFF32C9699D5B6896EEE0EDD1"
+        "64020E2BE0560858D9C00C037E34A96937C561A74C412BB4C746469527281C8C",
+        "07DC27B11E51FBAC75BC7B3C1D983E8B4B85FB1DEFAF218912AC864302730917"
+        "27F42B17ED1DF63E8EC118F04B23633C1DFB1574C8FB55CB45DA8E25AFB092BB"
+    };
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        vector<uint8_t> msg(msgLens[i]);
+        vector<uint8_t> outExp;
+        vector<uint8_t> out;
+
+        for (uint64_t j = 0; j < msgLens[i]; j++)
+            msg[j] = (uint8_t)j;
+
+        StringToHexArray(outs[i], outExp, false);
+
+        CSHAKE cshake(sizes[i], {}, vector<uint8_t>(S.begin(), S.end()));
+        cshake.Hash(msg, out, outExp.size());
+
+        if (out != outExp)
+        {
+            res.caseResults.push_back({ FAIL, "cSHAKE sample test failed." });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestParallelHash - NIST SP 800-185 ParallelHash128/256 and ParallelHashXOF
+ * samples, then random messages hashed with every Keccak engine and with
+ * threading forced on, compared against the scalar single-threaded result.
+ *
+ * @return  Pass if all outputs match, fail otherwise.
+ */
+
+TestResult TestParallelHash()
+{
+    TestResult res;
+
+    const string S = "Parallel Data";
+
+    const SHAKESize sizes[8]    = { SHAKE128, SHAKE128, SHAKE128, SHAKE256, SHAKE256, SHAKE256, SHAKE128, SHAKE256 };
+    const bool bCustom[8]       = { false, true, true, false, true, true, false, false };
+    const bool bLongMsg[8]      = { false, false, true, false, false, true, false, false };
+    const bool bXOF[8]          = { false, false, false, false, false, false, true, true };
+
+    const string outs[8] =
+    {
+        "BA8DC1D1D979331D3F813603C67F72609AB5E44B94A0B8F9AF46514454A2B4F5",
+        "FC484DCB3F84DCEEDC353438151BEE58157D6EFED0445A81F165E495795B7206",
+        "F7FD5312896C6685C828AF7E2ADB97E393E7F8D54E3C2EA4B95E5ACA3796E8FC",
+        "BC1EF124DA34495E948EAD207DD9842235DA432D2BBC54B4C110E64C45110553"
+        "1B7F2A3E0CE055C02805E7C2DE1FB746AF97A1DD01F43B824E31B87612410429",
+        "CDF15289B54F6212B4BC270528B49526006DD9B54E2B6ADD1EF6900DDA3963BB"
+        "33A72491F236969CA8AFAEA29C682D47A393C065B38E29FAE651A2091C833110",
+        "69D0FCB764EA055DD09334BC6021CB7E4B61348DFF375DA262671CDEC3EFFA8D"
+        "1B4568A6CCE16B1CAD946DDDE27F6CE2B8DEE4CD1B24851EBF00EB90D43813E9",
+        "FE47D661E49FFE5B7D999922C062356750CAF552985B8E8CE6667F2727C3C8D3",
+        "C10A052722614684144D28474850B410757E3CBA87651BA167A5CBDDFF7F4666"
+        "75FBF84BCAE7378AC444BE681D729499AFCA667FB879348BFDDA427863C82F1C"
+    };
+
+    for (uint64_t i = 0; i < 8; i++)
+    {
+        // Samples 3 and 6 use 12 byte chunks of 00..0B, 10..1B, ..., 50..5B; the
+        // others three 8 byte chunks 00..07, 10..17, 20..27.
+
+        const uint64_t chunkBytes   = bLongMsg[i] ? 12 : 8;
+        const uint64_t numChunks    = bLongMsg[i] ? 6 : 3;
+
+        vector<uint8_t> msg;
+        vector<uint8_t> outExp;
+        vector<uint8_t> out;
+
+        for (uint64_t c = 0; c < numChunks; c++)
+            for (uint64_t j = 0; j < chunkBytes; j++)
+                msg.push_back((uint8_t)(0x10 * c + j));
+
+        StringToHexArray(outs[i], outExp, false);
+
+        ParallelHash ph(sizes[i], chunkBytes, bCustom[i] ? vector<uint8_t>(S.begin(), S.end()) : vector<uint8_t>());
+
+        if (bXOF[i])
+            ph.HashXOF(msg, out, outExp.size());
+        else
+            ph.Hash(msg, out, outExp.size());
+
+        if (out != outExp)
+        {
+            res.caseResults.push_back({ FAIL, "ParallelHash sample test failed." });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+    }
+
+    const KeccakEngine engines[3]   = { KECCAK_SCALAR, KECCAK_AVX2, KECCAK_AVX512 };
+    const bool bSupported[3]        = { true, CPUHasFeature(CPU_AVX2), CPUHasFeature(CPU_AVX512) };
+
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        for (uint64_t j = 0; j < numCases; j++)
+        {
+            const uint64_t chunkBytes = rand() % 300 + 1;
+
+            vector<uint8_t> msg;
+            vector<uint8_t> outRef;
+
+            if (rand() % 8)
+                GenKey(8 * (rand() % 8192 + 1), msg);
+
+            ParallelHash phRef(sizes[3 * i], chunkBytes);
+            phRef.SetEngine(KECCAK_SCALAR);
+            phRef.SetThreading(1, 0);
+            phRef.Hash(msg, outRef, 64);
+
+            bool bMatch = true;
+
+            for (uint64_t e = 0; e < 3; e++)
+            {
+                if (!bSupported[e])
+                    continue;
+
+                vector<uint8_t> out;
+
+                ParallelHash ph(sizes[3 * i], chunkBytes);
+                ph.SetEngine(engines[e]);
+                ph.SetThreading(4, 0);
+                ph.Hash(msg, out, 64);
+
+                bMatch = bMatch && (out == outRef);
+            }
+
+            if (!bMatch)
+            {
+                res.caseResults.push_back({ FAIL, "ParallelHash engine/threading result differs from scalar." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * TestKMAC - NIST SP 800-185 KMAC128/256 and KMACXOF samples with key 40..5F,
+ * then check that a copied keyed KMAC produces the same MACs as re-keying for
+ * every message, and that Verify rejects a modified, truncated or empty MAC and
+ * refuses expected lengths below KMAC_MIN_MAC_BYTES.
+ *
+ * @return  Pass if all MACs match, fail otherwise.
+ */
+
+TestResult TestKMAC()
+{
+    TestResult res;
+
+    const string S = "My Tagged Application";
+
+    const SHAKESize sizes[8]    = { SHAKE128, SHAKE128, SHAKE128, SHAKE256, SHAKE256, SHAKE256, SHAKE128, SHAKE256 };
+    const uint64_t msgLens[8]   = { 4, 4, 200, 4, 200, 200, 4, 4 };
+    const bool bCustom[8]       = { false, true, true, true, false, true, false, true };
+    const bool bXOF[8]          = { false, false, false, false, false, false, true, true };
+
+    const string macs[8] =
+    {
+        "E5780B0D3EA6F7D3A429C5706AA43A00FADBD7D49628839E3187243F456EE14E",
+        "3B1FBA963CD8B0B59E8C1A6D71888B7143651AF8BA0A7070C0979E2811324AA5",
+        "1F5B4E6CCA02209E0DCB5CA635B89A15E271ECC760071DFD805FAA38F9729230",
+        "20C570C31346F703C9AC36C61C03CB64C3970D0CFC787E9B79599D273A68D2F7"
+        "F69D4CC3DE9D104A351689F27CF6F5951F0103F33F4F24871024D9C27773A8DD",
+        "75358CF39E41494E949707927CEE0AF20A3FF553904C86B08F21CC414BCFD691"
+        "589D27CF5E15369CBBFF8B9A4C2EB17800855D0235FF635DA82533EC6B759B69",
+        "B58618F71F92E1D56C1B8C55DDD7CD188B97B4CA4D99831EB2699A837DA2E4D9"
+        "70FBACFDE50033AEA585F1A2708510C32D07880801BD182898FE476876FC8965",
+        "CD83740BBD92CCC8CF032B1481A0F4460E7CA9DD12B08A0C4031178BACD6EC35",
+        "1755133F1534752AAD0748F2C706FB5C784512CAB835CD15676B16C0C6647FA9"
+        "6FAA7AF634A0BF8FF6DF39374FA00FAD9A39E322A7C92065A64EB1FB0801EB2B"
+    };
+
+    vector<uint8_t> key(32);
+
+    for (uint64_t i = 0; i < 32; i++)
+        key[i] = (uint8_t)(0x40 + i);
+
+    for (uint64_t i = 0; i < 8; i++)
+    {
+        vector<uint8_t> msg(msgLens[i]);
+        vector<uint8_t> macExp;
+        vector<uint8_t> mac;
+
+        for (uint64_t j = 0; j < msgLens[i]; j++)
+            msg[j] = (uint8_t)j;
+
+        StringToHexArray(macs[i], macExp, false);
+
+        KMAC kmac(sizes[i], bCustom[i] ? vector<uint8_t>(S.begin(), S.end()) : vector<uint8_t>());
+        kmac.SetKey(key);
+
+        if (bXOF[i])
+        {
+            mac.resize(macExp.size());
+            kmac.Init();
+            kmac.Update(msg);
+            kmac.FinalXOF(mac.data(), mac.size());
+        }
+        else
+        {
+            kmac.Mac(msg, mac, macExp.size());
+        }
+
+        if (mac != macExp)
+        {
+            res.caseResults.push_back({ FAIL, "KMAC sample test failed." });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+    }
+
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        vector<uint8_t> randKey;
+        GenKey(8 * (rand() % 200 + 1), randKey);
+
+        KMAC keyed(i ? SHAKE256 : SHAKE128);
+        keyed.SetKey(randKey);
+
+        for (uint64_t j = 0; j < numCases; j++)
+        {
+            vector<uint8_t> msg;
+            vector<uint8_t> macRef;
+            vector<uint8_t> macClone;
+
+            GenKey(8 * (rand() % 1024 + 1), msg);
+
+            KMAC fresh(i ? SHAKE256 : SHAKE128);
+            fresh.SetKey(randKey);
+            fresh.Mac(msg, macRef, 32);
+
+            KMAC clone = keyed;
+            clone.Mac(msg, macClone, 32);
+
+            vector<uint8_t> badMac = macRef;
+            badMac[rand() % badMac.size()] ^= 1;
+
+            vector<uint8_t> shortMac(macRef.begin(), macRef.begin() + rand() % 32);
+
+            bool bThrew = false;
+
+            try
+            {
+                keyed.Verify(msg, {}, KMAC_MIN_MAC_BYTES - 1);
+            }
+            catch (invalid_argument&)
+            {
+                bThrew = true;
+            }
+
+            if (macClone != macRef || !keyed.Verify(msg, macRef, 32) || keyed.Verify(msg, badMac, 32) ||
+                keyed.Verify(msg, shortMac, 32) || keyed.Verify(msg, {}, 32) || !bThrew)
+            {
+                res.caseResults.push_back({ FAIL, "KMAC cloned key state or Verify failed." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,77 @@
+#include "test.h"
+#include "threadpool.h"
+
+#define THREADPOOL_STRESS_ROUNDS    16
+#define THREADPOOL_STRESS_JOBS      2048
+
+/**
+ * TestThreadPoolStress - Run many small back-to-back ParallelFor jobs on a private
+ * pool, so workers routinely wake after the job they were posted for has already
+ * finished. Every task of every job must run exactly once, and a task that throws
+ * must be rethrown to the caller without breaking the next job.
+ *
+ * @return Pass if every job ran each task exactly once.
+ */
+
+TestResult TestThreadPoolStress()
+{
+    TestResult res;
+
+    ThreadPool pool(4);
+
+    for (uint32_t round = 0; round < THREADPOOL_STRESS_ROUNDS; round++)
+    {
+        bool bMatch = true;
+
+        for (uint64_t i = 0; i < THREADPOOL_STRESS_JOBS; i++)
+        {
+            const uint64_t jobID    = round * THREADPOOL_STRESS_JOBS + i + 1;
+            const uint64_t numTasks = 2 + i % 7;
+
+            vector<uint64_t> hits(numTasks, 0);
+
+            pool.ParallelFor(numTasks, [&](uint64_t t)
+            {
+                hits[t] += jobID;
+            });
+
+            for (uint64_t t = 0; t < numTasks; t++)
+                bMatch = bMatch && (hits[t] == jobID);
+        }
+
+        bool bThrew = false;
+
+        try
+        {
+            pool.ParallelFor(8, [&](uint64_t t)
+            {
+                if (t == round % 8)
+                    throw runtime_error("Pool task failure.");
+            });
+        }
+        catch (runtime_error&)
+        {
+            bThrew = true;
+        }
+
+        if (!bMatch || !bThrew)
+        {
+            char msg[256];
+
+            sprintf(
+                msg,
+                "Thread pool round %u ran a task twice, skipped one, or lost an exception.",
+                round
+            );
+
+            res.caseResults.push_back({ FAIL, string(msg) });
+            assert(false);
+        }
+        else
+        {
+            res.caseResults.push_back({ PASS, "" });
+        }
+    }
+
+    return res;
+}
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include "test.h"
+#include "xts.h"
+
+struct XTSTestVector
+{
+    string key1;
+    string key2;
+    string tweak;
+    string plainTxt;
+    string cipherTxt;
+};
+
+static const string xtsCipherTxt4 =
+    "27a7479befa1d476489f308cd4cfa6e2a96e4bbe3208ff25287dd3819616e89c"
+    "c78cf7f5e543445f8333d8fa7f56000005279fa5d8b5e4ad40e736ddb4d35412"
+    "328063fd2aab53e5ea1e0a9f332500a5df9487d07a5c92cc512c8866c7e860ce"
+    "93fdf166a24912b422976146ae20ce846bb7dc9ba94a767aaef20c0d61ad0265"
+    "5ea92dc4c4e41a8952c651d33174be51a10c421110e6d81588ede82103a252d8"
+    "a750e8768defffed9122810aaeb99f9172af82b604dc4b8e51bcb08235a6f434"
+    "1332e4ca60482a4ba1a03b3e65008fc5da76b70bf1690db4eae29c5f1badd03c"
+    "5ccf2a55d705ddcd86d449511ceb7ec30bf12b1fa35b913f9f747a8afd1b130e"
+    "94bff94effd01a91735ca1726acd0b197c4e5b03393697e126826fb6bbde8ecc"
+    "1e08298516e2c9ed03ff3c1b7860f6de76d4cecd94c8119855ef5297ca67e9f3"
+    "e7ff72b1e99785ca0a7e7720c5b36dc6d72cac9574c8cbbc2f801e23e56fd344"
+    "b07f22154beba0f08ce8891e643ed995c94d9a69c9f1b5f499027a78572aeebd"
+    "74d20cc39881c213ee770b1010e4bea718846977ae119f7a023ab58cca0ad752"
+    "afe656bb3c17256a9f6e9bf19fdd5a38fc82bbe872c5539edb609ef4f79c203e"
+    "bb140f2e583cb2ad15b4aa5b655016a8449277dbd477ef2c8d6c017db738b18d"
+    "eb4a427d1923ce3ff262735779a418f20a282df920147beabe421ee5319d0568";
+
+static const string xtsCipherTxt10 =
+    "1c3b3a102f770386e4836c99e370cf9bea00803f5e482357a4ae12d414a3e63b"
+    "5d31e276f8fe4a8d66b317f9ac683f44680a86ac35adfc3345befecb4bb188fd"
+    "5776926c49a3095eb108fd1098baec70aaa66999a72a82f27d848b21d4a741b0"
+    "c5cd4d5fff9dac89aeba122961d03a757123e9870f8acf1000020887891429ca"
+    "2a3e7a7d7df7b10355165c8b9a6d0a7de8b062c4500dc4cd120c0f7418dae3d0"
+    "b5781c34803fa75421c790dfe1de1834f280d7667b327f6c8cd7557e12ac3a0f"
+    "93ec05c52e0493ef31a12d3d9260f79a289d6a379bc70c50841473d1a8cc81ec"
+    "583e9645e07b8d9670655ba5bbcfecc6dc3966380ad8fecb17b6ba02469a020a"
+    "84e18e8f84252070c13e9f1f289be54fbc481457778f616015e1327a02b140f1"
+    "505eb309326d68378f8374595c849d84f4c333ec4423885143cb47bd71c5edae"
+    "9be69a2ffeceb1bec9de244fbe15992b11b77c040f12bd8f6a975a44a0f90c29"
+    "a9abc3d4d893927284c58754cce294529f8614dcd2aba991925fedc4ae74ffac"
+    "6e333b93eb4aff0479da9a410e4450e0dd7ae4c6e2910900575da401fc07059f"
+    "645e8b7e9bfdef33943054ff84011493c27b3429eaedb4ed5376441a77ed4385"
+    "1ad77f16f541dfd269d50d6a5f14fb0aab1cbb4c1550be97f7ab4066193c4caa"
+    "773dad38014bd2092fa755c824bb5e54c4f36ffda9fcea70b9c6e693e148c151";
+
+/**
+ * XTSEngines - AES engines available on this CPU.
+ *
+ * @param engines [out] AES engines to test.
+ */
+
+static void XTSEngines(vector<AESEngine>& engines)
+{
+    engines = { AES_REFERENCE, AES_TTABLE, AES_BITSLICED };
+
+    if (AESNISupported())
+        engines.push_back(AES_AESNI);
+}
+
+/**
+ * XTSKey - Convert Key1 and Key2 bytes to the big-endian key words XTS::SetKey takes.
+ *
+ * @param keyBytes  [in]    Key1 bytes followed by Key2 bytes.
+ * @param key       [out]   Key words.
+ */
+
+static void XTSKey(const vector<uint8_t>& keyBytes, vector<uint32_t>& key)
+{
+    key.resize(keyBytes.size() / 4);
+
+    for (uint32_t i = 0; i < key.size(); i++)
+    {
+        key[i] = (uint32_t)keyBytes[4 * i] << 24 | (uint32_t)keyBytes[4 * i + 1] << 16 |
+            (uint32_t)keyBytes[4 * i + 2] << 8 | keyBytes[4 * i + 3];
+    }
+}
+
+/**
+ * CountingBytes - Plaintext of the IEEE 1619 vectors: bytes 00, 01, 02, ... wrapping at 256.
+ *
+ * @param len [in] Number of bytes.
+ * @return Hex string of the bytes.
+ */
+
+static string CountingBytes(const uint32_t len)
+{
+    string hex;
+    const char* digits = "0123456789abcdef";
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        hex += digits[(i >> 4) & 0xf];
+        hex += digits[i & 0xf];
+    }
+
+    return hex;
+}
+
+/**
+ * RunXTSVectors - Encrypt and decrypt known-answer vectors with every available
+ * engine, both into a separate buffer and in place.
+ *
+ * @param sz        [in]        AES key size.
+ * @param vectors   [in]        Test vectors.
+ * @param res       [in/out]    Test results.
+ */
+
+static void RunXTSVectors(const AESSize sz, const vector<XTSTestVector>& vectors, TestResult& res)
+{
+    vector<AESEngine> engines;
+    XTSEngines(engines);
+
+    for (auto& tv : vectors)
+    {
+        vector<uint8_t> keyBytes;
+        vector<uint8_t> key2Bytes;
+        vector<uint8_t> tweak;
+        vector<uint8_t> plainTxt;
+        vector<uint8_t> cipherTxtExp;
+        vector<uint32_t> key;
+
+        StringToHexArray(tv.key1, keyBytes, false);
+        StringToHexArray(tv.key2, key2Bytes, false);
+        StringToHexArray(tv.tweak, tweak, false);
+        StringToHexArray(tv.plainTxt, plainTxt, false);
+        StringToHexArray(tv.cipherTxt, cipherTxtExp, false);
+
+        keyBytes.insert(keyBytes.end(), key2Bytes.begin(), key2Bytes.end());
+        XTSKey(keyBytes, key);
+
+        for (auto engine : engines)
+        {
+            XTS xts(sz);
+            xts.SetEngine(engine);
+            xts.SetKey(key);
+
+            vector<uint8_t> cipherTxtAct(plainTxt.size());
+            vector<uint8_t> plainTxtAct(plainTxt.size());
+            vector<uint8_t> inPlace = plainTxt;
+
+            xts.EncryptSector(&tweak[0], &plainTxt[0], &cipherTxtAct[0], plainTxt.size());
+            xts.DecryptSector(&tweak[0], &cipherTxtExp[0], &plainTxtAct[0], cipherTxtExp.size());
+
+            xts.EncryptSector(&tweak[0], &inPlace[0], &inPlace[0], inPlace.size());
+            bool bInPlaceEnc = (inPlace == cipherTxtExp);
+            xts.DecryptSector(&tweak[0], &inPlace[0], &inPlace[0], inPlace.size());
+
+            if (cipherTxtAct != cipherTxtExp || plainTxtAct != plainTxt || !bInPlaceEnc ||
+                inPlace != plainTxt)
+            {
+                res.caseResults.push_back({ FAIL, "Unexpected XTS-AES output for known-answer vector." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+}
+
+/**
+ * TestAESXTS128 - XTS-AES-128 known-answer tests from IEEE 1619 Annex B (vectors 2-4,
+ * and 15-18 for ciphertext stealing).
+ *
+ * @return Pass if all vectors match with every engine.
+ */
+
+TestResult TestAESXTS128()
+{
+    TestResult res;
+
+    const string pt44       = "4444444444444444444444444444444444444444444444444444444444444444";
+    const string tweak33    = "33333333330000000000000000000000";
+    const string key1Steal  = "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0";
+    const string key2Steal  = "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0";
+    const string tweakSteal = "9a785634120000000000000000000000";
+
+    const vector<XTSTestVector> vectors =
+    {
+        {
+            "11111111111111111111111111111111", "22222222222222222222222222222222", tweak33, pt44,
+            "c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0"
+        },
+        {
+            "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0", "22222222222222222222222222222222", tweak33, pt44,
+            "af85336b597afc1a900b2eb21ec949d292df4c047e0b21532186a5971a227a89"
+        },
+        {
+            "27182818284590452353602874713526", "31415926535897932384626433832795",
+            "00000000000000000000000000000000", CountingBytes(512), xtsCipherTxt4
+        },
+        {
+            key1Steal, key2Steal, tweakSteal, CountingBytes(17),
+            "6c1625db4671522d3d7599601de7ca09ed"
+        },
+        {
+            key1Steal, key2Steal, tweakSteal, CountingBytes(18),
+            "d069444b7a7e0cab09e24447d24deb1fedbf"
+        },
+        {
+            key1Steal, key2Steal, tweakSteal, CountingBytes(19),
+            "e5df1351c0544ba1350b3363cd8ef4beedbf9d"
+        },
+        {
+            key1Steal, key2Steal, tweakSteal, CountingBytes(20),
+            "9d84c813f719aa2c7be3f66171c7c5c2edbf9dac"
+        }
+    };
+
+    RunXTSVectors(AES128, vectors, res);
+    return res;
+}
+
+/**
+ * TestAESXTS256 - XTS-AES-256 known-answer test from IEEE 1619 Annex B (vector 10).
+ *
+ * @return Pass if the vector matches with every engine.
+ */
+
+TestResult TestAESXTS256()
+{
+    TestResult res;
+
+    const vector<XTSTestVector> vectors =
+    {
+        {
+            "2718281828459045235360287471352662497757247093699959574966967627",
+            "3141592653589793238462643383279502884197169399375105820974944592",
+            "ff000000000000000000000000000000", CountingBytes(512), xtsCipherTxt10
+        }
+    };
+
+    RunXTSVectors(AES256, vectors, res);
+    return res;
+}
+
+/**
+ * TestAESXTSSectors - Encrypt random multi-sector buffers, including a short final
+ * sector, with the multi-sector API on one and several threads, and check that
+ * they match sector-by-sector encryption, decrypt back in place, and that invalid
+ * keys and data unit sizes are rejected.
+ *
+ * @return Pass if all checks succeed.
+ */
+
+TestResult TestAESXTSSectors()
+{
+    TestResult res;
+
+    const AESSize sizes[2]      = { AES128, AES256 };
+    const uint32_t nks[2]       = { 4, 8 };
+    const uint64_t sectorBytes  = 512;
+
+    vector<AESEngine> engines;
+    XTSEngines(engines);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        for (auto engine : engines)
+        {
+            vector<uint8_t> keyBytes;
+            vector<uint8_t> plainTxt;
+            vector<uint32_t> key;
+
+            const uint64_t len          = 9 * sectorBytes + 16 + rand() % 200;
+            const uint64_t firstSector  = ((uint64_t)rand() << 32) | rand();
+
+            GenKey(64 * nks[i], keyBytes);
+            GenKey(8 * len, plainTxt);
+            XTSKey(keyBytes, key);
+
+            XTS xts(sizes[i]);
+            xts.SetEngine(engine);
+            xts.SetKey(key);
+
+            vector<uint8_t> cipherTxtExp(len);
+
+            for (uint64_t offset = 0, sector = firstSector; offset < len; offset += sectorBytes, sector++)
+            {
+                uint8_t tweak[XTS_BLOCK_BYTES];
+                XTS::SectorTweak(sector, tweak);
+                xts.EncryptSector(tweak, &plainTxt[offset], &cipherTxtExp[offset],
+                    min(sectorBytes, len - offset));
+            }
+
+            bool bMatch = true;
+
+            for (uint32_t threads = 1; threads <= 4; threads += 3)
+            {
+                xts.SetThreading(threads, 0);
+
+                vector<uint8_t> cipherTxt(len);
+                vector<uint8_t> buf = plainTxt;
+
+                xts.EncryptSectors(firstSector, sectorBytes, &plainTxt[0], &cipherTxt[0], len);
+                xts.EncryptSectors(firstSector, sectorBytes, &buf[0], &buf[0], len);
+
+                bMatch = bMatch && cipherTxt == cipherTxtExp && buf == cipherTxtExp;
+
+                xts.DecryptSectors(firstSector, sectorBytes, &buf[0], &buf[0], len);
+                bMatch = bMatch && buf == plainTxt;
+            }
+
+            if (!bMatch)
+            {
+                res.caseResults.push_back({ FAIL, "XTS-AES multi-sector output mismatch." });
+                assert(false);
+            }
+            else
+            {
+                res.caseResults.push_back({ PASS, "" });
+            }
+        }
+    }
+
+    bool bRejected = true;
+
+    try
+    {
+        XTS xts(AES192);
+        bRejected = false;
+    }
+    catch (const invalid_argument&) {}
+
+    XTS xts(AES128);
+
+    try
+    {
+        xts.SetKey({ 1, 2, 3, 4, 1, 2, 3, 4 });
+        bRejected = false;
+    }
+    catch (const invalid_argument&) {}
+
+    xts.SetKey({ 1, 2, 3, 4, 5, 6, 7, 8 });
+
+    vector<uint8_t> shortTail(sectorBytes + 8);
+
+    try
+    {
+        xts.EncryptSectors(0, sectorBytes, &shortTail[0], &shortTail[0], shortTail.size());
+        bRejected = false;
+    }
+    catch (const invalid_argument&) {}
+
+    if (!bRejected)
+    {
+        res.caseResults.push_back({ FAIL, "XTS-AES accepted an invalid key or data unit size." });
+        assert(false);
+    }
+    else
+    {
+        res.caseResults.push_back({ PASS, "" });
+    }
+
+    return res;
+}
\ No newline at end of file